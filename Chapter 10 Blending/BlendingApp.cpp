@@ -12,6 +12,8 @@
 #include "Common/MathHelper.h"
 #include "Common/UploadBuffer.h"
 #include "Common/GeometryGenerator.h"
+#include "Common/RenderQueue.h"
+#include "Common/DDSTextureTools.h"
 #include "Waves.h"
 
 using Microsoft::WRL::ComPtr;
@@ -121,6 +123,9 @@ struct RenderItem
     UINT IndexCount = 0;
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
+
+    // 렌더 큐의 항목 ID입니다. mAllRitems에서의 인덱스입니다.
+    UINT QueueItem = 0;
 };
 
 enum class RenderLayer : int
@@ -169,7 +174,8 @@ private:
     void BuildFrameResources();
     void BuildMaterials();
     void BuildRenderItems();
-    void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
+    void BuildRenderQueue();
+    void SubmitRenderQueue(ID3D12GraphicsCommandList* cmdList);
 
     std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
@@ -201,6 +207,14 @@ private:
     // PSO에 의해 나눠진 렌더 아이템 목록.
     std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+    // 모든 레이어의 렌더 아이템을 키로 정렬하고 바뀌는 상태만 기록한 명령들입니다.
+    RenderQueue mRenderQueue;
+    std::vector<RenderCommand> mRenderCommands;
+
+    // 렌더 큐의 지오메트리 ID와 재질 ID가 가리키는 대상입니다.
+    std::vector<std::pair<MeshGeometry*, D3D12_PRIMITIVE_TOPOLOGY>> mQueueGeometries;
+    std::vector<Material*> mQueueMaterials;
+
     std::unique_ptr<Waves> mWaves;
 
     PassConstants mMainPassCB;
@@ -331,6 +345,8 @@ void BlendingApp::Update(const GameTimer& gt)
     UpdateMaterialCBs(gt);
     UpdateMainPassCB(gt);
     UpdateWaves(gt);
+
+    BuildRenderQueue();
 }
 
 void BlendingApp::Draw(const GameTimer& gt)
@@ -368,13 +384,7 @@ void BlendingApp::Draw(const GameTimer& gt)
     auto passCB = mCurrFrameResource->PassCB->Resource();
     mCommandList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
-
-    mCommandList->SetPipelineState(mPSOs["alphaTested"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::AlphaTested]);
-
-    mCommandList->SetPipelineState(mPSOs["transparent"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Transparent]);
+    SubmitRenderQueue(mCommandList.Get());
 
     // 리소스의 상태를 출력할 수 있도록 변경합니다.
     mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
@@ -492,6 +502,8 @@ void BlendingApp::UpdateCamera(const GameTimer& gt)
 
 void BlendingApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -514,6 +526,8 @@ void BlendingApp::UpdateObjectCBs(const GameTimer& gt)
 
 void BlendingApp::UpdateMaterialCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currentMaterialCB = mCurrFrameResource->MaterialCB.get();
     for (auto& e : mMaterials)
     {
@@ -575,6 +589,8 @@ void BlendingApp::UpdateMainPassCB(const GameTimer& gt)
 
 void BlendingApp::UpdateWaves(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     // 0.25초마다 랜덤 웨이브를 발생시킵니다.
     static float t_base = 0.0f;
     if ((mTimer.TotalTime() - t_base) >= 0.25f)
@@ -631,9 +647,22 @@ void BlendingApp::LoadTextures()
     auto fenceTex = std::make_unique<Texture>();
     fenceTex->Name = "fenceTex";
     fenceTex->Filename = L"..\\Textures\\WireFence.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), fenceTex->Filename.c_str(),
-                                                      fenceTex->Resource, fenceTex->UploadHeap));
+
+    // 철망은 알파 테스트로 그립니다. 파일의 밉들을 그대로 쓰면 멀어질수록 clip을 통과하는 텍셀이
+    // 줄어서 철망이 가늘어지다가 사라지므로, 통과하는 비율을 최상위 밉과 같게 맞춘 밉 체인을 다시 만듭니다.
+    MipGenerationOptions fenceMipOptions;
+    fenceMipOptions.PreserveAlphaCoverage = true;
+    fenceMipOptions.AlphaReference = 0.1f; // Default.hlsl의 clip(diffuseAlbedo.a - 0.1f)
+
+    auto fenceBlob = d3dUtil::LoadBinary(fenceTex->Filename);
+    auto fenceBits = reinterpret_cast<const uint8_t*>(fenceBlob->GetBufferPointer());
+    std::vector<uint8_t> fenceData;
+    if (!GenerateDDSMipChain(fenceBits, fenceBlob->GetBufferSize(), fenceMipOptions, fenceData))
+        fenceData.assign(fenceBits, fenceBits + fenceBlob->GetBufferSize());
+
+    ThrowIfFailed(DirectX::CreateDDSTextureFromMemory12(md3dDevice.Get(),
+                                                        mCommandList.Get(), fenceData.data(), fenceData.size(),
+                                                        fenceTex->Resource, fenceTex->UploadHeap));
 
     mTextures[grassTex->Name] = std::move(grassTex);
     mTextures[waterTex->Name] = std::move(waterTex);
@@ -1062,37 +1091,118 @@ void BlendingApp::BuildRenderItems()
     mAllRitems.push_back(std::move(wavesRitem));
     mAllRitems.push_back(std::move(gridRitem));
     mAllRitems.push_back(std::move(boxRitem));
+
+    for (UINT i = 0; i < (UINT)mAllRitems.size(); ++i)
+        mAllRitems[i]->QueueItem = i;
 }
 
-void BlendingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
+// 그리는 순서대로의 레이어와 각 레이어의 PSO입니다. 순서가 렌더 큐의 레이어 ID이자 PSO ID입니다.
+static const RenderLayer gDrawOrder[] = { RenderLayer::Opaque, RenderLayer::AlphaTested, RenderLayer::Transparent };
+static const char* gDrawOrderPSOs[] = { "opaque", "alphaTested", "transparent" };
+
+void BlendingApp::BuildRenderQueue()
 {
-    UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-    UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
+    mRenderQueue.Clear();
 
-    auto objectCB = mCurrFrameResource->ObjectCB->Resource();
-    auto matCB = mCurrFrameResource->MaterialCB->Resource();
+    XMMATRIX view = XMLoadFloat4x4(&mView);
+    const float depthRange = mMainPassCB.FarZ - mMainPassCB.NearZ;
 
-    // 각 렌더 항목에 대해서...
-    for (size_t i = 0; i < ritems.size(); ++i)
+    for (UINT layer = 0; layer < _countof(gDrawOrder); ++layer)
     {
-        auto ri = ritems[i];
+        // 블렌딩하는 레이어는 뒤에서부터 그려야 합니다.
+        const bool backToFront = gDrawOrder[layer] == RenderLayer::Transparent;
 
-        cmdList->IASetVertexBuffers(0, 1, &ri->Geo->VertexBufferView());
-        cmdList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
-        cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
+        for (RenderItem* ri : mRitemLayer[(int)gDrawOrder[layer]])
+        {
+            auto geometry = std::make_pair(ri->Geo, ri->PrimitiveType);
+            auto geoIt = std::find(mQueueGeometries.begin(), mQueueGeometries.end(), geometry);
+            if (geoIt == mQueueGeometries.end())
+                geoIt = mQueueGeometries.insert(mQueueGeometries.end(), geometry);
+
+            if (mQueueMaterials.size() <= (size_t)ri->Mat->MatCBIndex)
+                mQueueMaterials.resize(ri->Mat->MatCBIndex + 1, nullptr);
+            mQueueMaterials[ri->Mat->MatCBIndex] = ri->Mat;
+
+            // 오브젝트 원점의 view 공간 깊이를 근평면 0, 원평면 1로 정규화해서 정렬합니다.
+            // 투영한 깊이와 달리 거리에 선형이고, 카메라 뒤에 있으면 음수가 되어 0으로 잘립니다.
+            XMMATRIX world = XMLoadFloat4x4(&ri->World);
+            XMVECTOR viewPos = XMVector3TransformCoord(world.r[3], view);
+            const float depth = (XMVectorGetZ(viewPos) - mMainPassCB.NearZ) / depthRange;
+
+            mRenderQueue.Add(ri->QueueItem, layer, layer, (UINT)(geoIt - mQueueGeometries.begin()),
+                ri->Mat->MatCBIndex, depth, backToFront);
+        }
+    }
 
-        CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-        tex.Offset(ri->Mat->DiffuseSrvHeapIndex, mCbvSrvUavDescriptorSize);
+    mRenderQueue.Sort();
+    mRenderQueue.BuildCommandStream(mRenderCommands);
 
-        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * objCBByteSize;
-        D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = matCB->GetGPUVirtualAddress() + ri->Mat->MatCBIndex * matCBByteSize;
+    std::wostringstream outs;
+    outs << L"Blending Demo    " << mRenderQueue.LastStats().StateChanges << L" state changes, "
+        << mRenderQueue.LastStats().StateChangesAvoided << L" avoided";
+    mMainWndCaption = outs.str();
+}
 
-        cmdList->SetGraphicsRootDescriptorTable(0, tex);
-        cmdList->SetGraphicsRootConstantBufferView(1, objCBAddress);
-        cmdList->SetGraphicsRootConstantBufferView(3, matCBAddress);
+void BlendingApp::SubmitRenderQueue(ID3D12GraphicsCommandList* cmdList)
+{
+    // 렌더 큐가 기록한 명령들을 그대로 커맨드 리스트에 옮깁니다.
+    struct CommandListTarget
+    {
+        BlendingApp* App;
+        ID3D12GraphicsCommandList* CmdList;
+        ID3D12Resource* ObjectCB;
+        ID3D12Resource* MatCB;
+        UINT ObjCBByteSize;
+        UINT MatCBByteSize;
+
+        void SetPipelineState(UINT pso)
+        {
+            CmdList->SetPipelineState(App->mPSOs[gDrawOrderPSOs[pso]].Get());
+        }
 
-        cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
-    }
+        void SetGeometry(UINT geometry)
+        {
+            MeshGeometry* geo = App->mQueueGeometries[geometry].first;
+
+            CmdList->IASetVertexBuffers(0, 1, &geo->VertexBufferView());
+            CmdList->IASetIndexBuffer(&geo->IndexBufferView());
+            CmdList->IASetPrimitiveTopology(App->mQueueGeometries[geometry].second);
+        }
+
+        void SetMaterial(UINT material)
+        {
+            Material* mat = App->mQueueMaterials[material];
+
+            CD3DX12_GPU_DESCRIPTOR_HANDLE tex(App->mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+            tex.Offset(mat->DiffuseSrvHeapIndex, App->mCbvSrvUavDescriptorSize);
+
+            D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = MatCB->GetGPUVirtualAddress() + mat->MatCBIndex * MatCBByteSize;
+
+            CmdList->SetGraphicsRootDescriptorTable(0, tex);
+            CmdList->SetGraphicsRootConstantBufferView(3, matCBAddress);
+        }
+
+        void Draw(UINT item)
+        {
+            auto ri = App->mAllRitems[item].get();
+
+            D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = ObjectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * ObjCBByteSize;
+            CmdList->SetGraphicsRootConstantBufferView(1, objCBAddress);
+
+            CmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+        }
+    };
+
+    CommandListTarget target = {
+        this,
+        cmdList,
+        mCurrFrameResource->ObjectCB->Resource(),
+        mCurrFrameResource->MaterialCB->Resource(),
+        d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants)),
+        d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants))
+    };
+
+    SubmitCommandStream(mRenderCommands, target);
 }
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> BlendingApp::GetStaticSamplers()
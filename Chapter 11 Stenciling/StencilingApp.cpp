@@ -531,6 +531,8 @@ void BlendingApp::UpdateCamera(const GameTimer& gt)
 
 void BlendingApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -553,6 +555,8 @@ void BlendingApp::UpdateObjectCBs(const GameTimer& gt)
 
 void BlendingApp::UpdateMaterialCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currentMaterialCB = mCurrFrameResource->MaterialCB.get();
     for (auto& e : mMaterials)
     {
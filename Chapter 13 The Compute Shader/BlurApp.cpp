@@ -522,6 +522,8 @@ void BlurApp::UpdateCamera(const GameTimer& gt)
 
 void BlurApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -544,6 +546,8 @@ void BlurApp::UpdateObjectCBs(const GameTimer& gt)
 
 void BlurApp::UpdateMaterialCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currentMaterialCB = mCurrFrameResource->MaterialCB.get();
     for (auto& e : mMaterials)
     {
@@ -605,6 +609,8 @@ void BlurApp::UpdateMainPassCB(const GameTimer& gt)
 
 void BlurApp::UpdateWaves(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     // 0.25초마다 랜덤 웨이브를 발생시킵니다.
     static float t_base = 0.0f;
     if ((mTimer.TotalTime() - t_base) >= 0.25f)
@@ -179,6 +179,9 @@ private:
     FrameResource* mCurrFrameResource = nullptr;
     int mCurrFrameResourceIndex = 0;
 
+    // 렌더 스레드가 제출하는 프레임 리소스입니다. Update가 채우고 있는 mCurrFrameResource와 다를 수 있습니다.
+    FrameResource* mDrawFrameResource = nullptr;
+
     ComPtr<ID3D12RootSignature> mRootSignature = nullptr;
 
     ComPtr<ID3D12DescriptorHeap> mSrvDescriptorHeap = nullptr;
@@ -245,6 +248,10 @@ FrameResource::~FrameResource()
 CameraAndDynamicIndexingApp::CameraAndDynamicIndexingApp(HINSTANCE hInstance)
     : D3DApp(hInstance)
 {
+    // 리버스 Z와 무한 원평면을 사용합니다. 부동소수점 뎁스는 0 근처에서 정밀하므로
+    // 먼 거리의 깊이가 근평면 쪽으로 몰리는 것을 상쇄합니다. 뎁스는 0으로 지웁니다.
+    mDepthStencilFormat = DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
+    mDepthClearValue = 0.0f;
 }
 
 CameraAndDynamicIndexingApp::~CameraAndDynamicIndexingApp()
@@ -271,6 +278,9 @@ bool CameraAndDynamicIndexingApp::Initialize()
     BuildFrameResources();
     BuildPSOs();
 
+    // 프레임 리소스 링을 통해서 Update와 Draw를 파이프라인으로 실행할 수 있습니다 (F6).
+    EnableFramePipeline(gNumFrameResources);
+
     // 초기화 명령들을 실행시킵니다.
     ThrowIfFailed(mCommandList->Close());
     ID3D12CommandList* cmdLists[] = {mCommandList.Get()};
@@ -286,15 +296,16 @@ void CameraAndDynamicIndexingApp::OnResize()
 {
     D3DApp::OnResize();
 
-    mCamera.SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
+    mCamera.SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f, Camera::DepthMode::ReversedInfinite);
 }
 
 void CameraAndDynamicIndexingApp::Update(const GameTimer& gt)
 {
     OnKeyboardInput(gt);
 
-    // 다음 프레임 리소스의 자원을 얻기위해 순환합니다.
-    mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
+    // 다음 프레임 리소스의 자원을 얻기위해 순환합니다. D3DApp은 렌더 스레드가 이 프레임 리소스를
+    // 돌려준 다음에 Update를 호출합니다.
+    mCurrFrameResourceIndex = UpdateFrameIndex();
     mCurrFrameResource = mFrameResources[mCurrFrameResourceIndex].get();
 
     // 현재 프레임 리소스에 대한 명령들이 GPU에서 처리 되었습니까?
@@ -315,7 +326,10 @@ void CameraAndDynamicIndexingApp::Update(const GameTimer& gt)
 
 void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
 {
-    auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
+    // 렌더 스레드에서 호출될 수 있으므로 Update가 채운 프레임 리소스에 기록된 값만 사용합니다.
+    mDrawFrameResource = mFrameResources[DrawFrameIndex()].get();
+
+    auto cmdListAlloc = mDrawFrameResource->CmdListAlloc;
 
     // 커맨드 기록을 위한 메모리를 재활용 합니다.
     // 제출한 커맨드들이 GPU에서 모두 끝났을때 리셋할 수 있습니다.
@@ -334,7 +348,7 @@ void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
 
     // 백 버퍼와 뎁스 버퍼를 클리어 합니다.
     mCommandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
-    mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+    mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, mDepthClearValue, 0, 0, nullptr);
 
     // 어디에 렌더링을 할지 설정합니다.
     mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
@@ -344,12 +358,12 @@ void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
 
     mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
 
-    auto passCB = mCurrFrameResource->PassCB->Resource();
+    auto passCB = mDrawFrameResource->PassCB->Resource();
     mCommandList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
 
     // 장면에서 사용되는 모든 메터리얼을 바인드 합니다.
     // 스트럭쳐 버퍼는 힙을 바로 루트 디스크립터로 설정할 수 있습니다.
-    auto matBuffer = mCurrFrameResource->MaterialBuffer->Resource();
+    auto matBuffer = mDrawFrameResource->MaterialBuffer->Resource();
     mCommandList->SetGraphicsRootConstantBufferView(2, matBuffer->GetGPUVirtualAddress());
 
     // 장면에서 사용되는 모든 텍스쳐를 바인드 합니다.
@@ -376,7 +390,7 @@ void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
     mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
 
     // 이 펜스 지점까지 커맨드들을 표시하기 위해 펜스 값을 증가합니다,
-    mCurrFrameResource->Fence = ++mCurrentFence;
+    mDrawFrameResource->Fence = ++mCurrentFence;
 
     // 새 펜스 지점을 설정하는 인스트럭션을 커맨드 큐에 추가합니다.
     // 어플리케이션은 GPU 시간축에 있지 않기 때문에,
@@ -438,6 +452,8 @@ void CameraAndDynamicIndexingApp::AnimateMaterials(const GameTimer& gt)
 
 void CameraAndDynamicIndexingApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -463,6 +479,8 @@ void CameraAndDynamicIndexingApp::UpdateObjectCBs(const GameTimer& gt)
 
 void CameraAndDynamicIndexingApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -493,10 +511,11 @@ void CameraAndDynamicIndexingApp::UpdateMainPassCB(const GameTimer& gt)
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
 
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+    // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+    XMMATRIX viewProj = mCamera.GetViewProj();
+    XMMATRIX invView = mCamera.GetInvView();
+    XMMATRIX invProj = mCamera.GetInvProj();
+    XMMATRIX invViewProj = mCamera.GetInvViewProj();
 
     XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
     XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
@@ -507,8 +526,8 @@ void CameraAndDynamicIndexingApp::UpdateMainPassCB(const GameTimer& gt)
     mMainPassCB.EyePosW = mCamera.GetPosition3f();
     mMainPassCB.RenderTargetSize = XMFLOAT2((float)mClientWidth, (float)mClientHeight);
     mMainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / mClientWidth, 1.0f / mClientHeight);
-    mMainPassCB.NearZ = 1.0f;
-    mMainPassCB.FarZ = 1000.0f;
+    mMainPassCB.NearZ = mCamera.GetNearZ();
+    mMainPassCB.FarZ = mCamera.GetFarZ();
     mMainPassCB.TotalTime = gt.TotalTime();
     mMainPassCB.DeltaTime = gt.DeltaTime();
     mMainPassCB.AmbientLight = {0.25f, 0.25f, 0.35f, 1.0f};
@@ -814,6 +833,7 @@ void CameraAndDynamicIndexingApp::BuildPSOs()
     opaquePsoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     opaquePsoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
     opaquePsoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+    opaquePsoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_GREATER;
     opaquePsoDesc.SampleMask = UINT_MAX;
     opaquePsoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
     opaquePsoDesc.NumRenderTargets = 1;
@@ -969,7 +989,7 @@ void CameraAndDynamicIndexingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmd
 {
     UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
 
-    auto objectCB = mCurrFrameResource->ObjectCB->Resource();
+    auto objectCB = mDrawFrameResource->ObjectCB->Resource();
 
     // 각 렌더 항목에 대해서...
     for (size_t i = 0; i < ritems.size(); ++i)
@@ -13,6 +13,12 @@
 #include "Common/UploadBuffer.h"
 #include "Common/GeometryGenerator.h"
 #include "Common/Camera.h"
+#include "Common/TexturePacker.h"
+#include "Common/InstanceCuller.h"
+#include "Common/BoundingVolumeHierarchy.h"
+#include "Common/OcclusionCuller.h"
+#include "Common/ScreenSizeLod.h"
+#include "Common/JobSystem.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -66,7 +72,7 @@ struct MaterialData
     DirectX::XMFLOAT4X4 MatTransform = MathHelper::Identity4x4();
 
     UINT DiffuseMapIndex = 0;
-    UINT MaterialPad0;
+    UINT DiffuseMapSlice = 0;
     UINT MaterialPad1;
     UINT MaterialPad2;
 };
@@ -107,6 +113,17 @@ public:
     UINT64 Fence = 0;
 };
 
+// 한 LOD의 DrawIndexedInstanced 파라미터와 이번 프레임에 인스턴스 버퍼에서 차지하는 범위입니다.
+struct RenderItemLod
+{
+    UINT IndexCount = 0;
+    UINT StartIndexLocation = 0;
+    int BaseVertexLocation = 0;
+
+    UINT StartInstance = 0;
+    UINT InstanceCount = 0;
+};
+
 // 도형을 그리는데 필요한 파라미터들을 저장한 가벼운 구조체입니다.
 // 이 구조체는 앱마다 굉장히 다를것 입니다.
 struct RenderItem
@@ -132,11 +149,23 @@ struct RenderItem
     BoundingBox Bounds;
     std::vector<InstanceData> Instances;
 
-    // DrawIndexedInstance 파라미터들 입니다.
+    // 인스턴스들의 world 바운딩 박스입니다. 인스턴스를 추가하거나 움직일 때 갱신합니다.
+    InstanceCuller Culler;
+
+    // 인스턴스들의 world 바운딩 박스로 만든 BVH입니다. 인스턴스가 움직이면 Refit합니다.
+    BoundingVolumeHierarchy Bvh;
+
+    // 카메라의 스윕 볼륨과 교차하는 인스턴스들입니다. 오름차순으로 정렬되어 있습니다.
+    std::vector<std::uint32_t> SweptCandidates;
+
+    // DrawIndexedInstance 파라미터들 입니다. InstanceCount는 모든 LOD의 인스턴스 수의 합입니다.
     UINT IndexCount = 0;
     UINT InstanceCount = 0;
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
+
+    // 0번이 가장 상세한 LOD입니다. 비어 있으면 위의 파라미터로 한 번에 그립니다.
+    std::vector<RenderItemLod> Lods;
 };
 
 class InstancingAndCullingApp : public D3DApp
@@ -161,6 +190,9 @@ private:
     void OnKeyboardInput(const GameTimer& gt);
     void AnimateMaterials(const GameTimer& gt);
     void UpdateInstanceData(const GameTimer& gt);
+    bool IsFrustumInsideSweptVolume() const;
+    void CullOccludedInstances(RenderItem& ritem, std::vector<std::uint32_t>& visible);
+    void RasterizeOccluders(const RenderItem& ritem, const std::vector<std::uint32_t>& visible);
     void UpdateMaterialBuffer(const GameTimer& gt);
     void UpdateMainPassCB(const GameTimer& gt);
 
@@ -189,6 +221,9 @@ private:
     std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
     std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
     std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
+
+    // 텍스쳐들을 묶은 결과입니다. 그룹의 인덱스가 SRV 힙에서의 인덱스입니다.
+    std::unique_ptr<TexturePacker> mTexturePacker;
     std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
     std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 
@@ -204,7 +239,36 @@ private:
 
     bool mFrustumCullingEnabled = true;
 
-    BoundingFrustum mCamFrustum;
+    // true이면 BVH로, false이면 모든 인스턴스를 선형으로 테스트합니다.
+    bool mBvhCullingEnabled = true;
+
+    // 프러스텀 컬링을 통과한 인스턴스의 인덱스입니다. 프레임마다 재사용합니다.
+    std::vector<std::uint32_t> mVisibleInstances;
+
+    // 카메라에 가까운 인스턴스 몇 개를 오클루더로 그려서 그 뒤에 가려진 인스턴스를 컬링합니다.
+    OcclusionCuller mOcclusionCuller;
+    bool mOcclusionCullingEnabled = false;
+    UINT mOccluderCount = 4;
+    std::vector<std::uint32_t> mOccluderCandidates;
+    UINT mOccludedCount = 0;
+
+    // 인스턴스들은 움직이지 않으므로 카메라 세대가 같으면 지난번 깊이 피라미드를 그대로 씁니다.
+    std::uint64_t mOccluderCameraGeneration = UINT64_MAX;
+
+    // 화면에서의 지름이 150, 50픽셀 이상이면 LOD 0, 1을, 그보다 작으면 LOD 2를 사용하고
+    // 4픽셀보다 작으면 컬링합니다.
+    ScreenSizeLod mLodSelector = ScreenSizeLod({ 150.0f, 50.0f, 0.0f }, 4.0f);
+    bool mLodEnabled = false;
+    std::vector<std::uint32_t> mLodStarts;
+
+    // 카메라가 지금처럼 움직이면 mPrefetchSeconds 안에 지나갈 공간을 감싸는 평면들입니다. 이 볼륨과
+    // 교차하는 인스턴스들을 후보로 모아 두고, 지금의 프러스텀이 볼륨 안에 있는 동안에는 후보들만
+    // 컬링합니다. 프러스텀이 볼륨을 벗어나면 평면과 후보를 다시 계산합니다.
+    bool mPrefetchEnabled = false;
+    float mPrefetchSeconds = 0.25f;
+    bool mSweptPlanesValid = false;
+    XMFLOAT4 mSweptPlanes[6];
+    UINT mSweptRefreshCount = 0;
 
     PassConstants mMainPassCB;
 
@@ -296,8 +360,6 @@ void InstancingAndCullingApp::OnResize()
     D3DApp::OnResize();
 
     mCamera.SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
-
-    BoundingFrustum::CreateFromMatrix(mCamFrustum, mCamera.GetProj());
 }
 
 void InstancingAndCullingApp::Update(const GameTimer& gt)
@@ -444,7 +506,35 @@ void InstancingAndCullingApp::OnKeyboardInput(const GameTimer& gt)
     if (GetAsyncKeyState('2') & 0x8000)
         mFrustumCullingEnabled = false;
 
+    if (GetAsyncKeyState('3') & 0x8000)
+        mBvhCullingEnabled = true;
+
+    if (GetAsyncKeyState('4') & 0x8000)
+        mBvhCullingEnabled = false;
+
+    if (GetAsyncKeyState('5') & 0x8000)
+        mOcclusionCullingEnabled = true;
+
+    if (GetAsyncKeyState('6') & 0x8000)
+        mOcclusionCullingEnabled = false;
+
+    if (GetAsyncKeyState('7') & 0x8000)
+        mLodEnabled = true;
+
+    if (GetAsyncKeyState('8') & 0x8000)
+        mLodEnabled = false;
+
+    if (GetAsyncKeyState('9') & 0x8000)
+        mPrefetchEnabled = true;
+
+    if (GetAsyncKeyState('0') & 0x8000)
+    {
+        mPrefetchEnabled = false;
+        mSweptPlanesValid = false;
+    }
+
     mCamera.UpdateViewMatrix();
+    mCamera.UpdateMotion(dt);
 }
 
 void InstancingAndCullingApp::AnimateMaterials(const GameTimer& gt)
@@ -453,54 +543,227 @@ void InstancingAndCullingApp::AnimateMaterials(const GameTimer& gt)
 
 void InstancingAndCullingApp::UpdateInstanceData(const GameTimer& gt)
 {
-    XMMATRIX view = mCamera.GetView();
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
+    PROFILE_FUNCTION();
+
+    // 인스턴스마다 프러스텀을 로컬 스페이스로 옮기는 대신 world 스페이스 평면으로
+    // 미리 계산된 world 바운딩 박스들을 테스트합니다.
+    const XMFLOAT4* frustumPlanes = mCamera.GetFrustumPlanes();
+
+    // 볼륨이 지금의 프러스텀을 포함하는 동안에는 후보 밖의 인스턴스가 보일 수 없습니다.
+    const bool refreshSwept = mPrefetchEnabled && (!mSweptPlanesValid || !IsFrustumInsideSweptVolume());
+    if (refreshSwept)
+    {
+        mCamera.GetSweptFrustumPlanes(mPrefetchSeconds, mSweptPlanes);
+        mSweptPlanesValid = true;
+        mSweptRefreshCount++;
+    }
+
+    mLodSelector.SetView(mCamera.GetPosition(), mCamera.GetProj(), (float)mClientHeight);
 
     auto currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
     for (auto& e : mAllRitems)
     {
         const auto& instanceData = e->Instances;
 
-        int visibleInstanceCount = 0;
-
-        for (UINT i = 0; i < (UINT)instanceData.size(); ++i)
+        // 워커 스레드에서 호출됩니다. 출력 위치가 서로 다르므로 매핑된 메모리에 잠금 없이 씁니다.
+        auto writeInstance = [&](std::uint32_t i, std::uint32_t outputIndex)
         {
             XMMATRIX world = XMLoadFloat4x4(&instanceData[i].World);
             XMMATRIX texTransform = XMLoadFloat4x4(&instanceData[i].TexTransform);
 
-            XMMATRIX invWorld = XMMatrixInverse(&XMMatrixDeterminant(world), world);
+            InstanceData data;
+            XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+            XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
+            data.MaterialIndex = instanceData[i].MaterialIndex;
 
-            // 뷰 스페이스에서 오브젝트 로컬 스페이스로 변환합니다.
-            XMMATRIX viewToLocal = XMMatrixMultiply(invView, invWorld);
+            currInstanceBuffer->CopyData(outputIndex, data);
+        };
 
-            // 카메라 프러스텀을 뷰 스페이스에서 오브젝트 로컬 스페이스로 이동합니다.
-            BoundingFrustum localSpaceFrustum;
-            mCamFrustum.Transform(localSpaceFrustum, viewToLocal);
+        UINT visibleInstanceCount = 0;
+        int planeTestsSaved = 0;
+        bool written = false;
 
-            // AABB와 프러스텀의 교체 테스트를 로컬 스페이스에서 진행합니다.
-            if ((localSpaceFrustum.Contains(e->Bounds) != DirectX::DISJOINT) || (mFrustumCullingEnabled == false))
-            {
-                InstanceData data;
-                XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
-                XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
-                data.MaterialIndex = instanceData[i].MaterialIndex;
+        if (refreshSwept)
+        {
+            e->Bvh.QueryFrustum(mSweptPlanes, e->SweptCandidates);
+            std::sort(e->SweptCandidates.begin(), e->SweptCandidates.end());
+        }
 
-                currInstanceBuffer->CopyData(visibleInstanceCount++, data);
+        // 카메라가 움직이지 않았으면 컬러들이 지난 프레임의 결과를 테스트 없이 재사용합니다.
+        if (mFrustumCullingEnabled && mPrefetchEnabled)
+        {
+            // 후보들은 인스턴스 순서로 정렬되어 있으므로 결과도 인스턴스 순서입니다.
+            e->Culler.CullCandidates(frustumPlanes, e->SweptCandidates, mVisibleInstances);
+            planeTestsSaved = e->Culler.LastStats().PlaneTestsSaved;
+        }
+        else if (mFrustumCullingEnabled && mBvhCullingEnabled)
+        {
+            // 트리 순회 순서는 카메라에 따라 바뀌므로 인스턴스 순서로 정렬해서 그리는 순서를 고정합니다.
+            e->Bvh.QueryFrustum(frustumPlanes, mVisibleInstances);
+            std::sort(mVisibleInstances.begin(), mVisibleInstances.end());
+            planeTestsSaved = e->Bvh.LastStats().PlaneTestsSaved;
+        }
+        else if (mFrustumCullingEnabled && !mOcclusionCullingEnabled && !mLodEnabled)
+        {
+            // 청크별로 컬링하고 보이는 수의 누적합으로 정해진 위치에 바로 씁니다.
+            visibleInstanceCount = e->Culler.CullParallel(frustumPlanes, writeInstance);
+            planeTestsSaved = e->Culler.LastStats().PlaneTestsSaved;
+            written = true;
+        }
+        else if (mFrustumCullingEnabled)
+        {
+            e->Culler.Cull(frustumPlanes, mVisibleInstances);
+            planeTestsSaved = e->Culler.LastStats().PlaneTestsSaved;
+        }
+        else
+        {
+            mVisibleInstances.resize(instanceData.size());
+            for (UINT i = 0; i < (UINT)instanceData.size(); ++i)
+                mVisibleInstances[i] = i;
+        }
+
+        if (!written)
+        {
+            // 오클루전 컬링은 프러스텀 컬링을 통과한 인스턴스들만 테스트합니다.
+            if (mOcclusionCullingEnabled)
+                CullOccludedInstances(*e, mVisibleInstances);
+
+            // 화면 크기로 작은 인스턴스를 컬링하고 LOD별로 연속된 범위에 모읍니다.
+            if (mLodEnabled && !e->Lods.empty())
+            {
+                mLodSelector.Bucket(mVisibleInstances, [&](std::uint32_t i)
+                {
+                    BoundingSphere sphere;
+                    BoundingSphere::CreateFromBoundingBox(sphere, e->Culler.GetWorldBounds(i));
+                    return sphere;
+                }, mLodStarts);
             }
+
+            visibleInstanceCount = (UINT)mVisibleInstances.size();
+            JobSystem::Default().ParallelFor(0u, visibleInstanceCount, [&](UINT k)
+            {
+                writeInstance(mVisibleInstances[k], k);
+            });
         }
 
         e->InstanceCount = visibleInstanceCount;
 
+        // LOD를 나누지 않았으면 모든 인스턴스를 LOD 0으로 그립니다.
+        for (size_t lod = 0; lod < e->Lods.size(); ++lod)
+        {
+            const bool bucketed = !written && mLodEnabled;
+            const UINT start = bucketed ? mLodStarts[lod] : (lod == 0 ? 0 : visibleInstanceCount);
+            const UINT end = bucketed ? mLodStarts[lod + 1] : visibleInstanceCount;
+
+            e->Lods[lod].StartInstance = start;
+            e->Lods[lod].InstanceCount = end - start;
+        }
+
         std::wostringstream outs;
         outs.precision(6);
         outs << L"Instancing and Culling Demo" << L"    "
-            << e->InstanceCount << L" objects visible out of " << e->Instances.size();
+            << e->InstanceCount << L" objects visible out of " << e->Instances.size()
+            << L"    " << planeTestsSaved << L" plane tests saved";
+        if (mOcclusionCullingEnabled)
+            outs << L"    " << mOccludedCount << L" occluded";
+        if (mLodEnabled)
+        {
+            outs << L"    LOD";
+            for (const auto& lod : e->Lods)
+                outs << L" " << lod.InstanceCount;
+            outs << L", " << mLodSelector.LastCulledCount() << L" too small";
+        }
+        if (mPrefetchEnabled)
+        {
+            outs << L"    " << e->SweptCandidates.size() << L" candidates for " << mPrefetchSeconds << L"s, "
+                << mSweptRefreshCount << L" refreshes";
+        }
         mMainWndCaption = outs.str();
     }
 }
 
+bool InstancingAndCullingApp::IsFrustumInsideSweptVolume() const
+{
+    // 프러스텀과 스윕 볼륨이 모두 볼록하므로 꼭짓점 여덟 개만 확인하면 됩니다.
+    XMFLOAT3 corners[BoundingFrustum::CORNER_COUNT];
+    mCamera.GetFrustum().GetCorners(corners);
+
+    for (const XMFLOAT3& c : corners)
+    {
+        for (const XMFLOAT4& p : mSweptPlanes)
+        {
+            if (p.x * c.x + p.y * c.y + p.z * c.z + p.w < 0.0f)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void InstancingAndCullingApp::CullOccludedInstances(RenderItem& ritem, std::vector<std::uint32_t>& visible)
+{
+    if (mOccluderCameraGeneration != mCamera.GetGeneration())
+    {
+        RasterizeOccluders(ritem, visible);
+        mOccluderCameraGeneration = mCamera.GetGeneration();
+    }
+
+    // 남은 인스턴스의 순서는 그대로 유지합니다.
+    const size_t frustumVisibleCount = visible.size();
+    visible.erase(std::remove_if(visible.begin(), visible.end(), [&](std::uint32_t i)
+    {
+        return !mOcclusionCuller.IsVisible(ritem.Culler.GetWorldBounds(i));
+    }), visible.end());
+
+    mOccludedCount = (UINT)(frustumVisibleCount - visible.size());
+}
+
+void InstancingAndCullingApp::RasterizeOccluders(const RenderItem& ritem, const std::vector<std::uint32_t>& visible)
+{
+    mOcclusionCuller.BeginFrame(mCamera.GetViewProj());
+
+    // 카메라에 가장 가까운 인스턴스들이 가장 많이 가리므로 이들을 오클루더로 사용합니다.
+    const XMVECTOR eyePos = mCamera.GetPosition();
+    auto distanceSq = [&](std::uint32_t i)
+    {
+        const BoundingBox bounds = ritem.Culler.GetWorldBounds(i);
+        return XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(XMLoadFloat3(&bounds.Center), eyePos)));
+    };
+
+    const UINT occluderCount = std::min<UINT>(mOccluderCount, (UINT)visible.size());
+    mOccluderCandidates = visible;
+    std::partial_sort(mOccluderCandidates.begin(), mOccluderCandidates.begin() + occluderCount, mOccluderCandidates.end(),
+        [&](std::uint32_t a, std::uint32_t b) { return distanceSq(a) < distanceSq(b); });
+
+    // 시스템 메모리에 남겨 둔 정점과 인덱스 버퍼를 그대로 그립니다. 위치가 Vertex의 첫 번째 멤버입니다.
+    const MeshGeometry* geo = ritem.Geo;
+    const BYTE* positions = (const BYTE*)geo->VertexBufferCPU->GetBufferPointer() + (size_t)ritem.BaseVertexLocation * geo->VertexByteStride;
+    const UINT vertexCount = geo->VertexBufferByteSize / geo->VertexByteStride - ritem.BaseVertexLocation;
+    const void* indices = geo->IndexBufferCPU->GetBufferPointer();
+
+    for (UINT k = 0; k < occluderCount; ++k)
+    {
+        XMMATRIX world = XMLoadFloat4x4(&ritem.Instances[mOccluderCandidates[k]].World);
+
+        if (geo->IndexFormat == DXGI_FORMAT_R32_UINT)
+        {
+            mOcclusionCuller.RasterizeOccluder(positions, geo->VertexByteStride, vertexCount,
+                (const std::uint32_t*)indices + ritem.StartIndexLocation, ritem.IndexCount, world);
+        }
+        else
+        {
+            mOcclusionCuller.RasterizeOccluder(positions, geo->VertexByteStride, vertexCount,
+                (const std::uint16_t*)indices + ritem.StartIndexLocation, ritem.IndexCount, world);
+        }
+    }
+
+    mOcclusionCuller.BuildHierarchy();
+}
+
 void InstancingAndCullingApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -517,6 +780,7 @@ void InstancingAndCullingApp::UpdateMaterialBuffer(const GameTimer& gt)
             matData.Roughness = mat->Roughness;
             XMStoreFloat4x4(&matData.MatTransform, XMMatrixTranspose(matTransform));
             matData.DiffuseMapIndex = mat->DiffuseSrvHeapIndex;
+            matData.DiffuseMapSlice = mat->DiffuseSrvArraySlice;
 
             currMaterialBuffer->CopyData(mat->MatCBIndex, matData);
 
@@ -531,10 +795,11 @@ void InstancingAndCullingApp::UpdateMainPassCB(const GameTimer& gt)
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
 
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+    // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+    XMMATRIX viewProj = mCamera.GetViewProj();
+    XMMATRIX invView = mCamera.GetInvView();
+    XMMATRIX invProj = mCamera.GetInvProj();
+    XMMATRIX invViewProj = mCamera.GetInvViewProj();
 
     XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
     XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
@@ -561,64 +826,144 @@ void InstancingAndCullingApp::UpdateMainPassCB(const GameTimer& gt)
     currPassCB->CopyData(0, mMainPassCB);
 }
 
+static TextureUploadDesc GetTextureUploadDesc(const D3D12_RESOURCE_DESC& texDesc)
+{
+    TextureUploadDesc uploadDesc;
+    uploadDesc.Width = texDesc.Width;
+    uploadDesc.Height = texDesc.Height;
+    uploadDesc.DepthOrArraySize = texDesc.DepthOrArraySize;
+    uploadDesc.MipLevels = texDesc.MipLevels;
+    uploadDesc.Format = texDesc.Format;
+    uploadDesc.IsVolume = texDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+
+    return uploadDesc;
+}
+
 void InstancingAndCullingApp::LoadTextures()
 {
-    auto bricksTex = std::make_unique<Texture>();
-    bricksTex->Name = "bricksTex";
-    bricksTex->Filename = L"..\\Textures\\bricks3.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), bricksTex->Filename.c_str(),
-                                                      bricksTex->Resource, bricksTex->UploadHeap));
-
-    auto stoneTex = std::make_unique<Texture>();
-    stoneTex->Name = "stoneTex";
-    stoneTex->Filename = L"..\\Textures\\stone.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), stoneTex->Filename.c_str(),
-                                                      stoneTex->Resource, stoneTex->UploadHeap));
-
-    auto tileTex = std::make_unique<Texture>();
-    tileTex->Name = "tileTex";
-    tileTex->Filename = L"..\\Textures\\tile.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), tileTex->Filename.c_str(),
-                                                      tileTex->Resource, tileTex->UploadHeap));
-
-    auto crateTex = std::make_unique<Texture>();
-    crateTex->Name = "crateTex";
-    crateTex->Filename = L"..\\Textures\\WoodCrate01.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), crateTex->Filename.c_str(),
-                                                      crateTex->Resource, crateTex->UploadHeap));
-
-    auto iceTex = std::make_unique<Texture>();
-    iceTex->Name = "iceTex";
-    iceTex->Filename = L"..\\Textures\\ice.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), iceTex->Filename.c_str(),
-                                                      iceTex->Resource, iceTex->UploadHeap));
-
-    auto grassTex = std::make_unique<Texture>();
-    grassTex->Name = "grassTex";
-    grassTex->Filename = L"..\\Textures\\grass.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), grassTex->Filename.c_str(),
-                                                      grassTex->Resource, grassTex->UploadHeap));
-
-    auto defaultTex = std::make_unique<Texture>();
-    defaultTex->Name = "defaultTex";
-    defaultTex->Filename = L"..\\Textures\\white1x1.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                      mCommandList.Get(), defaultTex->Filename.c_str(),
-                                                      defaultTex->Resource, defaultTex->UploadHeap));
-
-    mTextures[bricksTex->Name] = std::move(bricksTex);
-    mTextures[stoneTex->Name] = std::move(stoneTex);
-    mTextures[tileTex->Name] = std::move(tileTex);
-    mTextures[crateTex->Name] = std::move(crateTex);
-    mTextures[iceTex->Name] = std::move(iceTex);
-    mTextures[grassTex->Name] = std::move(grassTex);
-    mTextures[defaultTex->Name] = std::move(defaultTex);
+    std::vector<std::wstring> texFilenames =
+    {
+        L"..\\Textures\\bricks3.dds",
+        L"..\\Textures\\stone.dds",
+        L"..\\Textures\\tile.dds",
+        L"..\\Textures\\WoodCrate01.dds",
+        L"..\\Textures\\ice.dds",
+        L"..\\Textures\\grass.dds",
+        L"..\\Textures\\white1x1.dds"
+    };
+
+    // 스컬의 텍스쳐 좌표는 TexTransform으로 반복되므로 텍스쳐들을 wrapsUV로 등록합니다.
+    // 그러면 포맷과 크기가 같은 텍스쳐들만 텍스쳐 배열로 묶입니다. 1x1 텍스쳐는 아틀라스의
+    // UV 변환이 항상 같은 텍셀의 중심을 가리키므로 UV가 반복되어도 아틀라스에 넣을 수 있습니다.
+    mTexturePacker = std::make_unique<TexturePacker>();
+
+    std::vector<ComPtr<ID3DBlob>> ddsData(texFilenames.size());
+    std::vector<std::vector<D3D12_SUBRESOURCE_DATA>> subresources(texFilenames.size());
+    for (int i = 0; i < (int)texFilenames.size(); ++i)
+    {
+        ddsData[i] = d3dUtil::LoadBinary(texFilenames[i]);
+
+        D3D12_RESOURCE_DESC texDesc;
+        ThrowIfFailed(DirectX::GetDDSSubresourcesFromMemory12(
+            reinterpret_cast<const uint8_t*>(ddsData[i]->GetBufferPointer()),
+            ddsData[i]->GetBufferSize(), texDesc, subresources[i]));
+
+        const bool wrapsUV = texDesc.Width > 1 || texDesc.Height > 1;
+        mTexturePacker->AddTexture(GetTextureUploadDesc(texDesc), wrapsUV);
+    }
+
+    mTexturePacker->Pack();
+
+    // 그룹마다 리소스를 하나 만들고 묶인 텍스쳐들의 서브리소스를 한 번에 올립니다.
+    for (UINT g = 0; g < mTexturePacker->GroupCount(); ++g)
+    {
+        const TexturePackGroup& group = mTexturePacker->GetGroup(g);
+        const TextureUploadDesc& packDesc = group.Desc;
+
+        auto tex = std::make_unique<Texture>();
+        tex->Name = "packedTex" + std::to_string(g);
+        tex->Filename = texFilenames[group.Textures.front()];
+
+        D3D12_RESOURCE_DESC texDesc = {};
+        texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        texDesc.Width = packDesc.Width;
+        texDesc.Height = packDesc.Height;
+        texDesc.DepthOrArraySize = (UINT16)packDesc.DepthOrArraySize;
+        texDesc.MipLevels = (UINT16)packDesc.MipLevels;
+        texDesc.Format = packDesc.Format;
+        texDesc.SampleDesc.Count = 1;
+        texDesc.SampleDesc.Quality = 0;
+        texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        ThrowIfFailed(md3dDevice->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &texDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(&tex->Resource)));
+
+        const UINT subresourceCount = packDesc.DepthOrArraySize * packDesc.MipLevels;
+        std::vector<D3D12_SUBRESOURCE_DATA> groupData(subresourceCount);
+
+        // 아틀라스는 CPU에서 텍스쳐들을 합친 서브리소스를 올립니다.
+        std::vector<std::vector<uint8_t>> atlasData;
+        if (group.Kind == TexturePackKind::Atlas)
+        {
+            atlasData.resize(subresourceCount);
+            for (UINT i = 0; i < subresourceCount; ++i)
+            {
+                size_t numBytes = 0;
+                size_t rowBytes = 0;
+                DirectX::GetDDSSurfaceInfo(MathHelper::Max<size_t>((size_t)packDesc.Width >> i, 1),
+                                           MathHelper::Max<size_t>(packDesc.Height >> i, 1),
+                                           packDesc.Format, &numBytes, &rowBytes, nullptr);
+
+                atlasData[i].assign(numBytes, 0);
+                groupData[i].pData = atlasData[i].data();
+                groupData[i].RowPitch = rowBytes;
+                groupData[i].SlicePitch = numBytes;
+            }
+        }
+
+        std::vector<TexturePackCopy> copies;
+        for (UINT texIndex : group.Textures)
+        {
+            mTexturePacker->GetCopies(texIndex, copies);
+            for (const TexturePackCopy& copy : copies)
+            {
+                const D3D12_SUBRESOURCE_DATA& src = subresources[texIndex][copy.SrcSubresource];
+                if (group.Kind == TexturePackKind::Atlas)
+                {
+                    TexturePacker::CopySurface(packDesc.Format, copy, src.pData, src.RowPitch,
+                                               atlasData[copy.DstSubresource].data(),
+                                               groupData[copy.DstSubresource].RowPitch);
+                }
+                else
+                {
+                    groupData[copy.DstSubresource] = src;
+                }
+            }
+        }
+
+        const UINT64 uploadBufferSize = GetRequiredIntermediateSize(tex->Resource.Get(), 0, subresourceCount);
+        ThrowIfFailed(md3dDevice->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&tex->UploadHeap)));
+
+        UpdateSubresources(mCommandList.Get(), tex->Resource.Get(), tex->UploadHeap.Get(),
+                           0, 0, subresourceCount, groupData.data());
+
+        mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(tex->Resource.Get(),
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+        mTextures[tex->Name] = std::move(tex);
+    }
 }
 
 void InstancingAndCullingApp::BuildRootSignature()
@@ -678,60 +1023,36 @@ void InstancingAndCullingApp::BuildDescriptorHeaps()
     //
     CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 
-    auto bricksTex = mTextures["bricksTex"]->Resource;
-    auto stoneTex = mTextures["stoneTex"]->Resource;
-    auto tileTex = mTextures["tileTex"]->Resource;
-    auto crateTex = mTextures["crateTex"]->Resource;
-    auto iceTex = mTextures["iceTex"]->Resource;
-    auto grassTex = mTextures["grassTex"]->Resource;
-    auto defaultTex = mTextures["defaultTex"]->Resource;
-
+    // 그룹마다 Texture2DArray SRV를 하나 만듭니다. 단독 텍스쳐는 슬라이스가 하나인 배열입니다.
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
     srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srvDesc.Format = bricksTex->GetDesc().Format;
-    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MostDetailedMip = 0;
-    srvDesc.Texture2D.MipLevels = -1;
-    md3dDevice->CreateShaderResourceView(bricksTex.Get(), &srvDesc, hDescriptor);
-
-    // 다음 디스크립터 힙 위치로 이동합니다.
-    hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-    srvDesc.Format = stoneTex->GetDesc().Format;
-    md3dDevice->CreateShaderResourceView(stoneTex.Get(), &srvDesc, hDescriptor);
-
-    // 다음 디스크립터 힙 위치로 이동합니다.
-    hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-    srvDesc.Format = tileTex->GetDesc().Format;
-    md3dDevice->CreateShaderResourceView(tileTex.Get(), &srvDesc, hDescriptor);
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+    srvDesc.Texture2DArray.MostDetailedMip = 0;
+    srvDesc.Texture2DArray.FirstArraySlice = 0;
+    srvDesc.Texture2DArray.ResourceMinLODClamp = 0.0f;
 
-    // 다음 디스크립터 힙 위치로 이동합니다.
-    hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-    srvDesc.Format = crateTex->GetDesc().Format;
-    md3dDevice->CreateShaderResourceView(crateTex.Get(), &srvDesc, hDescriptor);
-
-    // 다음 디스크립터 힙 위치로 이동합니다.
-    hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-    srvDesc.Format = iceTex->GetDesc().Format;
-    srvDesc.Texture2D.MipLevels = iceTex->GetDesc().MipLevels;
-    md3dDevice->CreateShaderResourceView(iceTex.Get(), &srvDesc, hDescriptor);
-
-    // 다음 디스크립터 힙 위치로 이동합니다.
-    hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-    srvDesc.Format = grassTex->GetDesc().Format;
-    srvDesc.Texture2D.MipLevels = grassTex->GetDesc().MipLevels;
-    md3dDevice->CreateShaderResourceView(grassTex.Get(), &srvDesc, hDescriptor);
-
-    // 다음 디스크립터 힙 위치로 이동합니다.
-    hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
+    for (UINT g = 0; g < srvHeapDesc.NumDescriptors; ++g)
+    {
+        if (g < mTexturePacker->GroupCount())
+        {
+            auto tex = mTextures["packedTex" + std::to_string(g)]->Resource;
+            srvDesc.Format = tex->GetDesc().Format;
+            srvDesc.Texture2DArray.MipLevels = tex->GetDesc().MipLevels;
+            srvDesc.Texture2DArray.ArraySize = tex->GetDesc().DepthOrArraySize;
+            md3dDevice->CreateShaderResourceView(tex.Get(), &srvDesc, hDescriptor);
+        }
+        else
+        {
+            // 디스크립터 테이블의 나머지는 null SRV로 채웁니다.
+            srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            srvDesc.Texture2DArray.MipLevels = 1;
+            srvDesc.Texture2DArray.ArraySize = 1;
+            md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, hDescriptor);
+        }
 
-    srvDesc.Format = defaultTex->GetDesc().Format;
-    srvDesc.Texture2D.MipLevels = defaultTex->GetDesc().MipLevels;
-    md3dDevice->CreateShaderResourceView(defaultTex.Get(), &srvDesc, hDescriptor);
+        // 다음 디스크립터 힙 위치로 이동합니다.
+        hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
+    }
 }
 
 void InstancingAndCullingApp::BuildShadersAndInputLayout()
@@ -822,6 +1143,24 @@ void InstancingAndCullingApp::BuildSkullGeometry()
 
     fin.close();
 
+    // 멀리 있는 인스턴스를 위한 LOD 메시는 정점을 격자로 모아서 만들고, 같은 정점 버퍼를
+    // 가리키는 인덱스를 원래 인덱스 뒤에 붙입니다.
+    const float meshSize = XMVectorGetX(XMVector3Length(vMax - vMin));
+    const float lodCellSizes[] = { meshSize / 64.0f, meshSize / 24.0f };
+
+    std::vector<UINT> lodStartIndices;
+    std::vector<UINT> lodIndexCounts;
+    for (float cellSize : lodCellSizes)
+    {
+        std::vector<std::uint32_t> lodIndices;
+        BuildClusteredLodIndices(&vertices[0].Pos, sizeof(Vertex), (UINT)vertices.size(),
+            (const std::uint32_t*)indices.data(), (UINT)indices.size(), cellSize, lodIndices);
+
+        lodStartIndices.push_back((UINT)indices.size());
+        lodIndexCounts.push_back((UINT)lodIndices.size());
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+
     //
     // Pack the indices of all the meshes into one index buffer.
     //
@@ -851,13 +1190,21 @@ void InstancingAndCullingApp::BuildSkullGeometry()
     geo->IndexBufferByteSize = ibByteSize;
 
     SubmeshGeometry submesh;
-    submesh.IndexCount = (UINT)indices.size();
+    submesh.IndexCount = 3 * tcount;
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
     submesh.Bounds = bounds;
 
     geo->DrawArgs["skull"] = submesh;
 
+    for (size_t lod = 0; lod < lodStartIndices.size(); ++lod)
+    {
+        submesh.IndexCount = lodIndexCounts[lod];
+        submesh.StartIndexLocation = lodStartIndices[lod];
+
+        geo->DrawArgs["skullLod" + std::to_string(lod + 1)] = submesh;
+    }
+
     mGeometries[geo->Name] = std::move(geo);
 }
 
@@ -968,6 +1315,18 @@ void InstancingAndCullingApp::BuildMaterials()
     mMaterials["ice0"] = std::move(ice0);
     mMaterials["grass0"] = std::move(grass0);
     mMaterials["skullMat"] = std::move(skullMat);
+
+    // 위의 DiffuseSrvHeapIndex는 LoadTextures에서의 텍스쳐 순서입니다. 묶인 리소스의 SRV와
+    // 슬라이스로 바꾸고 텍스쳐의 UV 변환을 MatTransform에 붙입니다.
+    for (auto& e : mMaterials)
+    {
+        Material* mat = e.second.get();
+        const TexturePlacement& placement = mTexturePacker->GetPlacement(mat->DiffuseSrvHeapIndex);
+
+        mTexturePacker->ApplyUvTransform(mat->DiffuseSrvHeapIndex, mat->MatTransform);
+        mat->DiffuseSrvHeapIndex = placement.Group;
+        mat->DiffuseSrvArraySlice = placement.Slice;
+    }
 }
 
 void InstancingAndCullingApp::BuildRenderItems()
@@ -983,6 +1342,17 @@ void InstancingAndCullingApp::BuildRenderItems()
     skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs["skull"].BaseVertexLocation;
     skullRitem->Bounds = skullRitem->Geo->DrawArgs["skull"].Bounds;
 
+    for (const char* lodName : { "skull", "skullLod1", "skullLod2" })
+    {
+        const SubmeshGeometry& lodArgs = skullRitem->Geo->DrawArgs[lodName];
+
+        RenderItemLod lod;
+        lod.IndexCount = lodArgs.IndexCount;
+        lod.StartIndexLocation = lodArgs.StartIndexLocation;
+        lod.BaseVertexLocation = lodArgs.BaseVertexLocation;
+        skullRitem->Lods.push_back(lod);
+    }
+
     // Generate instance data.
     const int n = 5;
     mInstanceCount = n * n * n;
@@ -1014,10 +1384,18 @@ void InstancingAndCullingApp::BuildRenderItems()
 
                 XMStoreFloat4x4(&skullRitem->Instances[index].TexTransform, XMMatrixScaling(2.0f, 2.0f, 1.0f));
                 skullRitem->Instances[index].MaterialIndex = index % mMaterials.size();
+
+                skullRitem->Culler.AddInstance(skullRitem->Bounds, XMLoadFloat4x4(&skullRitem->Instances[index].World));
             }
         }
     }
 
+    std::vector<BoundingBox> worldBounds(mInstanceCount);
+    for (UINT i = 0; i < mInstanceCount; ++i)
+        worldBounds[i] = skullRitem->Culler.GetWorldBounds(i);
+
+    skullRitem->Bvh.Build(worldBounds);
+
     mAllRitems.push_back(std::move(skullRitem));
 
     // All the render items are opaque.
@@ -1039,9 +1417,26 @@ void InstancingAndCullingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList
         // 렌더 아이템을 위한 인스턴스 버퍼를 설정합니다.
         // 구조체 버퍼인 경우에 힙을 사용하지 않고 루트 디스크립터로 바인딩 할 수 있습니다.
         auto instanceBuffer = mCurrFrameResource->InstanceBuffer->Resource();
-        mCommandList->SetGraphicsRootShaderResourceView(0, instanceBuffer->GetGPUVirtualAddress());
 
-        cmdList->DrawIndexedInstanced(ri->IndexCount, ri->InstanceCount, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+        if (ri->Lods.empty())
+        {
+            mCommandList->SetGraphicsRootShaderResourceView(0, instanceBuffer->GetGPUVirtualAddress());
+
+            cmdList->DrawIndexedInstanced(ri->IndexCount, ri->InstanceCount, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+            continue;
+        }
+
+        // SV_InstanceID에는 StartInstanceLocation이 더해지지 않으므로 LOD의 범위만큼 버퍼 주소를 옮겨서 바인딩합니다.
+        for (const auto& lod : ri->Lods)
+        {
+            if (lod.InstanceCount == 0)
+                continue;
+
+            mCommandList->SetGraphicsRootShaderResourceView(0,
+                instanceBuffer->GetGPUVirtualAddress() + (UINT64)lod.StartInstance * sizeof(InstanceData));
+
+            cmdList->DrawIndexedInstanced(lod.IndexCount, lod.InstanceCount, lod.StartIndexLocation, lod.BaseVertexLocation, 0);
+        }
     }
 }
 
@@ -37,14 +37,14 @@ struct MaterialData
     float    Roughness;
     float4x4 MatTransform;
     uint     DiffuseMapIndex;
-    uint     MatPad0;
+    uint     DiffuseMapSlice;
     uint     MatPad1;
     uint     MatPad2;
 };
 
-// An array of textures, which is only supported in shader model 5.1+.  Unlike Texture2DArray, the textures
-// in this array can be different sizes and formats, making it more flexible than texture arrays.
-Texture2D gDiffuseMap[7] : register(t0);
+// An array of texture arrays, which is only supported in shader model 5.1+.  Each entry can have a different
+// size and format; textures that share both are packed into the slices of one entry.
+Texture2DArray gDiffuseMap[7] : register(t0);
 
 // Put in space1, so the texture array does not overlap with these resources.  
 // The texture array will occupy registers t0, t1, ..., t3 in space0. 
@@ -143,9 +143,10 @@ float4 PS(VertexOut pin) : SV_Target
     float3 fresnelR0 = matData.FresnelR0;
     float  roughness = matData.Roughness;
     uint diffuseTexIndex = matData.DiffuseMapIndex;
+    uint diffuseTexSlice = matData.DiffuseMapSlice;
 
     // Dynamically look up the texture in the array.
-    diffuseAlbedo *= gDiffuseMap[diffuseTexIndex].Sample(gsamLinearWrap, pin.TexC);
+    diffuseAlbedo *= gDiffuseMap[diffuseTexIndex].Sample(gsamLinearWrap, float3(pin.TexC, diffuseTexSlice));
 	
 #ifdef ALPHA_TEST
 	// Discard pixel if texture alpha < 0.1.  We do this test as soon 
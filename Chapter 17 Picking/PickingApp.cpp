@@ -6,6 +6,7 @@
 // Controls:
 //   Hold the left mouse button down and move the mouse to rotate.
 //   Hold the right mouse button down and move the mouse to zoom in and out.
+//   Press '1' to pick with the triangle BVH, '2' to test every triangle.
 //***************************************************************************************
 
 #include "Common/d3dApp.h"
@@ -13,6 +14,7 @@
 #include "Common/UploadBuffer.h"
 #include "Common/GeometryGenerator.h"
 #include "Common/Camera.h"
+#include "Common/TrianglePicker.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -113,6 +115,10 @@ struct RenderItem
 
     BoundingBox Bounds;
 
+    // TrianglePicker에서 이 렌더 아이템의 인스턴스 인덱스입니다.
+    // 피킹 메쉬의 삼각형 번호는 StartIndexLocation부터 셉니다.
+    UINT PickInstance = -1;
+
     // 월드 공간에서 도형의 위치, 회전, 스케일을 정의한 메트릭스입니다.
     XMFLOAT4X4 World = MathHelper::Identity4x4();
 
@@ -184,6 +190,14 @@ private:
     void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
     void Pick(int sx, int sy);
 
+    // 비교를 위해 모든 렌더 아이템의 모든 삼각형과 테스트합니다.
+    PickHit PickBruteForce(const PickRay& ray);
+    void UpdatePickingCaption();
+
+    // 피킹 통계를 디버그 출력에 남깁니다. 창 제목은 마지막 값만 보여주므로 비교하려면 이 기록을 사용합니다.
+    void LogBvhBuildStats(UINT vertexCount, UINT indexCount);
+    void LogPickStats(const PickHit& hit);
+
     std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
 private:
@@ -211,6 +225,22 @@ private:
 
     RenderItem* mPickedRitem = nullptr;
 
+    // 메쉬마다 삼각형 BVH를 가지고 있는 피킹 서비스입니다.
+    TrianglePicker mPicker;
+
+    // 지오메트리 이름으로 찾는 피킹 메쉬의 인덱스입니다.
+    std::unordered_map<std::string, UINT> mPickMeshes;
+
+    // 피킹 인스턴스 인덱스로 찾는 렌더 아이템입니다.
+    std::vector<RenderItem*> mPickInstanceRitems;
+
+    // false이면 모든 삼각형과 테스트합니다. 비교를 위해 남겨둡니다.
+    bool mBvhPickingEnabled = true;
+
+    double mBvhBuildMilliseconds = 0.0;
+    double mLastPickMilliseconds = 0.0;
+    UINT mLastPickTriangleTests = 0;
+
     PassConstants mMainPassCB;
 
     Camera mCamera;
@@ -456,6 +486,12 @@ void PickingApp::OnKeyboardInput(const GameTimer& gt)
     if (GetAsyncKeyState('S') & 0x8000)
         mCamera.Walk(-10.0f * dt);
 
+    if (GetAsyncKeyState('1') & 0x8000)
+        mBvhPickingEnabled = true;
+
+    if (GetAsyncKeyState('2') & 0x8000)
+        mBvhPickingEnabled = false;
+
     mCamera.UpdateViewMatrix();
 }
 
@@ -465,6 +501,8 @@ void PickingApp::AnimateMaterials(const GameTimer& gt)
 
 void PickingApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -482,6 +520,11 @@ void PickingApp::UpdateObjectCBs(const GameTimer& gt)
 
             currObjectCB->CopyData(e->ObjCBIndex, objConstants);
 
+            // World가 바뀐 첫 프레임에만 피킹 인스턴스를 옮깁니다. 인스턴스 BVH는 다음 피킹에서
+            // 움직인 인스턴스의 경로만 다시 계산됩니다.
+            if (e->NumFramesDirty == gNumFrameResources && e->PickInstance != (UINT)-1)
+                mPicker.SetInstanceWorld(e->PickInstance, world);
+
             // 다음 프레임 리소스도 마찬가지로 업데이트 되어야 합니다.
             e->NumFramesDirty--;
         }
@@ -490,6 +533,8 @@ void PickingApp::UpdateObjectCBs(const GameTimer& gt)
 
 void PickingApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -520,10 +565,11 @@ void PickingApp::UpdateMainPassCB(const GameTimer& gt)
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
 
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+    // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+    XMMATRIX viewProj = mCamera.GetViewProj();
+    XMMATRIX invView = mCamera.GetInvView();
+    XMMATRIX invProj = mCamera.GetInvProj();
+    XMMATRIX invViewProj = mCamera.GetInvViewProj();
 
     XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
     XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
@@ -740,6 +786,25 @@ void PickingApp::BuildCarGeometry()
 
     geo->DrawArgs["car"] = submesh;
 
+    // 피킹을 위해 메쉬의 삼각형 BVH를 만듭니다.
+    LARGE_INTEGER buildStart;
+    QueryPerformanceCounter(&buildStart);
+
+    mPickMeshes[geo->Name] = mPicker.AddMesh(vertices.data(), sizeof(Vertex), vcount,
+                                             (const std::uint32_t*)indices.data(), (UINT)indices.size());
+
+    LARGE_INTEGER buildEnd;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&buildEnd);
+    QueryPerformanceFrequency(&frequency);
+    mBvhBuildMilliseconds += 1000.0 * (double)(buildEnd.QuadPart - buildStart.QuadPart) / (double)frequency.QuadPart;
+
+    if (mPickMeshes[geo->Name] == TrianglePicker::Invalid)
+        OutputDebugStringW(L"[Picking] car mesh has out-of-range indices and cannot be picked\n");
+
+    LogBvhBuildStats(vcount, (UINT)indices.size());
+    UpdatePickingCaption();
+
     mGeometries[geo->Name] = std::move(geo);
 }
 
@@ -846,6 +911,9 @@ void PickingApp::BuildRenderItems()
     carRitem->IndexCount = carRitem->Geo->DrawArgs["car"].IndexCount;
     carRitem->StartIndexLocation = carRitem->Geo->DrawArgs["car"].StartIndexLocation;
     carRitem->BaseVertexLocation = carRitem->Geo->DrawArgs["car"].BaseVertexLocation;
+    carRitem->PickInstance = mPicker.AddInstance(mPickMeshes["carGeo"], XMLoadFloat4x4(&carRitem->World));
+    if (carRitem->PickInstance != TrianglePicker::Invalid)
+        mPickInstanceRitems.push_back(carRitem.get());
     mRitemLayer[(int)RenderLayer::Opaque].push_back(carRitem.get());
 
     auto pickedRitem = std::make_unique<RenderItem>();
@@ -898,41 +966,88 @@ void PickingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::
 
 void PickingApp::Pick(int sx, int sy)
 {
-    XMFLOAT4X4 P = mCamera.GetProj4x4f();
+    PROFILE_FUNCTION();
 
-    // 뷰 스페이스에서의 선택 레이를 계산합니다.
-    float vx = (+2.0f * sx / mClientWidth  - 1.0f) / P(0, 0);
-    float vy = (-2.0f * sy / mClientHeight + 1.0f) / P(1, 1);
-
-    // 뷰 스페이스에서 레이를 정의합니다.
-    XMVECTOR rayOrigin = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-    XMVECTOR rayDir = XMVectorSet(vx, vy, 1.0f, 0.0f);
-
-    XMMATRIX V = mCamera.GetView();
-    XMMATRIX invV = XMMatrixInverse(&XMMatrixDeterminant(V), V);
+    // 월드 스페이스에서의 선택 레이를 계산합니다.
+    PickRay ray = TrianglePicker::ComputeScreenRay((float)sx, (float)sy, (float)mClientWidth, (float)mClientHeight,
+                                                   mCamera.GetInvView(), mCamera.GetProj());
 
     // 처음에 선택된 렌더 아이템이 없다고 가정합니다.
     mPickedRitem->Visible = false;
 
+    // 보이지 않는 렌더 아이템들은 건너뜁니다.
+    for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
+    {
+        if (ri->PickInstance != TrianglePicker::Invalid)
+            mPicker.SetInstanceEnabled(ri->PickInstance, ri->Visible);
+    }
+
+    LARGE_INTEGER pickStart;
+    QueryPerformanceCounter(&pickStart);
+
+    PickHit hit;
+    if (mBvhPickingEnabled)
+    {
+        mPicker.Pick(&ray, 1, &hit);
+        mLastPickTriangleTests = mPicker.LastStats().TriangleTests;
+    }
+    else
+    {
+        hit = PickBruteForce(ray);
+    }
+
+    LARGE_INTEGER pickEnd;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&pickEnd);
+    QueryPerformanceFrequency(&frequency);
+    mLastPickMilliseconds = 1000.0 * (double)(pickEnd.QuadPart - pickStart.QuadPart) / (double)frequency.QuadPart;
+
+    if (hit.IsHit())
+    {
+        // 가장 가까운 삼각형을 강조합니다.
+        RenderItem* ri = mPickInstanceRitems[hit.Instance];
+
+        mPickedRitem->Visible = true;
+        mPickedRitem->IndexCount = 3;
+        mPickedRitem->BaseVertexLocation = ri->BaseVertexLocation;
+        mPickedRitem->World = ri->World;
+        mPickedRitem->NumFramesDirty = gNumFrameResources;
+        mPickedRitem->StartIndexLocation = ri->StartIndexLocation + 3 * hit.Triangle;
+    }
+
+    LogPickStats(hit);
+    UpdatePickingCaption();
+}
+
+PickHit PickingApp::PickBruteForce(const PickRay& ray)
+{
+    PickHit hit;
+    hit.Distance = MathHelper::Infinity;
+
+    mLastPickTriangleTests = 0;
+
+    XMVECTOR rayOriginW = XMLoadFloat3(&ray.Origin);
+    XMVECTOR rayDirW = XMLoadFloat3(&ray.Direction);
+
     // 불투명 렌더 아이템이 선택됬는지 검사합니다.
     for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
     {
         auto geo = ri->Geo;
 
-        // 보이지 않는 렌더 아이템들은 건너뜁니다.
-        if (ri->Visible == false)
+        // 보이지 않거나 피커에 등록되지 않은 렌더 아이템들은 건너뜁니다.
+        if (ri->Visible == false || ri->PickInstance == TrianglePicker::Invalid)
             continue;
 
         XMMATRIX W = XMLoadFloat4x4(&ri->World);
         XMMATRIX invW = XMMatrixInverse(&XMMatrixDeterminant(W), W);
 
-        // 레이를 뷰 스페이스에서 로컬 스페이스로 이동시키는 메트릭스를 계산합니다.
-        XMMATRIX toLocal = XMMatrixMultiply(invV, invW);
-
-        rayOrigin = XMVector3TransformCoord(rayOrigin, toLocal);
-        rayDir = XMVector3TransformNormal(rayDir, toLocal);
+        // 월드 스페이스의 레이를 렌더 아이템마다 따로 로컬 스페이스로 이동시킵니다.
+        XMVECTOR rayOrigin = XMVector3TransformCoord(rayOriginW, invW);
+        XMVECTOR rayDir = XMVector3TransformNormal(rayDirW, invW);
 
-        // 교차 테스트를 위해 레이 방향을 노말라이즈 합니다.
+        // 교차 테스트를 위해 레이 방향을 노말라이즈 합니다. 로컬 스페이스의 거리를
+        // 이 길이로 나누면 다른 렌더 아이템과 비교할 수 있는 월드 스페이스의 거리가 됩니다.
+        float localLength = XMVectorGetX(XMVector3Length(rayDir));
         rayDir = XMVector3Normalize(rayDir);
 
         // 먼저 메쉬의 바운딩 박스에 교차 검사를 합니다. 바운딩 박스가 교차되면 메쉬 삼각형과 교차 검사를 합니다.
@@ -943,17 +1058,16 @@ void PickingApp::Pick(int sx, int sy)
             // 주의: 데모에서는 버텍스와 인덱스가 어떤 포멧인지 암시적으로 알지만
             // 실제 어플리케이션에선 어떤 포멧으로 캐스팅해야하는지 메타데이터에 저장되어 있어야 합니다.
             auto vertices = (Vertex*)geo->VertexBufferCPU->GetBufferPointer();
-            auto indices = (std::uint32_t*)geo->IndexBufferCPU->GetBufferPointer();
+            auto indices = (std::uint32_t*)geo->IndexBufferCPU->GetBufferPointer() + ri->StartIndexLocation;
             UINT triCount = ri->IndexCount / 3;
 
             // 카메라에서 가장 가까운 레이와 교차하는 삼각형을 찾습니다.
-            tmin = MathHelper::Infinity;
             for (UINT i = 0; i < triCount; ++i)
             {
                 // 삼각형을 위한 인덱스.
-                UINT i0 = indices[i * 3 + 0];
-                UINT i1 = indices[i * 3 + 1];
-                UINT i2 = indices[i * 3 + 2];
+                UINT i0 = ri->BaseVertexLocation + indices[i * 3 + 0];
+                UINT i1 = ri->BaseVertexLocation + indices[i * 3 + 1];
+                UINT i2 = ri->BaseVertexLocation + indices[i * 3 + 2];
 
                 // 삼각형을 위한 버텍스 포지션.
                 XMVECTOR v0 = XMLoadFloat3(&vertices[i0].Pos);
@@ -962,26 +1076,60 @@ void PickingApp::Pick(int sx, int sy)
 
                 // 가장 가까운 삼각형을 찾기 위해서는 모두 검사해야합니다.
                 float t = 0.0f;
-                if (TriangleTests::Intersects(rayOrigin, rayDir, v0, v1, v2, t))
+                if (TriangleTests::Intersects(rayOrigin, rayDir, v0, v1, v2, t) && t / localLength < hit.Distance)
                 {
-                    if (t < tmin)
-                    {
-                        // 가장 가까운 삼각형을 찾았습니다.
-                        tmin = t;
-                        UINT pickedTriangle = i;
-
-                        mPickedRitem->Visible = true;
-                        mPickedRitem->IndexCount = 3;
-                        mPickedRitem->BaseVertexLocation = 0;
-                        mPickedRitem->World = ri->World;
-                        mPickedRitem->NumFramesDirty = gNumFrameResources;
-                        mPickedRitem->StartIndexLocation = 3 * pickedTriangle;
-                    }
+                    // 가장 가까운 삼각형을 찾았습니다. 무게중심 좌표는 구하지 않습니다.
+                    hit.Instance = ri->PickInstance;
+                    hit.Triangle = i;
+                    hit.Distance = t / localLength;
                 }
             }
-        }
 
+            mLastPickTriangleTests += triCount;
+        }
     }
+
+    return hit;
+}
+
+void PickingApp::UpdatePickingCaption()
+{
+    size_t bvhBytes = mPicker.MemoryUsage();
+
+    std::wostringstream outs;
+    outs.precision(3);
+    outs << L"Picking Demo" << L"    BVH build " << mBvhBuildMilliseconds << L" ms, "
+        << bvhBytes / 1024 << L" KB    last pick (" << (mBvhPickingEnabled ? L"BVH" : L"brute force") << L"): "
+        << mLastPickMilliseconds << L" ms, " << mLastPickTriangleTests << L" triangle tests";
+    mMainWndCaption = outs.str();
+}
+
+void PickingApp::LogBvhBuildStats(UINT vertexCount, UINT indexCount)
+{
+    std::wostringstream outs;
+    outs.precision(3);
+    outs << L"[Picking] BVH build: " << vertexCount << L" vertices, " << indexCount / 3 << L" triangles, "
+        << mBvhBuildMilliseconds << L" ms, " << mPicker.MemoryUsage() << L" bytes\n";
+    OutputDebugStringW(outs.str().c_str());
+}
+
+void PickingApp::LogPickStats(const PickHit& hit)
+{
+    std::wostringstream outs;
+    outs.precision(3);
+    outs << L"[Picking] pick (" << (mBvhPickingEnabled ? L"BVH" : L"brute force") << L"): "
+        << mLastPickMilliseconds << L" ms, " << mLastPickTriangleTests << L" triangle tests";
+
+    if (mBvhPickingEnabled)
+        outs << L", " << mPicker.LastStats().NodesVisited << L" nodes visited";
+
+    if (hit.IsHit())
+        outs << L", hit instance " << hit.Instance << L" triangle " << hit.Triangle << L" at " << hit.Distance;
+    else
+        outs << L", no hit";
+
+    outs << L"\n";
+    OutputDebugStringW(outs.str().c_str());
 }
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> PickingApp::GetStaticSamplers()
@@ -463,6 +463,8 @@ void CubeMapApp::AnimateMaterials(const GameTimer& gt)
 
 void CubeMapApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -488,6 +490,8 @@ void CubeMapApp::UpdateObjectCBs(const GameTimer& gt)
 
 void CubeMapApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -518,10 +522,11 @@ void CubeMapApp::UpdateMainPassCB(const GameTimer& gt)
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
 
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+    // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+    XMMATRIX viewProj = mCamera.GetViewProj();
+    XMMATRIX invView = mCamera.GetInvView();
+    XMMATRIX invProj = mCamera.GetInvProj();
+    XMMATRIX invViewProj = mCamera.GetInvViewProj();
 
     XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
     XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
@@ -531,6 +531,8 @@ void DynamicCubeMapApp::AnimateMaterials(const GameTimer& gt)
 
 void DynamicCubeMapApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -556,6 +558,8 @@ void DynamicCubeMapApp::UpdateObjectCBs(const GameTimer& gt)
 
 void DynamicCubeMapApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -586,10 +590,11 @@ void DynamicCubeMapApp::UpdateMainPassCB(const GameTimer& gt)
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
 
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+    // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+    XMMATRIX viewProj = mCamera.GetViewProj();
+    XMMATRIX invView = mCamera.GetInvView();
+    XMMATRIX invProj = mCamera.GetInvProj();
+    XMMATRIX invViewProj = mCamera.GetInvViewProj();
 
     XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
     XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
@@ -627,10 +632,11 @@ void DynamicCubeMapApp::UpdateCubeMapFacePassCBs()
         XMMATRIX view = mCubeMapCamera[i].GetView();
         XMMATRIX proj = mCubeMapCamera[i].GetProj();
 
-        XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-        XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-        XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-        XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+        // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+        XMMATRIX viewProj = mCubeMapCamera[i].GetViewProj();
+        XMMATRIX invView = mCubeMapCamera[i].GetInvView();
+        XMMATRIX invProj = mCubeMapCamera[i].GetInvProj();
+        XMMATRIX invViewProj = mCubeMapCamera[i].GetInvViewProj();
 
         XMStoreFloat4x4(&cubeFacePassCB.View, XMMatrixTranspose(view));
         XMStoreFloat4x4(&cubeFacePassCB.InvView, XMMatrixTranspose(invView));
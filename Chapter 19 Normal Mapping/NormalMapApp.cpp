@@ -13,6 +13,7 @@
 #include "Common/UploadBuffer.h"
 #include "Common/GeometryGenerator.h"
 #include "Common/Camera.h"
+#include "Common/InstanceBatcher.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -30,6 +31,17 @@ struct ObjectConstants
     UINT ObjPad2;
 };
 
+// 인스턴스 드로우에서 인스턴스마다 읽는 데이터입니다.
+struct InstanceData
+{
+    XMFLOAT4X4 World = MathHelper::Identity4x4();
+    XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+    UINT MaterialIndex;
+    UINT InstancePad0;
+    UINT InstancePad1;
+    UINT InstancePad2;
+};
+
 struct PassConstants
 {
     XMFLOAT4X4 View = MathHelper::Identity4x4();
@@ -98,6 +110,9 @@ public:
 
     std::unique_ptr<UploadBuffer<MaterialData>> MaterialBuffer = nullptr;
 
+    // 인스턴스 배치의 순서대로 저장된 인스턴스 데이터입니다.
+    std::unique_ptr<UploadBuffer<InstanceData>> InstanceBuffer = nullptr;
+
     // 펜스 값은 현재 펜스 지점까지의 명령들을 표시합니다.
     // 이 값은 아직 GPU에 의해서 자원들이 사용하는지 검사할 수 있게 해줍니다.
     UINT64 Fence = 0;
@@ -177,7 +192,9 @@ private:
     void BuildFrameResources();
     void BuildMaterials();
     void BuildRenderItems();
+    void BuildInstanceBatches();
     void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
+    void DrawInstanceBatches(ID3D12GraphicsCommandList* cmdList);
 
     std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
@@ -204,6 +221,9 @@ private:
     // PSO에 의해 나눠진 렌더 아이템 목록.
     std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+    // 불투명 레이어를 같은 메쉬끼리 묶은 인스턴스 배치입니다. 항목은 ObjCBIndex입니다.
+    InstanceBatcher mOpaqueBatcher;
+
     UINT mSkyTexHeapIndex = 0;
 
     PassConstants mMainPassCB;
@@ -245,6 +265,7 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
     PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
     ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
     MaterialBuffer = std::make_unique<UploadBuffer<MaterialData>>(device, materialCount, false);
+    InstanceBuffer = std::make_unique<UploadBuffer<InstanceData>>(device, objectCount, false);
 }
 
 FrameResource::~FrameResource()
@@ -280,6 +301,7 @@ bool NormalMapApp::Initialize()
     BuildShapeGeometry();
     BuildMaterials();
     BuildRenderItems();
+    BuildInstanceBatches();
     BuildFrameResources();
     BuildPSOs();
 
@@ -377,7 +399,7 @@ void NormalMapApp::Draw(const GameTimer& gt)
     // 루트 시그네쳐가 테이블에서 몇개의 디스크립터가 필요한지 알고있습니다.
     mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+    DrawInstanceBatches(mCommandList.Get());
 
     mCommandList->SetPipelineState(mPSOs["sky"].Get());
     DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
@@ -461,7 +483,10 @@ void NormalMapApp::AnimateMaterials(const GameTimer& gt)
 
 void NormalMapApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
+    auto currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
     for (auto& e : mAllRitems)
     {
         // 상수들이 바뀌었 때만 상수 버퍼 데이터를 업데이트 합니다.
@@ -478,6 +503,18 @@ void NormalMapApp::UpdateObjectCBs(const GameTimer& gt)
 
             currObjectCB->CopyData(e->ObjCBIndex, objConstants);
 
+            // 인스턴스로 그려지는 항목은 인스턴스 버퍼도 업데이트 합니다.
+            UINT instanceIndex = mOpaqueBatcher.GetInstanceIndex(e->ObjCBIndex);
+            if (instanceIndex != InstanceBatcher::InvalidInstance)
+            {
+                InstanceData instData;
+                instData.World = objConstants.World;
+                instData.TexTransform = objConstants.TexTransform;
+                instData.MaterialIndex = objConstants.MaterialIndex;
+
+                currInstanceBuffer->CopyData(instanceIndex, instData);
+            }
+
             // 다음 프레임 리소스도 마찬가지로 업데이트 되어야 합니다.
             e->NumFramesDirty--;
         }
@@ -486,6 +523,8 @@ void NormalMapApp::UpdateObjectCBs(const GameTimer& gt)
 
 void NormalMapApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -517,10 +556,11 @@ void NormalMapApp::UpdateMainPassCB(const GameTimer& gt)
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
 
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+    // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+    XMMATRIX viewProj = mCamera.GetViewProj();
+    XMMATRIX invView = mCamera.GetInvView();
+    XMMATRIX invProj = mCamera.GetInvProj();
+    XMMATRIX invViewProj = mCamera.GetInvViewProj();
 
     XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
     XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
@@ -593,7 +633,7 @@ void NormalMapApp::BuildRootSignature()
     texTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 10, 1, 0);
 
     // 루트 파라미터는 테이블, 루트 디스크립터, 루트 상수가 될 수 있습니다.
-    CD3DX12_ROOT_PARAMETER slotRootParameter[5];
+    CD3DX12_ROOT_PARAMETER slotRootParameter[6];
 
     // 루트 CBV를 생성합니다.
     slotRootParameter[0].InitAsConstantBufferView(0);
@@ -601,6 +641,7 @@ void NormalMapApp::BuildRootSignature()
     slotRootParameter[2].InitAsShaderResourceView(0, 1);
     slotRootParameter[3].InitAsDescriptorTable(1, &texTable0, D3D12_SHADER_VISIBILITY_PIXEL);
     slotRootParameter[4].InitAsDescriptorTable(1, &texTable1, D3D12_SHADER_VISIBILITY_PIXEL);
+    slotRootParameter[5].InitAsShaderResourceView(1, 1);
 
     auto staticSamplers = GetStaticSamplers();
 
@@ -1063,6 +1104,34 @@ void NormalMapApp::BuildRenderItems()
     }
 }
 
+void NormalMapApp::BuildInstanceBatches()
+{
+    // 같은 지오메트리와 서브메쉬를 그리는 항목들은 한 번의 인스턴스 드로우로 그립니다.
+    // 메터리얼은 인스턴스마다 MaterialIndex로 읽기 때문에 키에 포함되지 않습니다.
+    mOpaqueBatcher.Clear();
+    for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
+    {
+        InstanceBatchKey key;
+        key.Geometry = ri->Geo;
+        key.IndexCount = ri->IndexCount;
+        key.StartIndexLocation = ri->StartIndexLocation;
+        key.BaseVertexLocation = ri->BaseVertexLocation;
+        key.PrimitiveTopology = (std::uint32_t)ri->PrimitiveType;
+
+        mOpaqueBatcher.Add(ri->ObjCBIndex, key);
+    }
+    mOpaqueBatcher.Build();
+
+    // 인스턴스 버퍼의 위치가 바뀌었기 때문에 모든 프레임 리소스를 다시 업데이트 합니다.
+    for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
+        ri->NumFramesDirty = gNumFrameResources;
+
+    std::wostringstream outs;
+    outs << L"Normal Map Demo" << L"    " << mOpaqueBatcher.Batches().size() << L" opaque draws for "
+        << mRitemLayer[(int)RenderLayer::Opaque].size() << L" objects";
+    mMainWndCaption = outs.str();
+}
+
 void NormalMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
 {
     UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
@@ -1086,6 +1155,30 @@ void NormalMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std
     }
 }
 
+void NormalMapApp::DrawInstanceBatches(ID3D12GraphicsCommandList* cmdList)
+{
+    auto instanceBuffer = mCurrFrameResource->InstanceBuffer->Resource();
+
+    for (const InstanceBatch& batch : mOpaqueBatcher.Batches())
+    {
+        auto geo = (MeshGeometry*)batch.Key.Geometry;
+
+        cmdList->IASetVertexBuffers(0, 1, &geo->VertexBufferView());
+        cmdList->IASetIndexBuffer(&geo->IndexBufferView());
+        cmdList->IASetPrimitiveTopology((D3D12_PRIMITIVE_TOPOLOGY)batch.Key.PrimitiveTopology);
+
+        // SV_InstanceID는 StartInstanceLocation을 포함하지 않기 때문에
+        // 배치의 첫 번째 인스턴스를 가리키도록 루트 SRV의 주소를 옮깁니다.
+        D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = instanceBuffer->GetGPUVirtualAddress() +
+            batch.FirstInstance * sizeof(InstanceData);
+
+        cmdList->SetGraphicsRootShaderResourceView(5, instanceAddress);
+
+        cmdList->DrawIndexedInstanced(batch.Key.IndexCount, batch.InstanceCount,
+                                      batch.Key.StartIndexLocation, batch.Key.BaseVertexLocation, 0);
+    }
+}
+
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> NormalMapApp::GetStaticSamplers()
 {
     // 어플리케이션은 보통 몇개의 샘플러만 필요합니다. 그래서 자주 사용되는 샘플러 몇개를 정의하고
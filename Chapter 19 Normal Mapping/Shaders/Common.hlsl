@@ -18,6 +18,16 @@
 // Include structures and functions for lighting.
 #include "LightingUtil.hlsl"
 
+struct InstanceData
+{
+    float4x4 World;
+    float4x4 TexTransform;
+    uint     MaterialIndex;
+    uint     InstPad0;
+    uint     InstPad1;
+    uint     InstPad2;
+};
+
 struct MaterialData
 {
 	float4   DiffuseAlbedo;
@@ -40,6 +50,10 @@ Texture2D gTextureMaps[10] : register(t1);
 // The texture array will occupy registers t0, t1, ..., t3 in space0. 
 StructuredBuffer<MaterialData> gMaterialData : register(t0, space1);
 
+// Per-instance data of the instanced draws.  The application offsets the root SRV to the
+// first instance of each batch, so SV_InstanceID indexes the batch directly.
+StructuredBuffer<InstanceData> gInstanceData : register(t1, space1);
+
 
 SamplerState gsamPointWrap        : register(s0);
 SamplerState gsamPointClamp       : register(s1);
@@ -13,6 +13,10 @@
 #include "Common/UploadBuffer.h"
 #include "Common/GeometryGenerator.h"
 #include "Common/Camera.h"
+#include "Common/TextureUploadPlanner.h"
+#include "Common/TextureStreamingBudget.h"
+#include "Common/DDSTextureTools.h"
+#include "Common/InstanceBatcher.h"
 #include "ShadowMap.h"
 
 using Microsoft::WRL::ComPtr;
@@ -21,6 +25,21 @@ using namespace DirectX::PackedVector;
 
 const int gNumFrameResources = 3;
 
+// 모든 텍스쳐가 함께 사용하는 스테이징 링 버퍼의 최대 크기입니다.
+const UINT64 gTextureStagingRingSize = 16 * 1024 * 1024;
+
+// 모든 텍스쳐가 상주할 수 있는 메모리 예산입니다. 예산을 넘는 밉은 처음에 로드하지 않습니다.
+// 이 예제의 텍스쳐들은 모두 예산 안에 들어가므로 화면 크기에 맞는 밉이 바로 상주합니다.
+const UINT64 gTextureBudgetBytes = 256 * 1024 * 1024;
+
+// 스트리밍을 확인할 때만 켭니다. 하늘 큐브 맵의 최상위 밉이 들어가지 않는 작은 예산을 사용하므로
+// 하늘은 낮은 해상도로 남습니다.
+const bool gTextureStreamingDebugBudget = false;
+const UINT64 gTextureDebugBudgetBytes = 4 * 1024 * 1024;
+
+// SRV 힙의 디스크립터 블록 하나의 크기입니다. 힙에는 같은 배치의 블록이 두 개 있습니다.
+const UINT gSrvBlockSize = 14;
+
 struct ObjectConstants
 {
     XMFLOAT4X4 World = MathHelper::Identity4x4();
@@ -31,6 +50,17 @@ struct ObjectConstants
     UINT ObjPad2;
 };
 
+// 인스턴스 드로우에서 인스턴스마다 읽는 데이터입니다.
+struct InstanceData
+{
+    XMFLOAT4X4 World = MathHelper::Identity4x4();
+    XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+    UINT MaterialIndex;
+    UINT InstancePad0;
+    UINT InstancePad1;
+    UINT InstancePad2;
+};
+
 struct PassConstants
 {
     XMFLOAT4X4 View = MathHelper::Identity4x4();
@@ -99,6 +129,9 @@ public:
     std::unique_ptr<UploadBuffer<PassConstants>> PassCB = nullptr;
     std::unique_ptr<UploadBuffer<ObjectConstants>> ObjectCB = nullptr;
 
+    // 인스턴스 배치의 순서대로 저장된 인스턴스 데이터입니다.
+    std::unique_ptr<UploadBuffer<InstanceData>> InstanceBuffer = nullptr;
+
     std::unique_ptr<UploadBuffer<MaterialData>> MaterialBuffer = nullptr;
 
     // 펜스 값은 현재 펜스 지점까지의 명령들을 표시합니다.
@@ -137,6 +170,22 @@ struct RenderItem
     UINT IndexCount = 0;
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
+
+    // 로컬 공간의 바운딩 박스입니다. 텍스쳐의 화면 크기를 추정하는데 사용합니다.
+    BoundingBox Bounds;
+};
+
+// 스트리밍 중인 텍스쳐 업로드입니다. 복사가 끝날 때까지 새 텍스쳐와 스테이징 버퍼를 보관합니다.
+struct TextureStreamingUpload
+{
+    UINT TextureIndex = 0;
+    UINT TopMip = 0;
+
+    // 복사 명령 다음에 시그널한 펜스 값입니다.
+    UINT64 Fence = 0;
+
+    ComPtr<ID3D12Resource> Texture = nullptr;
+    ComPtr<ID3D12Resource> Staging = nullptr;
 };
 
 enum class RenderLayer : int
@@ -176,6 +225,14 @@ private:
     void UpdateShadowPassCB(const GameTimer& gt);
 
     void LoadTextures();
+    void UploadTextures(const std::vector<ID3D12Resource*>& textures,
+                        const std::vector<std::vector<D3D12_SUBRESOURCE_DATA>>& subresources);
+    void EstimateTextureScreenSizes();
+    void StreamTextures();
+    void BeginStreamingUpload(UINT index, UINT topMip);
+    void FinishStreamingUpload(UINT srvBlock);
+    void BuildTextureSrv(UINT index);
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GetSrvGpuHandle(UINT index) const;
     void BuildRootSignature();
     void BuildDescriptorHeaps();
     void BuildShadersAndInputLayout();
@@ -185,7 +242,9 @@ private:
     void BuildFrameResources();
     void BuildMaterials();
     void BuildRenderItems();
+    void BuildInstanceBatches();
     void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
+    void DrawInstanceBatches(ID3D12GraphicsCommandList* cmdList);
     void DrawSceneToShadowMap();
 
     std::array<const CD3DX12_STATIC_SAMPLER_DESC, 7> GetStaticSamplers();
@@ -205,6 +264,37 @@ private:
     std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
     std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 
+    // 모든 텍스쳐의 업로드에 사용되는 스테이징 링 버퍼입니다. 초기화가 끝나면 해제합니다.
+    ComPtr<ID3D12Resource> mTextureStagingRing = nullptr;
+
+    // 텍스쳐의 로드 순서입니다. SRV 힙에서의 인덱스와 같습니다.
+    std::vector<std::string> mTextureNames;
+    std::unique_ptr<TextureStreamingBudget> mTextureBudget;
+
+    // 파일에서 읽고 밉 체인을 채운 DDS 데이터입니다. 스트리밍할 때 파일을 다시 읽지 않도록
+    // 보관하고, 최상위 밉까지 상주하면 해제합니다.
+    std::vector<std::vector<uint8_t>> mTextureDDSData;
+
+    // 물체들의 거리와 크기로 추정한 텍스쳐마다의 화면 크기(한 변의 픽셀 수)입니다.
+    // 카메라가 지금처럼 움직이면 mStreamingLookAhead초 뒤에 있을 위치에서의 크기도 함께 보므로
+    // 다가가는 물체의 밉은 도착하기 전에 올라옵니다.
+    std::vector<float> mTextureScreenSizes;
+    float mStreamingLookAhead = 0.5f;
+
+    // 스트리밍 업로드는 프레임의 커맨드 리스트와 별도로 기록하고 펜스로 완료를 확인합니다.
+    ComPtr<ID3D12CommandAllocator> mStreamingCmdAlloc = nullptr;
+    ComPtr<ID3D12GraphicsCommandList> mStreamingCmdList = nullptr;
+    std::unique_ptr<TextureStreamingUpload> mStreamingUpload;
+
+    // 교체된 텍스쳐입니다. 교체 전에 제출된 프레임들이 끝날 때까지 (펜스 값, 리소스)로 보관합니다.
+    std::vector<std::pair<UINT64, ComPtr<ID3D12Resource>>> mRetiredTextures;
+
+    // 디스크립터의 원본은 셰이더에서 보이지 않는 힙에 있습니다. 텍스쳐를 교체할 때는 GPU가
+    // 사용하지 않는 블록에 원본을 복사한 뒤 그 블록을 사용하므로 큐를 비울 필요가 없습니다.
+    ComPtr<ID3D12DescriptorHeap> mSrvCpuHeap = nullptr;
+    UINT mActiveSrvBlock = 0;
+    UINT64 mSrvBlockFence[2] = { 0, 0 };
+
     std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
 
     // 렌더 아이템 목록.
@@ -213,14 +303,15 @@ private:
     // PSO에 의해 나눠진 렌더 아이템 목록.
     std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+    // 불투명 레이어를 같은 메쉬끼리 묶은 인스턴스 배치입니다. 항목은 ObjCBIndex입니다.
+    InstanceBatcher mOpaqueBatcher;
+
     UINT mSkyTexHeapIndex = 0;
     UINT mShadowMapHeapIndex = 0;
 
     UINT mNullCubeSrvIndex = 0;
     UINT mNullTexSrvIndex = 0;
 
-    CD3DX12_GPU_DESCRIPTOR_HANDLE mNullSrv;
-
     PassConstants mMainPassCB;   // 인덱스 0이 해당 패스의 cbuffer입니다.
     PassConstants mShadowPassCB; // 인덱스 1이 해당 패스의 cbuffer입니다.
 
@@ -279,6 +370,7 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
 
     PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
     ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
+    InstanceBuffer = std::make_unique<UploadBuffer<InstanceData>>(device, objectCount, false);
     MaterialBuffer = std::make_unique<UploadBuffer<MaterialData>>(device, materialCount, false);
 }
 
@@ -313,14 +405,24 @@ bool ShadowMapApp::Initialize()
     mShadowMap = std::make_unique<ShadowMap>(
         md3dDevice.Get(), 2048, 2048);
 
-    LoadTextures();
-    BuildRootSignature();
-    BuildDescriptorHeaps();
+    // 스트리밍 업로드를 기록할 커맨드 리스트입니다.
+    ThrowIfFailed(md3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                     IID_PPV_ARGS(mStreamingCmdAlloc.GetAddressOf())));
+    ThrowIfFailed(md3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mStreamingCmdAlloc.Get(),
+                                                nullptr, IID_PPV_ARGS(mStreamingCmdList.GetAddressOf())));
+    ThrowIfFailed(mStreamingCmdList->Close());
+
     BuildShadersAndInputLayout();
     BuildShapeGeometry();
     BuildSkullGeometry();
     BuildMaterials();
     BuildRenderItems();
+    BuildInstanceBatches();
+
+    // 상주시킬 밉은 물체들이 화면에서 차지하는 크기로 정하므로 렌더 아이템을 만든 다음에 로드합니다.
+    LoadTextures();
+    BuildRootSignature();
+    BuildDescriptorHeaps();
     BuildFrameResources();
     BuildPSOs();
 
@@ -332,6 +434,9 @@ bool ShadowMapApp::Initialize()
     // 초기화가 종료될 때가지 기다립니다.
     FlushCommandQueue();
 
+    // 텍스쳐 업로드가 끝났으므로 스테이징 링 버퍼는 더 이상 필요하지 않습니다.
+    mTextureStagingRing = nullptr;
+
     return true;
 }
 
@@ -380,6 +485,13 @@ void ShadowMapApp::Update(const GameTimer& gt)
         CloseHandle(eventHandle);
     }
 
+    // 카메라가 움직이면 텍스쳐에 필요한 해상도도 바뀝니다.
+    EstimateTextureScreenSizes();
+    for (UINT i = 0; i < mTextureBudget->TextureCount(); ++i)
+        mTextureBudget->SetScreenSize(i, mTextureScreenSizes[i]);
+
+    StreamTextures();
+
     //
     // 빛의 위치를 에니메이션 합니다.
     //
@@ -424,12 +536,12 @@ void ShadowMapApp::Draw(const GameTimer& gt)
     mCommandList->SetGraphicsRootShaderResourceView(2, matBuffer->GetGPUVirtualAddress());
 
     // 쉐도우 맵 패스를 위해 null SRV를 바인드 합니다.
-    mCommandList->SetGraphicsRootDescriptorTable(3, mNullSrv);
+    mCommandList->SetGraphicsRootDescriptorTable(3, GetSrvGpuHandle(mNullCubeSrvIndex));
 
     // 장면에서 사용되는 모든 텍스쳐를 바인드 합니다.
     // 여기서 디스크립터의 첫번째를 테이블에 설정합니다.
     // 루트 시그네쳐가 테이블에서 몇개의 디스크립터가 필요한지 알고있습니다.
-    mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    mCommandList->SetGraphicsRootDescriptorTable(4, GetSrvGpuHandle(0));
 
     DrawSceneToShadowMap();
 
@@ -455,12 +567,10 @@ void ShadowMapApp::Draw(const GameTimer& gt)
     // 그러므로 모든 오브젝트는 동일한 큐브맵을 사용하게 됩니다.
     // 로컬 큐브맵을 사용하고 싶다면 오브젝트마다 다른 큐브맵을 사용하거나
     // 큐브맵 텍스쳐 어레이를 사용해야합니다.
-    CD3DX12_GPU_DESCRIPTOR_HANDLE skyTexDescriptor(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-    skyTexDescriptor.Offset(mSkyTexHeapIndex, mCbvSrvUavDescriptorSize);
-    mCommandList->SetGraphicsRootDescriptorTable(3, skyTexDescriptor);
+    mCommandList->SetGraphicsRootDescriptorTable(3, GetSrvGpuHandle(mSkyTexHeapIndex));
 
     mCommandList->SetPipelineState(mPSOs["opaque"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+    DrawInstanceBatches(mCommandList.Get());
 
     mCommandList->SetPipelineState(mPSOs["debug"].Get());
     DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Debug]);
@@ -491,6 +601,9 @@ void ShadowMapApp::Draw(const GameTimer& gt)
     // 어플리케이션은 GPU 시간축에 있지 않기 때문에,
     // GPU가 모든 커맨드들의 처리가 완료되기 전까지 Signal()을 처리하지 않습니다.
     mCommandQueue->Signal(mFence.Get(), mCurrentFence);
+
+    // 이 펜스 지점까지는 현재 디스크립터 블록이 사용됩니다.
+    mSrvBlockFence[mActiveSrvBlock] = mCurrentFence;
 }
 
 void ShadowMapApp::OnMouseDown(WPARAM btnState, int x, int y)
@@ -539,6 +652,7 @@ void ShadowMapApp::OnKeyboardInput(const GameTimer& gt)
         mCamera.Strafe(10.0f * dt);
 
     mCamera.UpdateViewMatrix();
+    mCamera.UpdateMotion(dt);
 }
 
 void ShadowMapApp::AnimateMaterials(const GameTimer& gt)
@@ -547,7 +661,10 @@ void ShadowMapApp::AnimateMaterials(const GameTimer& gt)
 
 void ShadowMapApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
+    auto currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
     for (auto& e : mAllRitems)
     {
         // 상수들이 바뀌었 때만 상수 버퍼 데이터를 업데이트 합니다.
@@ -564,6 +681,18 @@ void ShadowMapApp::UpdateObjectCBs(const GameTimer& gt)
 
             currObjectCB->CopyData(e->ObjCBIndex, objConstants);
 
+            // 인스턴스로 그려지는 항목은 인스턴스 버퍼도 업데이트 합니다.
+            UINT instanceIndex = mOpaqueBatcher.GetInstanceIndex(e->ObjCBIndex);
+            if (instanceIndex != InstanceBatcher::InvalidInstance)
+            {
+                InstanceData instData;
+                instData.World = objConstants.World;
+                instData.TexTransform = objConstants.TexTransform;
+                instData.MaterialIndex = objConstants.MaterialIndex;
+
+                currInstanceBuffer->CopyData(instanceIndex, instData);
+            }
+
             // 다음 프레임 리소스도 마찬가지로 업데이트 되어야 합니다.
             e->NumFramesDirty--;
         }
@@ -572,6 +701,8 @@ void ShadowMapApp::UpdateObjectCBs(const GameTimer& gt)
 
 void ShadowMapApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -643,10 +774,11 @@ void ShadowMapApp::UpdateMainPassCB(const GameTimer& gt)
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
 
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
+    // 역행렬들은 카메라가 캐쉬해 두었다가 움직였을 때만 다시 계산합니다.
+    XMMATRIX viewProj = mCamera.GetViewProj();
+    XMMATRIX invView = mCamera.GetInvView();
+    XMMATRIX invProj = mCamera.GetInvProj();
+    XMMATRIX invViewProj = mCamera.GetInvViewProj();
 
     XMMATRIX shadowTransform = XMLoadFloat4x4(&mShadowTransform);
 
@@ -705,9 +837,43 @@ void ShadowMapApp::UpdateShadowPassCB(const GameTimer& gt)
     currPassCB->CopyData(1, mShadowPassCB);
 }
 
+static TextureUploadDesc GetTextureUploadDesc(const D3D12_RESOURCE_DESC& texDesc)
+{
+    TextureUploadDesc uploadDesc;
+    uploadDesc.Width = texDesc.Width;
+    uploadDesc.Height = texDesc.Height;
+    uploadDesc.DepthOrArraySize = texDesc.DepthOrArraySize;
+    uploadDesc.MipLevels = texDesc.MipLevels;
+    uploadDesc.Format = texDesc.Format;
+    uploadDesc.IsVolume = texDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+
+    return uploadDesc;
+}
+
+// DDS 파일을 읽고 밉 체인이 없거나 모자라면 CPU에서 만들어서 채웁니다.
+static std::vector<uint8_t> LoadDDSData(const std::wstring& filename)
+{
+    auto blob = d3dUtil::LoadBinary(filename);
+    auto bits = reinterpret_cast<const uint8_t*>(blob->GetBufferPointer());
+    std::vector<uint8_t> ddsData(bits, bits + blob->GetBufferSize());
+
+    D3D12_RESOURCE_DESC texDesc;
+    ThrowIfFailed(DirectX::GetDDSTextureDescFromMemory12(ddsData.data(), ddsData.size(), texDesc));
+
+    if (texDesc.MipLevels < MipGenerator::GetMipCount((UINT)texDesc.Width, texDesc.Height))
+    {
+        // 큐브 맵처럼 지원하지 않는 텍스쳐는 그대로 사용합니다.
+        std::vector<uint8_t> mipData;
+        if (GenerateDDSMipChain(ddsData.data(), ddsData.size(), MipGenerationOptions(), mipData))
+            ddsData.swap(mipData);
+    }
+
+    return ddsData;
+}
+
 void ShadowMapApp::LoadTextures()
 {
-    std::vector<std::string> texNames =
+    mTextureNames =
     {
         "bricksDiffuseMap",
         "bricksNormalMap",
@@ -729,17 +895,322 @@ void ShadowMapApp::LoadTextures()
         L"..\\Textures\\desertcube1024.dds"
     };
 
-    for (int i = 0; i < (int)texNames.size(); ++i)
+    // 렌더 아이템들로부터 텍스쳐가 화면에서 차지할 크기를 추정합니다.
+    EstimateTextureScreenSizes();
+    mTextureBudget = std::make_unique<TextureStreamingBudget>(
+        gTextureStreamingDebugBudget ? gTextureDebugBudgetBytes : gTextureBudgetBytes);
+
+    // 먼저 파일을 읽고 밉 체인을 채운 다음 텍스쳐마다 상주시킬 최상위 밉을 결정합니다.
+    // 읽은 데이터는 스트리밍에서 다시 사용하므로 보관합니다.
+    mTextureDDSData.resize(mTextureNames.size());
+    for (int i = 0; i < (int)mTextureNames.size(); ++i)
+    {
+        mTextureDDSData[i] = LoadDDSData(texFilenames[i]);
+
+        D3D12_RESOURCE_DESC texDesc;
+        ThrowIfFailed(DirectX::GetDDSTextureDescFromMemory12(mTextureDDSData[i].data(), mTextureDDSData[i].size(), texDesc));
+
+        mTextureBudget->AddTexture(GetTextureUploadDesc(texDesc), mTextureScreenSizes[i]);
+    }
+
+    mTextureBudget->Resolve();
+
+    // 텍스쳐마다 업로드 힙을 만드는 대신 텍스쳐만 생성하고 서브리소스 데이터를 모아둡니다.
+    std::vector<std::vector<D3D12_SUBRESOURCE_DATA>> subresources(mTextureNames.size());
+    std::vector<ID3D12Resource*> textures(mTextureNames.size());
+
+    for (int i = 0; i < (int)mTextureNames.size(); ++i)
     {
         auto texMap = std::make_unique<Texture>();
-        texMap->Name = texNames[i];
+        texMap->Name = mTextureNames[i];
         texMap->Filename = texFilenames[i];
-        ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-                                                          mCommandList.Get(), texMap->Filename.c_str(),
-                                                          texMap->Resource, texMap->UploadHeap));
+        ThrowIfFailed(DirectX::LoadDDSTextureFromMemory12(md3dDevice.Get(),
+                                                          mTextureDDSData[i].data(), mTextureDDSData[i].size(), texMap->Resource,
+                                                          subresources[i], (size_t)mTextureBudget->GetMaxSize(i)));
+
+        textures[i] = texMap->Resource.Get();
 
         mTextures[texMap->Name] = std::move(texMap);
     }
+
+    UploadTextures(textures, subresources);
+}
+
+// 서브리소스 하나를 스테이징 버퍼의 정렬된 위치에 쓰고 텍스쳐로 복사하는 명령을 기록합니다.
+static void RecordTextureCopy(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* staging, BYTE* mappedStaging,
+                              ID3D12Resource* texture, const TextureCopyDesc& copy, const D3D12_SUBRESOURCE_DATA& srcData)
+{
+    // 서브리소스의 행들을 정렬된 행 간격에 맞춰서 복사합니다.
+    for (UINT z = 0; z < copy.Depth; ++z)
+    {
+        BYTE* dstSlice = mappedStaging + copy.RingOffset + (UINT64)copy.RowPitch * copy.NumRows * z;
+        const BYTE* srcSlice = reinterpret_cast<const BYTE*>(srcData.pData) + srcData.SlicePitch * z;
+        for (UINT row = 0; row < copy.NumRows; ++row)
+        {
+            memcpy(dstSlice + (UINT64)copy.RowPitch * row, srcSlice + srcData.RowPitch * row, (size_t)copy.RowSizeInBytes);
+        }
+    }
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+    footprint.Offset = copy.RingOffset;
+    footprint.Footprint.Format = copy.Format;
+    footprint.Footprint.Width = copy.Width;
+    footprint.Footprint.Height = copy.Height;
+    footprint.Footprint.Depth = copy.Depth;
+    footprint.Footprint.RowPitch = copy.RowPitch;
+
+    CD3DX12_TEXTURE_COPY_LOCATION dstLocation(texture, copy.Subresource);
+    CD3DX12_TEXTURE_COPY_LOCATION srcLocation(staging, footprint);
+    cmdList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+}
+
+void ShadowMapApp::UploadTextures(const std::vector<ID3D12Resource*>& textures,
+                                  const std::vector<std::vector<D3D12_SUBRESOURCE_DATA>>& subresources)
+{
+    std::vector<TextureUploadDesc> uploadDescs(textures.size());
+    for (int i = 0; i < (int)textures.size(); ++i)
+        uploadDescs[i] = GetTextureUploadDesc(textures[i]->GetDesc());
+
+    // 모든 서브리소스를 하나의 스테이징 링에 배치합니다.
+    TextureUploadPlanner planner(gTextureStagingRingSize);
+    ThrowIfFailed(planner.Plan(uploadDescs) ? S_OK : E_OUTOFMEMORY);
+
+    // 링은 실제로 사용되는 최대 크기만큼만 만듭니다.
+    ThrowIfFailed(md3dDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(planner.PeakStagingBytes()),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&mTextureStagingRing)));
+
+    BYTE* mappedRing = nullptr;
+    ThrowIfFailed(mTextureStagingRing->Map(0, nullptr, reinterpret_cast<void**>(&mappedRing)));
+
+    UINT batch = 0;
+    for (const TextureCopyDesc& copy : planner.Copies())
+    {
+        if (copy.Batch != batch)
+        {
+            // 링의 앞부분을 다시 쓰기 전에 이전 배치의 복사가 끝날 때까지 기다립니다.
+            ThrowIfFailed(mCommandList->Close());
+            ID3D12CommandList* cmdLists[] = {mCommandList.Get()};
+            mCommandQueue->ExecuteCommandLists(1, cmdLists);
+            FlushCommandQueue();
+
+            ThrowIfFailed(mDirectCmdListAlloc->Reset());
+            ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
+
+            batch = copy.Batch;
+        }
+
+        RecordTextureCopy(mCommandList.Get(), mTextureStagingRing.Get(), mappedRing, textures[copy.TextureIndex],
+                          copy, subresources[copy.TextureIndex][copy.Subresource]);
+    }
+
+    mTextureStagingRing->Unmap(0, nullptr);
+
+    for (auto texture : textures)
+    {
+        mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture,
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+    }
+}
+
+void ShadowMapApp::EstimateTextureScreenSizes()
+{
+    mTextureScreenSizes.assign(mTextureNames.size(), 0.0f);
+
+    // 투영 행렬의 [1][1] 성분은 1 / tan(fovY / 2)입니다.
+    const float projScale = 1.0f / tanf(0.5f * mCamera.GetFovY());
+    const float maxScreenSize = (float)MathHelper::Max(mClientWidth, mClientHeight);
+    XMVECTOR eyePos = mCamera.GetPosition();
+
+    BoundingFrustum predictedFrustum;
+    mCamera.GetPredictedFrustum(mStreamingLookAhead, predictedFrustum);
+    XMVECTOR predictedEyePos = XMLoadFloat3(&predictedFrustum.Origin);
+
+    for (int layer : { (int)RenderLayer::Opaque, (int)RenderLayer::Sky })
+    {
+        for (auto ri : mRitemLayer[layer])
+        {
+            BoundingBox bounds;
+            ri->Bounds.Transform(bounds, XMLoadFloat4x4(&ri->World));
+
+            // 바운딩 스피어가 화면에서 차지하는 지름입니다. 카메라가 안에 있으면 화면 전체를 덮습니다.
+            // 지금과 예측한 위치 중 더 가까운 쪽을 기준으로 합니다.
+            float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Extents)));
+            float distance = MathHelper::Min(XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Center) - eyePos)),
+                                             XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Center) - predictedEyePos)));
+
+            float screenSize = maxScreenSize;
+            if (distance > radius)
+                screenSize = MathHelper::Min(maxScreenSize, radius / distance * projScale * mClientHeight);
+
+            // 텍스쳐 좌표가 반복되면 텍스쳐 한 장은 반복 횟수만큼 작게 보입니다.
+            XMFLOAT4X4 texTransform;
+            XMStoreFloat4x4(&texTransform, XMLoadFloat4x4(&ri->TexTransform) * XMLoadFloat4x4(&ri->Mat->MatTransform));
+            float tiling = MathHelper::Max(sqrtf(texTransform._11 * texTransform._11 + texTransform._12 * texTransform._12),
+                                           sqrtf(texTransform._21 * texTransform._21 + texTransform._22 * texTransform._22));
+            if (tiling > 0.0f)
+                screenSize /= tiling;
+
+            // 같은 텍스쳐를 사용하는 물체들 중 가장 크게 보이는 물체를 기준으로 합니다.
+            for (int heapIndex : { ri->Mat->DiffuseSrvHeapIndex, ri->Mat->NormalSrvHeapIndex })
+            {
+                if (heapIndex >= 0 && heapIndex < (int)mTextureScreenSizes.size())
+                    mTextureScreenSizes[heapIndex] = MathHelper::Max(mTextureScreenSizes[heapIndex], screenSize);
+            }
+        }
+    }
+}
+
+void ShadowMapApp::StreamTextures()
+{
+    const UINT64 completedFence = mFence->GetCompletedValue();
+
+    // 교체되기 전에 제출된 프레임들이 모두 끝난 텍스쳐를 해제합니다.
+    mRetiredTextures.erase(std::remove_if(mRetiredTextures.begin(), mRetiredTextures.end(),
+                                          [completedFence](const std::pair<UINT64, ComPtr<ID3D12Resource>>& retired)
+                                          {
+                                              return retired.first <= completedFence;
+                                          }),
+                           mRetiredTextures.end());
+
+    if (mStreamingUpload != nullptr)
+    {
+        // 복사가 아직 끝나지 않았으면 다음 프레임에 다시 확인합니다.
+        if (completedFence < mStreamingUpload->Fence)
+            return;
+
+        // 새 SRV를 쓸 블록을 GPU가 아직 사용하고 있어도 다음 프레임으로 미룹니다.
+        const UINT nextSrvBlock = (mActiveSrvBlock + 1) % 2;
+        if (completedFence < mSrvBlockFence[nextSrvBlock])
+            return;
+
+        FinishStreamingUpload(nextSrvBlock);
+    }
+
+    // 한 번에 하나의 텍스쳐만 한 단계의 밉씩 올립니다.
+    UINT index = 0;
+    UINT topMip = 0;
+    if (mTextureBudget->NextStreamingRequest(index, topMip))
+        BeginStreamingUpload(index, topMip);
+}
+
+void ShadowMapApp::BeginStreamingUpload(UINT index, UINT topMip)
+{
+    auto upload = std::make_unique<TextureStreamingUpload>();
+    upload->TextureIndex = index;
+    upload->TopMip = topMip;
+
+    // 로드할 때 만든 밉 체인에서 topMip부터의 서브리소스를 가진 새 텍스쳐를 만듭니다.
+    const std::vector<uint8_t>& ddsData = mTextureDDSData[index];
+    std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+    ThrowIfFailed(DirectX::LoadDDSTextureFromMemory12(md3dDevice.Get(),
+                                                      ddsData.data(), ddsData.size(), upload->Texture,
+                                                      subresources, (size_t)mTextureBudget->GetMaxSize(index, topMip)));
+
+    // 업로드는 한 번에 제출하므로 링 크기를 제한하지 않아서 배치가 하나만 만들어지게 합니다.
+    TextureUploadPlanner planner(UINT64_MAX);
+    ThrowIfFailed(planner.Plan({ GetTextureUploadDesc(upload->Texture->GetDesc()) }) ? S_OK : E_OUTOFMEMORY);
+
+    ThrowIfFailed(md3dDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(planner.PeakStagingBytes()),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&upload->Staging)));
+
+    // 이전 업로드가 끝난 다음에만 새 업로드를 시작하므로 할당자를 바로 재사용할 수 있습니다.
+    ThrowIfFailed(mStreamingCmdAlloc->Reset());
+    ThrowIfFailed(mStreamingCmdList->Reset(mStreamingCmdAlloc.Get(), nullptr));
+
+    BYTE* mappedStaging = nullptr;
+    ThrowIfFailed(upload->Staging->Map(0, nullptr, reinterpret_cast<void**>(&mappedStaging)));
+
+    for (const TextureCopyDesc& copy : planner.Copies())
+    {
+        RecordTextureCopy(mStreamingCmdList.Get(), upload->Staging.Get(), mappedStaging, upload->Texture.Get(),
+                          copy, subresources[copy.Subresource]);
+    }
+
+    upload->Staging->Unmap(0, nullptr);
+
+    mStreamingCmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(upload->Texture.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+    ThrowIfFailed(mStreamingCmdList->Close());
+    ID3D12CommandList* cmdLists[] = {mStreamingCmdList.Get()};
+    mCommandQueue->ExecuteCommandLists(1, cmdLists);
+
+    // 이후의 프레임에서 이 펜스 값으로 복사가 끝났는지 확인합니다. CPU는 기다리지 않습니다.
+    upload->Fence = ++mCurrentFence;
+    mCommandQueue->Signal(mFence.Get(), upload->Fence);
+
+    mStreamingUpload = std::move(upload);
+}
+
+void ShadowMapApp::FinishStreamingUpload(UINT srvBlock)
+{
+    const UINT index = mStreamingUpload->TextureIndex;
+    auto& texMap = mTextures[mTextureNames[index]];
+
+    // 지금까지 제출된 프레임들은 이전 텍스쳐를 사용하므로 그 프레임들이 끝날 때까지 보관합니다.
+    mRetiredTextures.emplace_back(mCurrentFence, texMap->Resource);
+    texMap->Resource = mStreamingUpload->Texture;
+
+    // 원본 힙의 SRV를 바꾸고 GPU가 사용하지 않는 블록에 복사한 다음 그 블록을 사용합니다.
+    BuildTextureSrv(index);
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE dstBlock(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
+                                           srvBlock * gSrvBlockSize, mCbvSrvUavDescriptorSize);
+    md3dDevice->CopyDescriptorsSimple(gSrvBlockSize, dstBlock, mSrvCpuHeap->GetCPUDescriptorHandleForHeapStart(),
+                                      D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    mActiveSrvBlock = srvBlock;
+
+    mTextureBudget->CommitResidentMip(index, mStreamingUpload->TopMip);
+
+    // 최상위 밉까지 상주하면 더 이상 스트리밍할 것이 없으므로 DDS 데이터를 해제합니다.
+    if (mStreamingUpload->TopMip == 0)
+        std::vector<uint8_t>().swap(mTextureDDSData[index]);
+
+    mStreamingUpload = nullptr;
+}
+
+CD3DX12_GPU_DESCRIPTOR_HANDLE ShadowMapApp::GetSrvGpuHandle(UINT index) const
+{
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart(),
+                                         mActiveSrvBlock * gSrvBlockSize + index, mCbvSrvUavDescriptorSize);
+}
+
+void ShadowMapApp::BuildTextureSrv(UINT index)
+{
+    auto resource = mTextures[mTextureNames[index]]->Resource;
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Format = resource->GetDesc().Format;
+
+    if (index == mSkyTexHeapIndex)
+    {
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+        srvDesc.TextureCube.MostDetailedMip = 0;
+        srvDesc.TextureCube.MipLevels = resource->GetDesc().MipLevels;
+        srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+    }
+    else
+    {
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MostDetailedMip = 0;
+        srvDesc.Texture2D.MipLevels = resource->GetDesc().MipLevels;
+        srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+    }
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvCpuHeap->GetCPUDescriptorHandleForHeapStart(),
+                                              index, mCbvSrvUavDescriptorSize);
+    md3dDevice->CreateShaderResourceView(resource.Get(), &srvDesc, hDescriptor);
 }
 
 void ShadowMapApp::BuildRootSignature()
@@ -751,7 +1222,7 @@ void ShadowMapApp::BuildRootSignature()
     texTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 10, 2, 0);
 
     // 루트 파라미터는 테이블, 루트 디스크립터, 루트 상수가 될 수 있습니다.
-    CD3DX12_ROOT_PARAMETER slotRootParameter[5];
+    CD3DX12_ROOT_PARAMETER slotRootParameter[6];
 
     // 루트 CBV를 생성합니다.
     slotRootParameter[0].InitAsConstantBufferView(0);
@@ -759,6 +1230,7 @@ void ShadowMapApp::BuildRootSignature()
     slotRootParameter[2].InitAsShaderResourceView(0, 1);
     slotRootParameter[3].InitAsDescriptorTable(1, &texTable0, D3D12_SHADER_VISIBILITY_PIXEL);
     slotRootParameter[4].InitAsDescriptorTable(1, &texTable1, D3D12_SHADER_VISIBILITY_PIXEL);
+    slotRootParameter[5].InitAsShaderResourceView(1, 1);
 
     auto staticSamplers = GetStaticSamplers();
 
@@ -791,17 +1263,24 @@ void ShadowMapApp::BuildDescriptorHeaps()
 {
     //
     // SRV 힙을 생성합니다.
+    // 디스크립터는 셰이더에서 보이지 않는 힙에 만들고, 셰이더에서 보이는 힙의 두 블록 중
+    // 하나에 복사해서 사용합니다. 스트리밍으로 텍스쳐가 바뀌면 GPU가 사용하지 않는 블록에
+    // 다시 복사하므로 이미 제출된 프레임이 읽는 디스크립터를 덮어쓰지 않습니다.
     //
     D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-    srvHeapDesc.NumDescriptors = 14;
+    srvHeapDesc.NumDescriptors = gSrvBlockSize;
     srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvCpuHeap)));
+
+    srvHeapDesc.NumDescriptors = 2 * gSrvBlockSize;
     srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
     ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvDescriptorHeap)));
 
     //
     // 디스크립터로 힙에 내용을 채웁니다.
     //
-    CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
+    CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvCpuHeap->GetCPUDescriptorHandleForHeapStart());
 
     std::vector<ComPtr<ID3D12Resource>> tex2DList =
     {
@@ -844,12 +1323,11 @@ void ShadowMapApp::BuildDescriptorHeaps()
     mNullCubeSrvIndex = mShadowMapHeapIndex + 1;
     mNullTexSrvIndex = mNullCubeSrvIndex + 1;
 
-    auto srvCpuStart = mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+    auto srvCpuStart = mSrvCpuHeap->GetCPUDescriptorHandleForHeapStart();
     auto srvGpuStart = mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
     auto dsvCpuStart = mDsvHeap->GetCPUDescriptorHandleForHeapStart();
 
     auto nullSrv = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, mNullCubeSrvIndex, mCbvSrvUavDescriptorSize);
-    mNullSrv = CD3DX12_GPU_DESCRIPTOR_HANDLE(srvGpuStart, mNullCubeSrvIndex, mCbvSrvUavDescriptorSize);
 
     md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, nullSrv);
     nullSrv.Offset(1, mCbvSrvUavDescriptorSize);
@@ -865,6 +1343,11 @@ void ShadowMapApp::BuildDescriptorHeaps()
         CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, mShadowMapHeapIndex, mCbvSrvUavDescriptorSize),
         CD3DX12_GPU_DESCRIPTOR_HANDLE(srvGpuStart, mShadowMapHeapIndex, mCbvSrvUavDescriptorSize),
         CD3DX12_CPU_DESCRIPTOR_HANDLE(dsvCpuStart, 1, mDsvDescriptorSize));
+
+    // 처음에는 0번 블록을 사용합니다.
+    md3dDevice->CopyDescriptorsSimple(gSrvBlockSize, mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
+                                      srvCpuStart, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    mActiveSrvBlock = 0;
 }
 
 void ShadowMapApp::BuildShadersAndInputLayout()
@@ -929,26 +1412,36 @@ void ShadowMapApp::BuildShapeGeometry()
     boxSubmesh.IndexCount = (UINT)box.Indices32.size();
     boxSubmesh.StartIndexLocation = boxIndexOffset;
     boxSubmesh.BaseVertexLocation = boxVertexOffset;
+    BoundingBox::CreateFromPoints(boxSubmesh.Bounds, box.Vertices.size(),
+                                  &box.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
 
     SubmeshGeometry gridSubmesh;
     gridSubmesh.IndexCount = (UINT)grid.Indices32.size();
     gridSubmesh.StartIndexLocation = gridIndexOffset;
     gridSubmesh.BaseVertexLocation = gridVertexOffset;
+    BoundingBox::CreateFromPoints(gridSubmesh.Bounds, grid.Vertices.size(),
+                                  &grid.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
 
     SubmeshGeometry sphereSubmesh;
     sphereSubmesh.IndexCount = (UINT)sphere.Indices32.size();
     sphereSubmesh.StartIndexLocation = sphereIndexOffset;
     sphereSubmesh.BaseVertexLocation = sphereVertexOffset;
+    BoundingBox::CreateFromPoints(sphereSubmesh.Bounds, sphere.Vertices.size(),
+                                  &sphere.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
 
     SubmeshGeometry cylinderSubmesh;
     cylinderSubmesh.IndexCount = (UINT)cylinder.Indices32.size();
     cylinderSubmesh.StartIndexLocation = cylinderIndexOffset;
     cylinderSubmesh.BaseVertexLocation = cylinderVertexOffset;
+    BoundingBox::CreateFromPoints(cylinderSubmesh.Bounds, cylinder.Vertices.size(),
+                                  &cylinder.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
 
     SubmeshGeometry quadSubmesh;
     quadSubmesh.IndexCount = (UINT)quad.Indices32.size();
     quadSubmesh.StartIndexLocation = quadIndexOffset;
     quadSubmesh.BaseVertexLocation = quadVertexOffset;
+    BoundingBox::CreateFromPoints(quadSubmesh.Bounds, quad.Vertices.size(),
+                                  &quad.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
 
     //
     // Extract the vertex elements we are interested in and pack the
@@ -1326,6 +1819,7 @@ void ShadowMapApp::BuildRenderItems()
     skyRitem->IndexCount = skyRitem->Geo->DrawArgs["sphere"].IndexCount;
     skyRitem->StartIndexLocation = skyRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
     skyRitem->BaseVertexLocation = skyRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+    skyRitem->Bounds = skyRitem->Geo->DrawArgs["sphere"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Sky].push_back(skyRitem.get());
     mAllRitems.push_back(std::move(skyRitem));
@@ -1340,6 +1834,7 @@ void ShadowMapApp::BuildRenderItems()
     quadRitem->IndexCount = quadRitem->Geo->DrawArgs["quad"].IndexCount;
     quadRitem->StartIndexLocation = quadRitem->Geo->DrawArgs["quad"].StartIndexLocation;
     quadRitem->BaseVertexLocation = quadRitem->Geo->DrawArgs["quad"].BaseVertexLocation;
+    quadRitem->Bounds = quadRitem->Geo->DrawArgs["quad"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Debug].push_back(quadRitem.get());
     mAllRitems.push_back(std::move(quadRitem));
@@ -1354,6 +1849,7 @@ void ShadowMapApp::BuildRenderItems()
     boxRitem->IndexCount = boxRitem->Geo->DrawArgs["box"].IndexCount;
     boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
     boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+    boxRitem->Bounds = boxRitem->Geo->DrawArgs["box"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Opaque].push_back(boxRitem.get());
     mAllRitems.push_back(std::move(boxRitem));
@@ -1368,6 +1864,7 @@ void ShadowMapApp::BuildRenderItems()
     skullRitem->IndexCount = skullRitem->Geo->DrawArgs["skull"].IndexCount;
     skullRitem->StartIndexLocation = skullRitem->Geo->DrawArgs["skull"].StartIndexLocation;
     skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs["skull"].BaseVertexLocation;
+    skullRitem->Bounds = skullRitem->Geo->DrawArgs["skull"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Opaque].push_back(skullRitem.get());
     mAllRitems.push_back(std::move(skullRitem));
@@ -1382,6 +1879,7 @@ void ShadowMapApp::BuildRenderItems()
     gridRitem->IndexCount = gridRitem->Geo->DrawArgs["grid"].IndexCount;
     gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
     gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+    gridRitem->Bounds = gridRitem->Geo->DrawArgs["grid"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Opaque].push_back(gridRitem.get());
     mAllRitems.push_back(std::move(gridRitem));
@@ -1410,6 +1908,7 @@ void ShadowMapApp::BuildRenderItems()
         leftCylRitem->IndexCount = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
         leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
         leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+        leftCylRitem->Bounds = leftCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
         XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
         XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
@@ -1420,6 +1919,7 @@ void ShadowMapApp::BuildRenderItems()
         rightCylRitem->IndexCount = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
         rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
         rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+        rightCylRitem->Bounds = rightCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
         XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
         leftSphereRitem->TexTransform = MathHelper::Identity4x4();
@@ -1430,6 +1930,7 @@ void ShadowMapApp::BuildRenderItems()
         leftSphereRitem->IndexCount = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
         leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
         leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+        leftSphereRitem->Bounds = leftSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
         XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
         rightSphereRitem->TexTransform = MathHelper::Identity4x4();
@@ -1440,6 +1941,7 @@ void ShadowMapApp::BuildRenderItems()
         rightSphereRitem->IndexCount = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
         rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
         rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+        rightSphereRitem->Bounds = rightSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
         mRitemLayer[(int)RenderLayer::Opaque].push_back(leftCylRitem.get());
         mRitemLayer[(int)RenderLayer::Opaque].push_back(rightCylRitem.get());
@@ -1453,6 +1955,34 @@ void ShadowMapApp::BuildRenderItems()
     }
 }
 
+void ShadowMapApp::BuildInstanceBatches()
+{
+    // 같은 지오메트리와 서브메쉬를 그리는 항목들은 한 번의 인스턴스 드로우로 그립니다.
+    // 메터리얼은 인스턴스마다 MaterialIndex로 읽기 때문에 키에 포함되지 않습니다.
+    mOpaqueBatcher.Clear();
+    for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
+    {
+        InstanceBatchKey key;
+        key.Geometry = ri->Geo;
+        key.IndexCount = ri->IndexCount;
+        key.StartIndexLocation = ri->StartIndexLocation;
+        key.BaseVertexLocation = ri->BaseVertexLocation;
+        key.PrimitiveTopology = (std::uint32_t)ri->PrimitiveType;
+
+        mOpaqueBatcher.Add(ri->ObjCBIndex, key);
+    }
+    mOpaqueBatcher.Build();
+
+    // 인스턴스 버퍼의 위치가 바뀌었기 때문에 모든 프레임 리소스를 다시 업데이트 합니다.
+    for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
+        ri->NumFramesDirty = gNumFrameResources;
+
+    std::wostringstream outs;
+    outs << L"Shadow Map Demo" << L"    " << mOpaqueBatcher.Batches().size() << L" opaque draws for "
+        << mRitemLayer[(int)RenderLayer::Opaque].size() << L" objects";
+    mMainWndCaption = outs.str();
+}
+
 void ShadowMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
 {
     UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
@@ -1476,6 +2006,30 @@ void ShadowMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std
     }
 }
 
+void ShadowMapApp::DrawInstanceBatches(ID3D12GraphicsCommandList* cmdList)
+{
+    auto instanceBuffer = mCurrFrameResource->InstanceBuffer->Resource();
+
+    for (const InstanceBatch& batch : mOpaqueBatcher.Batches())
+    {
+        auto geo = (MeshGeometry*)batch.Key.Geometry;
+
+        cmdList->IASetVertexBuffers(0, 1, &geo->VertexBufferView());
+        cmdList->IASetIndexBuffer(&geo->IndexBufferView());
+        cmdList->IASetPrimitiveTopology((D3D12_PRIMITIVE_TOPOLOGY)batch.Key.PrimitiveTopology);
+
+        // SV_InstanceID는 StartInstanceLocation을 포함하지 않기 때문에
+        // 배치의 첫 번째 인스턴스를 가리키도록 루트 SRV의 주소를 옮깁니다.
+        D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = instanceBuffer->GetGPUVirtualAddress() +
+            batch.FirstInstance * sizeof(InstanceData);
+
+        cmdList->SetGraphicsRootShaderResourceView(5, instanceAddress);
+
+        cmdList->DrawIndexedInstanced(batch.Key.IndexCount, batch.InstanceCount,
+                                      batch.Key.StartIndexLocation, batch.Key.BaseVertexLocation, 0);
+    }
+}
+
 void ShadowMapApp::DrawSceneToShadowMap()
 {
     mCommandList->RSSetViewports(1, &mShadowMap->Viewport());
@@ -1503,7 +2057,7 @@ void ShadowMapApp::DrawSceneToShadowMap()
 
     mCommandList->SetPipelineState(mPSOs["shadow_opaque"].Get());
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+    DrawInstanceBatches(mCommandList.Get());
 
     // 텍스쳐에서 읽기 위해 GENERIC_READ로 변경합니다.
     mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mShadowMap->Resource(),
@@ -433,6 +433,8 @@ void LandAndWavesApp::UpdateCamera(const GameTimer& gt)
 
 void LandAndWavesApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -483,6 +485,8 @@ void LandAndWavesApp::UpdateMainPassCB(const GameTimer& gt)
 
 void LandAndWavesApp::UpdateWaves(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     // 0.25초마다 랜덤 웨이브를 발생시킵니다.
     static float t_base = 0.0f;
     if ((mTimer.TotalTime() - t_base) >= 0.25f)
@@ -3,7 +3,7 @@
 //***************************************************************************************
 
 #include "Waves.h"
-#include <ppl.h>
+#include "Common/JobSystem.h"
 #include <algorithm>
 #include <vector>
 #include <cassert>
@@ -96,7 +96,7 @@ void Waves::Update(float dt)
     if (t >= mTimeStep)
     {
         // Only update interior points; we use zero boundary conditions.
-        concurrency::parallel_for(1, mNumRows - 1, [this](int i)
+        JobSystem::Default().ParallelFor(1, mNumRows - 1, [this](int i)
                                   //for(int i = 1; i < mNumRows-1; ++i)
                                   {
                                       for (int j = 1; j < mNumCols - 1; ++j)
@@ -130,7 +130,7 @@ void Waves::Update(float dt)
         //
         // Compute normals using finite difference scheme.
         //
-        concurrency::parallel_for(1, mNumRows - 1, [this](int i)
+        JobSystem::Default().ParallelFor(1, mNumRows - 1, [this](int i)
                                   //for(int i = 1; i < mNumRows - 1; ++i)
                                   {
                                       for (int j = 1; j < mNumCols - 1; ++j)
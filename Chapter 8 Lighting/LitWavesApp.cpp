@@ -455,6 +455,8 @@ void LitWavesApp::UpdateCamera(const GameTimer& gt)
 
 void LitWavesApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -477,6 +479,8 @@ void LitWavesApp::UpdateObjectCBs(const GameTimer& gt)
 
 void LitWavesApp::UpdateMaterialCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currentMaterialCB = mCurrFrameResource->MaterialCB.get();
     for (auto& e : mMaterials)
     {
@@ -534,6 +538,8 @@ void LitWavesApp::UpdateMainPassCB(const GameTimer& gt)
 
 void LitWavesApp::UpdateWaves(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     // 0.25초마다 랜덤 웨이브를 발생시킵니다.
     static float t_base = 0.0f;
     if ((mTimer.TotalTime() - t_base) >= 0.25f)
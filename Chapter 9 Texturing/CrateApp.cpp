@@ -427,6 +427,8 @@ void CrateApp::UpdateCamera(const GameTimer& gt)
 
 void CrateApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -449,6 +451,8 @@ void CrateApp::UpdateObjectCBs(const GameTimer& gt)
 
 void CrateApp::UpdateMaterialCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currentMaterialCB = mCurrFrameResource->MaterialCB.get();
     for (auto& e : mMaterials)
     {
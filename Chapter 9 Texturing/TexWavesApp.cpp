@@ -479,6 +479,8 @@ void TexWavesApp::UpdateCamera(const GameTimer& gt)
 
 void TexWavesApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -501,6 +503,8 @@ void TexWavesApp::UpdateObjectCBs(const GameTimer& gt)
 
 void TexWavesApp::UpdateMaterialCBs(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     auto currentMaterialCB = mCurrFrameResource->MaterialCB.get();
     for (auto& e : mMaterials)
     {
@@ -562,6 +566,8 @@ void TexWavesApp::UpdateMainPassCB(const GameTimer& gt)
 
 void TexWavesApp::UpdateWaves(const GameTimer& gt)
 {
+    PROFILE_FUNCTION();
+
     // 0.25초마다 랜덤 웨이브를 발생시킵니다.
     static float t_base = 0.0f;
     if ((mTimer.TotalTime() - t_base) >= 0.25f)
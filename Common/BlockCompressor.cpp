@@ -0,0 +1,1220 @@
+﻿//***************************************************************************************
+// BlockCompressor.cpp
+//***************************************************************************************
+
+#include "BlockCompressor.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace DirectX;
+
+// BC1 4색 모드에서 인덱스마다 두 번째 끝점이 차지하는 비율입니다.
+static const float gBC1FourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+static const float gBC1ThreeColorWeights[3] = { 0.0f, 1.0f, 0.5f };
+
+// BC7 2비트, 4비트 인덱스의 보간 가중치입니다 (64가 두 번째 끝점).
+static const int gBC7Weights2[4] = { 0, 21, 43, 64 };
+static const int gBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+//---------------------------------------------------------------------------------------
+// 끝점 맞추기
+//---------------------------------------------------------------------------------------
+
+static XMVECTOR ClampColor(FXMVECTOR v)
+{
+    return XMVectorClamp(v, XMVectorZero(), XMVectorReplicate(255.0f));
+}
+
+// 가장 큰 범위를 가진 채널과의 공분산 부호로 대각선 방향을 맞춘 바운딩 박스를 구합니다.
+static void FitBoundingBox(const XMVECTOR* points, int count, XMVECTOR& e0, XMVECTOR& e1)
+{
+    XMVECTOR mn = points[0];
+    XMVECTOR mx = points[0];
+    XMVECTOR mean = XMVectorZero();
+    for (int i = 0; i < count; ++i)
+    {
+        mn = XMVectorMin(mn, points[i]);
+        mx = XMVectorMax(mx, points[i]);
+        mean = XMVectorAdd(mean, points[i]);
+    }
+    mean = XMVectorScale(mean, 1.0f / count);
+
+    XMFLOAT4 range;
+    XMStoreFloat4(&range, XMVectorSubtract(mx, mn));
+    const float ranges[4] = { range.x, range.y, range.z, range.w };
+    const int major = (int)(std::max_element(ranges, ranges + 4) - ranges);
+
+    XMFLOAT4 cov(0.0f, 0.0f, 0.0f, 0.0f);
+    for (int i = 0; i < count; ++i)
+    {
+        XMVECTOR d = XMVectorSubtract(points[i], mean);
+        XMVECTOR m = XMVectorScale(d, XMVectorGetByIndex(d, major));
+        XMStoreFloat4(&cov, XMVectorAdd(XMLoadFloat4(&cov), m));
+    }
+
+    // 주 채널과 반대로 움직이는 채널은 끝점을 뒤집습니다.
+    XMVECTOR flip = XMVectorLess(XMLoadFloat4(&cov), XMVectorZero());
+    e0 = XMVectorSelect(mn, mx, flip);
+    e1 = XMVectorSelect(mx, mn, flip);
+
+    // 끝점을 조금 안쪽으로 당기면 양 끝 픽셀의 오차가 줄어듭니다.
+    XMVECTOR inset = XMVectorScale(XMVectorSubtract(e1, e0), 1.0f / 16.0f);
+    e0 = XMVectorAdd(e0, inset);
+    e1 = XMVectorSubtract(e1, inset);
+}
+
+// 공분산 행렬의 거듭제곱법으로 주성분 축을 구하고 그 축 위의 양 끝을 끝점으로 씁니다.
+static void FitPrincipalAxis(const XMVECTOR* points, int count, XMVECTOR& e0, XMVECTOR& e1)
+{
+    XMVECTOR mean = XMVectorZero();
+    for (int i = 0; i < count; ++i)
+        mean = XMVectorAdd(mean, points[i]);
+    mean = XMVectorScale(mean, 1.0f / count);
+
+    XMMATRIX cov;
+    cov.r[0] = cov.r[1] = cov.r[2] = cov.r[3] = XMVectorZero();
+    for (int i = 0; i < count; ++i)
+    {
+        XMVECTOR d = XMVectorSubtract(points[i], mean);
+        cov.r[0] = XMVectorAdd(cov.r[0], XMVectorScale(d, XMVectorGetX(d)));
+        cov.r[1] = XMVectorAdd(cov.r[1], XMVectorScale(d, XMVectorGetY(d)));
+        cov.r[2] = XMVectorAdd(cov.r[2], XMVectorScale(d, XMVectorGetZ(d)));
+        cov.r[3] = XMVectorAdd(cov.r[3], XMVectorScale(d, XMVectorGetW(d)));
+    }
+
+    // 분산이 가장 큰 행에서 시작하면 빨리 수렴합니다.
+    XMVECTOR axis = cov.r[0];
+    float maxVariance = -1.0f;
+    for (int r = 0; r < 4; ++r)
+    {
+        float variance = XMVectorGetByIndex(cov.r[r], r);
+        if (variance > maxVariance)
+        {
+            maxVariance = variance;
+            axis = cov.r[r];
+        }
+    }
+
+    if (maxVariance <= 0.0f)
+    {
+        e0 = e1 = mean;
+        return;
+    }
+
+    for (int iter = 0; iter < 8; ++iter)
+    {
+        axis = XMVector4Transform(axis, cov);
+
+        float length = XMVectorGetX(XMVector4Length(axis));
+        if (length < 1e-6f)
+        {
+            e0 = e1 = mean;
+            return;
+        }
+        axis = XMVectorScale(axis, 1.0f / length);
+    }
+
+    float minT = std::numeric_limits<float>::max();
+    float maxT = -std::numeric_limits<float>::max();
+    for (int i = 0; i < count; ++i)
+    {
+        float t = XMVectorGetX(XMVector4Dot(XMVectorSubtract(points[i], mean), axis));
+        minT = std::min<float>(minT, t);
+        maxT = std::max<float>(maxT, t);
+    }
+
+    e0 = ClampColor(XMVectorAdd(mean, XMVectorScale(axis, minT)));
+    e1 = ClampColor(XMVectorAdd(mean, XMVectorScale(axis, maxT)));
+}
+
+// 인덱스가 정해졌을 때 오차제곱합이 최소인 끝점을 구합니다.
+// weights[i]는 i번째 점에서 두 번째 끝점이 차지하는 비율입니다.
+static bool RefineEndpoints(const XMVECTOR* points, const float* weights, int count, XMVECTOR& e0, XMVECTOR& e1)
+{
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    XMVECTOR xa = XMVectorZero();
+    XMVECTOR xb = XMVectorZero();
+
+    for (int i = 0; i < count; ++i)
+    {
+        float b = weights[i];
+        float a = 1.0f - b;
+
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        xa = XMVectorAdd(xa, XMVectorScale(points[i], a));
+        xb = XMVectorAdd(xb, XMVectorScale(points[i], b));
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f)
+        return false;
+
+    float invDet = 1.0f / det;
+    e0 = ClampColor(XMVectorScale(XMVectorSubtract(XMVectorScale(xa, bb), XMVectorScale(xb, ab)), invDet));
+    e1 = ClampColor(XMVectorScale(XMVectorSubtract(XMVectorScale(xb, aa), XMVectorScale(xa, ab)), invDet));
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+// BC1 색 블록
+//---------------------------------------------------------------------------------------
+
+static std::uint16_t PackRgb565(FXMVECTOR color)
+{
+    XMFLOAT4 c;
+    XMStoreFloat4(&c, ClampColor(color));
+
+    std::uint16_t r = (std::uint16_t)(c.x * (31.0f / 255.0f) + 0.5f);
+    std::uint16_t g = (std::uint16_t)(c.y * (63.0f / 255.0f) + 0.5f);
+    std::uint16_t b = (std::uint16_t)(c.z * (31.0f / 255.0f) + 0.5f);
+
+    return (std::uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRgb565(std::uint16_t color, int rgb[3])
+{
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+static void BuildBC1Palette(std::uint16_t c0, std::uint16_t c1, bool fourColor, int palette[4][3])
+{
+    UnpackRgb565(c0, palette[0]);
+    UnpackRgb565(c1, palette[1]);
+
+    for (int ch = 0; ch < 3; ++ch)
+    {
+        if (fourColor)
+        {
+            palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+            palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+        }
+        else
+        {
+            palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+            palette[3][ch] = 0;
+        }
+    }
+}
+
+struct BC1Candidate
+{
+    std::uint16_t Color0 = 0;
+    std::uint16_t Color1 = 0;
+    std::uint32_t Indices = 0;
+    int Error = std::numeric_limits<int>::max();
+};
+
+// 끝점을 565로 양자화하고 모든 픽셀의 인덱스를 고릅니다.
+// threeColor이면 c0 <= c1인 3색 모드를 쓰고 투명한 픽셀은 인덱스 3을 받습니다.
+static BC1Candidate EvaluateBC1(const std::uint8_t pixels[16][4], FXMVECTOR e0, FXMVECTOR e1,
+                                bool threeColor, bool hasTransparent)
+{
+    BC1Candidate candidate;
+    candidate.Color0 = PackRgb565(e0);
+    candidate.Color1 = PackRgb565(e1);
+
+    if (threeColor ? candidate.Color0 > candidate.Color1 : candidate.Color0 < candidate.Color1)
+        std::swap(candidate.Color0, candidate.Color1);
+
+    int palette[4][3];
+    BuildBC1Palette(candidate.Color0, candidate.Color1, !threeColor, palette);
+
+    const int paletteCount = threeColor ? 3 : 4;
+
+    candidate.Error = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        if (hasTransparent && pixels[i][3] < 128)
+        {
+            candidate.Indices |= 3u << (2 * i);
+            continue;
+        }
+
+        int bestIndex = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int p = 0; p < paletteCount; ++p)
+        {
+            int dr = palette[p][0] - pixels[i][0];
+            int dg = palette[p][1] - pixels[i][1];
+            int db = palette[p][2] - pixels[i][2];
+            int error = dr * dr + dg * dg + db * db;
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+
+        candidate.Indices |= (std::uint32_t)bestIndex << (2 * i);
+        candidate.Error += bestError;
+    }
+
+    return candidate;
+}
+
+// allowThreeColor가 false이면 (BC3의 색 블록) 항상 4색 모드를 씁니다.
+static void EncodeBC1Color(const std::uint8_t pixels[16][4], CompressionQuality quality,
+                           bool allowThreeColor, std::uint8_t* block)
+{
+    XMVECTOR points[16];
+    int count = 0;
+    bool hasTransparent = false;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (allowThreeColor && pixels[i][3] < 128)
+        {
+            hasTransparent = true;
+            continue;
+        }
+
+        points[count++] = XMVectorSet(pixels[i][0], pixels[i][1], pixels[i][2], 0.0f);
+    }
+
+    BC1Candidate best;
+    if (count == 0)
+    {
+        // 모두 투명합니다. c0 == c1이면 3색 모드입니다.
+        best.Indices = 0xFFFFFFFF;
+    }
+    else
+    {
+        const bool threeColor = hasTransparent;
+
+        XMVECTOR e0, e1;
+        if (quality == CompressionQuality::Fast)
+            FitBoundingBox(points, count, e0, e1);
+        else
+            FitPrincipalAxis(points, count, e0, e1);
+
+        best = EvaluateBC1(pixels, e0, e1, threeColor, hasTransparent);
+
+        if (quality == CompressionQuality::High)
+        {
+            XMVECTOR b0, b1;
+            FitBoundingBox(points, count, b0, b1);
+            BC1Candidate boxCandidate = EvaluateBC1(pixels, b0, b1, threeColor, hasTransparent);
+            if (boxCandidate.Error < best.Error)
+                best = boxCandidate;
+
+            // 불투명한 블록도 3색 모드가 더 나을 때가 있습니다 (중간색 하나가 정확한 경우).
+            if (!threeColor && allowThreeColor)
+            {
+                BC1Candidate threeCandidate = EvaluateBC1(pixels, e0, e1, true, false);
+                if (threeCandidate.Error < best.Error)
+                    best = threeCandidate;
+            }
+
+            // 현재 인덱스로 끝점을 다시 맞추는 과정을 반복합니다.
+            for (int iter = 0; iter < 2 && best.Error > 0; ++iter)
+            {
+                const bool bestThreeColor = allowThreeColor && best.Color0 <= best.Color1;
+
+                float weights[16];
+                int n = 0;
+                for (int i = 0; i < 16; ++i)
+                {
+                    int index = (best.Indices >> (2 * i)) & 3;
+                    if (hasTransparent && pixels[i][3] < 128)
+                        continue;
+                    weights[n++] = bestThreeColor ? gBC1ThreeColorWeights[index] : gBC1FourColorWeights[index];
+                }
+
+                int c0[3], c1[3];
+                UnpackRgb565(best.Color0, c0);
+                UnpackRgb565(best.Color1, c1);
+                XMVECTOR r0 = XMVectorSet((float)c0[0], (float)c0[1], (float)c0[2], 0.0f);
+                XMVECTOR r1 = XMVectorSet((float)c1[0], (float)c1[1], (float)c1[2], 0.0f);
+                if (!RefineEndpoints(points, weights, n, r0, r1))
+                    break;
+
+                BC1Candidate refined = EvaluateBC1(pixels, r0, r1, bestThreeColor, hasTransparent);
+                if (refined.Error >= best.Error)
+                    break;
+
+                best = refined;
+            }
+        }
+
+        // 끝점이 같으면 모든 픽셀이 첫 번째 끝점을 사용합니다.
+        if (best.Color0 == best.Color1 && !hasTransparent)
+            best.Indices = 0;
+    }
+
+    block[0] = (std::uint8_t)(best.Color0 & 0xFF);
+    block[1] = (std::uint8_t)(best.Color0 >> 8);
+    block[2] = (std::uint8_t)(best.Color1 & 0xFF);
+    block[3] = (std::uint8_t)(best.Color1 >> 8);
+    for (int i = 0; i < 4; ++i)
+        block[4 + i] = (std::uint8_t)(best.Indices >> (8 * i));
+}
+
+static void DecodeBC1Color(const std::uint8_t* block, bool forceFourColor, std::uint8_t pixels[16][4])
+{
+    std::uint16_t c0 = (std::uint16_t)(block[0] | (block[1] << 8));
+    std::uint16_t c1 = (std::uint16_t)(block[2] | (block[3] << 8));
+    std::uint32_t indices = (std::uint32_t)block[4] | ((std::uint32_t)block[5] << 8) |
+                            ((std::uint32_t)block[6] << 16) | ((std::uint32_t)block[7] << 24);
+
+    const bool fourColor = forceFourColor || c0 > c1;
+
+    int palette[4][3];
+    BuildBC1Palette(c0, c1, fourColor, palette);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        int index = (indices >> (2 * i)) & 3;
+        pixels[i][0] = (std::uint8_t)palette[index][0];
+        pixels[i][1] = (std::uint8_t)palette[index][1];
+        pixels[i][2] = (std::uint8_t)palette[index][2];
+        pixels[i][3] = (!fourColor && index == 3) ? 0 : 255;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+// BC4 단일 채널 블록 (BC3 알파, BC5의 각 채널)
+//---------------------------------------------------------------------------------------
+
+static void BuildBC4Palette(int a0, int a1, int palette[8])
+{
+    palette[0] = a0;
+    palette[1] = a1;
+
+    if (a0 > a1)
+    {
+        for (int i = 1; i <= 6; ++i)
+            palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+    }
+    else
+    {
+        for (int i = 1; i <= 4; ++i)
+            palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static int EvaluateBC4(const std::uint8_t values[16], int a0, int a1, std::uint64_t& indices)
+{
+    int palette[8];
+    BuildBC4Palette(a0, a1, palette);
+
+    indices = 0;
+    int totalError = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestIndex = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int p = 0; p < 8; ++p)
+        {
+            int d = palette[p] - values[i];
+            if (d * d < bestError)
+            {
+                bestError = d * d;
+                bestIndex = p;
+            }
+        }
+
+        indices |= (std::uint64_t)bestIndex << (3 * i);
+        totalError += bestError;
+    }
+
+    return totalError;
+}
+
+static void EncodeBC4Block(const std::uint8_t values[16], CompressionQuality quality, std::uint8_t* block)
+{
+    int mn = 255, mx = 0;
+    int innerMin = 255, innerMax = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        mn = std::min<int>(mn, values[i]);
+        mx = std::max<int>(mx, values[i]);
+
+        if (values[i] != 0 && values[i] != 255)
+        {
+            innerMin = std::min<int>(innerMin, values[i]);
+            innerMax = std::max<int>(innerMax, values[i]);
+        }
+    }
+
+    // 8값 모드는 a0 > a1, 6값 모드는 a0 <= a1이고 0과 255를 따로 표현합니다.
+    int bestA0 = mx;
+    int bestA1 = mn;
+    std::uint64_t bestIndices = 0;
+    int bestError = EvaluateBC4(values, bestA0, bestA1, bestIndices);
+
+    auto tryEndpoints = [&](int a0, int a1)
+    {
+        std::uint64_t indices = 0;
+        int error = EvaluateBC4(values, a0, a1, indices);
+        if (error < bestError)
+        {
+            bestError = error;
+            bestA0 = a0;
+            bestA1 = a1;
+            bestIndices = indices;
+        }
+    };
+
+    if (quality != CompressionQuality::Fast && bestError > 0 && innerMin <= innerMax && (mn == 0 || mx == 255))
+        tryEndpoints(innerMin, innerMax);
+
+    if (quality == CompressionQuality::High && bestError > 0)
+    {
+        for (int a0 = mx; a0 >= std::max<int>(mn + 1, mx - 3); --a0)
+        {
+            for (int a1 = mn; a1 <= std::min<int>(a0 - 1, mn + 3); ++a1)
+                tryEndpoints(a0, a1);
+        }
+    }
+
+    block[0] = (std::uint8_t)bestA0;
+    block[1] = (std::uint8_t)bestA1;
+    for (int i = 0; i < 6; ++i)
+        block[2 + i] = (std::uint8_t)(bestIndices >> (8 * i));
+}
+
+static void DecodeBC4Block(const std::uint8_t* block, std::uint8_t values[16])
+{
+    int palette[8];
+    BuildBC4Palette(block[0], block[1], palette);
+
+    std::uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i)
+        indices |= (std::uint64_t)block[2 + i] << (8 * i);
+
+    for (int i = 0; i < 16; ++i)
+        values[i] = (std::uint8_t)palette[(indices >> (3 * i)) & 7];
+}
+
+//---------------------------------------------------------------------------------------
+// BC7 모드 5, 6 블록
+//---------------------------------------------------------------------------------------
+
+struct BitWriter
+{
+    std::uint8_t* Data;
+    int Position;
+
+    void Write(std::uint32_t value, int bitCount)
+    {
+        for (int b = 0; b < bitCount; ++b, ++Position)
+        {
+            if ((value >> b) & 1)
+                Data[Position >> 3] |= (std::uint8_t)(1 << (Position & 7));
+        }
+    }
+};
+
+struct BitReader
+{
+    const std::uint8_t* Data;
+    int Position;
+
+    std::uint32_t Read(int bitCount)
+    {
+        std::uint32_t value = 0;
+        for (int b = 0; b < bitCount; ++b, ++Position)
+            value |= (std::uint32_t)((Data[Position >> 3] >> (Position & 7)) & 1) << b;
+        return value;
+    }
+};
+
+struct BC7Endpoint
+{
+    int Quantized[4]; // 7비트
+    int PBit;
+};
+
+// 7비트 값과 공유 p비트로 양자화합니다. 두 p비트 중 오차가 작은 쪽을 고릅니다.
+static BC7Endpoint QuantizeBC7Endpoint(FXMVECTOR endpoint)
+{
+    XMFLOAT4 e;
+    XMStoreFloat4(&e, ClampColor(endpoint));
+    const float channels[4] = { e.x, e.y, e.z, e.w };
+
+    BC7Endpoint best = {};
+    float bestError = std::numeric_limits<float>::max();
+    for (int p = 0; p < 2; ++p)
+    {
+        BC7Endpoint q;
+        q.PBit = p;
+
+        float error = 0.0f;
+        for (int ch = 0; ch < 4; ++ch)
+        {
+            int c = (int)std::floor((channels[ch] - p) * 0.5f + 0.5f);
+            q.Quantized[ch] = std::min<int>(std::max<int>(c, 0), 127);
+
+            float d = (float)((q.Quantized[ch] << 1) | p) - channels[ch];
+            error += d * d;
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            best = q;
+        }
+    }
+
+    return best;
+}
+
+static void BuildBC7Palette(const BC7Endpoint& q0, const BC7Endpoint& q1, int palette[16][4])
+{
+    for (int ch = 0; ch < 4; ++ch)
+    {
+        int d0 = (q0.Quantized[ch] << 1) | q0.PBit;
+        int d1 = (q1.Quantized[ch] << 1) | q1.PBit;
+        for (int i = 0; i < 16; ++i)
+            palette[i][ch] = ((64 - gBC7Weights4[i]) * d0 + gBC7Weights4[i] * d1 + 32) >> 6;
+    }
+}
+
+struct BC7Candidate
+{
+    BC7Endpoint Endpoint0;
+    BC7Endpoint Endpoint1;
+    int Indices[16];
+    int Error = std::numeric_limits<int>::max();
+};
+
+static BC7Candidate EvaluateBC7(const std::uint8_t pixels[16][4], FXMVECTOR e0, FXMVECTOR e1)
+{
+    BC7Candidate candidate;
+    candidate.Endpoint0 = QuantizeBC7Endpoint(e0);
+    candidate.Endpoint1 = QuantizeBC7Endpoint(e1);
+
+    int palette[16][4];
+    BuildBC7Palette(candidate.Endpoint0, candidate.Endpoint1, palette);
+
+    candidate.Error = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestIndex = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int p = 0; p < 16; ++p)
+        {
+            int error = 0;
+            for (int ch = 0; ch < 4; ++ch)
+            {
+                int d = palette[p][ch] - pixels[i][ch];
+                error += d * d;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+
+        candidate.Indices[i] = bestIndex;
+        candidate.Error += bestError;
+    }
+
+    return candidate;
+}
+
+static BC7Candidate FitBC7Mode6(const std::uint8_t pixels[16][4], CompressionQuality quality)
+{
+    XMVECTOR points[16];
+    for (int i = 0; i < 16; ++i)
+        points[i] = XMVectorSet(pixels[i][0], pixels[i][1], pixels[i][2], pixels[i][3]);
+
+    XMVECTOR e0, e1;
+    if (quality == CompressionQuality::Fast)
+        FitBoundingBox(points, 16, e0, e1);
+    else
+        FitPrincipalAxis(points, 16, e0, e1);
+
+    BC7Candidate best = EvaluateBC7(pixels, e0, e1);
+
+    if (quality == CompressionQuality::High)
+    {
+        XMVECTOR b0, b1;
+        FitBoundingBox(points, 16, b0, b1);
+        BC7Candidate boxCandidate = EvaluateBC7(pixels, b0, b1);
+        if (boxCandidate.Error < best.Error)
+            best = boxCandidate;
+    }
+
+    const int refineCount = quality == CompressionQuality::High ? 3 : (quality == CompressionQuality::Normal ? 1 : 0);
+    for (int iter = 0; iter < refineCount && best.Error > 0; ++iter)
+    {
+        float weights[16];
+        for (int i = 0; i < 16; ++i)
+            weights[i] = gBC7Weights4[best.Indices[i]] / 64.0f;
+
+        XMVECTOR r0, r1;
+        if (!RefineEndpoints(points, weights, 16, r0, r1))
+            break;
+
+        BC7Candidate refined = EvaluateBC7(pixels, r0, r1);
+        if (refined.Error >= best.Error)
+            break;
+
+        best = refined;
+    }
+
+    return best;
+}
+
+static void WriteBC7Mode6(BC7Candidate& candidate, std::uint8_t* block)
+{
+    // 첫 번째 픽셀의 인덱스(앵커)는 최상위 비트가 0이어야 하므로 필요하면 끝점을 뒤집습니다.
+    if (candidate.Indices[0] >= 8)
+    {
+        std::swap(candidate.Endpoint0, candidate.Endpoint1);
+        for (int i = 0; i < 16; ++i)
+            candidate.Indices[i] = 15 - candidate.Indices[i];
+    }
+
+    std::fill(block, block + 16, (std::uint8_t)0);
+
+    BitWriter writer = { block, 0 };
+    writer.Write(1 << 6, 7);
+    for (int ch = 0; ch < 4; ++ch)
+    {
+        writer.Write(candidate.Endpoint0.Quantized[ch], 7);
+        writer.Write(candidate.Endpoint1.Quantized[ch], 7);
+    }
+    writer.Write(candidate.Endpoint0.PBit, 1);
+    writer.Write(candidate.Endpoint1.PBit, 1);
+
+    writer.Write(candidate.Indices[0], 3);
+    for (int i = 1; i < 16; ++i)
+        writer.Write(candidate.Indices[i], 4);
+}
+
+// 모드 5는 색(7비트 끝점)과 알파(8비트 끝점)를 각자의 2비트 인덱스로 따로 보간합니다.
+// 컷아웃처럼 알파와 색이 서로 관계없는 블록은 모드 6보다 오차가 훨씬 작습니다.
+struct BC7Mode5Candidate
+{
+    int Color0[3];
+    int Color1[3];
+    int Alpha0 = 0;
+    int Alpha1 = 0;
+    int ColorIndices[16];
+    int AlphaIndices[16];
+    int Error = std::numeric_limits<int>::max();
+};
+
+static int ExpandBC7Color7(int c)
+{
+    return (c << 1) | (c >> 6);
+}
+
+static int EvaluateBC7Mode5Color(const std::uint8_t pixels[16][4], FXMVECTOR e0, FXMVECTOR e1,
+                                 BC7Mode5Candidate& candidate)
+{
+    XMFLOAT4 f0, f1;
+    XMStoreFloat4(&f0, ClampColor(e0));
+    XMStoreFloat4(&f1, ClampColor(e1));
+    const float c0[3] = { f0.x, f0.y, f0.z };
+    const float c1[3] = { f1.x, f1.y, f1.z };
+
+    int palette[4][3];
+    for (int ch = 0; ch < 3; ++ch)
+    {
+        candidate.Color0[ch] = (int)(c0[ch] * (127.0f / 255.0f) + 0.5f);
+        candidate.Color1[ch] = (int)(c1[ch] * (127.0f / 255.0f) + 0.5f);
+
+        int d0 = ExpandBC7Color7(candidate.Color0[ch]);
+        int d1 = ExpandBC7Color7(candidate.Color1[ch]);
+        for (int i = 0; i < 4; ++i)
+            palette[i][ch] = ((64 - gBC7Weights2[i]) * d0 + gBC7Weights2[i] * d1 + 32) >> 6;
+    }
+
+    int totalError = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestIndex = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int p = 0; p < 4; ++p)
+        {
+            int error = 0;
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                int d = palette[p][ch] - pixels[i][ch];
+                error += d * d;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+
+        candidate.ColorIndices[i] = bestIndex;
+        totalError += bestError;
+    }
+
+    return totalError;
+}
+
+static BC7Mode5Candidate FitBC7Mode5(const std::uint8_t pixels[16][4], CompressionQuality quality)
+{
+    XMVECTOR points[16];
+    for (int i = 0; i < 16; ++i)
+        points[i] = XMVectorSet(pixels[i][0], pixels[i][1], pixels[i][2], 0.0f);
+
+    XMVECTOR e0, e1;
+    if (quality == CompressionQuality::Fast)
+        FitBoundingBox(points, 16, e0, e1);
+    else
+        FitPrincipalAxis(points, 16, e0, e1);
+
+    BC7Mode5Candidate best;
+    int colorError = EvaluateBC7Mode5Color(pixels, e0, e1, best);
+
+    const int refineCount = quality == CompressionQuality::High ? 3 : (quality == CompressionQuality::Normal ? 1 : 0);
+    for (int iter = 0; iter < refineCount && colorError > 0; ++iter)
+    {
+        float weights[16];
+        for (int i = 0; i < 16; ++i)
+            weights[i] = gBC7Weights2[best.ColorIndices[i]] / 64.0f;
+
+        XMVECTOR r0, r1;
+        if (!RefineEndpoints(points, weights, 16, r0, r1))
+            break;
+
+        BC7Mode5Candidate refined = best;
+        int refinedError = EvaluateBC7Mode5Color(pixels, r0, r1, refined);
+        if (refinedError >= colorError)
+            break;
+
+        best = refined;
+        colorError = refinedError;
+    }
+
+    // 알파는 최솟값과 최댓값을 그대로 8비트 끝점으로 씁니다.
+    int mn = 255, mx = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        mn = std::min<int>(mn, pixels[i][3]);
+        mx = std::max<int>(mx, pixels[i][3]);
+    }
+    best.Alpha0 = mn;
+    best.Alpha1 = mx;
+
+    int alphaError = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestIndex = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int p = 0; p < 4; ++p)
+        {
+            int a = ((64 - gBC7Weights2[p]) * mn + gBC7Weights2[p] * mx + 32) >> 6;
+            int d = a - pixels[i][3];
+            if (d * d < bestError)
+            {
+                bestError = d * d;
+                bestIndex = p;
+            }
+        }
+
+        best.AlphaIndices[i] = bestIndex;
+        alphaError += bestError;
+    }
+
+    best.Error = colorError + alphaError;
+
+    return best;
+}
+
+static void WriteBC7Mode5(BC7Mode5Candidate& candidate, std::uint8_t* block)
+{
+    // 색과 알파 인덱스 모두 첫 번째 픽셀이 앵커입니다.
+    if (candidate.ColorIndices[0] >= 2)
+    {
+        std::swap(candidate.Color0, candidate.Color1);
+        for (int i = 0; i < 16; ++i)
+            candidate.ColorIndices[i] = 3 - candidate.ColorIndices[i];
+    }
+
+    if (candidate.AlphaIndices[0] >= 2)
+    {
+        std::swap(candidate.Alpha0, candidate.Alpha1);
+        for (int i = 0; i < 16; ++i)
+            candidate.AlphaIndices[i] = 3 - candidate.AlphaIndices[i];
+    }
+
+    std::fill(block, block + 16, (std::uint8_t)0);
+
+    BitWriter writer = { block, 0 };
+    writer.Write(1 << 5, 6);
+    writer.Write(0, 2); // 채널 회전 없음
+    for (int ch = 0; ch < 3; ++ch)
+    {
+        writer.Write(candidate.Color0[ch], 7);
+        writer.Write(candidate.Color1[ch], 7);
+    }
+    writer.Write(candidate.Alpha0, 8);
+    writer.Write(candidate.Alpha1, 8);
+
+    writer.Write(candidate.ColorIndices[0], 1);
+    for (int i = 1; i < 16; ++i)
+        writer.Write(candidate.ColorIndices[i], 2);
+
+    writer.Write(candidate.AlphaIndices[0], 1);
+    for (int i = 1; i < 16; ++i)
+        writer.Write(candidate.AlphaIndices[i], 2);
+}
+
+static void EncodeBC7(const std::uint8_t pixels[16][4], CompressionQuality quality, std::uint8_t* block)
+{
+    BC7Candidate mode6 = FitBC7Mode6(pixels, quality);
+
+    bool alphaVaries = false;
+    for (int i = 1; i < 16; ++i)
+        alphaVaries |= pixels[i][3] != pixels[0][3];
+
+    // 빠른 설정에서는 알파가 변하는 블록만 모드 5를 시도합니다.
+    if (mode6.Error > 0 && (alphaVaries || quality != CompressionQuality::Fast))
+    {
+        BC7Mode5Candidate mode5 = FitBC7Mode5(pixels, quality);
+        if (mode5.Error < mode6.Error)
+        {
+            WriteBC7Mode5(mode5, block);
+            return;
+        }
+    }
+
+    WriteBC7Mode6(mode6, block);
+}
+
+static bool DecodeBC7Block(const std::uint8_t* block, std::uint8_t pixels[16][4])
+{
+    if ((block[0] & 0x7F) == 0x40)
+    {
+        BitReader reader = { block, 7 };
+
+        BC7Endpoint q0, q1;
+        for (int ch = 0; ch < 4; ++ch)
+        {
+            q0.Quantized[ch] = (int)reader.Read(7);
+            q1.Quantized[ch] = (int)reader.Read(7);
+        }
+        q0.PBit = (int)reader.Read(1);
+        q1.PBit = (int)reader.Read(1);
+
+        int palette[16][4];
+        BuildBC7Palette(q0, q1, palette);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int index = (int)reader.Read(i == 0 ? 3 : 4);
+            for (int ch = 0; ch < 4; ++ch)
+                pixels[i][ch] = (std::uint8_t)palette[index][ch];
+        }
+
+        return true;
+    }
+
+    if ((block[0] & 0x3F) == 0x20)
+    {
+        BitReader reader = { block, 6 };
+        int rotation = (int)reader.Read(2);
+
+        int d0[4], d1[4];
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            d0[ch] = ExpandBC7Color7((int)reader.Read(7));
+            d1[ch] = ExpandBC7Color7((int)reader.Read(7));
+        }
+        d0[3] = (int)reader.Read(8);
+        d1[3] = (int)reader.Read(8);
+
+        int colorIndices[16];
+        for (int i = 0; i < 16; ++i)
+            colorIndices[i] = (int)reader.Read(i == 0 ? 1 : 2);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int alphaIndex = (int)reader.Read(i == 0 ? 1 : 2);
+            for (int ch = 0; ch < 4; ++ch)
+            {
+                int w = gBC7Weights2[ch < 3 ? colorIndices[i] : alphaIndex];
+                pixels[i][ch] = (std::uint8_t)(((64 - w) * d0[ch] + w * d1[ch] + 32) >> 6);
+            }
+
+            // 회전은 알파와 색 채널 하나를 바꿉니다.
+            if (rotation != 0)
+                std::swap(pixels[i][3], pixels[i][rotation - 1]);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------------------------
+// BlockCompressor
+//---------------------------------------------------------------------------------------
+
+BlockCompressor::BlockCompressor(BlockFormat format, CompressionQuality quality, bool srgb)
+    : mFormat(format), mQuality(quality), mSrgb(srgb)
+{
+}
+
+BlockFormat BlockCompressor::Format() const
+{
+    return mFormat;
+}
+
+CompressionQuality BlockCompressor::Quality() const
+{
+    return mQuality;
+}
+
+DXGI_FORMAT BlockCompressor::GetDxgiFormat() const
+{
+    switch (mFormat)
+    {
+    case BlockFormat::BC1:
+        return mSrgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+    case BlockFormat::BC3:
+        return mSrgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+    case BlockFormat::BC5:
+        return DXGI_FORMAT_BC5_UNORM;
+    case BlockFormat::BC7:
+        return mSrgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+    }
+
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+void BlockCompressor::Compress(const RgbaImage& image, CompressedImage& compressed) const
+{
+    PROFILE_FUNCTION();
+
+    const std::uint32_t blockBytes = GetBlockBytes(GetDxgiFormat());
+    const std::uint32_t blocksWide = std::max<std::uint32_t>(1, (image.Width + 3) / 4);
+    const std::uint32_t blocksHigh = std::max<std::uint32_t>(1, (image.Height + 3) / 4);
+
+    compressed.Format = GetDxgiFormat();
+    compressed.Width = image.Width;
+    compressed.Height = image.Height;
+    compressed.RowPitch = blocksWide * blockBytes;
+    compressed.Blocks.assign((size_t)compressed.RowPitch * blocksHigh, 0);
+
+    if (image.Width == 0 || image.Height == 0)
+    {
+        compressed.Blocks.clear();
+        return;
+    }
+
+    // 블록들은 서로 독립적이므로 블록 행 단위로 병렬 처리합니다.
+    JobSystem::Default().ParallelFor(0, (int)blocksHigh, [&](int by)
+    {
+        std::uint8_t pixels[16][4];
+        for (std::uint32_t bx = 0; bx < blocksWide; ++bx)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                const std::uint8_t* src = image.GetClampedPixel(bx * 4 + (i & 3), by * 4 + (i >> 2));
+                std::copy(src, src + 4, pixels[i]);
+            }
+
+            CompressBlock(pixels, &compressed.Blocks[(size_t)by * compressed.RowPitch + bx * blockBytes]);
+        }
+    });
+}
+
+void BlockCompressor::CompressBlock(const std::uint8_t pixels[16][4], std::uint8_t* block) const
+{
+    std::uint8_t channel[16];
+
+    switch (mFormat)
+    {
+    case BlockFormat::BC1:
+        EncodeBC1Color(pixels, mQuality, true, block);
+        break;
+
+    case BlockFormat::BC3:
+        for (int i = 0; i < 16; ++i)
+            channel[i] = pixels[i][3];
+        EncodeBC4Block(channel, mQuality, block);
+        EncodeBC1Color(pixels, mQuality, false, block + 8);
+        break;
+
+    case BlockFormat::BC5:
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int i = 0; i < 16; ++i)
+                channel[i] = pixels[i][ch];
+            EncodeBC4Block(channel, mQuality, block + 8 * ch);
+        }
+        break;
+
+    case BlockFormat::BC7:
+        EncodeBC7(pixels, mQuality, block);
+        break;
+    }
+}
+
+bool BlockCompressor::Decompress(const CompressedImage& compressed, RgbaImage& image)
+{
+    const std::uint32_t blockBytes = GetBlockBytes(compressed.Format);
+    if (blockBytes == 0)
+        return false;
+
+    image.Resize(compressed.Width, compressed.Height);
+
+    const std::uint32_t blocksWide = (compressed.Width + 3) / 4;
+    const std::uint32_t blocksHigh = (compressed.Height + 3) / 4;
+
+    for (std::uint32_t by = 0; by < blocksHigh; ++by)
+    {
+        for (std::uint32_t bx = 0; bx < blocksWide; ++bx)
+        {
+            const std::uint8_t* block = &compressed.Blocks[(size_t)by * compressed.RowPitch + bx * blockBytes];
+
+            std::uint8_t pixels[16][4];
+            std::uint8_t channel[16];
+
+            switch (compressed.Format)
+            {
+            case DXGI_FORMAT_BC1_UNORM:
+            case DXGI_FORMAT_BC1_UNORM_SRGB:
+                DecodeBC1Color(block, false, pixels);
+                break;
+
+            case DXGI_FORMAT_BC2_UNORM:
+            case DXGI_FORMAT_BC2_UNORM_SRGB:
+                // BC2는 4비트 알파를 그대로 저장합니다.
+                DecodeBC1Color(block + 8, true, pixels);
+                for (int i = 0; i < 16; ++i)
+                    pixels[i][3] = (std::uint8_t)(((block[i / 2] >> (4 * (i & 1))) & 0xF) * 17);
+                break;
+
+            case DXGI_FORMAT_BC3_UNORM:
+            case DXGI_FORMAT_BC3_UNORM_SRGB:
+                DecodeBC1Color(block + 8, true, pixels);
+                DecodeBC4Block(block, channel);
+                for (int i = 0; i < 16; ++i)
+                    pixels[i][3] = channel[i];
+                break;
+
+            case DXGI_FORMAT_BC5_UNORM:
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    DecodeBC4Block(block + 8 * ch, channel);
+                    for (int i = 0; i < 16; ++i)
+                        pixels[i][ch] = channel[i];
+                }
+                for (int i = 0; i < 16; ++i)
+                {
+                    pixels[i][2] = 0;
+                    pixels[i][3] = 255;
+                }
+                break;
+
+            case DXGI_FORMAT_BC7_UNORM:
+            case DXGI_FORMAT_BC7_UNORM_SRGB:
+                if (!DecodeBC7Block(block, pixels))
+                    return false;
+                break;
+
+            default:
+                return false;
+            }
+
+            for (int i = 0; i < 16; ++i)
+            {
+                std::uint32_t x = bx * 4 + (i & 3);
+                std::uint32_t y = by * 4 + (i >> 2);
+                if (x < image.Width && y < image.Height)
+                    std::copy(pixels[i], pixels[i] + 4, image.GetPixel(x, y));
+            }
+        }
+    }
+
+    return true;
+}
+
+double BlockCompressor::ComputePsnr(const RgbaImage& original, const CompressedImage& compressed) const
+{
+    RgbaImage decoded;
+    if (!Decompress(compressed, decoded) || decoded.Width != original.Width || decoded.Height != original.Height)
+        return 0.0;
+
+    double squaredError = 0.0;
+    size_t sampleCount = 0;
+
+    for (size_t i = 0; i < original.Pixels.size(); i += 4)
+    {
+        const std::uint8_t* a = &original.Pixels[i];
+        const std::uint8_t* b = &decoded.Pixels[i];
+
+        int channelCount = 4;
+        if (mFormat == BlockFormat::BC5)
+        {
+            channelCount = 2;
+        }
+        else if (mFormat == BlockFormat::BC1)
+        {
+            // BC1의 알파는 1비트이므로 알파 테스트 결과만 비교하고 투명한 픽셀의 색은 무시합니다.
+            int alpha = a[3] < 128 ? 0 : 255;
+            squaredError += (double)(alpha - b[3]) * (alpha - b[3]);
+            sampleCount++;
+
+            channelCount = alpha == 0 ? 0 : 3;
+        }
+
+        for (int ch = 0; ch < channelCount; ++ch)
+        {
+            double d = (double)a[ch] - b[ch];
+            squaredError += d * d;
+        }
+        sampleCount += channelCount;
+    }
+
+    if (sampleCount == 0 || squaredError == 0.0)
+        return std::numeric_limits<double>::infinity();
+
+    double mse = squaredError / sampleCount;
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+std::uint32_t BlockCompressor::GetBlockBytes(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_UNORM:
+        return 8;
+
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return 16;
+
+    default:
+        return 0;
+    }
+}
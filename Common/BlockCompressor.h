@@ -0,0 +1,75 @@
+﻿//***************************************************************************************
+// BlockCompressor.h
+//
+// CPU encoder that turns RGBA8 images into BC1, BC3, BC5 or BC7 blocks so raw source
+// images (such as the tree*.bmp sprites) can be shipped as compressed DDS files at
+// 1/4 to 1/8 of their size.  Block rows are encoded in parallel, the endpoint fits use
+// DirectXMath vectors, and the quality preset trades encode time for error.
+//
+// BC7 output uses modes 6 and 5 only: mode 6 (one RGBA subset, 4-bit indices) for most
+// blocks and mode 5 (separate color and alpha indices) where alpha does not follow the
+// color, such as cutouts.  The decoder understands the blocks it writes plus BC2.
+//***************************************************************************************
+
+#pragma once
+
+#include "RgbaImage.h"
+#include <dxgiformat.h>
+#include <cstdint>
+#include <vector>
+
+enum class BlockFormat
+{
+    BC1, // RGB + 1비트 알파, 블록당 8바이트
+    BC3, // RGBA, 블록당 16바이트
+    BC5, // RG (노멀 맵), 블록당 16바이트
+    BC7  // RGBA 고품질, 블록당 16바이트
+};
+
+enum class CompressionQuality
+{
+    Fast,   // 바운딩 박스로 끝점을 고릅니다.
+    Normal, // 주성분 축으로 끝점을 고릅니다.
+    High    // 주성분 축에서 시작해서 최소제곱으로 끝점을 다듬고 다른 모드도 시도합니다.
+};
+
+// 압축된 밉 하나입니다. 블록 행 사이에 여백이 없습니다.
+struct CompressedImage
+{
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+    std::uint32_t Width = 0;
+    std::uint32_t Height = 0;
+    std::uint32_t RowPitch = 0;
+
+    std::vector<std::uint8_t> Blocks;
+};
+
+class BlockCompressor
+{
+public:
+    explicit BlockCompressor(BlockFormat format, CompressionQuality quality = CompressionQuality::Normal, bool srgb = false);
+
+    BlockFormat Format() const;
+    CompressionQuality Quality() const;
+    DXGI_FORMAT GetDxgiFormat() const;
+
+    // 4x4 블록 단위로 압축합니다. 크기가 4의 배수가 아니면 가장자리 픽셀을 반복합니다.
+    void Compress(const RgbaImage& image, CompressedImage& compressed) const;
+
+    // 압축된 이미지를 풀어서 원본과 비교한 PSNR(dB)입니다. BC1은 RGB와 알파 테스트 결과,
+    // BC5는 RG만 비교합니다. 오차가 없으면 무한대를 반환합니다.
+    double ComputePsnr(const RgbaImage& original, const CompressedImage& compressed) const;
+
+    // 이 인코더가 만든 블록(과 BC2 블록)을 RGBA8로 풉니다.
+    static bool Decompress(const CompressedImage& compressed, RgbaImage& image);
+
+    static std::uint32_t GetBlockBytes(DXGI_FORMAT format);
+
+private:
+    void CompressBlock(const std::uint8_t pixels[16][4], std::uint8_t* block) const;
+
+private:
+    BlockFormat mFormat = BlockFormat::BC1;
+    CompressionQuality mQuality = CompressionQuality::Normal;
+    bool mSrgb = false;
+};
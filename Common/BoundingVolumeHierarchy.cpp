@@ -0,0 +1,717 @@
+﻿//***************************************************************************************
+// BoundingVolumeHierarchy.cpp
+//***************************************************************************************
+
+#include "BoundingVolumeHierarchy.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+// SAH를 평가할 때 축마다 사용하는 구간 수입니다.
+static const int gBinCount = 16;
+
+static const std::uint32_t gAllPlanes = 0x3F;
+
+// 레이 순회 스택의 고정 크기입니다. 더 깊은 트리는 힙에 넘깁니다.
+static const std::uint32_t gRayStackSize = 64;
+
+static float HalfSurfaceArea(const XMFLOAT3& mn, const XMFLOAT3& mx)
+{
+    const float dx = mx.x - mn.x;
+    const float dy = mx.y - mn.y;
+    const float dz = mx.z - mn.z;
+
+    return dx * dy + dy * dz + dz * dx;
+}
+
+static void GrowBounds(XMFLOAT3& mn, XMFLOAT3& mx, const XMFLOAT3& pmin, const XMFLOAT3& pmax)
+{
+    mn.x = std::min<float>(mn.x, pmin.x);
+    mn.y = std::min<float>(mn.y, pmin.y);
+    mn.z = std::min<float>(mn.z, pmin.z);
+    mx.x = std::max<float>(mx.x, pmax.x);
+    mx.y = std::max<float>(mx.y, pmax.y);
+    mx.z = std::max<float>(mx.z, pmax.z);
+}
+
+static float GetAxis(const XMFLOAT3& v, int axis)
+{
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// 박스가 평면 밖에 있으면 -1, 평면 안쪽에 완전히 있으면 1, 걸쳐 있으면 0입니다.
+static int ClassifyBox(const XMFLOAT4& plane, const XMFLOAT3& mn, const XMFLOAT3& mx)
+{
+    const float cx = 0.5f * (mn.x + mx.x);
+    const float cy = 0.5f * (mn.y + mx.y);
+    const float cz = 0.5f * (mn.z + mx.z);
+    const float ex = 0.5f * (mx.x - mn.x);
+    const float ey = 0.5f * (mx.y - mn.y);
+    const float ez = 0.5f * (mx.z - mn.z);
+
+    const float dist = plane.x * cx + plane.y * cy + plane.z * cz + plane.w;
+    const float radius = std::fabs(plane.x) * ex + std::fabs(plane.y) * ey + std::fabs(plane.z) * ez;
+
+    if (dist + radius < 0.0f)
+        return -1;
+
+    return dist - radius >= 0.0f ? 1 : 0;
+}
+
+// 레이가 박스와 교차하는 구간의 시작 거리를 tEntry에 씁니다. invDir은 레이 방향의 역수입니다.
+static bool IntersectSlabs(FXMVECTOR origin, FXMVECTOR invDir, const XMFLOAT3& mn, const XMFLOAT3& mx,
+    float maxDist, float& tEntry)
+{
+    const XMVECTOR t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&mn), origin), invDir);
+    const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&mx), origin), invDir);
+
+    const XMVECTOR tNear = XMVectorMin(t0, t1);
+    const XMVECTOR tFar = XMVectorMax(t0, t1);
+
+    const float enter = std::max<float>(std::max<float>(XMVectorGetX(tNear), XMVectorGetY(tNear)),
+        std::max<float>(XMVectorGetZ(tNear), 0.0f));
+    const float exit = std::min<float>(std::min<float>(XMVectorGetX(tFar), XMVectorGetY(tFar)),
+        std::min<float>(XMVectorGetZ(tFar), maxDist));
+
+    tEntry = enter;
+    return enter <= exit;
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+    mNodes.clear();
+    mIndices.clear();
+    mPrimitiveMin.clear();
+    mPrimitiveMax.clear();
+
+    mParents.clear();
+    mPrimitiveLeaves.clear();
+    mNodeAreaSum = 0.0f;
+    mBuildSahCost = 0.0f;
+
+    mNodeRejectPlane.clear();
+    mPrimitiveRejectPlane.clear();
+    mHasCachedResult = false;
+}
+
+void BoundingVolumeHierarchy::Build(const std::vector<BoundingBox>& bounds)
+{
+    PROFILE_FUNCTION();
+
+    Clear();
+
+    const std::uint32_t count = (std::uint32_t)bounds.size();
+    if (count == 0)
+        return;
+
+    mPrimitiveMin.resize(count);
+    mPrimitiveMax.resize(count);
+    mIndices.resize(count);
+
+    std::vector<XMFLOAT3> centroids(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        const BoundingBox& box = bounds[i];
+        mPrimitiveMin[i] = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+        mPrimitiveMax[i] = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+        centroids[i] = box.Center;
+        mIndices[i] = i;
+    }
+
+    // 노드는 최대 2N - 1개이므로 미리 할당해서 참조가 무효화되지 않게 합니다.
+    mNodes.reserve(2 * (size_t)count - 1);
+
+    Node root;
+    root.LeftOrFirst = 0;
+    root.Count = count;
+    mNodes.push_back(root);
+
+    std::vector<std::uint32_t> stack;
+    stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        Node& node = mNodes[stack.back()];
+        stack.pop_back();
+
+        UpdateNodeBounds(node);
+
+        const std::uint32_t first = node.LeftOrFirst;
+        const std::uint32_t nodeCount = node.Count;
+        if (nodeCount <= 1)
+            continue;
+
+        XMFLOAT3 centroidMin(FLT_MAX, FLT_MAX, FLT_MAX);
+        XMFLOAT3 centroidMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (std::uint32_t i = first; i < first + nodeCount; ++i)
+            GrowBounds(centroidMin, centroidMax, centroids[mIndices[i]], centroids[mIndices[i]]);
+
+        // 세 축 모두에 대해서 구간 경계마다 SAH 비용을 계산합니다.
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = FLT_MAX;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float axisMin = GetAxis(centroidMin, axis);
+            const float extent = GetAxis(centroidMax, axis) - axisMin;
+            if (extent <= 0.0f)
+                continue;
+
+            struct Bin
+            {
+                XMFLOAT3 Min = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+                XMFLOAT3 Max = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+                std::uint32_t Count = 0;
+            };
+            Bin bins[gBinCount];
+
+            const float scale = gBinCount / extent;
+            for (std::uint32_t i = first; i < first + nodeCount; ++i)
+            {
+                const std::uint32_t prim = mIndices[i];
+                const int b = std::min<int>((int)((GetAxis(centroids[prim], axis) - axisMin) * scale), gBinCount - 1);
+                GrowBounds(bins[b].Min, bins[b].Max, mPrimitiveMin[prim], mPrimitiveMax[prim]);
+                bins[b].Count++;
+            }
+
+            // 왼쪽에서 오른쪽으로, 오른쪽에서 왼쪽으로 누적합니다.
+            float leftCost[gBinCount - 1];
+            Bin left;
+            for (int b = 0; b < gBinCount - 1; ++b)
+            {
+                GrowBounds(left.Min, left.Max, bins[b].Min, bins[b].Max);
+                left.Count += bins[b].Count;
+                leftCost[b] = left.Count > 0 ? HalfSurfaceArea(left.Min, left.Max) * left.Count : 0.0f;
+            }
+
+            Bin right;
+            for (int b = gBinCount - 1; b > 0; --b)
+            {
+                GrowBounds(right.Min, right.Max, bins[b].Min, bins[b].Max);
+                right.Count += bins[b].Count;
+
+                const float cost = leftCost[b - 1] + (right.Count > 0 ? HalfSurfaceArea(right.Min, right.Max) * right.Count : 0.0f);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        // 나누는 것보다 리프로 두는 것이 싸면 리프로 둡니다.
+        const float leafCost = HalfSurfaceArea(node.Min, node.Max) * nodeCount;
+        if (nodeCount <= MaxLeafSize && (bestAxis < 0 || bestCost >= leafCost))
+            continue;
+
+        std::uint32_t leftCount = 0;
+        if (bestAxis >= 0)
+        {
+            const float axisMin = GetAxis(centroidMin, bestAxis);
+            const float scale = gBinCount / (GetAxis(centroidMax, bestAxis) - axisMin);
+
+            auto middle = std::partition(mIndices.begin() + first, mIndices.begin() + first + nodeCount, [&](std::uint32_t prim)
+            {
+                const int b = std::min<int>((int)((GetAxis(centroids[prim], bestAxis) - axisMin) * scale), gBinCount - 1);
+                return b < bestSplit;
+            });
+
+            leftCount = (std::uint32_t)(middle - (mIndices.begin() + first));
+        }
+
+        // 중심점이 모두 같은 경우처럼 나눠지지 않으면 절반으로 나눕니다.
+        if (leftCount == 0 || leftCount == nodeCount)
+            leftCount = nodeCount / 2;
+
+        Node leftChild;
+        leftChild.LeftOrFirst = first;
+        leftChild.Count = leftCount;
+
+        Node rightChild;
+        rightChild.LeftOrFirst = first + leftCount;
+        rightChild.Count = nodeCount - leftCount;
+
+        node.LeftOrFirst = (std::uint32_t)mNodes.size();
+        node.Count = 0;
+
+        mNodes.push_back(leftChild);
+        mNodes.push_back(rightChild);
+
+        stack.push_back(node.LeftOrFirst);
+        stack.push_back(node.LeftOrFirst + 1);
+    }
+
+    mNodeRejectPlane.assign(mNodes.size(), 0);
+    mPrimitiveRejectPlane.assign(count, 0);
+
+    UpdateTopology();
+    mBuildSahCost = SahCost();
+}
+
+void BoundingVolumeHierarchy::UpdateTopology()
+{
+    static const std::uint32_t NoParent = 0xFFFFFFFF;
+
+    mParents.assign(mNodes.size(), NoParent);
+    mPrimitiveLeaves.assign(mPrimitiveMin.size(), 0);
+    mNodeAreaSum = 0.0f;
+
+    for (std::uint32_t i = 0; i < (std::uint32_t)mNodes.size(); ++i)
+    {
+        const Node& node = mNodes[i];
+        mNodeAreaSum += HalfSurfaceArea(node.Min, node.Max);
+
+        if (node.Count == 0)
+        {
+            mParents[node.LeftOrFirst] = i;
+            mParents[node.LeftOrFirst + 1] = i;
+        }
+        else
+        {
+            for (std::uint32_t k = node.LeftOrFirst; k < node.LeftOrFirst + node.Count; ++k)
+                mPrimitiveLeaves[mIndices[k]] = i;
+        }
+    }
+}
+
+void BoundingVolumeHierarchy::SetPrimitiveBounds(std::uint32_t primitive, const BoundingBox& bounds)
+{
+    mPrimitiveMin[primitive] = XMFLOAT3(bounds.Center.x - bounds.Extents.x,
+        bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z);
+    mPrimitiveMax[primitive] = XMFLOAT3(bounds.Center.x + bounds.Extents.x,
+        bounds.Center.y + bounds.Extents.y, bounds.Center.z + bounds.Extents.z);
+
+    mHasCachedResult = false;
+}
+
+void BoundingVolumeHierarchy::Refit()
+{
+    PROFILE_FUNCTION();
+
+    // 자식은 항상 부모보다 뒤에 있으므로 거꾸로 순회하면 자식이 먼저 갱신됩니다.
+    for (size_t i = mNodes.size(); i-- > 0;)
+    {
+        Node& node = mNodes[i];
+        if (node.Count > 0)
+        {
+            UpdateNodeBounds(node);
+        }
+        else
+        {
+            const Node& left = mNodes[node.LeftOrFirst];
+            const Node& right = mNodes[node.LeftOrFirst + 1];
+
+            node.Min = left.Min;
+            node.Max = left.Max;
+            GrowBounds(node.Min, node.Max, right.Min, right.Max);
+        }
+    }
+
+    UpdateTopology();
+    mHasCachedResult = false;
+}
+
+std::uint32_t BoundingVolumeHierarchy::RefitPrimitives(const std::vector<std::uint32_t>& primitives)
+{
+    PROFILE_FUNCTION();
+
+    std::uint32_t refitCount = 0;
+
+    // 노드의 바운딩 박스를 다시 계산하고 바뀌었는지를 반환합니다.
+    auto refitNode = [this, &refitCount](std::uint32_t index)
+    {
+        Node& node = mNodes[index];
+        const XMFLOAT3 oldMin = node.Min;
+        const XMFLOAT3 oldMax = node.Max;
+
+        if (node.Count > 0)
+        {
+            UpdateNodeBounds(node);
+        }
+        else
+        {
+            node.Min = mNodes[node.LeftOrFirst].Min;
+            node.Max = mNodes[node.LeftOrFirst].Max;
+            GrowBounds(node.Min, node.Max, mNodes[node.LeftOrFirst + 1].Min, mNodes[node.LeftOrFirst + 1].Max);
+        }
+
+        refitCount++;
+        mNodeAreaSum += HalfSurfaceArea(node.Min, node.Max) - HalfSurfaceArea(oldMin, oldMax);
+
+        return std::memcmp(&oldMin, &node.Min, sizeof(XMFLOAT3)) != 0 || std::memcmp(&oldMax, &node.Max, sizeof(XMFLOAT3)) != 0;
+    };
+
+    // 리프를 먼저 모두 갱신합니다. 그래야 위로 올라가면서 다시 계산하는 부모가 항상
+    // 최신 자식을 보게 되고, 박스가 바뀌지 않은 노드에서 멈출 수 있습니다.
+    std::vector<std::uint32_t> changedLeaves;
+    for (std::uint32_t prim : primitives)
+    {
+        const std::uint32_t leaf = mPrimitiveLeaves[prim];
+        if (refitNode(leaf))
+            changedLeaves.push_back(leaf);
+    }
+
+    for (std::uint32_t leaf : changedLeaves)
+    {
+        for (std::uint32_t node = mParents[leaf]; node < mNodes.size(); node = mParents[node])
+        {
+            if (!refitNode(node))
+                break;
+        }
+    }
+
+    mHasCachedResult = false;
+    return refitCount;
+}
+
+float BoundingVolumeHierarchy::SahCost() const
+{
+    if (mNodes.empty())
+        return 0.0f;
+
+    const float rootArea = HalfSurfaceArea(mNodes[0].Min, mNodes[0].Max);
+    return rootArea > 0.0f ? mNodeAreaSum / rootArea : 0.0f;
+}
+
+float BoundingVolumeHierarchy::BuildSahCost() const
+{
+    return mBuildSahCost;
+}
+
+void BoundingVolumeHierarchy::UpdateNodeBounds(Node& node) const
+{
+    node.Min = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+    node.Max = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for (std::uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; ++i)
+        GrowBounds(node.Min, node.Max, mPrimitiveMin[mIndices[i]], mPrimitiveMax[mIndices[i]]);
+}
+
+std::uint32_t BoundingVolumeHierarchy::PrimitiveCount() const
+{
+    return (std::uint32_t)mIndices.size();
+}
+
+std::uint32_t BoundingVolumeHierarchy::NodeCount() const
+{
+    return (std::uint32_t)mNodes.size();
+}
+
+BoundingBox BoundingVolumeHierarchy::GetBounds() const
+{
+    if (mNodes.empty())
+        return BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+    BoundingBox box;
+    BoundingBox::CreateFromPoints(box, XMLoadFloat3(&mNodes[0].Min), XMLoadFloat3(&mNodes[0].Max));
+    return box;
+}
+
+const BoundingVolumeHierarchy::QueryStats& BoundingVolumeHierarchy::LastStats() const
+{
+    return mStats;
+}
+
+bool BoundingVolumeHierarchy::TestPlanes(const XMFLOAT4 planes[6], const XMFLOAT3& mn, const XMFLOAT3& mx,
+    std::uint32_t& mask, std::uint8_t& lastReject)
+{
+    // 지난번에 거부했던 평면부터 테스트합니다. 카메라가 조금씩 움직이면 대부분 여기서 끝납니다.
+    const int cachedPlane = lastReject;
+    if (mask & (1u << cachedPlane))
+    {
+        mStats.PlaneTests++;
+
+        const int side = ClassifyBox(planes[cachedPlane], mn, mx);
+        if (side < 0)
+        {
+            mStats.CachedPlaneRejects++;
+            return false;
+        }
+
+        if (side > 0)
+            mask &= ~(1u << cachedPlane);
+    }
+
+    // 이미 안쪽에 있는 것으로 판정된 평면은 다시 테스트하지 않습니다.
+    for (int p = 0; p < 6; ++p)
+    {
+        if (p == cachedPlane || (mask & (1u << p)) == 0)
+            continue;
+
+        mStats.PlaneTests++;
+
+        const int side = ClassifyBox(planes[p], mn, mx);
+        if (side < 0)
+        {
+            lastReject = (std::uint8_t)p;
+            return false;
+        }
+
+        if (side > 0)
+            mask &= ~(1u << p);
+    }
+
+    return true;
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(const XMFLOAT4 planes[6], std::vector<std::uint32_t>& primitives)
+{
+    PROFILE_FUNCTION();
+
+    const bool unchanged = mHasCachedResult && std::memcmp(mLastPlanes, planes, sizeof(mLastPlanes)) == 0;
+    std::memcpy(mLastPlanes, planes, sizeof(mLastPlanes));
+
+    mStats = QueryStats();
+    mStats.Primitives = PrimitiveCount();
+
+    if (unchanged)
+    {
+        primitives = mLastResult;
+
+        mStats.PlaneTestsSaved = (std::int32_t)(6 * mStats.Primitives);
+        mStats.Unchanged = true;
+        return;
+    }
+
+    primitives.clear();
+    if (mNodes.empty())
+        return;
+
+    struct StackEntry
+    {
+        std::uint32_t Node;
+        std::uint32_t PlaneMask;
+    };
+
+    std::vector<StackEntry> stack;
+    stack.push_back({ 0, gAllPlanes });
+
+    while (!stack.empty())
+    {
+        const StackEntry entry = stack.back();
+        stack.pop_back();
+
+        const Node& node = mNodes[entry.Node];
+        mStats.NodesVisited++;
+
+        std::uint32_t mask = entry.PlaneMask;
+        if (!TestPlanes(planes, node.Min, node.Max, mask, mNodeRejectPlane[entry.Node]))
+            continue;
+
+        if (mask == 0)
+        {
+            // 서브트리 전체가 프러스텀 안에 있습니다. 서브트리의 프리미티브들은 mIndices에서
+            // 가장 왼쪽 리프부터 가장 오른쪽 리프까지 연속되어 있습니다.
+            std::uint32_t leftmost = entry.Node;
+            while (mNodes[leftmost].Count == 0)
+                leftmost = mNodes[leftmost].LeftOrFirst;
+
+            std::uint32_t rightmost = entry.Node;
+            while (mNodes[rightmost].Count == 0)
+                rightmost = mNodes[rightmost].LeftOrFirst + 1;
+
+            const std::uint32_t first = mNodes[leftmost].LeftOrFirst;
+            const std::uint32_t last = mNodes[rightmost].LeftOrFirst + mNodes[rightmost].Count;
+            primitives.insert(primitives.end(), mIndices.begin() + first, mIndices.begin() + last);
+            mStats.AcceptedSubtrees++;
+            continue;
+        }
+
+        if (node.Count > 0)
+        {
+            for (std::uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; ++i)
+            {
+                const std::uint32_t prim = mIndices[i];
+
+                std::uint32_t primMask = mask;
+                if (TestPlanes(planes, mPrimitiveMin[prim], mPrimitiveMax[prim], primMask, mPrimitiveRejectPlane[prim]))
+                    primitives.push_back(prim);
+            }
+
+            continue;
+        }
+
+        // 왼쪽 자식을 먼저 방문하도록 오른쪽 자식을 먼저 넣습니다.
+        stack.push_back({ node.LeftOrFirst + 1, mask });
+        stack.push_back({ node.LeftOrFirst, mask });
+    }
+
+    mStats.PlaneTestsSaved = (std::int32_t)(6 * mStats.Primitives) - (std::int32_t)mStats.PlaneTests;
+
+    mLastResult = primitives;
+    mHasCachedResult = true;
+}
+
+bool BoundingVolumeHierarchy::QueryRay(FXMVECTOR origin, FXMVECTOR direction, float maxDist,
+    const RayIntersectFunction& intersect, std::uint32_t& primitive, float& dist, RayStats* stats) const
+{
+    auto intersectLeaf = [&intersect](const std::uint32_t* primitives, std::uint32_t count,
+        float leafMaxDist, std::uint32_t& leafPrimitive, float& leafDist)
+    {
+        bool hit = false;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            float t = 0.0f;
+            if (intersect(primitives[i], t) && t >= 0.0f && t < leafMaxDist)
+            {
+                leafMaxDist = t;
+                leafPrimitive = primitives[i];
+                leafDist = t;
+                hit = true;
+            }
+        }
+
+        return hit;
+    };
+
+    return QueryRayLeaves(origin, direction, maxDist, intersectLeaf, primitive, dist, stats);
+}
+
+bool BoundingVolumeHierarchy::QueryRayLeaves(FXMVECTOR origin, FXMVECTOR direction, float maxDist,
+    const RayLeafIntersectFunction& intersectLeaf, std::uint32_t& primitive, float& dist, RayStats* stats) const
+{
+    return TraceRay(origin, direction, maxDist, intersectLeaf, false, primitive, dist, stats);
+}
+
+bool BoundingVolumeHierarchy::QueryRayAny(FXMVECTOR origin, FXMVECTOR direction, float maxDist,
+    const RayLeafIntersectFunction& intersectLeaf, RayStats* stats) const
+{
+    std::uint32_t primitive = 0;
+    float dist = 0.0f;
+    return TraceRay(origin, direction, maxDist, intersectLeaf, true, primitive, dist, stats);
+}
+
+bool BoundingVolumeHierarchy::TraceRay(FXMVECTOR origin, FXMVECTOR direction, float maxDist,
+    const RayLeafIntersectFunction& intersectLeaf, bool anyHit, std::uint32_t& primitive, float& dist,
+    RayStats* stats) const
+{
+    RayStats rayStats;
+
+    // 축에 평행한 레이에서 0 * 무한대가 생기지 않도록 0인 성분을 아주 작은 값으로 바꿉니다.
+    XMFLOAT3 d;
+    XMStoreFloat3(&d, direction);
+    d.x = std::fabs(d.x) < 1e-20f ? (d.x < 0.0f ? -1e-20f : 1e-20f) : d.x;
+    d.y = std::fabs(d.y) < 1e-20f ? (d.y < 0.0f ? -1e-20f : 1e-20f) : d.y;
+    d.z = std::fabs(d.z) < 1e-20f ? (d.z < 0.0f ? -1e-20f : 1e-20f) : d.z;
+    const XMVECTOR invDir = XMVectorReciprocal(XMLoadFloat3(&d));
+
+    float closest = maxDist;
+    bool hit = false;
+
+    struct StackEntry
+    {
+        std::uint32_t Node;
+        float Entry;
+    };
+
+    // 쿼리마다 힙 할당을 하지 않도록 고정 크기 스택을 먼저 사용합니다.
+    StackEntry stack[gRayStackSize];
+    std::uint32_t stackSize = 0;
+    std::vector<StackEntry> spill;
+
+    auto push = [&](std::uint32_t node, float entry)
+    {
+        if (stackSize < gRayStackSize)
+            stack[stackSize++] = { node, entry };
+        else
+            spill.push_back({ node, entry });
+    };
+
+    float rootEntry = 0.0f;
+    if (!mNodes.empty() && IntersectSlabs(origin, invDir, mNodes[0].Min, mNodes[0].Max, closest, rootEntry))
+        push(0, rootEntry);
+
+    while (stackSize > 0 || !spill.empty())
+    {
+        StackEntry entry;
+        if (!spill.empty())
+        {
+            entry = spill.back();
+            spill.pop_back();
+        }
+        else
+        {
+            entry = stack[--stackSize];
+        }
+
+        // 스택에 넣은 후에 더 가까운 교차를 찾았으면 건너뜁니다.
+        if (entry.Entry > closest)
+            continue;
+
+        const Node& node = mNodes[entry.Node];
+        rayStats.NodesVisited++;
+
+        if (node.Count > 0)
+        {
+            rayStats.PrimitiveTests += node.Count;
+
+            std::uint32_t leafPrimitive = 0;
+            float t = 0.0f;
+            if (intersectLeaf(&mIndices[node.LeftOrFirst], node.Count, closest, leafPrimitive, t) && t < closest)
+            {
+                closest = t;
+                primitive = leafPrimitive;
+                hit = true;
+
+                if (anyHit)
+                    break;
+            }
+
+            continue;
+        }
+
+        const std::uint32_t left = node.LeftOrFirst;
+        const std::uint32_t right = node.LeftOrFirst + 1;
+
+        float leftEntry = 0.0f;
+        float rightEntry = 0.0f;
+        const bool hitLeft = IntersectSlabs(origin, invDir, mNodes[left].Min, mNodes[left].Max, closest, leftEntry);
+        const bool hitRight = IntersectSlabs(origin, invDir, mNodes[right].Min, mNodes[right].Max, closest, rightEntry);
+
+        // 가까운 자식을 먼저 방문하도록 먼 자식을 먼저 넣습니다.
+        if (hitLeft && hitRight)
+        {
+            if (leftEntry <= rightEntry)
+            {
+                push(right, rightEntry);
+                push(left, leftEntry);
+            }
+            else
+            {
+                push(left, leftEntry);
+                push(right, rightEntry);
+            }
+        }
+        else if (hitLeft)
+        {
+            push(left, leftEntry);
+        }
+        else if (hitRight)
+        {
+            push(right, rightEntry);
+        }
+    }
+
+    if (hit)
+        dist = closest;
+
+    if (stats)
+        *stats = rayStats;
+
+    return hit;
+}
+
+size_t BoundingVolumeHierarchy::MemoryUsage() const
+{
+    return mNodes.capacity() * sizeof(Node) +
+        mIndices.capacity() * sizeof(std::uint32_t) +
+        (mPrimitiveMin.capacity() + mPrimitiveMax.capacity()) * sizeof(XMFLOAT3) +
+        mNodeRejectPlane.capacity() + mPrimitiveRejectPlane.capacity() +
+        (mLastResult.capacity() + mParents.capacity() + mPrimitiveLeaves.capacity()) * sizeof(std::uint32_t);
+}
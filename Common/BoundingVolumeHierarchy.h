@@ -0,0 +1,183 @@
+﻿//***************************************************************************************
+// BoundingVolumeHierarchy.h
+//
+// A bounding volume hierarchy over axis aligned boxes (instances, triangles, ...).  The
+// tree is built top-down with a binned surface area heuristic and stored as a flat
+// node array in which children always come after their parent, so moving primitives
+// are handled with a bottom-up refit instead of a rebuild.  RefitPrimitives only walks
+// from the leaves of the changed primitives up to the root, so its cost follows the
+// number of changed primitives.  Refitting keeps the topology, so the tree gets worse
+// as primitives move apart; SahCost against BuildSahCost tells when to rebuild.
+//
+// Frustum queries carry a mask of the planes that still have to be tested: a node
+// that is completely inside a plane clears its bit for the whole subtree, a subtree
+// completely inside the frustum is accepted without further tests and a node outside
+// any plane is rejected with everything below it.  Each node and primitive also keeps
+// the plane that rejected it last time and tests it first, and a query with the same
+// planes as the previous one on an unchanged tree returns the previous result.
+//
+// Ray queries walk the tree front to back, visiting the nearer child first and skipping
+// nodes that start beyond the closest hit so far; the caller supplies the exact
+// primitive test, so the same tree serves instance picking and per-mesh triangle
+// picking.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class BoundingVolumeHierarchy
+{
+public:
+    // 리프 노드가 가질 수 있는 최대 프리미티브 수입니다.
+    static const std::uint32_t MaxLeafSize = 4;
+
+    // 마지막 QueryFrustum의 통계입니다.
+    struct QueryStats
+    {
+        std::uint32_t Primitives = 0;
+        std::uint32_t NodesVisited = 0;
+
+        // 평면 마스크가 비어서 테스트 없이 통째로 받아들인 서브트리 수입니다.
+        std::uint32_t AcceptedSubtrees = 0;
+
+        // 노드와 프리미티브에 대해서 실제로 수행한 박스-평면 테스트 수입니다.
+        std::uint32_t PlaneTests = 0;
+
+        // 모든 프리미티브를 6개 평면과 테스트하는 경우보다 줄어든 테스트 수입니다.
+        std::int32_t PlaneTestsSaved = 0;
+
+        // 지난번에 거부했던 평면 하나로 바로 거부된 노드와 프리미티브 수입니다.
+        std::uint32_t CachedPlaneRejects = 0;
+
+        // 평면과 트리가 그대로여서 지난 결과를 재사용했으면 true입니다.
+        bool Unchanged = false;
+    };
+
+    // QueryRay의 통계입니다.
+    struct RayStats
+    {
+        std::uint32_t NodesVisited = 0;
+        std::uint32_t PrimitiveTests = 0;
+    };
+
+    // 프리미티브와 레이의 교차 테스트입니다. 교차하면 레이 방향 길이 단위의 거리를 t에 쓰고 true를 반환합니다.
+    using RayIntersectFunction = std::function<bool(std::uint32_t primitive, float& t)>;
+
+    // 리프 하나의 프리미티브들(최대 MaxLeafSize개)을 한 번에 테스트합니다. maxDist보다 가까이 교차하는
+    // 프리미티브가 있으면 가장 가까운 것을 primitive와 t에 쓰고 true를 반환합니다.
+    using RayLeafIntersectFunction = std::function<bool(const std::uint32_t* primitives, std::uint32_t count,
+        float maxDist, std::uint32_t& primitive, float& t)>;
+
+    BoundingVolumeHierarchy() = default;
+
+    void Clear();
+
+    // bounds[i]가 프리미티브 i의 바운딩 박스입니다.
+    void Build(const std::vector<DirectX::BoundingBox>& bounds);
+
+    // 프리미티브의 바운딩 박스만 바꿉니다. 노드에 반영하려면 Refit을 호출합니다.
+    void SetPrimitiveBounds(std::uint32_t primitive, const DirectX::BoundingBox& bounds);
+
+    // 트리의 구조는 유지하고 모든 노드의 바운딩 박스를 아래에서 위로 다시 계산합니다.
+    void Refit();
+
+    // SetPrimitiveBounds로 바꾼 프리미티브들의 리프에서 루트까지만 다시 계산합니다.
+    // 다시 계산한 노드 수를 반환합니다.
+    std::uint32_t RefitPrimitives(const std::vector<std::uint32_t>& primitives);
+
+    // 루트의 표면적에 대한 모든 노드 표면적의 합입니다. 레이가 루트를 지날 때 방문할 것으로
+    // 예상되는 노드 수에 비례합니다. BuildSahCost는 마지막 Build 직후의 값입니다.
+    float SahCost() const;
+    float BuildSahCost() const;
+
+    std::uint32_t PrimitiveCount() const;
+    std::uint32_t NodeCount() const;
+
+    // 루트 노드의 바운딩 박스입니다.
+    DirectX::BoundingBox GetBounds() const;
+
+    // MathHelper::ComputeFrustumPlanes로 구한 world 평면들과 교차하는 프리미티브들을
+    // primitives에 씁니다. 순서는 트리를 순회한 순서입니다. 거부한 평면을 기억하므로 const가 아닙니다.
+    void QueryFrustum(const DirectX::XMFLOAT4 planes[6], std::vector<std::uint32_t>& primitives);
+
+    const QueryStats& LastStats() const;
+
+    // origin에서 direction으로 maxDist까지의 레이와 가장 가까이 교차하는 프리미티브를 찾습니다.
+    // 교차하는 프리미티브가 없으면 false를 반환합니다. 트리를 바꾸지 않으므로 여러 스레드에서 호출할 수 있습니다.
+    bool QueryRay(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDist,
+        const RayIntersectFunction& intersect, std::uint32_t& primitive, float& dist, RayStats* stats = nullptr) const;
+
+    // QueryRay와 같지만 리프마다 한 번 호출되므로 여러 프리미티브를 SIMD로 함께 테스트할 수 있습니다.
+    bool QueryRayLeaves(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDist,
+        const RayLeafIntersectFunction& intersectLeaf, std::uint32_t& primitive, float& dist, RayStats* stats = nullptr) const;
+
+    // maxDist 안에서 레이와 교차하는 프리미티브가 하나라도 있으면 true입니다. 처음 찾은 교차에서 멈추므로
+    // 가장 가까운 교차를 찾는 것보다 빠릅니다. 시야 검사처럼 가려졌는지만 알면 되는 경우에 사용합니다.
+    bool QueryRayAny(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDist,
+        const RayLeafIntersectFunction& intersectLeaf, RayStats* stats = nullptr) const;
+
+    // 노드, 인덱스, 프리미티브 바운딩 박스와 캐시가 차지하는 바이트 수입니다.
+    size_t MemoryUsage() const;
+
+private:
+    struct Node
+    {
+        DirectX::XMFLOAT3 Min;
+
+        // 내부 노드이면 왼쪽 자식의 인덱스(오른쪽 자식은 바로 다음), 리프이면 mIndices에서의 시작 위치입니다.
+        std::uint32_t LeftOrFirst = 0;
+
+        DirectX::XMFLOAT3 Max;
+
+        // 0이면 내부 노드입니다.
+        std::uint32_t Count = 0;
+    };
+
+    void UpdateNodeBounds(Node& node) const;
+
+    // 부모 인덱스, 리프 인덱스와 표면적의 합을 다시 계산합니다.
+    void UpdateTopology();
+
+    // QueryRayLeaves와 QueryRayAny의 순회입니다. anyHit이면 처음 찾은 교차에서 멈춥니다.
+    bool TraceRay(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDist,
+        const RayLeafIntersectFunction& intersectLeaf, bool anyHit, std::uint32_t& primitive, float& dist,
+        RayStats* stats) const;
+
+    // mask에 남은 평면들로 박스를 테스트합니다. 밖에 있으면 거부한 평면을 lastReject에 기억하고
+    // false를 반환하고, 완전히 안쪽에 있는 평면은 mask에서 지웁니다.
+    bool TestPlanes(const DirectX::XMFLOAT4 planes[6], const DirectX::XMFLOAT3& mn, const DirectX::XMFLOAT3& mx,
+        std::uint32_t& mask, std::uint8_t& lastReject);
+
+private:
+    std::vector<Node> mNodes;
+
+    // 노드의 부모 인덱스와 프리미티브가 들어있는 리프의 인덱스입니다. RefitPrimitives에서 사용합니다.
+    std::vector<std::uint32_t> mParents;
+    std::vector<std::uint32_t> mPrimitiveLeaves;
+
+    // 모든 노드의 표면적(절반)의 합입니다. RefitPrimitives가 바뀐 만큼만 갱신합니다.
+    float mNodeAreaSum = 0.0f;
+    float mBuildSahCost = 0.0f;
+
+    // 리프 노드들이 가리키는 프리미티브 인덱스들입니다.
+    std::vector<std::uint32_t> mIndices;
+
+    std::vector<DirectX::XMFLOAT3> mPrimitiveMin;
+    std::vector<DirectX::XMFLOAT3> mPrimitiveMax;
+
+    // 노드와 프리미티브를 마지막으로 거부한 평면의 인덱스(0~5)입니다.
+    std::vector<std::uint8_t> mNodeRejectPlane;
+    std::vector<std::uint8_t> mPrimitiveRejectPlane;
+
+    // 지난 결과를 재사용하기 위한 상태입니다.
+    DirectX::XMFLOAT4 mLastPlanes[6] = {};
+    bool mHasCachedResult = false;
+    std::vector<std::uint32_t> mLastResult;
+
+    QueryStats mStats;
+};
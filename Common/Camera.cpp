@@ -4,9 +4,23 @@
 //***************************************************************************************
 
 #include "Camera.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace DirectX;
 
+// 무한 원평면 투영에서 컬링 프러스텀의 원거리는 근평면 거리의 이 배수를 넘지 않습니다.
+static const float gMaxCullDepthRatio = 1.0e6f;
+
+// 속도를 부드럽게 만드는 시간 상수(초)입니다. 입력이 프레임마다 들쭉날쭉해도 예측이 떨리지 않습니다.
+static const float gMotionSmoothingTime = 0.1f;
+
+// 스윕 볼륨을 만들 때 예측 구간을 나누는 수입니다. 회전할 때 중간 프러스텀들도 감싸기 위해 필요합니다.
+static const int gSweepSteps = 4;
+
+// 예측할 때 회전하면서 이동하는 경로를 적분하는 단계 수입니다.
+static const int gPredictionSteps = 8;
+
 Camera::Camera()
 {
     SetLens(0.25f * MathHelper::Pi, 1.0, 1.0, 1000.0f);
@@ -30,12 +44,14 @@ void Camera::SetPosition(float x, float y, float z)
 {
     mPosition = XMFLOAT3(x, y, z);
     mViewDirty = true;
+    mTeleported = true;
 }
 
 void Camera::SetPosition(const DirectX::XMFLOAT3& v)
 {
     mPosition = v;
     mViewDirty = true;
+    mTeleported = true;
 }
 
 DirectX::XMVECTOR Camera::GetRight() const
@@ -78,6 +94,11 @@ float Camera::GetFarZ() const
     return mFarZ;
 }
 
+float Camera::GetCullFarZ() const
+{
+    return mCullFarZ;
+}
+
 float Camera::GetAspect() const
 {
     return mAspect;
@@ -88,6 +109,11 @@ float Camera::GetFovY() const
     return mFovY;
 }
 
+Camera::DepthMode Camera::GetDepthMode() const
+{
+    return mDepthMode;
+}
+
 float Camera::GetFovX() const
 {
     float halfWidth = 0.5f * GetNearWindowHeight();
@@ -114,19 +140,50 @@ float Camera::GetFarWindowHeight() const
     return mFarWindowHeight;
 }
 
-void Camera::SetLens(float fovY, float aspect, float zn, float zf)
+void Camera::SetLens(float fovY, float aspect, float zn, float zf, DepthMode depthMode)
 {
+    const bool infinite = depthMode == DepthMode::ReversedInfinite;
+
     // 프로퍼티들을 캐쉬합니다.
     mFovY = fovY;
     mAspect = aspect;
     mNearZ = zn;
-    mFarZ = zf;
+    mFarZ = infinite ? MathHelper::Infinity : zf;
+    mCullFarZ = infinite ? std::min<float>(zf, zn * gMaxCullDepthRatio) : zf;
+    mDepthMode = depthMode;
 
     mNearWindowHeight = 2.0f * mNearZ * tanf(0.5f * mFovY);
-    mFarWindowHeight  = 2.0f * mFarZ * tanf(0.5f * mFovY);
+    mFarWindowHeight  = infinite ? MathHelper::Infinity : 2.0f * mFarZ * tanf(0.5f * mFovY);
 
-    XMMATRIX P = XMMatrixPerspectiveFovLH(mFovY, mAspect, mNearZ, mFarZ);
+    XMMATRIX P;
+    if (depthMode == DepthMode::Standard)
+    {
+        P = XMMatrixPerspectiveFovLH(mFovY, mAspect, mNearZ, mFarZ);
+    }
+    else if (depthMode == DepthMode::Reversed)
+    {
+        // 근평면과 원평면을 바꾸면 깊이가 근평면에서 1, 원평면에서 0이 됩니다.
+        P = XMMatrixPerspectiveFovLH(mFovY, mAspect, mFarZ, mNearZ);
+    }
+    else
+    {
+        // 클립 공간 z를 zn으로 고정하면 w = z로 나눈 깊이가 zn / z가 됩니다.
+        // 근평면에서 1이고 거리가 무한대로 갈 때 0에 다가갑니다.
+        const float yScale = 1.0f / tanf(0.5f * mFovY);
+        const float xScale = yScale / mAspect;
+
+        P = XMMatrixSet(
+            xScale, 0.0f,   0.0f,   0.0f,
+            0.0f,   yScale, 0.0f,   0.0f,
+            0.0f,   0.0f,   0.0f,   1.0f,
+            0.0f,   0.0f,   mNearZ, 0.0f);
+    }
     XMStoreFloat4x4(&mProj, P);
+
+    // ViewProj와 월드 프러스텀도 프로젝션에 의존합니다.
+    mProjDerivedDirty = true;
+    mViewDerivedDirty = true;
+    mGeneration++;
 }
 
 void Camera::LookAt(DirectX::FXMVECTOR pos, DirectX::FXMVECTOR target, DirectX::FXMVECTOR worldUp)
@@ -141,6 +198,7 @@ void Camera::LookAt(DirectX::FXMVECTOR pos, DirectX::FXMVECTOR target, DirectX::
     XMStoreFloat3(&mUp, U);
 
     mViewDirty = true;
+    mTeleported = true;
 }
 
 void Camera::LookAt(const DirectX::XMFLOAT3& pos, const DirectX::XMFLOAT3& target, const DirectX::XMFLOAT3& up)
@@ -174,6 +232,53 @@ DirectX::XMFLOAT4X4 Camera::GetProj4x4f() const
     return mProj;
 }
 
+DirectX::XMMATRIX Camera::GetInvView() const
+{
+    UpdateViewDerived();
+    return XMLoadFloat4x4(&mInvView);
+}
+
+DirectX::XMMATRIX Camera::GetInvProj() const
+{
+    UpdateProjDerived();
+    return XMLoadFloat4x4(&mInvProj);
+}
+
+DirectX::XMMATRIX Camera::GetViewProj() const
+{
+    UpdateViewDerived();
+    return XMLoadFloat4x4(&mViewProj);
+}
+
+DirectX::XMMATRIX Camera::GetInvViewProj() const
+{
+    UpdateViewDerived();
+    return XMLoadFloat4x4(&mInvViewProj);
+}
+
+const DirectX::XMFLOAT4* Camera::GetFrustumPlanes() const
+{
+    UpdateViewDerived();
+    return mFrustumPlanes;
+}
+
+const DirectX::BoundingFrustum& Camera::GetViewFrustum() const
+{
+    UpdateProjDerived();
+    return mViewFrustum;
+}
+
+const DirectX::BoundingFrustum& Camera::GetFrustum() const
+{
+    UpdateViewDerived();
+    return mFrustum;
+}
+
+std::uint64_t Camera::GetGeneration() const
+{
+    return mGeneration;
+}
+
 void Camera::Strafe(float d)
 {
     // mPosition += d * mRight
@@ -181,6 +286,7 @@ void Camera::Strafe(float d)
     XMVECTOR r = XMLoadFloat3(&mRight);
     XMVECTOR p = XMLoadFloat3(&mPosition);
     XMStoreFloat3(&mPosition, XMVectorMultiplyAdd(s, r, p));
+    XMStoreFloat3(&mFrameMove, XMVectorMultiplyAdd(s, r, XMLoadFloat3(&mFrameMove)));
 
     mViewDirty = true;
 }
@@ -192,6 +298,7 @@ void Camera::Walk(float d)
     XMVECTOR l = XMLoadFloat3(&mLook);
     XMVECTOR p = XMLoadFloat3(&mPosition);
     XMStoreFloat3(&mPosition, XMVectorMultiplyAdd(s, l, p));
+    XMStoreFloat3(&mFrameMove, XMVectorMultiplyAdd(s, l, XMLoadFloat3(&mFrameMove)));
 
     mViewDirty = true;
 }
@@ -205,6 +312,7 @@ void Camera::Pitch(float angle)
     XMStoreFloat3(&mUp,   XMVector3TransformNormal(XMLoadFloat3(&mUp), R));
     XMStoreFloat3(&mLook, XMVector3TransformNormal(XMLoadFloat3(&mLook), R));
 
+    mFramePitch += angle;
     mViewDirty = true;
 }
 
@@ -218,6 +326,7 @@ void Camera::RotateY(float angle)
     XMStoreFloat3(&mUp,    XMVector3TransformNormal(XMLoadFloat3(&mUp), R));
     XMStoreFloat3(&mLook,  XMVector3TransformNormal(XMLoadFloat3(&mLook), R));
 
+    mFrameYaw += angle;
     mViewDirty = true;
 }
 
@@ -267,5 +376,189 @@ void Camera::UpdateViewMatrix()
         mView(3, 3) = 1.0f;
 
         mViewDirty = false;
+        mViewDerivedDirty = true;
+        mGeneration++;
+    }
+}
+
+void Camera::UpdateProjDerived() const
+{
+    if (mProjDerivedDirty)
+    {
+        XMMATRIX P = XMLoadFloat4x4(&mProj);
+        XMVECTOR det = XMMatrixDeterminant(P);
+        XMStoreFloat4x4(&mInvProj, XMMatrixInverse(&det, P));
+
+        // BoundingFrustum::CreateFromMatrix는 표준 깊이만 이해하므로 프러스텀 속성으로 직접 만듭니다.
+        const float tanHalfFovY = tanf(0.5f * mFovY);
+        const float tanHalfFovX = mAspect * tanHalfFovY;
+        mViewFrustum = BoundingFrustum(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f),
+            tanHalfFovX, -tanHalfFovX, tanHalfFovY, -tanHalfFovY, mNearZ, mCullFarZ);
+
+        mProjDerivedDirty = false;
+    }
+}
+
+void Camera::UpdateViewDerived() const
+{
+    UpdateProjDerived();
+
+    if (mViewDerivedDirty)
+    {
+        XMMATRIX V = XMLoadFloat4x4(&mView);
+        XMMATRIX P = XMLoadFloat4x4(&mProj);
+
+        // 뷰 메트릭스는 회전과 이동뿐이므로 회전 부분을 전치하고 이동을 되돌려서 역행렬을 만듭니다.
+        // mPosition은 UpdateViewMatrix 이후에 바뀌었을 수 있으므로 mView만 사용합니다.
+        XMMATRIX invView = XMMatrixTranspose(XMMatrixSet(
+            mView(0, 0), mView(0, 1), mView(0, 2), 0.0f,
+            mView(1, 0), mView(1, 1), mView(1, 2), 0.0f,
+            mView(2, 0), mView(2, 1), mView(2, 2), 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f));
+        XMVECTOR t = XMVectorSet(-mView(3, 0), -mView(3, 1), -mView(3, 2), 1.0f);
+        invView.r[3] = XMVector3TransformNormal(t, invView);
+        invView.r[3] = XMVectorSetW(invView.r[3], 1.0f);
+
+        XMMATRIX viewProj = XMMatrixMultiply(V, P);
+        XMMATRIX invViewProj = XMMatrixMultiply(XMLoadFloat4x4(&mInvProj), invView);
+
+        XMStoreFloat4x4(&mInvView, invView);
+        XMStoreFloat4x4(&mViewProj, viewProj);
+        XMStoreFloat4x4(&mInvViewProj, invViewProj);
+
+        MathHelper::ComputeFrustumPlanes(viewProj, mFrustumPlanes, mDepthMode != DepthMode::Standard);
+        mViewFrustum.Transform(mFrustum, invView);
+
+        // 무한 원평면 투영에는 먼 평면이 없으므로 BoundingFrustum과 같은 거리에 만듭니다.
+        // 법선은 시선의 반대 방향이고 눈에서 시선 방향으로 mCullFarZ만큼 떨어진 점을 지납니다.
+        if (mDepthMode == DepthMode::ReversedInfinite)
+        {
+            const XMVECTOR look = invView.r[2];
+            const float w = XMVectorGetX(XMVector3Dot(look, invView.r[3])) + mCullFarZ;
+            XMStoreFloat4(&mFrustumPlanes[5], XMVectorSetW(XMVectorNegate(look), w));
+        }
+
+        mViewDerivedDirty = false;
+    }
+}
+
+void Camera::UpdateMotion(float dt)
+{
+    if (dt <= 0.0f)
+        return;
+
+    if (mTeleported)
+    {
+        mLocalVelocity = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        mPitchRate = 0.0f;
+        mYawRate = 0.0f;
+    }
+    else
+    {
+        // 이번 프레임의 속도 쪽으로 지수적으로 다가갑니다. 프레임 시간이 달라도 같은 시간 상수를 가집니다.
+        const float t = 1.0f - expf(-dt / gMotionSmoothingTime);
+        const float invDt = 1.0f / dt;
+
+        // 이동은 카메라 스페이스에서 기억해서 회전과 함께 방향이 바뀌도록 합니다.
+        XMVECTOR v = XMLoadFloat3(&mLocalVelocity);
+        XMVECTOR frameV = XMVector3TransformNormal(XMVectorScale(XMLoadFloat3(&mFrameMove), invDt), GetView());
+        XMStoreFloat3(&mLocalVelocity, XMVectorLerp(v, frameV, t));
+
+        mPitchRate += (mFramePitch * invDt - mPitchRate) * t;
+        mYawRate += (mFrameYaw * invDt - mYawRate) * t;
+    }
+
+    mFrameMove = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    mFramePitch = 0.0f;
+    mFrameYaw = 0.0f;
+    mTeleported = false;
+}
+
+DirectX::XMVECTOR Camera::GetVelocity() const
+{
+    return XMVector3TransformNormal(XMLoadFloat3(&mLocalVelocity), GetInvView());
+}
+
+float Camera::GetPitchRate() const
+{
+    return mPitchRate;
+}
+
+float Camera::GetYawRate() const
+{
+    return mYawRate;
+}
+
+DirectX::XMMATRIX Camera::GetPredictedInvView(float seconds) const
+{
+    XMMATRIX invView = GetInvView();
+
+    const float h = seconds / gPredictionSteps;
+    const XMVECTOR localStep = XMVectorScale(XMLoadFloat3(&mLocalVelocity), h);
+    const XMMATRIX yaw = XMMatrixRotationY(mYawRate * h);
+
+    for (int i = 0; i < gPredictionSteps; ++i)
+    {
+        // 지금의 기저로 이동한 뒤 입력과 같게 오른쪽 축에 대해 피치를, 월드 Y축에 대해 요를 적용합니다.
+        invView.r[3] = XMVectorAdd(invView.r[3], XMVector3TransformNormal(localStep, invView));
+
+        XMMATRIX R = XMMatrixMultiply(XMMatrixRotationAxis(invView.r[0], mPitchRate * h), yaw);
+        invView.r[0] = XMVector3TransformNormal(invView.r[0], R);
+        invView.r[1] = XMVector3TransformNormal(invView.r[1], R);
+        invView.r[2] = XMVector3TransformNormal(invView.r[2], R);
+    }
+
+    return invView;
+}
+
+void Camera::GetPredictedFrustum(float seconds, DirectX::BoundingFrustum& frustum) const
+{
+    GetViewFrustum().Transform(frustum, GetPredictedInvView(seconds));
+}
+
+void Camera::GetSweptFrustumPlanes(float seconds, DirectX::XMFLOAT4 planes[6]) const
+{
+    // 지금의 평면들을 바깥쪽으로만 밀어서 예측 구간의 프러스텀 꼭짓점들을 모두 포함시킵니다.
+    // 볼록한 프러스텀들의 꼭짓점을 포함하면 프러스텀 전체도 포함됩니다.
+    const XMFLOAT4* currPlanes = GetFrustumPlanes();
+    const BoundingFrustum& viewFrustum = GetViewFrustum();
+
+    // 뷰 스페이스에서 z = 1인 네 모서리 방향입니다.
+    const XMVECTOR edges[4] =
+    {
+        XMVectorSet(viewFrustum.LeftSlope,  viewFrustum.TopSlope,    1.0f, 0.0f),
+        XMVectorSet(viewFrustum.RightSlope, viewFrustum.TopSlope,    1.0f, 0.0f),
+        XMVectorSet(viewFrustum.RightSlope, viewFrustum.BottomSlope, 1.0f, 0.0f),
+        XMVectorSet(viewFrustum.LeftSlope,  viewFrustum.BottomSlope, 1.0f, 0.0f)
+    };
+
+    XMVECTOR P[6];
+    for (int i = 0; i < 6; ++i)
+        P[i] = XMLoadFloat4(&currPlanes[i]);
+
+    // 안쪽이 양수입니다. 꼭짓점이 바깥에 있으면 평면을 그 꼭짓점까지 옮깁니다.
+    auto includePoint = [&](FXMVECTOR p)
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            float d = XMVectorGetX(XMPlaneDotCoord(P[i], p));
+            if (d < 0.0f)
+                P[i] = XMVectorSetW(P[i], XMVectorGetW(P[i]) - d);
+        }
+    };
+
+    for (int step = 1; step <= gSweepSteps; ++step)
+    {
+        XMMATRIX invView = GetPredictedInvView(seconds * (float)step / gSweepSteps);
+
+        for (int c = 0; c < 4; ++c)
+        {
+            // 무한 원평면 투영에서도 컬링 프러스텀은 mCullFarZ에서 끝납니다.
+            includePoint(XMVector3TransformCoord(XMVectorScale(edges[c], mNearZ), invView));
+            includePoint(XMVector3TransformCoord(XMVectorScale(edges[c], mCullFarZ), invView));
+        }
     }
+
+    for (int i = 0; i < 6; ++i)
+        XMStoreFloat4(&planes[i], P[i]);
 }
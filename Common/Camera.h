@@ -7,15 +7,39 @@
 //    so that the view matrix can be constructed.  
 //   -It keeps track of the viewing frustum of the camera so that the projection
 //    matrix can be obtained.
+//   -The matrices derived from the view and projection (inverses, view-projection,
+//    world-space frustum planes and BoundingFrustum) are computed on first use after
+//    a change and cached.  GetGeneration() changes whenever they do, so systems that
+//    depend on the camera can skip work when it has not moved.
+//   -Walk/Strafe/Pitch/RotateY inputs are accumulated and turned into a smoothed
+//    velocity and pitch/yaw rate by UpdateMotion, once per frame.  From these the camera
+//    extrapolates a predicted frustum and the planes of a volume swept by the frustum
+//    over a look-ahead time, so culling and streaming can start before the view arrives.
+//   -SetLens can build a reversed-Z projection (near plane at depth 1), optionally
+//    with the far plane at infinity, for large scenes with a floating-point depth buffer.
+//    The frustum planes, BoundingFrustum and window sizes follow the chosen mode.  An
+//    infinite projection still culls against a finite far distance, so the frustum
+//    handed to the cullers never has corners at infinity.
 //***************************************************************************************
 
 #pragma once
 
-#include "d3dUtil.h"
+#include "MathHelper.h"
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
 
 class Camera
 {
 public:
+    // 깊이 버퍼에 기록되는 값의 분포입니다.
+    enum class DepthMode
+    {
+        Standard,        // 근평면이 0, 원평면이 1. 깊이 테스트는 LESS.
+        Reversed,        // 근평면이 1, 원평면이 0. 깊이 테스트는 GREATER이고 0으로 지웁니다.
+        ReversedInfinite // Reversed와 같지만 원평면이 없습니다. 깊이는 zn / z입니다.
+    };
+
     Camera();
     ~Camera();
 
@@ -40,14 +64,21 @@ public:
     float GetFovY() const;
     float GetFovX() const;
 
-    // 뷰 스페이스 좌표계에서 가깝거나 먼 평면의 거리를 얻습니다.
+    // GetFrustumPlanes와 GetFrustum의 원평면까지의 거리입니다. 항상 유한하고, ReversedInfinite가
+    // 아니면 GetFarZ와 같습니다.
+    float GetCullFarZ() const;
+
+    // 뷰 스페이스 좌표계에서 가깝거나 먼 평면의 거리를 얻습니다. 원평면이 무한대이면 GetFarZ와
+    // GetFarWindow*는 MathHelper::Infinity를 반환합니다.
     float GetNearWindowWidth() const;
     float GetNearWindowHeight() const;
     float GetFarWindowWidth() const;
     float GetFarWindowHeight() const;
 
-    // 프러스트럼을 설정합니다.
-    void SetLens(float fovY, float aspect, float zn, float zf);
+    // 프러스트럼을 설정합니다. ReversedInfinite이면 zf는 투영에 쓰이지 않고 컬링 프러스텀의 원거리가
+    // 됩니다. 이때 zf가 무한대이거나 zn의 100만 배보다 멀면 100만 배로 잘립니다.
+    void SetLens(float fovY, float aspect, float zn, float zf, DepthMode depthMode = DepthMode::Standard);
+    DepthMode GetDepthMode() const;
 
     // LookAt 파라미터를 통해 카메라 스페이스를 정의합니다.
     void LookAt(DirectX::FXMVECTOR pos, DirectX::FXMVECTOR target, DirectX::FXMVECTOR worldUp);
@@ -60,6 +91,42 @@ public:
     DirectX::XMFLOAT4X4 GetView4x4f() const;
     DirectX::XMFLOAT4X4 GetProj4x4f() const;
 
+    // 뷰/프로젝션에서 유도된 메트릭스들입니다. 처음 요청될 때 계산되고 카메라가 바뀔 때까지 캐쉬됩니다.
+    DirectX::XMMATRIX GetInvView() const;
+    DirectX::XMMATRIX GetInvProj() const;
+    DirectX::XMMATRIX GetViewProj() const;
+    DirectX::XMMATRIX GetInvViewProj() const;
+
+    // 월드 스페이스 프러스텀 평면 6개(왼쪽, 오른쪽, 아래, 위, 가까운, 먼 순서)입니다. 먼 평면은
+    // GetCullFarZ 거리에 있습니다.
+    const DirectX::XMFLOAT4* GetFrustumPlanes() const;
+
+    // 뷰 스페이스와 월드 스페이스의 프러스텀입니다.
+    const DirectX::BoundingFrustum& GetViewFrustum() const;
+    const DirectX::BoundingFrustum& GetFrustum() const;
+
+    // 뷰나 프로젝션 메트릭스가 바뀔 때마다 증가합니다. 값이 같으면 위의 결과도 모두 같습니다.
+    std::uint64_t GetGeneration() const;
+
+    // 한 프레임의 입력과 UpdateViewMatrix가 끝난 뒤 프레임 시간으로 호출해서 속도와 각속도를 갱신합니다.
+    // SetPosition과 LookAt은 순간 이동으로 취급해서 속도를 0으로 되돌립니다.
+    void UpdateMotion(float dt);
+
+    // 월드 스페이스 속도(초당 거리)와 오른쪽 축/월드 Y축에 대한 각속도(초당 라디안)입니다.
+    DirectX::XMVECTOR GetVelocity() const;
+    float GetPitchRate() const;
+    float GetYawRate() const;
+
+    // 카메라 스페이스 속도와 각속도가 유지된다고 가정한 seconds초 뒤의 월드 스페이스 프러스텀입니다.
+    // 걸으면서 돌면 곡선을 따라갑니다.
+    // N 프레임 뒤를 원하면 N * DeltaTime을 넘깁니다.
+    void GetPredictedFrustum(float seconds, DirectX::BoundingFrustum& frustum) const;
+
+    // 카메라 스페이스 속도와 각속도가 유지된다고 가정하고 지금부터 seconds초 뒤까지 프러스텀이 지나가는
+    // 공간을 감싸는 평면 6개입니다. 걸으면서 돌면 곡선을 따라갑니다. GetFrustumPlanes와 순서와 방향이
+    // 같으므로 같은 컬러에 그대로 넘길 수 있습니다. N 프레임 뒤까지를 원하면 N * DeltaTime을 넘깁니다.
+    void GetSweptFrustumPlanes(float seconds, DirectX::XMFLOAT4 planes[6]) const;
+
     // 카메라를 거리 d만큼 횡/축 이동합니다.
     void Strafe(float d);
     void Walk(float d);
@@ -71,6 +138,12 @@ public:
     // 카메라의 위치/방향이 수정된 뒤에 뷰 메트릭스를 다시 계산하기 위해 호출합니다.
     void UpdateViewMatrix();
 
+private:
+    void UpdateProjDerived() const;
+    void UpdateViewDerived() const;
+
+    DirectX::XMMATRIX GetPredictedInvView(float seconds) const;
+
 private:
     // 세계 공간에서의 카메라 좌표계.
     DirectX::XMFLOAT3 mPosition = {0.0f, 0.0f, 0.0f};
@@ -81,14 +154,41 @@ private:
     // 프러스트럼 속성 캐쉬.
     float mNearZ = 0.0f;
     float mFarZ = 0.0f;
+    float mCullFarZ = 0.0f;
     float mAspect = 0.0f;
     float mFovY = 0.0f;
     float mNearWindowHeight = 0.0f;
     float mFarWindowHeight = 0.0f;
+    DepthMode mDepthMode = DepthMode::Standard;
 
     bool mViewDirty = true;
 
     // 뷰/프로젝션 메트릭스 캐쉬.
     DirectX::XMFLOAT4X4 mView = MathHelper::Identity4x4();
     DirectX::XMFLOAT4X4 mProj = MathHelper::Identity4x4();
+
+    std::uint64_t mGeneration = 0;
+
+    // 유도된 값들의 캐쉬. const 함수에서 필요할 때 갱신합니다.
+    mutable bool mProjDerivedDirty = true;
+    mutable bool mViewDerivedDirty = true;
+
+    mutable DirectX::XMFLOAT4X4 mInvView = MathHelper::Identity4x4();
+    mutable DirectX::XMFLOAT4X4 mInvProj = MathHelper::Identity4x4();
+    mutable DirectX::XMFLOAT4X4 mViewProj = MathHelper::Identity4x4();
+    mutable DirectX::XMFLOAT4X4 mInvViewProj = MathHelper::Identity4x4();
+    mutable DirectX::XMFLOAT4 mFrustumPlanes[6] = {};
+    mutable DirectX::BoundingFrustum mViewFrustum;
+    mutable DirectX::BoundingFrustum mFrustum;
+
+    // 마지막 UpdateMotion 이후의 입력 누적.
+    DirectX::XMFLOAT3 mFrameMove = {0.0f, 0.0f, 0.0f};
+    float mFramePitch = 0.0f;
+    float mFrameYaw = 0.0f;
+    bool mTeleported = true;
+
+    // 부드럽게 만든 속도(카메라 스페이스)와 각속도.
+    DirectX::XMFLOAT3 mLocalVelocity = {0.0f, 0.0f, 0.0f};
+    float mPitchRate = 0.0f;
+    float mYawRate = 0.0f;
 };
\ No newline at end of file
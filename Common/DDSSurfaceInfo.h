@@ -0,0 +1,26 @@
+﻿//***************************************************************************************
+// DDSSurfaceInfo.h
+//
+// Size of one surface of a DXGI format: bits per pixel, row size, row count and byte
+// size, with block compressed formats counting 4x4 blocks as rows.  Split out of the
+// DDS loader so the CPU-only texture planners can use it without Direct3D headers.
+//***************************************************************************************
+
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstddef>
+
+namespace DirectX
+{
+    // 포맷의 픽셀당 비트 수입니다. 알 수 없는 포맷이면 0을 반환합니다.
+    std::size_t GetDDSBitsPerPixel(DXGI_FORMAT fmt);
+
+    // Byte size, row size and row count of one surface (block compressed formats count 4x4 blocks as rows).
+    void GetDDSSurfaceInfo(std::size_t width,
+                           std::size_t height,
+                           DXGI_FORMAT fmt,
+                           std::size_t* outNumBytes,
+                           std::size_t* outRowBytes,
+                           std::size_t* outNumRows);
+}
@@ -21,6 +21,7 @@
 #include <assert.h>
 #include <algorithm>
 #include <memory>
+#include <vector>
 #include <wrl.h>
 
 #include "DDSTextureLoader.h" 
@@ -73,6 +74,13 @@ struct DDS_PIXELFORMAT
 #define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
 #define DDS_WIDTH  0x00000004 // DDSD_WIDTH
 
+#define DDS_HEADER_FLAGS_TEXTURE    0x00001007  // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+#define DDS_HEADER_FLAGS_MIPMAP     0x00020000  // DDSD_MIPMAPCOUNT
+#define DDS_HEADER_FLAGS_LINEARSIZE 0x00080000  // DDSD_LINEARSIZE
+
+#define DDS_SURFACE_FLAGS_TEXTURE 0x00001000 // DDSCAPS_TEXTURE
+#define DDS_SURFACE_FLAGS_MIPMAP  0x00400008 // DDSCAPS_COMPLEX | DDSCAPS_MIPMAP
+
 #define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
 #define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
 #define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
@@ -274,148 +282,7 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
 //--------------------------------------------------------------------------------------
 static size_t BitsPerPixel( _In_ DXGI_FORMAT fmt )
 {
-    switch( fmt )
-    {
-    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:
-    case DXGI_FORMAT_R32G32B32A32_UINT:
-    case DXGI_FORMAT_R32G32B32A32_SINT:
-        return 128;
-
-    case DXGI_FORMAT_R32G32B32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32_FLOAT:
-    case DXGI_FORMAT_R32G32B32_UINT:
-    case DXGI_FORMAT_R32G32B32_SINT:
-        return 96;
-
-    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:
-    case DXGI_FORMAT_R16G16B16A16_UNORM:
-    case DXGI_FORMAT_R16G16B16A16_UINT:
-    case DXGI_FORMAT_R16G16B16A16_SNORM:
-    case DXGI_FORMAT_R16G16B16A16_SINT:
-    case DXGI_FORMAT_R32G32_TYPELESS:
-    case DXGI_FORMAT_R32G32_FLOAT:
-    case DXGI_FORMAT_R32G32_UINT:
-    case DXGI_FORMAT_R32G32_SINT:
-    case DXGI_FORMAT_R32G8X24_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-    case DXGI_FORMAT_Y416:
-    case DXGI_FORMAT_Y210:
-    case DXGI_FORMAT_Y216:
-        return 64;
-
-    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-    case DXGI_FORMAT_R10G10B10A2_UNORM:
-    case DXGI_FORMAT_R10G10B10A2_UINT:
-    case DXGI_FORMAT_R11G11B10_FLOAT:
-    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-    case DXGI_FORMAT_R8G8B8A8_UINT:
-    case DXGI_FORMAT_R8G8B8A8_SNORM:
-    case DXGI_FORMAT_R8G8B8A8_SINT:
-    case DXGI_FORMAT_R16G16_TYPELESS:
-    case DXGI_FORMAT_R16G16_FLOAT:
-    case DXGI_FORMAT_R16G16_UNORM:
-    case DXGI_FORMAT_R16G16_UINT:
-    case DXGI_FORMAT_R16G16_SNORM:
-    case DXGI_FORMAT_R16G16_SINT:
-    case DXGI_FORMAT_R32_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT:
-    case DXGI_FORMAT_R32_FLOAT:
-    case DXGI_FORMAT_R32_UINT:
-    case DXGI_FORMAT_R32_SINT:
-    case DXGI_FORMAT_R24G8_TYPELESS:
-    case DXGI_FORMAT_D24_UNORM_S8_UINT:
-    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-    case DXGI_FORMAT_B8G8R8X8_UNORM:
-    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-    case DXGI_FORMAT_AYUV:
-    case DXGI_FORMAT_Y410:
-    case DXGI_FORMAT_YUY2:
-        return 32;
-
-    case DXGI_FORMAT_P010:
-    case DXGI_FORMAT_P016:
-        return 24;
-
-    case DXGI_FORMAT_R8G8_TYPELESS:
-    case DXGI_FORMAT_R8G8_UNORM:
-    case DXGI_FORMAT_R8G8_UINT:
-    case DXGI_FORMAT_R8G8_SNORM:
-    case DXGI_FORMAT_R8G8_SINT:
-    case DXGI_FORMAT_R16_TYPELESS:
-    case DXGI_FORMAT_R16_FLOAT:
-    case DXGI_FORMAT_D16_UNORM:
-    case DXGI_FORMAT_R16_UNORM:
-    case DXGI_FORMAT_R16_UINT:
-    case DXGI_FORMAT_R16_SNORM:
-    case DXGI_FORMAT_R16_SINT:
-    case DXGI_FORMAT_B5G6R5_UNORM:
-    case DXGI_FORMAT_B5G5R5A1_UNORM:
-    case DXGI_FORMAT_A8P8:
-    case DXGI_FORMAT_B4G4R4A4_UNORM:
-        return 16;
-
-    case DXGI_FORMAT_NV12:
-    case DXGI_FORMAT_420_OPAQUE:
-    case DXGI_FORMAT_NV11:
-        return 12;
-
-    case DXGI_FORMAT_R8_TYPELESS:
-    case DXGI_FORMAT_R8_UNORM:
-    case DXGI_FORMAT_R8_UINT:
-    case DXGI_FORMAT_R8_SNORM:
-    case DXGI_FORMAT_R8_SINT:
-    case DXGI_FORMAT_A8_UNORM:
-    case DXGI_FORMAT_AI44:
-    case DXGI_FORMAT_IA44:
-    case DXGI_FORMAT_P8:
-        return 8;
-
-    case DXGI_FORMAT_R1_UNORM:
-        return 1;
-
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC4_TYPELESS:
-    case DXGI_FORMAT_BC4_UNORM:
-    case DXGI_FORMAT_BC4_SNORM:
-        return 4;
-
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_BC5_TYPELESS:
-    case DXGI_FORMAT_BC5_UNORM:
-    case DXGI_FORMAT_BC5_SNORM:
-    case DXGI_FORMAT_BC6H_TYPELESS:
-    case DXGI_FORMAT_BC6H_UF16:
-    case DXGI_FORMAT_BC6H_SF16:
-    case DXGI_FORMAT_BC7_TYPELESS:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
-        return 8;
-
-    default:
-        return 0;
-    }
+    return DirectX::GetDDSBitsPerPixel( fmt );
 }
 
 
@@ -429,125 +296,7 @@ static void GetSurfaceInfo( _In_ size_t width,
                             _Out_opt_ size_t* outRowBytes,
                             _Out_opt_ size_t* outNumRows )
 {
-    size_t numBytes = 0;
-    size_t rowBytes = 0;
-    size_t numRows = 0;
-
-    bool bc = false;
-    bool packed = false;
-    bool planar = false;
-    size_t bpe = 0;
-    switch (fmt)
-    {
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC4_TYPELESS:
-    case DXGI_FORMAT_BC4_UNORM:
-    case DXGI_FORMAT_BC4_SNORM:
-        bc=true;
-        bpe = 8;
-        break;
-
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_BC5_TYPELESS:
-    case DXGI_FORMAT_BC5_UNORM:
-    case DXGI_FORMAT_BC5_SNORM:
-    case DXGI_FORMAT_BC6H_TYPELESS:
-    case DXGI_FORMAT_BC6H_UF16:
-    case DXGI_FORMAT_BC6H_SF16:
-    case DXGI_FORMAT_BC7_TYPELESS:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
-        bc = true;
-        bpe = 16;
-        break;
-
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:
-    case DXGI_FORMAT_YUY2:
-        packed = true;
-        bpe = 4;
-        break;
-
-    case DXGI_FORMAT_Y210:
-    case DXGI_FORMAT_Y216:
-        packed = true;
-        bpe = 8;
-        break;
-
-    case DXGI_FORMAT_NV12:
-    case DXGI_FORMAT_420_OPAQUE:
-        planar = true;
-        bpe = 2;
-        break;
-
-    case DXGI_FORMAT_P010:
-    case DXGI_FORMAT_P016:
-        planar = true;
-        bpe = 4;
-        break;
-    }
-
-    if (bc)
-    {
-        size_t numBlocksWide = 0;
-        if (width > 0)
-        {
-            numBlocksWide = std::max<size_t>( 1, (width + 3) / 4 );
-        }
-        size_t numBlocksHigh = 0;
-        if (height > 0)
-        {
-            numBlocksHigh = std::max<size_t>( 1, (height + 3) / 4 );
-        }
-        rowBytes = numBlocksWide * bpe;
-        numRows = numBlocksHigh;
-        numBytes = rowBytes * numBlocksHigh;
-    }
-    else if (packed)
-    {
-        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
-        numRows = height;
-        numBytes = rowBytes * height;
-    }
-    else if ( fmt == DXGI_FORMAT_NV11 )
-    {
-        rowBytes = ( ( width + 3 ) >> 2 ) * 4;
-        numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
-        numBytes = rowBytes * numRows;
-    }
-    else if (planar)
-    {
-        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
-        numBytes = ( rowBytes * height ) + ( ( rowBytes * height + 1 ) >> 1 );
-        numRows = height + ( ( height + 1 ) >> 1 );
-    }
-    else
-    {
-        size_t bpp = BitsPerPixel( fmt );
-        rowBytes = ( width * bpp + 7 ) / 8; // round up to nearest byte
-        numRows = height;
-        numBytes = rowBytes * height;
-    }
-
-    if (outNumBytes)
-    {
-        *outNumBytes = numBytes;
-    }
-    if (outRowBytes)
-    {
-        *outRowBytes = rowBytes;
-    }
-    if (outNumRows)
-    {
-        *outNumRows = numRows;
-    }
+    DirectX::GetDDSSurfaceInfo( width, height, fmt, outNumBytes, outRowBytes, outNumRows );
 }
 
 
@@ -797,6 +546,27 @@ static DXGI_FORMAT MakeSRGB( _In_ DXGI_FORMAT format )
 }
 
 
+//--------------------------------------------------------------------------------------
+static bool IsSRGB( _In_ DXGI_FORMAT format )
+{
+    // The formats MakeSRGB converts to.
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
 //--------------------------------------------------------------------------------------
 static HRESULT FillInitData( _In_ size_t width,
                              _In_ size_t height,
@@ -1269,11 +1039,13 @@ static HRESULT CreateD3DResources12(
 		texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 		texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
+		// Without a command list the caller uploads the subresources itself (for example
+		// through a shared staging ring), so create the texture ready to be copied into.
 		hr = device->CreateCommittedResource(
 			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
 			D3D12_HEAP_FLAG_NONE,
 			&texDesc,
-			D3D12_RESOURCE_STATE_COMMON,
+			cmdList ? D3D12_RESOURCE_STATE_COMMON : D3D12_RESOURCE_STATE_COPY_DEST,
 			nullptr,
 			IID_PPV_ARGS(&texture)
 			);
@@ -1283,7 +1055,7 @@ static HRESULT CreateD3DResources12(
 			texture = nullptr;
 			return hr;
 		}
-		else
+		else if (cmdList)
 		{
 			const UINT num2DSubresources = texDesc.DepthOrArraySize * texDesc.MipLevels;
 			const UINT64 uploadBufferSize = GetRequiredIntermediateSize(texture.Get(), 0, num2DSubresources);
@@ -1669,29 +1441,28 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
     return hr;
 }
 
-static HRESULT CreateTextureFromDDS12(
-	_In_ ID3D12Device* device,
-	_In_opt_ ID3D12GraphicsCommandList* cmdList,
+//--------------------------------------------------------------------------------------
+static HRESULT GetTextureInfoFromDDS12(
 	_In_ const DDS_HEADER* header,
-	_In_reads_bytes_(bitSize) const uint8_t* bitData,
-	_In_ size_t bitSize,
-	_In_ size_t maxsize,
-	_In_ bool forceSRGB,
-	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap)
+	_Out_ uint32_t& resDim,
+	_Out_ UINT& width,
+	_Out_ UINT& height,
+	_Out_ UINT& depth,
+	_Out_ size_t& mipCount,
+	_Out_ UINT& arraySize,
+	_Out_ DXGI_FORMAT& format,
+	_Out_ bool& isCubeMap)
 {
-	HRESULT hr = S_OK;
+	width = header->width;
+	height = header->height;
+	depth = header->depth;
 
-	UINT width = header->width;
-	UINT height = header->height;
-	UINT depth = header->depth;
+	resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+	arraySize = 1;
+	format = DXGI_FORMAT_UNKNOWN;
+	isCubeMap = false;
 
-	uint32_t resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
-	UINT arraySize = 1;
-	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
-	bool isCubeMap = false;
-
-	size_t mipCount = header->mipMapCount;
+	mipCount = header->mipMapCount;
 	if (0 == mipCount) mipCount = 1;
 
 	if ((header->ddspf.flags & DDS_FOURCC) && (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
@@ -1835,6 +1606,38 @@ static HRESULT CreateTextureFromDDS12(
 		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 	}
 
+	return S_OK;
+}
+
+static HRESULT CreateTextureFromDDS12(
+	_In_ ID3D12Device* device,
+	_In_opt_ ID3D12GraphicsCommandList* cmdList,
+	_In_ const DDS_HEADER* header,
+	_In_reads_bytes_(bitSize) const uint8_t* bitData,
+	_In_ size_t bitSize,
+	_In_ size_t maxsize,
+	_In_ bool forceSRGB,
+	ComPtr<ID3D12Resource>& texture,
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	_Out_opt_ std::vector<D3D12_SUBRESOURCE_DATA>* subresources = nullptr)
+{
+	HRESULT hr = S_OK;
+
+	uint32_t resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+	UINT width = 0;
+	UINT height = 0;
+	UINT depth = 0;
+	size_t mipCount = 0;
+	UINT arraySize = 1;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	bool isCubeMap = false;
+
+	hr = GetTextureInfoFromDDS12(header, resDim, width, height, depth, mipCount, arraySize, format, isCubeMap);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
 	// Create the texture
 	std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(
 		new (std::nothrow) D3D12_SUBRESOURCE_DATA[mipCount * arraySize]
@@ -1870,6 +1673,11 @@ static HRESULT CreateTextureFromDDS12(
 			textureUploadHeap);
 	}
 
+	if (SUCCEEDED(hr) && subresources)
+	{
+		subresources->assign(initData.get(), initData.get() + (mipCount - skipMip) * arraySize);
+	}
+
 	return hr;
 }
 
@@ -2228,6 +2036,409 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 	return hr;
 }
 
+HRESULT DirectX::LoadDDSTextureFromFile12(_In_ ID3D12Device* device,
+	_In_z_ const wchar_t* szFileName,
+	_Out_ ComPtr<ID3D12Resource>& texture,
+	_Out_ std::unique_ptr<uint8_t[]>& ddsData,
+	_Out_ std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+	_In_ size_t maxsize,
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode)
+{
+	if (texture)
+	{
+		texture = nullptr;
+	}
+	if (alphaMode)
+	{
+		*alphaMode = DDS_ALPHA_MODE_UNKNOWN;
+	}
+	subresources.clear();
+
+	if (!device || !szFileName)
+	{
+		return E_INVALIDARG;
+	}
+
+	DDS_HEADER* header = nullptr;
+	uint8_t* bitData = nullptr;
+	size_t bitSize = 0;
+
+	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsData, &header, &bitData, &bitSize);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// The subresource data points into ddsData, so the caller keeps it alive until the copies are recorded.
+	ComPtr<ID3D12Resource> noUploadHeap;
+	hr = CreateTextureFromDDS12(device, nullptr, header,
+		bitData, bitSize, maxsize, false, texture, noUploadHeap, &subresources);
+
+	if (SUCCEEDED(hr))
+	{
+		if (alphaMode)
+			*alphaMode = GetAlphaMode(header);
+	}
+
+	return hr;
+}
+
+//--------------------------------------------------------------------------------------
+static HRESULT GetHeaderFromMemory12(_In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+	_In_ size_t ddsDataSize,
+	_Out_ const DDS_HEADER** header,
+	_Out_ ptrdiff_t* offset)
+{
+	if (!ddsData || ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t)))
+	{
+		return E_INVALIDARG;
+	}
+
+	uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
+	if (dwMagicNumber != DDS_MAGIC)
+	{
+		return E_FAIL;
+	}
+
+	auto hdr = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
+
+	// Verify header to validate DDS file
+	if (hdr->size != sizeof(DDS_HEADER) ||
+		hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+	{
+		return E_FAIL;
+	}
+
+	// Check for DX10 extension
+	bool bDXT10Header = false;
+	if ((hdr->ddspf.flags & DDS_FOURCC) &&
+		(MAKEFOURCC('D', 'X', '1', '0') == hdr->ddspf.fourCC))
+	{
+		// Must be long enough for both headers and magic value
+		if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
+		{
+			return E_FAIL;
+		}
+
+		bDXT10Header = true;
+	}
+
+	*header = hdr;
+	*offset = sizeof(uint32_t)
+		+ sizeof(DDS_HEADER)
+		+ (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
+
+	return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::GetDDSTextureDescFromMemory12(
+	const uint8_t* ddsData,
+	size_t ddsDataSize,
+	D3D12_RESOURCE_DESC& texDesc)
+{
+	ZeroMemory(&texDesc, sizeof(D3D12_RESOURCE_DESC));
+
+	const DDS_HEADER* header = nullptr;
+	ptrdiff_t offset = 0;
+	HRESULT hr = GetHeaderFromMemory12(ddsData, ddsDataSize, &header, &offset);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	uint32_t resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+	UINT width = 0;
+	UINT height = 0;
+	UINT depth = 0;
+	size_t mipCount = 0;
+	UINT arraySize = 1;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	bool isCubeMap = false;
+
+	hr = GetTextureInfoFromDDS12(header, resDim, width, height, depth, mipCount, arraySize, format, isCubeMap);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	texDesc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(resDim);
+	texDesc.Width = width;
+	texDesc.Height = height;
+	texDesc.DepthOrArraySize = (resDim == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? (uint16_t)depth : (uint16_t)arraySize;
+	texDesc.MipLevels = (uint16_t)mipCount;
+	texDesc.Format = format;
+	texDesc.SampleDesc.Count = 1;
+	texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::LoadDDSTextureFromMemory12(
+	ID3D12Device* device,
+	const uint8_t* ddsData,
+	size_t ddsDataSize,
+	ComPtr<ID3D12Resource>& texture,
+	std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+	size_t maxsize,
+	DDS_ALPHA_MODE* alphaMode)
+{
+	if (texture)
+	{
+		texture = nullptr;
+	}
+	if (alphaMode)
+	{
+		*alphaMode = DDS_ALPHA_MODE_UNKNOWN;
+	}
+	subresources.clear();
+
+	if (!device)
+	{
+		return E_INVALIDARG;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	ptrdiff_t offset = 0;
+	HRESULT hr = GetHeaderFromMemory12(ddsData, ddsDataSize, &header, &offset);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// The subresource data points into ddsData, so the caller keeps it alive until the copies are recorded.
+	ComPtr<ID3D12Resource> noUploadHeap;
+	hr = CreateTextureFromDDS12(device, nullptr, header,
+		ddsData + offset, ddsDataSize - offset, maxsize, false, texture, noUploadHeap, &subresources);
+
+	if (SUCCEEDED(hr))
+	{
+		if (alphaMode)
+			*alphaMode = GetAlphaMode(header);
+	}
+
+	return hr;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::GetDDSSubresourcesFromMemory12(
+	const uint8_t* ddsData,
+	size_t ddsDataSize,
+	D3D12_RESOURCE_DESC& texDesc,
+	std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+	bool* isCubeMap)
+{
+	subresources.clear();
+	if (isCubeMap)
+	{
+		*isCubeMap = false;
+	}
+
+	HRESULT hr = GetDDSTextureDescFromMemory12(ddsData, ddsDataSize, texDesc);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	ptrdiff_t offset = 0;
+	hr = GetHeaderFromMemory12(ddsData, ddsDataSize, &header, &offset);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	uint32_t resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+	UINT width = 0;
+	UINT height = 0;
+	UINT depth = 0;
+	size_t mipCount = 0;
+	UINT arraySize = 1;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	bool cubeMap = false;
+
+	hr = GetTextureInfoFromDDS12(header, resDim, width, height, depth, mipCount, arraySize, format, cubeMap);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	subresources.resize(mipCount * arraySize);
+
+	size_t skipMip = 0;
+	size_t twidth = 0;
+	size_t theight = 0;
+	size_t tdepth = 0;
+
+	hr = FillInitData12(width, height, depth, mipCount, arraySize, format, 0,
+		ddsDataSize - offset, ddsData + offset,
+		twidth, theight, tdepth, skipMip, subresources.data());
+
+	if (FAILED(hr))
+	{
+		subresources.clear();
+		return hr;
+	}
+
+	if (isCubeMap)
+	{
+		*isCubeMap = cubeMap;
+	}
+
+	return S_OK;
+}
+
+_Use_decl_annotations_
+bool DirectX::IsDDSFormatSRGB(DXGI_FORMAT fmt)
+{
+	return IsSRGB(fmt);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::SaveDDSTextureToMemory12(const D3D12_RESOURCE_DESC& texDesc,
+	const D3D12_SUBRESOURCE_DATA* subresources,
+	UINT subresourceCount,
+	std::vector<uint8_t>& ddsData)
+{
+	ddsData.clear();
+
+	if (!subresources)
+	{
+		return E_INVALIDARG;
+	}
+
+	if (texDesc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D
+		|| texDesc.MipLevels == 0
+		|| subresourceCount != (UINT)texDesc.MipLevels * texDesc.DepthOrArraySize
+		|| BitsPerPixel(texDesc.Format) == 0)
+	{
+		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+	}
+
+	DDS_HEADER header = {};
+	header.size = sizeof(DDS_HEADER);
+	header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_LINEARSIZE;
+	header.height = texDesc.Height;
+	header.width = (uint32_t)texDesc.Width;
+	header.mipMapCount = texDesc.MipLevels;
+	header.caps = DDS_SURFACE_FLAGS_TEXTURE;
+	if (texDesc.MipLevels > 1)
+	{
+		header.flags |= DDS_HEADER_FLAGS_MIPMAP;
+		header.caps |= DDS_SURFACE_FLAGS_MIPMAP;
+	}
+
+	size_t numBytes = 0;
+	GetSurfaceInfo((size_t)texDesc.Width, texDesc.Height, texDesc.Format, &numBytes, nullptr, nullptr);
+	header.pitchOrLinearSize = (uint32_t)numBytes;
+
+	header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+	header.ddspf.flags = DDS_FOURCC;
+
+	// Legacy readers understand the FourCC codes; everything else goes in the DX10 extension.
+	bool writeDXT10Header = false;
+	if (texDesc.DepthOrArraySize == 1 && texDesc.Format == DXGI_FORMAT_BC1_UNORM)
+		header.ddspf.fourCC = MAKEFOURCC('D', 'X', 'T', '1');
+	else if (texDesc.DepthOrArraySize == 1 && texDesc.Format == DXGI_FORMAT_BC3_UNORM)
+		header.ddspf.fourCC = MAKEFOURCC('D', 'X', 'T', '5');
+	else if (texDesc.DepthOrArraySize == 1 && texDesc.Format == DXGI_FORMAT_BC5_UNORM)
+		header.ddspf.fourCC = MAKEFOURCC('A', 'T', 'I', '2');
+	else
+	{
+		header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+		writeDXT10Header = true;
+	}
+
+	DDS_HEADER_DXT10 headerDXT10 = {};
+	headerDXT10.dxgiFormat = texDesc.Format;
+	headerDXT10.resourceDimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	headerDXT10.arraySize = texDesc.DepthOrArraySize;
+
+	auto appendBytes = [&ddsData](const void* data, size_t size)
+	{
+		auto bytes = reinterpret_cast<const uint8_t*>(data);
+		ddsData.insert(ddsData.end(), bytes, bytes + size);
+	};
+
+	appendBytes(&DDS_MAGIC, sizeof(uint32_t));
+	appendBytes(&header, sizeof(DDS_HEADER));
+	if (writeDXT10Header)
+		appendBytes(&headerDXT10, sizeof(DDS_HEADER_DXT10));
+
+	// DDS stores every mip of slice 0, then every mip of slice 1 and so on, which is the
+	// same order as the subresource index. Rows are written without any pitch padding.
+	for (UINT i = 0; i < subresourceCount; ++i)
+	{
+		UINT mip = i % texDesc.MipLevels;
+		size_t w = std::max<size_t>(1, (size_t)(texDesc.Width >> mip));
+		size_t h = std::max<size_t>(1, texDesc.Height >> mip);
+
+		size_t rowBytes = 0;
+		size_t numRows = 0;
+		GetSurfaceInfo(w, h, texDesc.Format, nullptr, &rowBytes, &numRows);
+
+		auto srcRow = reinterpret_cast<const uint8_t*>(subresources[i].pData);
+		for (size_t row = 0; row < numRows; ++row)
+		{
+			appendBytes(srcRow, rowBytes);
+			srcRow += subresources[i].RowPitch;
+		}
+	}
+
+	return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::SaveDDSTextureToFile12(const wchar_t* szFileName,
+	const D3D12_RESOURCE_DESC& texDesc,
+	const D3D12_SUBRESOURCE_DATA* subresources,
+	UINT subresourceCount)
+{
+	if (!szFileName)
+	{
+		return E_INVALIDARG;
+	}
+
+	std::vector<uint8_t> ddsData;
+	HRESULT hr = SaveDDSTextureToMemory12(texDesc, subresources, subresourceCount, ddsData);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// open the file
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+	ScopedHandle hFile(safe_handle(CreateFile2(szFileName,
+		GENERIC_WRITE,
+		0,
+		CREATE_ALWAYS,
+		nullptr)));
+#else
+	ScopedHandle hFile(safe_handle(CreateFileW(szFileName,
+		GENERIC_WRITE,
+		0,
+		nullptr,
+		CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr)));
+#endif
+
+	if (!hFile)
+	{
+		return HRESULT_FROM_WIN32(GetLastError());
+	}
+
+	DWORD bytesWritten = 0;
+	if (!WriteFile(hFile.get(), ddsData.data(), (DWORD)ddsData.size(), &bytesWritten, nullptr))
+	{
+		return HRESULT_FROM_WIN32(GetLastError());
+	}
+
+	return (bytesWritten == ddsData.size()) ? S_OK : E_FAIL;
+}
+
 _Use_decl_annotations_
 HRESULT DirectX::CreateDDSTextureFromFile( ID3D11Device* d3dDevice,
                                            ID3D11DeviceContext* d3dContext,
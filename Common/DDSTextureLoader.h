@@ -25,10 +25,13 @@
 #include <wrl.h>
 #include <d3d11_1.h>
 #include "d3dx12.h"
+#include "DDSSurfaceInfo.h"
 
 #pragma warning(push)
 #pragma warning(disable : 4005)
 #include <stdint.h>
+#include <memory>
+#include <vector>
 
 #pragma warning(pop)
 
@@ -92,6 +95,56 @@ namespace DirectX
 		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 		                               );
 
+	// Creates the texture in the COPY_DEST state without an upload heap and returns its
+	// subresources (pointing into ddsData) so several textures can share one staging buffer.
+	HRESULT LoadDDSTextureFromFile12(_In_ ID3D12Device* device,
+		                             _In_z_ const wchar_t* szFileName,
+		                             _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                             _Out_ std::unique_ptr<uint8_t[]>& ddsData,
+		                             _Out_ std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+		                             _In_ size_t maxsize = 0,
+		                             _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                             );
+
+	HRESULT LoadDDSTextureFromMemory12(_In_ ID3D12Device* device,
+		                               _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+		                               _In_ size_t ddsDataSize,
+		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                               _Out_ std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+		                               _In_ size_t maxsize = 0,
+		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                               );
+
+	// Reads only the header and fills in the description of the full mip chain, without a device.
+	HRESULT GetDDSTextureDescFromMemory12(_In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+		                                  _In_ size_t ddsDataSize,
+		                                  _Out_ D3D12_RESOURCE_DESC& texDesc
+		                                  );
+
+	// Returns the subresources of every mip and slice in the file (pointing into ddsData), without a device.
+	HRESULT GetDDSSubresourcesFromMemory12(_In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+		                                   _In_ size_t ddsDataSize,
+		                                   _Out_ D3D12_RESOURCE_DESC& texDesc,
+		                                   _Out_ std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+		                                   _Out_opt_ bool* isCubeMap = nullptr
+		                                   );
+
+	// True for the sRGB formats the loader can produce, so their texels should be filtered in linear space.
+	bool IsDDSFormatSRGB(_In_ DXGI_FORMAT fmt);
+
+	// Writes a 2D texture (or texture array) and its mip chain as a DDS file.
+	HRESULT SaveDDSTextureToMemory12(_In_ const D3D12_RESOURCE_DESC& texDesc,
+		                             _In_reads_(subresourceCount) const D3D12_SUBRESOURCE_DATA* subresources,
+		                             _In_ UINT subresourceCount,
+		                             _Out_ std::vector<uint8_t>& ddsData
+		                             );
+
+	HRESULT SaveDDSTextureToFile12(_In_z_ const wchar_t* szFileName,
+		                           _In_ const D3D12_RESOURCE_DESC& texDesc,
+		                           _In_reads_(subresourceCount) const D3D12_SUBRESOURCE_DATA* subresources,
+		                           _In_ UINT subresourceCount
+		                           );
+
     // Standard version with optional auto-gen mipmap support
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_opt_ ID3D11DeviceContext* d3dContext,
@@ -0,0 +1,266 @@
+﻿//***************************************************************************************
+// DDSTextureTools.cpp
+//***************************************************************************************
+
+#include "DDSTextureTools.h"
+#include "DDSTextureLoader.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+//---------------------------------------------------------------------------------------
+// 압축된 밉 체인 저장
+//---------------------------------------------------------------------------------------
+
+// 밉 체인을 DDS 로더가 쓸 수 있는 리소스 설명과 서브리소스들로 바꿉니다.
+static bool GetMipChainSubresources(const std::vector<CompressedImage>& mipChain, D3D12_RESOURCE_DESC& texDesc,
+    std::vector<D3D12_SUBRESOURCE_DATA>& subresources)
+{
+    if (mipChain.empty())
+        return false;
+
+    const CompressedImage& top = mipChain[0];
+
+    texDesc = {};
+    texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    texDesc.Width = top.Width;
+    texDesc.Height = top.Height;
+    texDesc.DepthOrArraySize = 1;
+    texDesc.MipLevels = (UINT16)mipChain.size();
+    texDesc.Format = top.Format;
+    texDesc.SampleDesc.Count = 1;
+
+    subresources.resize(mipChain.size());
+    for (size_t mip = 0; mip < mipChain.size(); ++mip)
+    {
+        const CompressedImage& image = mipChain[mip];
+
+        // 각 밉은 이전 밉의 절반 크기여야 합니다.
+        if (image.Format != top.Format ||
+            image.Width != std::max<std::uint32_t>(1, top.Width >> mip) ||
+            image.Height != std::max<std::uint32_t>(1, top.Height >> mip))
+        {
+            return false;
+        }
+
+        subresources[mip].pData = image.Blocks.data();
+        subresources[mip].RowPitch = image.RowPitch;
+        subresources[mip].SlicePitch = image.Blocks.size();
+    }
+
+    return true;
+}
+
+bool SaveCompressedDDSToMemory(const std::vector<CompressedImage>& mipChain, std::vector<std::uint8_t>& ddsData)
+{
+    D3D12_RESOURCE_DESC texDesc;
+    std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+    if (!GetMipChainSubresources(mipChain, texDesc, subresources))
+        return false;
+
+    return SUCCEEDED(DirectX::SaveDDSTextureToMemory12(texDesc, subresources.data(), (UINT)subresources.size(), ddsData));
+}
+
+bool SaveCompressedDDSFile(const std::wstring& filename, const std::vector<CompressedImage>& mipChain)
+{
+    D3D12_RESOURCE_DESC texDesc;
+    std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+    if (!GetMipChainSubresources(mipChain, texDesc, subresources))
+        return false;
+
+    return SUCCEEDED(DirectX::SaveDDSTextureToFile12(filename.c_str(), texDesc,
+                                                     subresources.data(), (UINT)subresources.size()));
+}
+
+//---------------------------------------------------------------------------------------
+// DDS 밉 체인
+//---------------------------------------------------------------------------------------
+
+static bool IsBGRA(DXGI_FORMAT format)
+{
+    return format == DXGI_FORMAT_B8G8R8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+        format == DXGI_FORMAT_B8G8R8X8_UNORM || format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+}
+
+static bool IsRGBA(DXGI_FORMAT format)
+{
+    return format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+}
+
+static bool IsXChannel(DXGI_FORMAT format)
+{
+    return format == DXGI_FORMAT_B8G8R8X8_UNORM || format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+}
+
+// 다시 압축할 때 사용할 블록 포맷입니다. BC2는 인코더가 없으므로 BC3으로 씁니다.
+static bool GetBlockFormat(DXGI_FORMAT format, BlockFormat& blockFormat)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        blockFormat = BlockFormat::BC1;
+        return true;
+
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        blockFormat = BlockFormat::BC3;
+        return true;
+
+    case DXGI_FORMAT_BC5_UNORM:
+        blockFormat = BlockFormat::BC5;
+        return true;
+
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        blockFormat = BlockFormat::BC7;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static bool DecodeSurface(const D3D12_SUBRESOURCE_DATA& surface, DXGI_FORMAT format,
+    std::uint32_t width, std::uint32_t height, RgbaImage& image)
+{
+    const std::uint8_t* bits = reinterpret_cast<const std::uint8_t*>(surface.pData);
+
+    if (IsRGBA(format) || IsBGRA(format))
+    {
+        image.Resize(width, height);
+        for (std::uint32_t y = 0; y < height; ++y)
+        {
+            const std::uint8_t* src = bits + (size_t)y * surface.RowPitch;
+            std::uint8_t* dst = image.GetPixel(0, y);
+            for (std::uint32_t x = 0; x < width; ++x, src += 4, dst += 4)
+            {
+                const bool bgra = IsBGRA(format);
+                dst[0] = bgra ? src[2] : src[0];
+                dst[1] = src[1];
+                dst[2] = bgra ? src[0] : src[2];
+                dst[3] = IsXChannel(format) ? 255 : src[3];
+            }
+        }
+
+        return true;
+    }
+
+    BlockFormat blockFormat;
+    if (!GetBlockFormat(format, blockFormat))
+        return false;
+
+    CompressedImage compressed;
+    compressed.Format = format;
+    compressed.Width = width;
+    compressed.Height = height;
+    compressed.RowPitch = (std::uint32_t)surface.RowPitch;
+    compressed.Blocks.assign(bits, bits + surface.SlicePitch);
+
+    return BlockCompressor::Decompress(compressed, image);
+}
+
+static void EncodeSurface(const RgbaImage& image, DXGI_FORMAT format, CompressionQuality quality,
+    std::vector<std::uint8_t>& bits, std::uint32_t& rowPitch)
+{
+    BlockFormat blockFormat;
+    if (GetBlockFormat(format, blockFormat))
+    {
+        CompressedImage compressed;
+        BlockCompressor(blockFormat, quality, DirectX::IsDDSFormatSRGB(format)).Compress(image, compressed);
+
+        rowPitch = compressed.RowPitch;
+        bits.swap(compressed.Blocks);
+        return;
+    }
+
+    rowPitch = image.Width * 4;
+    bits = image.Pixels;
+
+    if (IsBGRA(format))
+    {
+        for (size_t i = 0; i < bits.size(); i += 4)
+        {
+            std::swap(bits[i], bits[i + 2]);
+            if (IsXChannel(format))
+                bits[i + 3] = 255;
+        }
+    }
+}
+
+bool GenerateDDSMipChain(const std::uint8_t* ddsData, size_t ddsDataSize, const MipGenerationOptions& options,
+    std::vector<std::uint8_t>& result, CompressionQuality quality)
+{
+    D3D12_RESOURCE_DESC texDesc;
+    std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+    bool isCubeMap = false;
+    if (FAILED(DirectX::GetDDSSubresourcesFromMemory12(ddsData, ddsDataSize, texDesc, subresources, &isCubeMap)))
+        return false;
+
+    if (texDesc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || isCubeMap)
+        return false;
+
+    const std::uint32_t width = (std::uint32_t)texDesc.Width;
+    const std::uint32_t height = texDesc.Height;
+    const std::uint32_t arraySize = texDesc.DepthOrArraySize;
+
+    // 슬라이스마다 최상위 밉만 풉니다.
+    std::vector<RgbaImage> slices(arraySize);
+    for (std::uint32_t slice = 0; slice < arraySize; ++slice)
+    {
+        if (!DecodeSurface(subresources[slice * texDesc.MipLevels], texDesc.Format, width, height, slices[slice]))
+            return false;
+    }
+
+    MipGenerationOptions generatorOptions = options;
+    generatorOptions.Srgb = DirectX::IsDDSFormatSRGB(texDesc.Format);
+
+    std::vector<std::vector<RgbaImage>> mipChains;
+    MipGenerator(generatorOptions).GenerateArray(slices, mipChains);
+
+    DXGI_FORMAT format = texDesc.Format;
+    if (format == DXGI_FORMAT_BC2_UNORM)
+        format = DXGI_FORMAT_BC3_UNORM;
+    else if (format == DXGI_FORMAT_BC2_UNORM_SRGB)
+        format = DXGI_FORMAT_BC3_UNORM_SRGB;
+
+    const std::uint32_t mipLevels = (std::uint32_t)mipChains[0].size();
+    const std::uint32_t surfaceCount = arraySize * mipLevels;
+
+    // 밉들은 서로 독립적이므로 모든 슬라이스와 밉을 병렬로 압축합니다.
+    // 포맷이 같으면 최상위 밉은 다시 압축하지 않고 원본 블록을 그대로 씁니다.
+    std::vector<std::vector<std::uint8_t>> surfaceBits(surfaceCount);
+    std::vector<std::uint32_t> rowPitches(surfaceCount);
+    JobSystem::Default().ParallelFor(0, (int)surfaceCount, [&](int i)
+    {
+        const std::uint32_t slice = i / mipLevels;
+        const std::uint32_t mip = i % mipLevels;
+
+        if (mip == 0 && format == texDesc.Format)
+        {
+            const D3D12_SUBRESOURCE_DATA& top = subresources[slice * texDesc.MipLevels];
+            const std::uint8_t* bits = reinterpret_cast<const std::uint8_t*>(top.pData);
+            surfaceBits[i].assign(bits, bits + top.SlicePitch);
+            rowPitches[i] = (std::uint32_t)top.RowPitch;
+        }
+        else
+        {
+            EncodeSurface(mipChains[slice][mip], format, quality, surfaceBits[i], rowPitches[i]);
+        }
+    });
+
+    std::vector<D3D12_SUBRESOURCE_DATA> mipData(surfaceCount);
+    for (std::uint32_t i = 0; i < surfaceCount; ++i)
+    {
+        mipData[i].pData = surfaceBits[i].data();
+        mipData[i].RowPitch = rowPitches[i];
+        mipData[i].SlicePitch = surfaceBits[i].size();
+    }
+
+    D3D12_RESOURCE_DESC mipDesc = texDesc;
+    mipDesc.MipLevels = (UINT16)mipLevels;
+    mipDesc.Format = format;
+
+    return SUCCEEDED(DirectX::SaveDDSTextureToMemory12(mipDesc, mipData.data(), surfaceCount, result));
+}
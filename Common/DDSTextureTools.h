@@ -0,0 +1,23 @@
+﻿//***************************************************************************************
+// DDSTextureTools.h
+//
+// DDS input and output for the CPU texture tools.  BlockCompressor and MipGenerator
+// only work on images in memory; the functions here connect them to the DDS loader,
+// which needs the Direct3D headers.
+//***************************************************************************************
+
+#pragma once
+
+#include "MipGenerator.h"
+#include <string>
+
+// 밉 체인(0번이 가장 상세한 밉)을 하나의 DDS 데이터로 씁니다.
+// 모든 밉은 같은 포맷이고 이전 밉의 절반 크기여야 합니다.
+bool SaveCompressedDDSToMemory(const std::vector<CompressedImage>& mipChain, std::vector<std::uint8_t>& ddsData);
+bool SaveCompressedDDSFile(const std::wstring& filename, const std::vector<CompressedImage>& mipChain);
+
+// DDS 데이터의 최상위 밉으로 전체 밉 체인을 다시 만들어서 같은 포맷의 DDS 데이터로 씁니다.
+// 2D 텍스쳐와 텍스쳐 배열의 RGBA8/BGRA8, BC1/BC2/BC3/BC5/BC7을 지원하고 BC2는 BC3으로 씁니다.
+// 큐브 맵, 3차원 텍스쳐, 그 밖의 포맷이면 false를 반환합니다.
+bool GenerateDDSMipChain(const std::uint8_t* ddsData, size_t ddsDataSize, const MipGenerationOptions& options,
+    std::vector<std::uint8_t>& result, CompressionQuality quality = CompressionQuality::Fast);
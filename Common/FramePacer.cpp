@@ -0,0 +1,126 @@
+﻿//***************************************************************************************
+// FramePacer.cpp
+//***************************************************************************************
+
+#include "FramePacer.h"
+#include "GameTimer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+FramePacer::FramePacer()
+    : FramePacer(&GameTimer::Now, [](std::int64_t nanoseconds)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(nanoseconds));
+        })
+{
+}
+
+FramePacer::FramePacer(NowFunction now, SleepFunction sleep)
+    : mNow(std::move(now)), mSleep(std::move(sleep))
+{
+}
+
+void FramePacer::SetTargetFrameTime(std::int64_t nanoseconds)
+{
+    mTargetFrameTime = std::max<std::int64_t>(nanoseconds, 0);
+    mNextDeadline = -1;
+}
+
+void FramePacer::SetTargetFrameRate(double framesPerSecond)
+{
+    SetTargetFrameTime(framesPerSecond > 0.0 ? (std::int64_t)(1e9 / framesPerSecond) : 0);
+}
+
+std::int64_t FramePacer::TargetFrameTime() const
+{
+    return mTargetFrameTime;
+}
+
+void FramePacer::SetSpinThreshold(std::int64_t nanoseconds)
+{
+    mSpinThreshold = std::max<std::int64_t>(nanoseconds, 0);
+}
+
+void FramePacer::Reset()
+{
+    mNextDeadline = mNow() + mTargetFrameTime;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+    if (mTargetFrameTime == 0)
+        return;
+
+    std::int64_t now = mNow();
+    if (mNextDeadline < 0)
+        mNextDeadline = now + mTargetFrameTime;
+
+    const std::int64_t deadline = mNextDeadline;
+
+    if (now < deadline)
+    {
+        // 늦잠을 감안해서 마감 시각보다 조금 일찍 깨어나도록 잡니다.
+        const std::int64_t sleepTime = deadline - now - mSpinThreshold - mOversleepEstimate;
+        if (sleepTime > 0)
+        {
+            const std::int64_t sleepStart = now;
+            mSleep(sleepTime);
+            now = mNow();
+
+            const std::int64_t oversleep = std::max<std::int64_t>(now - sleepStart - sleepTime, 0);
+            mOversleepEstimate = oversleep > mOversleepEstimate ?
+                oversleep : mOversleepEstimate - (mOversleepEstimate - oversleep) / 16;
+
+            mSleepSum += now - sleepStart;
+        }
+
+        // 남은 시간은 스핀합니다.
+        const std::int64_t spinStart = now;
+        while (now < deadline)
+            now = mNow();
+
+        mSpinSum += now - spinStart;
+    }
+    else
+    {
+        ++mMissedFrames;
+    }
+
+    const std::int64_t jitter = now - deadline;
+    mJitterSum += jitter;
+    mJitterMax = std::max(mJitterMax, jitter);
+    ++mFrameCount;
+
+    // 한 프레임 이상 늦었으면 밀린 프레임을 몰아서 실행하지 않도록 지금부터 다시 잡습니다.
+    mNextDeadline = jitter > mTargetFrameTime ? now + mTargetFrameTime : deadline + mTargetFrameTime;
+}
+
+FramePacer::PacingStats FramePacer::Stats() const
+{
+    PacingStats stats;
+    stats.FrameCount = mFrameCount;
+    stats.MissedFrames = mMissedFrames;
+    stats.MaxJitterMs = (float)(mJitterMax * 1e-6);
+    stats.OversleepEstimateMs = (float)(mOversleepEstimate * 1e-6);
+
+    if (mFrameCount > 0)
+    {
+        stats.AvgJitterMs = (float)(mJitterSum * 1e-6 / mFrameCount);
+        stats.AvgSleepMs = (float)(mSleepSum * 1e-6 / mFrameCount);
+        stats.AvgSpinMs = (float)(mSpinSum * 1e-6 / mFrameCount);
+    }
+
+    return stats;
+}
+
+void FramePacer::ResetStats()
+{
+    mFrameCount = 0;
+    mMissedFrames = 0;
+    mJitterSum = 0;
+    mJitterMax = 0;
+    mSleepSum = 0;
+    mSpinSum = 0;
+}
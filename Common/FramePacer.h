@@ -0,0 +1,85 @@
+﻿//***************************************************************************************
+// FramePacer.h
+//
+// Frame limiter for the message loop.  WaitForNextFrame() blocks until the next frame
+// deadline: it sleeps for most of the remaining time and spins for the rest, because
+// OS sleeps wake up late by an amount that varies from machine to machine.  The pacer
+// measures that oversleep and sleeps correspondingly shorter next time, and it records
+// how far from the deadline each frame actually started (the scheduling jitter).
+//
+// The clock and the sleep are injected, so the pacing logic is portable and can be
+// driven by a fake clock.  By default it uses GameTimer::Now and std::this_thread.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+class FramePacer
+{
+public:
+    // 지금 시각(나노초)을 반환합니다.
+    using NowFunction = std::function<std::int64_t()>;
+
+    // 최소한 주어진 시간(나노초) 동안 스레드를 재웁니다. 늦게 깨어나도 됩니다.
+    using SleepFunction = std::function<void(std::int64_t)>;
+
+    struct PacingStats
+    {
+        std::uint32_t FrameCount = 0;
+
+        // 프레임이 마감 시각보다 늦게 시작한 시간입니다.
+        float AvgJitterMs = 0.0f;
+        float MaxJitterMs = 0.0f;
+
+        // 기다리기 전에 이미 마감 시각이 지난 프레임 수입니다.
+        std::uint32_t MissedFrames = 0;
+
+        // 잠든 시간과 스핀한 시간의 프레임당 평균입니다.
+        float AvgSleepMs = 0.0f;
+        float AvgSpinMs = 0.0f;
+
+        // 다음 잠에서 빼 둘 늦잠 예상치입니다.
+        float OversleepEstimateMs = 0.0f;
+    };
+
+    FramePacer();
+    FramePacer(NowFunction now, SleepFunction sleep);
+
+    // 0이면 제한하지 않습니다.
+    void SetTargetFrameTime(std::int64_t nanoseconds);
+    void SetTargetFrameRate(double framesPerSecond);
+    std::int64_t TargetFrameTime() const;
+
+    // 마감 시각까지 남은 시간이 이보다 짧으면 자지 않고 스핀합니다.
+    void SetSpinThreshold(std::int64_t nanoseconds);
+
+    // 다음 마감 시각을 지금부터 한 프레임 뒤로 잡습니다. 루프를 시작하거나 정지가 풀렸을 때 호출합니다.
+    void Reset();
+
+    // 프레임 끝에서 호출합니다. 다음 프레임의 마감 시각까지 기다립니다.
+    void WaitForNextFrame();
+
+    // 마지막 ResetStats 이후의 통계입니다.
+    PacingStats Stats() const;
+    void ResetStats();
+
+private:
+    NowFunction mNow;
+    SleepFunction mSleep;
+
+    std::int64_t mTargetFrameTime = 0;
+    std::int64_t mSpinThreshold = 1000000;
+    std::int64_t mNextDeadline = -1;
+
+    // 요청한 시간보다 늦게 깨어난 시간의 추정치입니다. 늘어날 때는 바로 따라가고 줄어들 때는 천천히 줄입니다.
+    std::int64_t mOversleepEstimate = 0;
+
+    std::uint32_t mFrameCount = 0;
+    std::uint32_t mMissedFrames = 0;
+    std::int64_t mJitterSum = 0;
+    std::int64_t mJitterMax = 0;
+    std::int64_t mSleepSum = 0;
+    std::int64_t mSpinSum = 0;
+};
@@ -0,0 +1,234 @@
+﻿//***************************************************************************************
+// FramePipeline.cpp
+//***************************************************************************************
+
+#include "FramePipeline.h"
+#include "Profiler.h"
+#include <cassert>
+
+namespace
+{
+    // 소비자 스레드를 기다리는 동안 pump를 호출하는 간격입니다.
+    const std::chrono::milliseconds gPumpInterval(5);
+}
+
+FramePipeline::FramePipeline(std::uint32_t slotCount)
+    : mSlotCount(slotCount)
+{
+    assert(slotCount > 0);
+}
+
+FramePipeline::~FramePipeline()
+{
+    StopConsumerThread(nullptr);
+}
+
+std::uint32_t FramePipeline::SlotCount() const
+{
+    return mSlotCount;
+}
+
+bool FramePipeline::BeginProduce(std::uint32_t& slot, std::chrono::milliseconds timeout)
+{
+    PROFILE_FUNCTION();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    assert(mProduceBegun == mProduced);
+
+    // 소비자가 아직 돌려주지 않은 슬롯은 다시 채울 수 없습니다.
+    const bool ready = mSlotReleased.wait_for(lock, timeout, [this]()
+        {
+            return mClosed || mProduceBegun - mConsumed < mSlotCount;
+        });
+
+    if (!ready || mClosed)
+        return false;
+
+    slot = (std::uint32_t)(mProduceBegun % mSlotCount);
+    ++mProduceBegun;
+
+    return true;
+}
+
+void FramePipeline::EndProduce()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        assert(mProduceBegun == mProduced + 1);
+
+        ++mProduced;
+    }
+
+    mPacketReady.notify_all();
+}
+
+bool FramePipeline::BeginConsume(std::uint32_t& slot)
+{
+    PROFILE_FUNCTION();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    assert(mConsumeBegun == mConsumed);
+
+    mPacketReady.wait(lock, [this]()
+        {
+            return mClosed || mConsumeBegun < mProduced;
+        });
+
+    if (mConsumeBegun == mProduced)
+        return false;
+
+    slot = (std::uint32_t)(mConsumeBegun % mSlotCount);
+    ++mConsumeBegun;
+
+    return true;
+}
+
+void FramePipeline::EndConsume()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        assert(mConsumeBegun == mConsumed + 1);
+
+        ++mConsumed;
+    }
+
+    // WaitIdle도 이 조건 변수를 기다립니다.
+    mSlotReleased.notify_all();
+}
+
+bool FramePipeline::WaitIdle(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    return mSlotReleased.wait_for(lock, timeout, [this]()
+        {
+            return mClosed || mConsumed == mProduced;
+        });
+}
+
+void FramePipeline::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+    }
+
+    mSlotReleased.notify_all();
+    mPacketReady.notify_all();
+}
+
+void FramePipeline::Reopen()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mClosed = false;
+}
+
+bool FramePipeline::IsClosed() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mClosed;
+}
+
+std::uint64_t FramePipeline::ProducedCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mProduced;
+}
+
+std::uint64_t FramePipeline::ConsumedCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mConsumed;
+}
+
+void FramePipeline::StartConsumerThread(const char* threadName, std::function<void(std::uint32_t)> consume)
+{
+    assert(!mConsumerThread.joinable());
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mConsumerRunning = true;
+        mConsumerException = nullptr;
+    }
+
+    mConsumerThread = std::thread([this, threadName, consume = std::move(consume)]()
+        {
+            Profiler::SetThreadName(threadName);
+            ConsumerThreadMain(consume);
+        });
+}
+
+void FramePipeline::StopConsumerThread(const std::function<void()>& pump)
+{
+    if (!mConsumerThread.joinable())
+        return;
+
+    // 소비자 스레드는 남은 패킷을 모두 소비한 다음에 끝납니다. 슬롯 순서는 이어서 사용합니다.
+    Close();
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mSlotReleased.wait_for(lock, gPumpInterval, [this]() { return !mConsumerRunning; }))
+        {
+            if (pump)
+            {
+                lock.unlock();
+                pump();
+                lock.lock();
+            }
+        }
+    }
+
+    mConsumerThread.join();
+    Reopen();
+}
+
+bool FramePipeline::HasConsumerThread() const
+{
+    return mConsumerThread.joinable();
+}
+
+void FramePipeline::RethrowConsumerException()
+{
+    std::exception_ptr e;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::swap(e, mConsumerException);
+    }
+
+    if (e == nullptr)
+        return;
+
+    // 예외를 잡은 소비자 스레드는 더 이상 아무것도 기다리지 않으므로 pump 없이 정리합니다.
+    StopConsumerThread(nullptr);
+    std::rethrow_exception(e);
+}
+
+void FramePipeline::ConsumerThreadMain(const std::function<void(std::uint32_t)>& consume)
+{
+    try
+    {
+        std::uint32_t slot = 0;
+        while (BeginConsume(slot))
+        {
+            consume(slot);
+            EndConsume();
+        }
+    }
+    catch (...)
+    {
+        // 실패한 패킷은 소비된 것으로 치고 버립니다. 생산자는 닫힌 파이프라인을 보고 예외를 꺼냅니다.
+        std::lock_guard<std::mutex> lock(mMutex);
+        mConsumerException = std::current_exception();
+        mConsumed = mConsumeBegun;
+        mClosed = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mConsumerRunning = false;
+    }
+
+    mSlotReleased.notify_all();
+    mPacketReady.notify_all();
+}
@@ -0,0 +1,97 @@
+﻿//***************************************************************************************
+// FramePipeline.h
+//
+// Hand-off between the thread that updates a frame and the thread that draws it.  The
+// slots are the application's frame resources (gNumFrameResources of them): Update
+// fills slot N+1 while Draw records and submits slot N.  The producer takes the slots
+// in ring order and may not reuse a slot until the consumer has released it; the GPU
+// side of the reuse is still guarded by the frame resource's fence, which the consumer
+// sets before it releases the slot, so the producer sees the new value.
+//
+// Producer and consumer may also run one after the other on the same thread.
+// StartConsumerThread runs the consumer on a thread owned by the pipeline.  The
+// producer thread's waits take a timeout or a pump callback, because on Windows the
+// consumer's Present can send a message to the window thread and block until it is
+// handled.
+//***************************************************************************************
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class FramePipeline
+{
+public:
+    explicit FramePipeline(std::uint32_t slotCount);
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline& rhs) = delete;
+    FramePipeline& operator=(const FramePipeline& rhs) = delete;
+
+    std::uint32_t SlotCount() const;
+
+    // 다음 슬롯이 빌 때까지 최대 timeout만큼 기다립니다. 슬롯을 얻지 못했거나 닫혔으면 false를 반환합니다.
+    bool BeginProduce(std::uint32_t& slot, std::chrono::milliseconds timeout);
+
+    // 채운 슬롯을 소비자에게 넘깁니다.
+    void EndProduce();
+
+    // 다음 패킷이 완성될 때까지 기다립니다. 닫힌 뒤에는 남은 패킷을 모두 넘긴 다음 false를 반환합니다.
+    bool BeginConsume(std::uint32_t& slot);
+
+    // 슬롯을 생산자에게 돌려줍니다.
+    void EndConsume();
+
+    // 지금까지 넘긴 패킷이 모두 소비될 때까지 최대 timeout만큼 기다립니다. 스왑 체인처럼 소비자가
+    // 쓰는 자원을 생산자 스레드에서 바꾸기 전에 호출합니다. 모두 소비되었거나 닫혔으면 true를 반환합니다.
+    bool WaitIdle(std::chrono::milliseconds timeout);
+
+    // 생산을 멈추고 기다리는 스레드들을 깨웁니다. Reopen하면 슬롯 순서를 이어서 다시 사용할 수 있습니다.
+    void Close();
+    void Reopen();
+    bool IsClosed() const;
+
+    std::uint64_t ProducedCount() const;
+    std::uint64_t ConsumedCount() const;
+
+    // 아래 함수들은 생산자 스레드에서 호출합니다.
+
+    // 패킷마다 consume(slot)을 호출하는 소비자 스레드를 시작합니다. 스레드는 닫힌 뒤 남은 패킷을
+    // 모두 소비하고 끝납니다. consume이 던진 예외는 파이프라인을 닫고 그 패킷을 버립니다.
+    void StartConsumerThread(const char* threadName, std::function<void(std::uint32_t)> consume);
+
+    // 파이프라인을 닫고 소비자 스레드가 끝날 때까지 기다린 다음 다시 엽니다. 기다리는 동안
+    // 주기적으로 pump를 호출해서 소비자가 생산자 스레드에 보낸 요청을 처리할 수 있게 합니다.
+    void StopConsumerThread(const std::function<void()>& pump);
+    bool HasConsumerThread() const;
+
+    // 소비자 스레드가 예외로 끝났으면 스레드를 정리하고 그 예외를 다시 던집니다.
+    void RethrowConsumerException();
+
+private:
+    void ConsumerThreadMain(const std::function<void(std::uint32_t)>& consume);
+
+    const std::uint32_t mSlotCount;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mSlotReleased;
+    std::condition_variable mPacketReady;
+
+    // 패킷 번호를 슬롯 수로 나눈 나머지가 슬롯 인덱스입니다.
+    std::uint64_t mProduceBegun = 0;
+    std::uint64_t mProduced = 0;
+    std::uint64_t mConsumeBegun = 0;
+    std::uint64_t mConsumed = 0;
+
+    bool mClosed = false;
+
+    std::thread mConsumerThread;
+    bool mConsumerRunning = false;
+    std::exception_ptr mConsumerException;
+};
@@ -2,16 +2,33 @@
 // GameTimer.cpp by Frank Luna (C) 2011 All Rights Reserved.
 //***************************************************************************************
 
-#include <windows.h>
 #include "GameTimer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <utility>
+#include <vector>
 
 GameTimer::GameTimer()
-	: mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0),
-	mPausedTime(0), mStopTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+	: GameTimer(&GameTimer::Now)
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
+}
+
+GameTimer::GameTimer(NowFunction now)
+	: mNow(std::move(now)), mSecondsPerCount(1.0e-9), mDeltaTime(-1.0), mBaseTime(0),
+	mPausedTime(0), mStopTime(0), mPrevTime(0), mCurrTime(0), mStopped(false),
+	mFrameCount(0)
+{
+	for (auto& frameTime : mFrameTimes)
+		frameTime.store(0.0f, std::memory_order_relaxed);
+}
+
+std::int64_t GameTimer::Now()
+{
+	// steady_clock never goes backwards and is QueryPerformanceCounter on Windows.
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
@@ -55,19 +72,19 @@ float GameTimer::DeltaTime() const
 
 void GameTimer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	std::int64_t currTime = mNow();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
 	mStopTime = 0;
 	mStopped = false;
+
+	mFrameCount.store(0, std::memory_order_release);
 }
 
 void GameTimer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	std::int64_t startTime = mNow();
 
 
 	// Accumulate the time elapsed between stop and start pairs.
@@ -90,10 +107,7 @@ void GameTimer::Stop()
 {
 	if (!mStopped)
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-
-		mStopTime = currTime;
+		mStopTime = mNow();
 		mStopped = true;
 	}
 }
@@ -106,9 +120,7 @@ void GameTimer::Tick()
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-	mCurrTime = currTime;
+	mCurrTime = mNow();
 
 	// Time difference between this frame and the previous.
 	mDeltaTime = (mCurrTime - mPrevTime) * mSecondsPerCount;
@@ -123,4 +135,99 @@ void GameTimer::Tick()
 	{
 		mDeltaTime = 0.0;
 	}
+
+	// Record the frame time.  Only this thread writes, so a relaxed load of the count
+	// is enough here; the release store publishes the slot to readers.
+	std::uint64_t count = mFrameCount.load(std::memory_order_relaxed);
+	mFrameTimes[count % FrameHistorySize].store((float)mDeltaTime, std::memory_order_relaxed);
+	mFrameCount.store(count + 1, std::memory_order_release);
+}
+
+std::uint64_t GameTimer::FrameCount() const
+{
+	return mFrameCount.load(std::memory_order_acquire);
+}
+
+std::uint32_t GameTimer::CopyFrameTimes(float* frameTimes, std::uint64_t& firstFrame) const
+{
+	std::uint64_t count = mFrameCount.load(std::memory_order_acquire);
+	std::uint32_t n = (std::uint32_t)std::min<std::uint64_t>(count, FrameHistorySize);
+	firstFrame = count - n;
+
+	for (std::uint32_t i = 0; i < n; ++i)
+		frameTimes[i] = mFrameTimes[(count - n + i) % FrameHistorySize].load(std::memory_order_relaxed);
+
+	return n;
+}
+
+GameTimer::FrameStats GameTimer::ComputeFrameStats() const
+{
+	std::vector<float> ms(FrameHistorySize);
+	std::uint64_t firstFrame = 0;
+	std::uint32_t n = CopyFrameTimes(ms.data(), firstFrame);
+	ms.resize(n);
+
+	FrameStats stats;
+	stats.FrameCount = n;
+	if (n == 0)
+		return stats;
+
+	double sum = 0.0;
+	for (float& t : ms)
+	{
+		t *= 1000.0f;
+		sum += t;
+	}
+
+	double mean = sum / n;
+	double variance = 0.0;
+	for (float t : ms)
+		variance += (t - mean) * (t - mean);
+
+	stats.AvgMs = (float)mean;
+	stats.StdDevMs = (float)std::sqrt(variance / n);
+
+	std::sort(ms.begin(), ms.end());
+
+	// Nearest rank: the smallest value with at least p percent of the samples at or below it.
+	auto percentile = [&](double p)
+	{
+		std::uint32_t rank = (std::uint32_t)std::ceil(p / 100.0 * n);
+		return ms[std::max<std::uint32_t>(rank, 1) - 1];
+	};
+
+	stats.MinMs = ms.front();
+	stats.MaxMs = ms.back();
+	stats.P50Ms = percentile(50.0);
+	stats.P95Ms = percentile(95.0);
+	stats.P99Ms = percentile(99.0);
+
+	return stats;
+}
+
+void GameTimer::WriteFrameTimesCsv(std::ostream& os) const
+{
+	std::vector<float> frameTimes(FrameHistorySize);
+	std::uint64_t firstFrame = 0;
+	std::uint32_t n = CopyFrameTimes(frameTimes.data(), firstFrame);
+
+	// Rows are numbered by their frame index since Reset().
+	os << "frame,ms\n";
+	for (std::uint32_t i = 0; i < n; ++i)
+		os << (firstFrame + i) << ',' << frameTimes[i] * 1000.0f << '\n';
+}
+
+void GameTimer::WriteFrameStatsJson(std::ostream& os) const
+{
+	FrameStats stats = ComputeFrameStats();
+
+	os << "{\"frames\": " << stats.FrameCount
+		<< ", \"min_ms\": " << stats.MinMs
+		<< ", \"avg_ms\": " << stats.AvgMs
+		<< ", \"p50_ms\": " << stats.P50Ms
+		<< ", \"p95_ms\": " << stats.P95Ms
+		<< ", \"p99_ms\": " << stats.P99Ms
+		<< ", \"max_ms\": " << stats.MaxMs
+		<< ", \"stddev_ms\": " << stats.StdDevMs
+		<< "}\n";
 }
\ No newline at end of file
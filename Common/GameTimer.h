@@ -1,14 +1,46 @@
 ﻿//***************************************************************************************
 // GameTimer.h by Frank Luna (C) 2011 All Rights Reserved.
+//
+// Portable (std::chrono::steady_clock) game timer.  Besides the total and delta time,
+// it keeps the last FrameHistorySize frame times in a ring that the main thread writes
+// and any thread may read without locking, and computes min/avg/percentile/stddev
+// statistics from it.  Percentiles show stutter that an averaged FPS hides.
+//
+// The clock is injected like FramePacer's, so the recording and the statistics can be
+// driven by a fake clock.  By default it is GameTimer::Now.
 //***************************************************************************************
 
 #ifndef GAMETIMER_H
 #define GAMETIMER_H
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+
 class GameTimer
 {
 public:
+	// Returns the current time in nanoseconds.
+	using NowFunction = std::function<std::int64_t()>;
+
+	// Frame time statistics in milliseconds.  Percentiles use the nearest-rank method.
+	struct FrameStats
+	{
+		std::uint32_t FrameCount = 0;
+		float MinMs = 0.0f;
+		float AvgMs = 0.0f;
+		float P50Ms = 0.0f;
+		float P95Ms = 0.0f;
+		float P99Ms = 0.0f;
+		float MaxMs = 0.0f;
+		float StdDevMs = 0.0f;
+	};
+
+	static const std::uint32_t FrameHistorySize = 1024;
+
 	GameTimer();
+	explicit GameTimer(NowFunction now);
 
 	float TotalTime() const; // in seconds
 	float DeltaTime() const; // in seconds
@@ -18,17 +50,45 @@ public:
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
+	// Number of frame times recorded since Reset(), not capped at FrameHistorySize.
+	std::uint64_t FrameCount() const;
+
+	// Statistics over the most recent frames (at most FrameHistorySize).
+	FrameStats ComputeFrameStats() const;
+
+	// Writes the recorded frame times, oldest first, as "frame,ms" rows.
+	void WriteFrameTimesCsv(std::ostream& os) const;
+
+	// Writes ComputeFrameStats() as a single JSON object.
+	void WriteFrameStatsJson(std::ostream& os) const;
+
+	// Current time of the timer's clock, in nanoseconds.
+	static std::int64_t Now();
+
+private:
+	// Copies the recorded frame times (in seconds), oldest first, and the frame index of
+	// the first one.  Returns the count.
+	std::uint32_t CopyFrameTimes(float* frameTimes, std::uint64_t& firstFrame) const;
+
 private:
+	NowFunction mNow;
+
 	double mSecondsPerCount;
 	double mDeltaTime;
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+	std::int64_t mBaseTime;
+	std::int64_t mPausedTime;
+	std::int64_t mStopTime;
+	std::int64_t mPrevTime;
+	std::int64_t mCurrTime;
 
 	bool mStopped;
+
+	// Ring of frame times written only by Tick().  Readers load the count with acquire
+	// ordering, so every slot below it has been written; a slot that Tick() overwrites
+	// while it is being copied yields either the old or the new frame time.
+	std::atomic<float> mFrameTimes[FrameHistorySize];
+	std::atomic<std::uint64_t> mFrameCount;
 };
 
 #endif // GAMETIMER_H
\ No newline at end of file
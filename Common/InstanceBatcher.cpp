@@ -0,0 +1,119 @@
+﻿//***************************************************************************************
+// InstanceBatcher.cpp
+//***************************************************************************************
+
+#include "InstanceBatcher.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <functional>
+
+bool InstanceBatchKey::operator==(const InstanceBatchKey& rhs) const
+{
+    return Geometry == rhs.Geometry &&
+        IndexCount == rhs.IndexCount &&
+        StartIndexLocation == rhs.StartIndexLocation &&
+        BaseVertexLocation == rhs.BaseVertexLocation &&
+        PrimitiveTopology == rhs.PrimitiveTopology;
+}
+
+size_t InstanceBatcher::KeyHash::operator()(const InstanceBatchKey& key) const
+{
+    size_t h = std::hash<const void*>()(key.Geometry);
+
+    auto combine = [&h](std::uint32_t v)
+    {
+        h ^= std::hash<std::uint32_t>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    };
+
+    combine(key.IndexCount);
+    combine(key.StartIndexLocation);
+    combine((std::uint32_t)key.BaseVertexLocation);
+    combine(key.PrimitiveTopology);
+
+    return h;
+}
+
+void InstanceBatcher::Clear()
+{
+    mAddedItems.clear();
+    mAddedKeys.clear();
+
+    mBatches.clear();
+    mItems.clear();
+    mInstanceIndices.clear();
+}
+
+void InstanceBatcher::Add(std::uint32_t item, const InstanceBatchKey& key)
+{
+    mAddedItems.push_back(item);
+    mAddedKeys.push_back(key);
+}
+
+void InstanceBatcher::Build()
+{
+    PROFILE_FUNCTION();
+
+    mBatches.clear();
+
+    // 1단계: 키마다 배치를 만들고 항목 수를 셉니다.
+    std::unordered_map<InstanceBatchKey, std::uint32_t, KeyHash> batchLookup;
+    std::vector<std::uint32_t> addedBatches(mAddedItems.size());
+
+    for (size_t i = 0; i < mAddedItems.size(); ++i)
+    {
+        auto it = batchLookup.find(mAddedKeys[i]);
+        if (it == batchLookup.end())
+        {
+            it = batchLookup.emplace(mAddedKeys[i], (std::uint32_t)mBatches.size()).first;
+
+            InstanceBatch batch;
+            batch.Key = mAddedKeys[i];
+            mBatches.push_back(batch);
+        }
+
+        addedBatches[i] = it->second;
+        mBatches[it->second].InstanceCount++;
+    }
+
+    // 2단계: 배치 크기의 누적합으로 시작 위치를 정하고 항목을 순서대로 채웁니다.
+    std::uint32_t first = 0;
+    for (InstanceBatch& batch : mBatches)
+    {
+        batch.FirstInstance = first;
+        first += batch.InstanceCount;
+    }
+
+    std::vector<std::uint32_t> next(mBatches.size());
+    for (size_t b = 0; b < mBatches.size(); ++b)
+        next[b] = mBatches[b].FirstInstance;
+
+    mItems.resize(mAddedItems.size());
+
+    std::uint32_t maxItem = 0;
+    for (std::uint32_t item : mAddedItems)
+        maxItem = std::max<std::uint32_t>(maxItem, item);
+    mInstanceIndices.assign(mAddedItems.empty() ? 0 : (size_t)maxItem + 1, (std::uint32_t)InvalidInstance);
+
+    for (size_t i = 0; i < mAddedItems.size(); ++i)
+    {
+        const std::uint32_t instance = next[addedBatches[i]]++;
+
+        mItems[instance] = mAddedItems[i];
+        mInstanceIndices[mAddedItems[i]] = instance;
+    }
+}
+
+const std::vector<InstanceBatch>& InstanceBatcher::Batches() const
+{
+    return mBatches;
+}
+
+const std::vector<std::uint32_t>& InstanceBatcher::Items() const
+{
+    return mItems;
+}
+
+std::uint32_t InstanceBatcher::GetInstanceIndex(std::uint32_t item) const
+{
+    return item < mInstanceIndices.size() ? mInstanceIndices[item] : InvalidInstance;
+}
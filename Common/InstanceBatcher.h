@@ -0,0 +1,76 @@
+﻿//***************************************************************************************
+// InstanceBatcher.h
+//
+// Automatic instancing.  Render items are added with the key of what they draw
+// (geometry, submesh range and topology); items with equal keys are grouped into one
+// batch and laid out contiguously in instance order, so the per-object data can live
+// in a structured instance buffer and every batch becomes a single instanced draw.
+// The number of draw calls then follows the number of unique meshes instead of the
+// number of objects.  Batches keep the order in which their key first appeared.
+//
+// Per-object state that the shader reads per instance (world, material index) is not
+// part of the key.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 같은 키를 가진 항목들은 한 번의 인스턴스 드로우로 그릴 수 있습니다.
+struct InstanceBatchKey
+{
+    const void* Geometry = nullptr;
+    std::uint32_t IndexCount = 0;
+    std::uint32_t StartIndexLocation = 0;
+    std::int32_t BaseVertexLocation = 0;
+    std::uint32_t PrimitiveTopology = 0;
+
+    bool operator==(const InstanceBatchKey& rhs) const;
+};
+
+struct InstanceBatch
+{
+    InstanceBatchKey Key;
+
+    // 인스턴스 버퍼에서 이 배치가 차지하는 범위입니다.
+    std::uint32_t FirstInstance = 0;
+    std::uint32_t InstanceCount = 0;
+};
+
+class InstanceBatcher
+{
+public:
+    static const std::uint32_t InvalidInstance = 0xFFFFFFFF;
+
+    void Clear();
+
+    // item은 호출하는 쪽에서 항목을 구분하는 인덱스(예: ObjCBIndex)입니다.
+    void Add(std::uint32_t item, const InstanceBatchKey& key);
+
+    // 같은 키의 항목들을 묶어서 배치와 인스턴스 순서를 만듭니다. 같은 배치 안에서는 추가한 순서를 유지합니다.
+    void Build();
+
+    const std::vector<InstanceBatch>& Batches() const;
+
+    // 인스턴스 버퍼에 들어가는 순서대로의 항목들입니다.
+    const std::vector<std::uint32_t>& Items() const;
+
+    // 항목이 인스턴스 버퍼에서 차지하는 위치입니다. 추가하지 않은 항목이면 InvalidInstance입니다.
+    std::uint32_t GetInstanceIndex(std::uint32_t item) const;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const InstanceBatchKey& key) const;
+    };
+
+    std::vector<std::uint32_t> mAddedItems;
+    std::vector<InstanceBatchKey> mAddedKeys;
+
+    std::vector<InstanceBatch> mBatches;
+    std::vector<std::uint32_t> mItems;
+    std::vector<std::uint32_t> mInstanceIndices;
+};
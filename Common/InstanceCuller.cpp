@@ -0,0 +1,318 @@
+﻿//***************************************************************************************
+// InstanceCuller.cpp
+//***************************************************************************************
+
+#include "InstanceCuller.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+// 네 레인의 비교 결과를 4비트 마스크로 바꿉니다.
+static inline int MoveMask(FXMVECTOR v)
+{
+#if defined(_XM_SSE_INTRINSICS_)
+    return _mm_movemask_ps(v);
+#else
+    XMUINT4 bits;
+    XMStoreUInt4(&bits, v);
+    return (int)((bits.x >> 31) | ((bits.y >> 31) << 1) | ((bits.z >> 31) << 2) | ((bits.w >> 31) << 3));
+#endif
+}
+
+static inline std::uint32_t CountBits(int mask)
+{
+    return (std::uint32_t)((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1));
+}
+
+void InstanceCuller::Clear()
+{
+    mCount = 0;
+
+    mCenterX.clear();
+    mCenterY.clear();
+    mCenterZ.clear();
+    mExtentX.clear();
+    mExtentY.clear();
+    mExtentZ.clear();
+
+    mLastRejectPlane.clear();
+    mHasCachedResult = false;
+}
+
+std::uint32_t InstanceCuller::AddInstance(const BoundingBox& localBounds, FXMMATRIX world)
+{
+    const std::uint32_t index = mCount++;
+
+    const size_t paddedCount = (mCount + 3) & ~3u;
+    mCenterX.resize(paddedCount, 0.0f);
+    mCenterY.resize(paddedCount, 0.0f);
+    mCenterZ.resize(paddedCount, 0.0f);
+    mExtentX.resize(paddedCount, 0.0f);
+    mExtentY.resize(paddedCount, 0.0f);
+    mExtentZ.resize(paddedCount, 0.0f);
+    mLastRejectPlane.resize(paddedCount, 0);
+
+    SetInstance(index, localBounds, world);
+
+    return index;
+}
+
+void InstanceCuller::SetInstance(std::uint32_t index, const BoundingBox& localBounds, FXMMATRIX world)
+{
+    BoundingBox worldBounds;
+    localBounds.Transform(worldBounds, world);
+
+    mCenterX[index] = worldBounds.Center.x;
+    mCenterY[index] = worldBounds.Center.y;
+    mCenterZ[index] = worldBounds.Center.z;
+    mExtentX[index] = worldBounds.Extents.x;
+    mExtentY[index] = worldBounds.Extents.y;
+    mExtentZ[index] = worldBounds.Extents.z;
+
+    mHasCachedResult = false;
+}
+
+std::uint32_t InstanceCuller::InstanceCount() const
+{
+    return mCount;
+}
+
+BoundingBox InstanceCuller::GetWorldBounds(std::uint32_t index) const
+{
+    return BoundingBox(
+        XMFLOAT3(mCenterX[index], mCenterY[index], mCenterZ[index]),
+        XMFLOAT3(mExtentX[index], mExtentY[index], mExtentZ[index]));
+}
+
+void InstanceCuller::Cull(const XMFLOAT4 planes[6], std::vector<std::uint32_t>& visible)
+{
+    PROFILE_FUNCTION();
+
+    if (IsUnchanged(planes, 0))
+    {
+        visible = mLastVisible;
+        return;
+    }
+
+    visible.clear();
+    CullRange(planes, 0, mCount, visible, mStats);
+
+    mLastVisible = visible;
+    mHasCachedResult = true;
+    mCachedChunkSize = 0;
+}
+
+std::uint32_t InstanceCuller::CullParallel(const XMFLOAT4 planes[6], const EmitFunction& emit, std::uint32_t chunkSize)
+{
+    PROFILE_FUNCTION();
+
+    // 청크가 네 개씩 묶은 그룹의 경계에서 시작하도록 4의 배수로 올립니다.
+    chunkSize = (std::max<std::uint32_t>(chunkSize, 4) + 3) & ~3u;
+
+    const std::uint32_t chunkCount = (mCount + chunkSize - 1) / chunkSize;
+
+    // 아무것도 바뀌지 않았으면 지난 청크 결과와 출력 위치를 그대로 사용합니다.
+    const bool unchanged = IsUnchanged(planes, chunkSize);
+    if (!unchanged)
+    {
+        if (mChunkVisible.size() < chunkCount)
+            mChunkVisible.resize(chunkCount);
+        mChunkOffsets.resize(chunkCount);
+        mChunkStats.assign(chunkCount, CullStats());
+
+        // 1단계: 청크마다 독립적으로 컬링합니다. 청크는 4의 배수에서 시작하므로 거부 평면 캐시도 겹치지 않습니다.
+        JobSystem::Default().ParallelFor(0u, chunkCount, [&](std::uint32_t chunk)
+        {
+            const std::uint32_t first = chunk * chunkSize;
+            const std::uint32_t last = std::min<std::uint32_t>(first + chunkSize, mCount);
+
+            mChunkVisible[chunk].clear();
+            CullRange(planes, first, last, mChunkVisible[chunk], mChunkStats[chunk]);
+        });
+
+        // 2단계: 보이는 인스턴스 수의 배타적 누적합이 각 청크의 출력 시작 위치입니다.
+        mStats = CullStats();
+        std::uint32_t offset = 0;
+        for (std::uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            mChunkOffsets[chunk] = offset;
+            offset += (std::uint32_t)mChunkVisible[chunk].size();
+
+            mStats.Instances += mChunkStats[chunk].Instances;
+            mStats.PlaneTests += mChunkStats[chunk].PlaneTests;
+            mStats.PlaneTestsSaved += mChunkStats[chunk].PlaneTestsSaved;
+            mStats.CachedPlaneRejects += mChunkStats[chunk].CachedPlaneRejects;
+        }
+
+        mHasCachedResult = true;
+        mCachedChunkSize = chunkSize;
+    }
+
+    const std::uint32_t visibleCount = chunkCount == 0 ? 0 :
+        mChunkOffsets[chunkCount - 1] + (std::uint32_t)mChunkVisible[chunkCount - 1].size();
+
+    // 3단계: 청크마다 자신의 출력 범위에만 씁니다.
+    JobSystem::Default().ParallelFor(0u, chunkCount, [&](std::uint32_t chunk)
+    {
+        std::uint32_t outputIndex = mChunkOffsets[chunk];
+        for (std::uint32_t instance : mChunkVisible[chunk])
+            emit(instance, outputIndex++);
+    });
+
+    return visibleCount;
+}
+
+void InstanceCuller::CullCandidates(const XMFLOAT4 planes[6], const std::vector<std::uint32_t>& candidates,
+    std::vector<std::uint32_t>& visible)
+{
+    PROFILE_FUNCTION();
+
+    // 다음 Cull이 이 결과를 자신의 결과로 재사용하지 않도록 합니다.
+    mHasCachedResult = false;
+
+    mStats = CullStats();
+    mStats.Instances = (std::uint32_t)candidates.size();
+
+    visible.clear();
+    for (std::uint32_t i : candidates)
+    {
+        // 지난번에 거부했던 평면을 먼저, 나머지 평면을 순서대로 테스트합니다.
+        std::uint8_t& cached = mLastRejectPlane[i];
+
+        bool inside = true;
+        for (int k = 0; k < 6 && inside; ++k)
+        {
+            const int p = k == 0 ? cached : (k - 1 < cached ? k - 1 : k);
+            const XMFLOAT4& plane = planes[p];
+
+            const float dist = mCenterX[i] * plane.x + mCenterY[i] * plane.y + mCenterZ[i] * plane.z + plane.w;
+            const float radius = mExtentX[i] * fabsf(plane.x) + mExtentY[i] * fabsf(plane.y) + mExtentZ[i] * fabsf(plane.z);
+
+            mStats.PlaneTests++;
+            if (dist + radius < 0.0f)
+            {
+                inside = false;
+                mStats.CachedPlaneRejects += k == 0 ? 1 : 0;
+                cached = (std::uint8_t)p;
+            }
+        }
+
+        if (inside)
+            visible.push_back(i);
+    }
+
+    mStats.PlaneTestsSaved = (std::int32_t)(6 * mCount) - (std::int32_t)mStats.PlaneTests;
+}
+
+const InstanceCuller::CullStats& InstanceCuller::LastStats() const
+{
+    return mStats;
+}
+
+bool InstanceCuller::IsUnchanged(const XMFLOAT4 planes[6], std::uint32_t chunkSize)
+{
+    const bool unchanged = mHasCachedResult && mCachedChunkSize == chunkSize &&
+        std::memcmp(mLastPlanes, planes, sizeof(mLastPlanes)) == 0;
+
+    std::memcpy(mLastPlanes, planes, sizeof(mLastPlanes));
+
+    if (unchanged)
+    {
+        mStats.Instances = mCount;
+        mStats.PlaneTestsSaved = (std::int32_t)(6 * mCount);
+        mStats.PlaneTests = 0;
+        mStats.CachedPlaneRejects = 0;
+        mStats.Unchanged = true;
+    }
+
+    return unchanged;
+}
+
+void InstanceCuller::CullRange(const XMFLOAT4 planes[6], std::uint32_t first, std::uint32_t last,
+    std::vector<std::uint32_t>& visible, CullStats& stats)
+{
+    PROFILE_FUNCTION();
+
+    stats = CullStats();
+    stats.Instances = last - first;
+
+    // 평면의 각 성분을 네 레인에 복제해 둡니다. 박스의 반지름에는 법선의 절댓값을 사용합니다.
+    XMVECTOR nx[6], ny[6], nz[6], d[6];
+    XMVECTOR ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        nx[p] = XMVectorReplicate(planes[p].x);
+        ny[p] = XMVectorReplicate(planes[p].y);
+        nz[p] = XMVectorReplicate(planes[p].z);
+        d[p] = XMVectorReplicate(planes[p].w);
+        ax[p] = XMVectorAbs(nx[p]);
+        ay[p] = XMVectorAbs(ny[p]);
+        az[p] = XMVectorAbs(nz[p]);
+    }
+
+    const XMVECTOR zero = XMVectorZero();
+
+    for (std::uint32_t i = first; i < last; i += 4)
+    {
+        // 배열 끝의 채우기용 레인은 제외합니다.
+        const std::uint32_t lanes = last - i < 4 ? last - i : 4;
+        const int laneMask = (1 << lanes) - 1;
+
+        XMVECTOR cx = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterX[i]));
+        XMVECTOR cy = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterY[i]));
+        XMVECTOR cz = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterZ[i]));
+        XMVECTOR ex = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentX[i]));
+        XMVECTOR ey = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentY[i]));
+        XMVECTOR ez = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentZ[i]));
+
+        // 먼저 레인마다 지난 프레임에 거부했던 평면으로 테스트합니다.
+        std::uint8_t* cached = &mLastRejectPlane[i];
+        const XMVECTOR cnx = XMVectorSet(planes[cached[0]].x, planes[cached[1]].x, planes[cached[2]].x, planes[cached[3]].x);
+        const XMVECTOR cny = XMVectorSet(planes[cached[0]].y, planes[cached[1]].y, planes[cached[2]].y, planes[cached[3]].y);
+        const XMVECTOR cnz = XMVectorSet(planes[cached[0]].z, planes[cached[1]].z, planes[cached[2]].z, planes[cached[3]].z);
+        const XMVECTOR cd = XMVectorSet(planes[cached[0]].w, planes[cached[1]].w, planes[cached[2]].w, planes[cached[3]].w);
+
+        // 중심까지의 거리에 평면 방향으로의 반지름을 더한 값이 음수이면 박스 전체가 평면 밖에 있습니다.
+        XMVECTOR dist = XMVectorMultiplyAdd(cx, cnx, XMVectorMultiplyAdd(cy, cny, XMVectorMultiplyAdd(cz, cnz, cd)));
+        XMVECTOR radius = XMVectorMultiplyAdd(ex, XMVectorAbs(cnx), XMVectorMultiplyAdd(ey, XMVectorAbs(cny), XMVectorMultiply(ez, XMVectorAbs(cnz))));
+
+        int outside = MoveMask(XMVectorLess(XMVectorAdd(dist, radius), zero)) & laneMask;
+        stats.PlaneTests += lanes;
+        stats.CachedPlaneRejects += CountBits(outside);
+
+        // 남은 레인은 나머지 평면들로 테스트하고 거부한 평면을 기억합니다.
+        for (int p = 0; p < 6 && outside != laneMask; ++p)
+        {
+            dist = XMVectorMultiplyAdd(cx, nx[p], XMVectorMultiplyAdd(cy, ny[p], XMVectorMultiplyAdd(cz, nz[p], d[p])));
+            radius = XMVectorMultiplyAdd(ex, ax[p], XMVectorMultiplyAdd(ey, ay[p], XMVectorMultiply(ez, az[p])));
+
+            const int active = laneMask & ~outside;
+            const int rejected = MoveMask(XMVectorLess(XMVectorAdd(dist, radius), zero)) & active;
+
+            int tested = active;
+            for (std::uint32_t lane = 0; lane < lanes; ++lane)
+            {
+                if (cached[lane] == p)
+                    tested &= ~(1 << lane);
+
+                if (rejected & (1 << lane))
+                    cached[lane] = (std::uint8_t)p;
+            }
+
+            stats.PlaneTests += CountBits(tested);
+            outside |= rejected;
+        }
+
+        for (std::uint32_t lane = 0; lane < lanes; ++lane)
+        {
+            if ((outside & (1 << lane)) == 0)
+                visible.push_back(i + lane);
+        }
+    }
+
+    stats.PlaneTestsSaved = (std::int32_t)(6 * stats.Instances) - (std::int32_t)stats.PlaneTests;
+}
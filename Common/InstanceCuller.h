@@ -0,0 +1,124 @@
+﻿//***************************************************************************************
+// InstanceCuller.h
+//
+// Frustum culling for large sets of instances.  The world-space AABB of each instance
+// is computed once, when the instance is added or moved, and stored as SoA arrays
+// (center x/y/z, extents x/y/z).  Culling then tests four boxes at a time against the
+// six world-space frustum planes with DirectXMath vectors, so there is no per-instance
+// matrix inverse or frustum transform in the frame loop.
+//
+// CullParallel splits the instances into fixed-size chunks and culls them on worker
+// threads.  An exclusive prefix sum of the per-chunk visible counts gives every chunk
+// its own range of the compacted output, so the workers can write straight into a
+// mapped upload buffer without locks and the output order matches Cull.
+//
+// Culling is temporally coherent: every instance remembers the plane that rejected it
+// last frame and tests that plane first, which rejects most invisible instances with
+// a single test while the camera moves smoothly.  When neither the planes nor any
+// bounds changed since the last call, the previous result is reused without testing.
+//
+// CullCandidates tests only a precomputed list of instances, such as the instances
+// inside a swept frustum volume that keeps containing the view for several frames.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class InstanceCuller
+{
+public:
+    // CullParallel이 한 워커에 맡기는 인스턴스 수의 기본값입니다.
+    static const std::uint32_t DefaultChunkSize = 1024;
+
+    // 보이는 인스턴스와 압축된 출력에서의 위치를 받는 콜백입니다. 워커 스레드에서 호출됩니다.
+    using EmitFunction = std::function<void(std::uint32_t instance, std::uint32_t outputIndex)>;
+
+    // 마지막 컬링의 통계입니다.
+    struct CullStats
+    {
+        std::uint32_t Instances = 0;
+
+        // 실제로 수행한 박스-평면 테스트 수입니다.
+        std::uint32_t PlaneTests = 0;
+
+        // 모든 인스턴스를 6개 평면과 테스트하는 경우보다 줄어든 테스트 수입니다.
+        std::int32_t PlaneTestsSaved = 0;
+
+        // 지난 프레임에 거부했던 평면 하나로 바로 거부된 인스턴스 수입니다.
+        std::uint32_t CachedPlaneRejects = 0;
+
+        // 평면과 바운딩 박스가 그대로여서 지난 결과를 재사용했으면 true입니다.
+        bool Unchanged = false;
+    };
+
+    InstanceCuller() = default;
+
+    void Clear();
+
+    // 로컬 바운딩 박스를 world로 변환해서 저장하고 인스턴스의 인덱스를 반환합니다.
+    std::uint32_t AddInstance(const DirectX::BoundingBox& localBounds, DirectX::FXMMATRIX world);
+
+    // 움직인 인스턴스의 바운딩 박스를 다시 계산합니다.
+    void SetInstance(std::uint32_t index, const DirectX::BoundingBox& localBounds, DirectX::FXMMATRIX world);
+
+    std::uint32_t InstanceCount() const;
+    DirectX::BoundingBox GetWorldBounds(std::uint32_t index) const;
+
+    // MathHelper::ComputeFrustumPlanes로 구한 world 평면들과 교차하는 인스턴스의 인덱스를
+    // 오름차순으로 visible에 씁니다. 인스턴스마다 거부한 평면을 기억하므로 const가 아닙니다.
+    void Cull(const DirectX::XMFLOAT4 planes[6], std::vector<std::uint32_t>& visible);
+
+    // 청크 단위로 병렬 컬링한 뒤 보이는 인스턴스마다 emit을 호출하고 보이는 인스턴스 수를 반환합니다.
+    // outputIndex는 0부터 연속이고 인스턴스 순서와 같은 순서이므로 서로 다른 워커가 겹쳐 쓰지 않습니다.
+    // 청크별 임시 버퍼를 재사용하므로 같은 InstanceCuller에서 동시에 호출하면 안됩니다.
+    std::uint32_t CullParallel(const DirectX::XMFLOAT4 planes[6], const EmitFunction& emit,
+        std::uint32_t chunkSize = DefaultChunkSize);
+
+    // candidates에 있는 인스턴스만 테스트해서 보이는 것들을 candidates의 순서대로 visible에 씁니다.
+    // 나머지는 보이지 않는 것으로 취급하므로 candidates는 planes의 볼륨을 포함하는 볼륨으로 컬링한
+    // 결과여야 합니다. PlaneTestsSaved에는 테스트하지 않은 인스턴스들의 몫도 들어갑니다.
+    void CullCandidates(const DirectX::XMFLOAT4 planes[6], const std::vector<std::uint32_t>& candidates,
+        std::vector<std::uint32_t>& visible);
+
+    const CullStats& LastStats() const;
+
+private:
+    // [first, last) 범위의 인스턴스를 컬링해서 visible 뒤에 추가합니다. first는 4의 배수여야 합니다.
+    void CullRange(const DirectX::XMFLOAT4 planes[6], std::uint32_t first, std::uint32_t last,
+        std::vector<std::uint32_t>& visible, CullStats& stats);
+
+    // 평면이 지난번과 같고 바운딩 박스도 바뀌지 않았으면 true를 반환합니다. 평면은 항상 기억합니다.
+    bool IsUnchanged(const DirectX::XMFLOAT4 planes[6], std::uint32_t chunkSize);
+
+private:
+    // 네 개씩 묶어서 읽을 수 있도록 배열의 크기는 항상 4의 배수입니다.
+    std::uint32_t mCount = 0;
+
+    std::vector<float> mCenterX;
+    std::vector<float> mCenterY;
+    std::vector<float> mCenterZ;
+    std::vector<float> mExtentX;
+    std::vector<float> mExtentY;
+    std::vector<float> mExtentZ;
+
+    // 인스턴스를 마지막으로 거부한 평면의 인덱스(0~5)입니다.
+    std::vector<std::uint8_t> mLastRejectPlane;
+
+    // 지난 결과를 재사용하기 위한 상태입니다. mCachedChunkSize가 0이면 Cull의 결과입니다.
+    DirectX::XMFLOAT4 mLastPlanes[6] = {};
+    bool mHasCachedResult = false;
+    std::uint32_t mCachedChunkSize = 0;
+    std::vector<std::uint32_t> mLastVisible;
+
+    CullStats mStats;
+
+    // CullParallel의 청크별 결과와 출력 시작 위치입니다.
+    std::vector<std::vector<std::uint32_t>> mChunkVisible;
+    std::vector<std::uint32_t> mChunkOffsets;
+    std::vector<CullStats> mChunkStats;
+};
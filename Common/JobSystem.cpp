@@ -0,0 +1,419 @@
+﻿//***************************************************************************************
+// JobSystem.cpp
+//***************************************************************************************
+
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    // 현재 스레드가 워커이면 그 작업 시스템과 워커 인덱스입니다.
+    thread_local const JobSystem* tJobSystem = nullptr;
+    thread_local std::uint32_t tWorkerIndex = 0;
+
+    thread_local std::uint32_t tRandomState = 0x9E3779B9u;
+
+    std::uint32_t NextRandom(std::uint32_t& state)
+    {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+bool JobSystem::WorkQueue::Push(Task* task)
+{
+    const std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+    const std::int64_t top = mTop.load(std::memory_order_acquire);
+    if (bottom - top >= Capacity)
+        return false;
+
+    mTasks[bottom & (Capacity - 1)].store(task, std::memory_order_relaxed);
+    mBottom.store(bottom + 1, std::memory_order_release);
+
+    return true;
+}
+
+JobSystem::Task* JobSystem::WorkQueue::Pop()
+{
+    const std::int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = mTop.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        // 비어 있습니다.
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Task* task = mTasks[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // 마지막 하나는 훔치는 스레드와 경쟁합니다.
+        if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            task = nullptr;
+
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return task;
+}
+
+JobSystem::Task* JobSystem::WorkQueue::Steal()
+{
+    std::int64_t top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+    if (top >= bottom)
+        return nullptr;
+
+    Task* task = mTasks[top & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+
+    return task;
+}
+
+bool JobSystem::WorkQueue::IsEmpty() const
+{
+    return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+}
+
+bool JobSystem::Counter::IsDone() const
+{
+    // 마지막 작업의 Finish가 잠금을 풀 때까지 기다리므로 true를 반환한 다음에는 파괴해도 됩니다.
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPending.load(std::memory_order_relaxed) == 0;
+}
+
+JobSystem::JobSystem(std::uint32_t workerCount)
+{
+    // 모든 워커를 만든 다음에 스레드를 시작합니다. 워커들은 서로의 덱에서 훔칩니다.
+    for (std::uint32_t i = 0; i < workerCount; ++i)
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->RandomState = 0x9E3779B9u * (i + 1);
+        mWorkers.push_back(std::move(worker));
+    }
+
+    for (std::uint32_t i = 0; i < workerCount; ++i)
+        mWorkers[i]->Thread = std::thread([this, i]() { WorkerMain(i); });
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStopping = true;
+    }
+    mSleepCondition.notify_all();
+
+    for (auto& worker : mWorkers)
+        worker->Thread.join();
+}
+
+JobSystem& JobSystem::Default()
+{
+    static JobSystem system([]()
+        {
+            const std::uint32_t threadCount = std::thread::hardware_concurrency();
+            return threadCount > 1 ? threadCount - 1 : 0;
+        }());
+
+    return system;
+}
+
+std::uint32_t JobSystem::WorkerCount() const
+{
+    return (std::uint32_t)mWorkers.size();
+}
+
+void JobSystem::Run(JobFunction job, Counter* counter)
+{
+    if (counter != nullptr)
+        counter->mPending.fetch_add(1, std::memory_order_relaxed);
+
+    Submit(new Task{ std::move(job), counter });
+}
+
+void JobSystem::RunAfter(Counter& dependency, JobFunction job, Counter* counter)
+{
+    if (counter != nullptr)
+        counter->mPending.fetch_add(1, std::memory_order_relaxed);
+
+    Task* task = new Task{ std::move(job), counter };
+    {
+        std::lock_guard<std::mutex> lock(dependency.mMutex);
+        if (dependency.mPending.load(std::memory_order_relaxed) != 0)
+        {
+            dependency.mContinuations.push_back(task);
+            return;
+        }
+    }
+
+    Submit(task);
+}
+
+void JobSystem::Wait(Counter& counter)
+{
+    Worker* worker = CurrentWorker();
+
+    while (counter.mPending.load(std::memory_order_acquire) != 0 || !counter.IsDone())
+    {
+        if (Task* task = FindTask(worker))
+            Execute(task);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::ParallelForRange(std::uint32_t count, std::uint32_t grain, const RangeFunction& body)
+{
+    if (count == 0)
+        return;
+
+    // 지정하지 않으면 스레드마다 16조각 정도가 되도록 합니다. 실제로 나뉘는 크기는 RunRange가 정합니다.
+    if (grain == 0)
+        grain = std::max<std::uint32_t>(count / ((WorkerCount() + 1) * 16), 1);
+
+    if (mWorkers.empty() || count <= grain)
+    {
+        body(0, count);
+        return;
+    }
+
+    Counter counter;
+    RunRange(0, count, grain, body, counter);
+    Wait(counter);
+}
+
+ScratchArena& JobSystem::Scratch()
+{
+    if (Worker* worker = CurrentWorker())
+        return worker->Scratch;
+
+    // 워커가 아닌 스레드는 각자의 스크래치 메모리를 사용합니다.
+    thread_local ScratchArena scratch;
+    return scratch;
+}
+
+JobSystem::Stats JobSystem::GetStats() const
+{
+    Stats stats;
+    stats.RangeSplits = mSharedSplits.load(std::memory_order_relaxed);
+
+    for (const auto& worker : mWorkers)
+    {
+        stats.JobsExecuted += worker->JobsExecuted.load(std::memory_order_relaxed);
+        stats.JobsStolen += worker->JobsStolen.load(std::memory_order_relaxed);
+        stats.RangeSplits += worker->RangeSplits.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+void JobSystem::WorkerMain(std::uint32_t index)
+{
+    tJobSystem = this;
+    tWorkerIndex = index;
+    Profiler::SetThreadName("Worker");
+
+    Worker* worker = mWorkers[index].get();
+
+    for (;;)
+    {
+        // 작업을 찾기 전의 세대를 기억합니다. 찾는 동안 작업이 들어왔으면 잠들지 않습니다.
+        const std::uint64_t epoch = mWorkEpoch.load(std::memory_order_seq_cst);
+
+        if (Task* task = FindTask(worker))
+        {
+            Execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        if (mStopping)
+            break;
+
+        mSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        mSleepCondition.wait(lock, [this, epoch]()
+            {
+                return mStopping || mWorkEpoch.load(std::memory_order_seq_cst) != epoch;
+            });
+        mSleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+
+        if (mStopping)
+            break;
+    }
+}
+
+JobSystem::Worker* JobSystem::CurrentWorker() const
+{
+    return tJobSystem == this ? mWorkers[tWorkerIndex].get() : nullptr;
+}
+
+void JobSystem::Submit(Task* task)
+{
+    // 워커가 없으면 바로 실행합니다.
+    if (mWorkers.empty())
+    {
+        Execute(task);
+        return;
+    }
+
+    if (Worker* worker = CurrentWorker())
+    {
+        // 덱이 가득 찼으면 나중에 실행할 이유가 없으므로 바로 실행합니다.
+        if (!worker->Queue.Push(task))
+        {
+            Execute(task);
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(mSharedMutex);
+        mSharedQueue.push_back(task);
+        mSharedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    WakeWorkers();
+}
+
+JobSystem::Task* JobSystem::FindTask(Worker* worker)
+{
+    // 자신의 덱, 공유 큐, 다른 워커의 덱 순서로 찾습니다.
+    if (worker != nullptr)
+    {
+        if (Task* task = worker->Queue.Pop())
+            return task;
+    }
+
+    if (mSharedCount.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(mSharedMutex);
+        if (!mSharedQueue.empty())
+        {
+            Task* task = mSharedQueue.front();
+            mSharedQueue.pop_front();
+            mSharedCount.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+
+    const std::uint32_t workerCount = (std::uint32_t)mWorkers.size();
+    if (workerCount == 0)
+        return nullptr;
+
+    // 여러 스레드가 같은 워커에서 훔치지 않도록 무작위로 시작합니다.
+    const std::uint32_t start = NextRandom(worker != nullptr ? worker->RandomState : tRandomState) % workerCount;
+    for (std::uint32_t i = 0; i < workerCount; ++i)
+    {
+        Worker* victim = mWorkers[(start + i) % workerCount].get();
+        if (victim == worker)
+            continue;
+
+        if (Task* task = victim->Queue.Steal())
+        {
+            if (worker != nullptr)
+                worker->JobsStolen.fetch_add(1, std::memory_order_relaxed);
+
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::Execute(Task* task)
+{
+    task->Function();
+
+    if (Worker* worker = CurrentWorker())
+        worker->JobsExecuted.fetch_add(1, std::memory_order_relaxed);
+
+    Counter* counter = task->Completion;
+    delete task;
+
+    if (counter != nullptr)
+        Finish(counter);
+}
+
+void JobSystem::Finish(Counter* counter)
+{
+    // 0이 되는 순간과 RunAfter가 계속 작업을 등록하는 것이 겹치지 않도록 잠금 안에서 줄입니다.
+    std::vector<Task*> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mMutex);
+        if (counter->mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ready.swap(counter->mContinuations);
+    }
+
+    // 여기서부터는 카운터를 건드리지 않습니다. 기다리던 스레드가 파괴했을 수 있습니다.
+    for (Task* task : ready)
+        Submit(task);
+}
+
+void JobSystem::WakeWorkers()
+{
+    mWorkEpoch.fetch_add(1, std::memory_order_seq_cst);
+
+    if (mSleepingWorkers.load(std::memory_order_seq_cst) > 0)
+    {
+        // 잠금을 거쳐서 조건을 확인하고 잠드는 중인 워커가 알림을 놓치지 않게 합니다.
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+        }
+        mSleepCondition.notify_one();
+    }
+}
+
+bool JobSystem::HasQueuedWork(Worker* worker) const
+{
+    if (worker != nullptr)
+        return !worker->Queue.IsEmpty();
+
+    return mSharedCount.load(std::memory_order_relaxed) > 0;
+}
+
+void JobSystem::RunRange(std::uint32_t first, std::uint32_t last, std::uint32_t grain,
+    const RangeFunction& body, Counter& counter)
+{
+    Worker* worker = CurrentWorker();
+
+    while (last - first > grain)
+    {
+        if (!HasQueuedWork(worker))
+        {
+            // 다른 스레드가 가져갈 일이 남아 있지 않으면 뒤쪽 절반을 내놓습니다.
+            const std::uint32_t mid = first + (last - first) / 2;
+            const std::uint32_t end = last;
+
+            Run([this, mid, end, grain, &body, &counter]()
+                {
+                    RunRange(mid, end, grain, body, counter);
+                }, &counter);
+
+            if (worker != nullptr)
+                worker->RangeSplits.fetch_add(1, std::memory_order_relaxed);
+            else
+                mSharedSplits.fetch_add(1, std::memory_order_relaxed);
+
+            last = mid;
+        }
+        else
+        {
+            body(first, first + grain);
+            first += grain;
+        }
+    }
+
+    body(first, last);
+}
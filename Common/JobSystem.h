@@ -0,0 +1,182 @@
+﻿//***************************************************************************************
+// JobSystem.h
+//
+// Portable work-stealing job system.  Every worker thread owns a deque of jobs: it
+// pushes and pops its own jobs at the bottom (the most recently spawned first, while
+// their data is still in cache) and an idle worker steals from the top of another
+// worker's deque.  Threads that are not workers, such as the main and render threads,
+// submit through a shared queue and run jobs themselves while they wait.
+//
+// Jobs are continuation style rather than fibers: a job never blocks a thread.  Waiting
+// on a Counter runs other jobs until the counter reaches zero, and RunAfter schedules
+// a job to start when a dependency counter reaches zero.
+//
+// ParallelFor splits its range lazily.  A range is halved only when the running thread
+// has no queued work left for others to steal, so the split depth, and with it the
+// effective grain size, follows how busy the pool is.  The grain argument is only the
+// smallest piece of work that is handed out.  Scratch() returns the calling thread's
+// ScratchArena for temporary allocations inside a job.
+//***************************************************************************************
+
+#pragma once
+
+#include "ScratchArena.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+    struct Task;
+
+public:
+    using JobFunction = std::function<void()>;
+    using RangeFunction = std::function<void(std::uint32_t begin, std::uint32_t end)>;
+
+    // 끝나지 않은 작업의 수입니다. 0이 되면 이 카운터를 기다리던 작업들이 시작됩니다.
+    // 작업들이 끝나기 전에 파괴하면 안 되고, Wait가 반환된 다음에는 다시 사용할 수 있습니다.
+    class Counter
+    {
+    public:
+        Counter() = default;
+
+        Counter(const Counter& rhs) = delete;
+        Counter& operator=(const Counter& rhs) = delete;
+
+        bool IsDone() const;
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<std::uint32_t> mPending{0};
+
+        mutable std::mutex mMutex;
+        std::vector<Task*> mContinuations;
+    };
+
+    struct Stats
+    {
+        std::uint64_t JobsExecuted = 0;
+        std::uint64_t JobsStolen = 0;
+        std::uint64_t RangeSplits = 0;
+    };
+
+    // workerCount가 0이면 모든 작업을 기다리는 스레드가 실행합니다.
+    explicit JobSystem(std::uint32_t workerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem& rhs) = delete;
+    JobSystem& operator=(const JobSystem& rhs) = delete;
+
+    // 하드웨어 스레드 수보다 하나 적은 워커를 가진 전역 작업 시스템입니다.
+    // 기다리는 스레드가 나머지 하나의 역할을 합니다.
+    static JobSystem& Default();
+
+    std::uint32_t WorkerCount() const;
+
+    // 작업은 예외를 던지지 않아야 합니다. counter가 있으면 작업이 끝날 때 줄어듭니다.
+    void Run(JobFunction job, Counter* counter = nullptr);
+
+    // dependency가 0이 된 다음에 작업을 시작합니다. 이미 0이면 바로 시작합니다.
+    void RunAfter(Counter& dependency, JobFunction job, Counter* counter = nullptr);
+
+    // counter가 0이 될 때까지 다른 작업들을 실행하면서 기다립니다.
+    void Wait(Counter& counter);
+
+    // [first, last)의 모든 인덱스에 대해서 body를 호출하고 모두 끝날 때까지 기다립니다.
+    // concurrency::parallel_for와 같은 형태입니다. grain이 0이면 작업 수에서 정합니다.
+    template<typename Index, typename Function>
+    void ParallelFor(Index first, Index last, const Function& body, std::uint32_t grain = 0)
+    {
+        if (!(first < last))
+            return;
+
+        ParallelForRange((std::uint32_t)(last - first), grain, [first, &body](std::uint32_t begin, std::uint32_t end)
+            {
+                for (std::uint32_t i = begin; i < end; ++i)
+                    body((Index)(first + (Index)i));
+            });
+    }
+
+    // [0, count)를 나눠서 body(begin, end)를 호출합니다.
+    void ParallelForRange(std::uint32_t count, std::uint32_t grain, const RangeFunction& body);
+
+    // 호출한 스레드의 스크래치 메모리입니다. ScratchArena::Scope로 사용한 만큼 되돌립니다.
+    ScratchArena& Scratch();
+
+    Stats GetStats() const;
+
+private:
+    struct Task
+    {
+        JobFunction Function;
+        Counter* Completion = nullptr;
+    };
+
+    // Chase-Lev 작업 훔치기 덱입니다. 주인 스레드만 아래쪽에 넣고 빼며, 다른 스레드들은 위쪽에서 훔칩니다.
+    class WorkQueue
+    {
+    public:
+        static const std::int64_t Capacity = 4096;
+
+        // 가득 차면 false를 반환합니다.
+        bool Push(Task* task);
+        Task* Pop();
+        Task* Steal();
+        bool IsEmpty() const;
+
+    private:
+        std::atomic<std::int64_t> mTop{0};
+        std::atomic<std::int64_t> mBottom{0};
+        std::atomic<Task*> mTasks[Capacity];
+    };
+
+    struct Worker
+    {
+        WorkQueue Queue;
+        ScratchArena Scratch;
+        std::thread Thread;
+
+        std::uint32_t RandomState = 0;
+        std::atomic<std::uint64_t> JobsExecuted{0};
+        std::atomic<std::uint64_t> JobsStolen{0};
+        std::atomic<std::uint64_t> RangeSplits{0};
+    };
+
+    void WorkerMain(std::uint32_t index);
+
+    // 현재 스레드가 이 작업 시스템의 워커이면 그 워커를 반환합니다.
+    Worker* CurrentWorker() const;
+
+    void Submit(Task* task);
+    Task* FindTask(Worker* worker);
+    void Execute(Task* task);
+    void Finish(Counter* counter);
+    void WakeWorkers();
+
+    bool HasQueuedWork(Worker* worker) const;
+    void RunRange(std::uint32_t first, std::uint32_t last, std::uint32_t grain,
+        const RangeFunction& body, Counter& counter);
+
+private:
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+
+    // 워커가 아닌 스레드가 제출한 작업들입니다.
+    mutable std::mutex mSharedMutex;
+    std::deque<Task*> mSharedQueue;
+    std::atomic<std::uint32_t> mSharedCount{0};
+    std::atomic<std::uint64_t> mSharedSplits{0};
+
+    // 일이 없는 워커는 잠듭니다. 작업을 넣을 때마다 mWorkEpoch를 올려서 잠들기 직전에 들어온 작업을 놓치지 않습니다.
+    std::mutex mSleepMutex;
+    std::condition_variable mSleepCondition;
+    std::atomic<std::uint64_t> mWorkEpoch{0};
+    std::atomic<std::uint32_t> mSleepingWorkers{0};
+    bool mStopping = false;
+};
@@ -5,6 +5,7 @@
 #include "MathHelper.h"
 #include <float.h>
 #include <cmath>
+#include <utility>
 
 using namespace DirectX;
 
@@ -33,6 +34,36 @@ float MathHelper::AngleFromXY(float x, float y)
 	return theta;
 }
 
+void MathHelper::ComputeFrustumPlanes(CXMMATRIX viewProj, XMFLOAT4 planes[6], bool reverseZ)
+{
+	// With row vectors, clip = p * viewProj, so each clip coordinate is p dotted with a
+	// column of viewProj.  Direct3D clips to -w <= x,y <= w and 0 <= z <= w.
+	XMMATRIX M = XMMatrixTranspose(viewProj);
+
+	XMVECTOR p[6] =
+	{
+		XMVectorAdd(M.r[3], M.r[0]),      // left
+		XMVectorSubtract(M.r[3], M.r[0]), // right
+		XMVectorAdd(M.r[3], M.r[1]),      // bottom
+		XMVectorSubtract(M.r[3], M.r[1]), // top
+		M.r[2],                           // near
+		XMVectorSubtract(M.r[3], M.r[2])  // far
+	};
+
+	// With reversed depth, z = w is the near plane and z = 0 is the far plane.
+	if (reverseZ)
+		std::swap(p[4], p[5]);
+
+	for (int i = 0; i < 6; ++i)
+	{
+		// The far plane of an infinite projection has no normal.
+		if (XMVectorGetX(XMVector3LengthSq(p[i])) < 1e-20f)
+			planes[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+		else
+			XMStoreFloat4(&planes[i], XMPlaneNormalize(p[i]));
+	}
+}
+
 XMVECTOR MathHelper::RandUnitVec3()
 {
 	XMVECTOR One = XMVectorSet(1.0f, 1.0f, 1.0f, 1.0f);
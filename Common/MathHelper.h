@@ -6,9 +6,9 @@
 
 #pragma once
 
-#include <Windows.h>
 #include <DirectXMath.h>
 #include <cstdint>
+#include <cstdlib>
 
 class MathHelper
 {
@@ -89,6 +89,14 @@ public:
 		return I;
 	}
 
+	// Extracts the six world-space frustum planes (left, right, bottom, top, near, far)
+	// from a view-projection matrix.  The planes are normalized and their normals point
+	// into the frustum, so a point p is inside when dot(plane.xyz, p) + plane.w >= 0.
+	// Set reverseZ when the projection maps the near plane to depth 1 and the far plane
+	// to depth 0.  An infinite far plane is returned as (0, 0, 0, 1), which every point
+	// passes.
+	static void ComputeFrustumPlanes(DirectX::CXMMATRIX viewProj, DirectX::XMFLOAT4 planes[6], bool reverseZ = false);
+
 	static DirectX::XMVECTOR RandUnitVec3();
 	static DirectX::XMVECTOR RandHemisphereUnitVec3(DirectX::XMVECTOR n);
 
@@ -0,0 +1,316 @@
+﻿//***************************************************************************************
+// MipGenerator.cpp
+//***************************************************************************************
+
+#include "MipGenerator.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+// 카이저 필터의 반지름(출력 텍셀 단위)과 창의 모양을 정하는 알파입니다.
+static const float gKaiserRadius = 3.0f;
+static const float gKaiserAlpha = 4.0f;
+
+// 선형 공간의 float 텍셀입니다. 밉은 항상 이전 밉의 이 형태에서 만듭니다.
+struct FloatImage
+{
+    std::uint32_t Width = 0;
+    std::uint32_t Height = 0;
+    std::vector<XMFLOAT4> Texels;
+};
+
+// 출력 텍셀 하나가 읽는 원본 텍셀과 가중치입니다.
+struct FilterTap
+{
+    std::uint32_t Index;
+    float Weight;
+};
+
+//---------------------------------------------------------------------------------------
+// 필터
+//---------------------------------------------------------------------------------------
+
+// 0차 제1종 변형 베셀 함수의 급수 전개입니다.
+static float BesselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    const float halfX = 0.5f * x;
+    for (int k = 1; k < 32; ++k)
+    {
+        const float t = halfX / k;
+        term *= t * t;
+        sum += term;
+        if (term < 1e-7f * sum)
+            break;
+    }
+
+    return sum;
+}
+
+// d는 출력 텍셀 단위의 거리입니다.
+static float EvaluateFilter(MipFilter filter, float d)
+{
+    d = std::fabs(d);
+
+    if (filter == MipFilter::Box)
+        return d < 0.5f ? 1.0f : (d == 0.5f ? 0.5f : 0.0f);
+
+    if (d >= gKaiserRadius)
+        return 0.0f;
+
+    const float t = d / gKaiserRadius;
+    const float window = BesselI0(gKaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(gKaiserAlpha);
+    const float sinc = d < 1e-6f ? 1.0f : std::sin(XM_PI * d) / (XM_PI * d);
+
+    return sinc * window;
+}
+
+static float GetFilterRadius(MipFilter filter)
+{
+    return filter == MipFilter::Box ? 0.5f : gKaiserRadius;
+}
+
+// 한 축의 출력 텍셀마다 탭을 만듭니다. 이미지 밖은 가장자리 텍셀로 고정합니다.
+static void BuildFilterTaps(std::uint32_t srcSize, std::uint32_t dstSize, MipFilter filter,
+    std::vector<std::vector<FilterTap>>& taps)
+{
+    const float scale = (float)srcSize / dstSize;
+    const float radius = GetFilterRadius(filter) * scale;
+
+    taps.assign(dstSize, std::vector<FilterTap>());
+    for (std::uint32_t x = 0; x < dstSize; ++x)
+    {
+        const float center = (x + 0.5f) * scale;
+        const int first = (int)std::floor(center - radius);
+        const int last = (int)std::ceil(center + radius);
+
+        float weightSum = 0.0f;
+        for (int s = first; s <= last; ++s)
+        {
+            const float weight = EvaluateFilter(filter, (s + 0.5f - center) / scale);
+            if (weight == 0.0f)
+                continue;
+
+            const int index = std::min<int>(std::max<int>(s, 0), (int)srcSize - 1);
+            taps[x].push_back({ (std::uint32_t)index, weight });
+            weightSum += weight;
+        }
+
+        for (FilterTap& tap : taps[x])
+            tap.Weight /= weightSum;
+    }
+}
+
+// 가로, 세로 순서로 나눠서 필터링합니다. 각 패스는 행 단위로 병렬 처리합니다.
+static void Downsample(const FloatImage& src, MipFilter filter, FloatImage& dst)
+{
+    dst.Width = std::max<std::uint32_t>(src.Width / 2, 1);
+    dst.Height = std::max<std::uint32_t>(src.Height / 2, 1);
+    dst.Texels.resize((size_t)dst.Width * dst.Height);
+
+    std::vector<std::vector<FilterTap>> tapsX;
+    std::vector<std::vector<FilterTap>> tapsY;
+    BuildFilterTaps(src.Width, dst.Width, filter, tapsX);
+    BuildFilterTaps(src.Height, dst.Height, filter, tapsY);
+
+    std::vector<XMFLOAT4> temp((size_t)dst.Width * src.Height);
+
+    JobSystem::Default().ParallelFor(0, (int)src.Height, [&](int y)
+    {
+        const XMFLOAT4* srcRow = &src.Texels[(size_t)y * src.Width];
+        XMFLOAT4* tempRow = &temp[(size_t)y * dst.Width];
+
+        for (std::uint32_t x = 0; x < dst.Width; ++x)
+        {
+            XMVECTOR sum = XMVectorZero();
+            for (const FilterTap& tap : tapsX[x])
+                sum = XMVectorMultiplyAdd(XMLoadFloat4(&srcRow[tap.Index]), XMVectorReplicate(tap.Weight), sum);
+
+            XMStoreFloat4(&tempRow[x], sum);
+        }
+    });
+
+    JobSystem::Default().ParallelFor(0, (int)dst.Height, [&](int y)
+    {
+        XMFLOAT4* dstRow = &dst.Texels[(size_t)y * dst.Width];
+
+        for (std::uint32_t x = 0; x < dst.Width; ++x)
+        {
+            XMVECTOR sum = XMVectorZero();
+            for (const FilterTap& tap : tapsY[y])
+                sum = XMVectorMultiplyAdd(XMLoadFloat4(&temp[(size_t)tap.Index * dst.Width + x]), XMVectorReplicate(tap.Weight), sum);
+
+            // sinc의 음수 로브가 만든 링잉이 다음 밉으로 쌓이지 않게 자릅니다.
+            XMStoreFloat4(&dstRow[x], XMVectorSaturate(sum));
+        }
+    });
+}
+
+//---------------------------------------------------------------------------------------
+// 변환과 알파 커버리지
+//---------------------------------------------------------------------------------------
+
+static void ToFloatImage(const RgbaImage& src, bool srgb, FloatImage& dst)
+{
+    dst.Width = src.Width;
+    dst.Height = src.Height;
+    dst.Texels.resize((size_t)src.Width * src.Height);
+
+    const XMVECTOR toFloat = XMVectorReplicate(1.0f / 255.0f);
+    for (size_t i = 0; i < dst.Texels.size(); ++i)
+    {
+        const std::uint8_t* p = &src.Pixels[i * 4];
+        XMVECTOR c = XMVectorMultiply(XMVectorSet(p[0], p[1], p[2], p[3]), toFloat);
+        if (srgb)
+            c = XMColorSRGBToRGB(c);
+
+        XMStoreFloat4(&dst.Texels[i], c);
+    }
+}
+
+static void ToRgbaImage(const FloatImage& src, bool srgb, float alphaScale, RgbaImage& dst)
+{
+    dst.Resize(src.Width, src.Height);
+
+    const XMVECTOR scale = XMVectorSet(255.0f, 255.0f, 255.0f, 255.0f * alphaScale);
+    for (size_t i = 0; i < src.Texels.size(); ++i)
+    {
+        XMVECTOR c = XMLoadFloat4(&src.Texels[i]);
+        if (srgb)
+            c = XMColorRGBToSRGB(c);
+
+        c = XMVectorClamp(XMVectorMultiplyAdd(c, scale, g_XMOneHalf), XMVectorZero(), XMVectorReplicate(255.0f));
+
+        XMFLOAT4 v;
+        XMStoreFloat4(&v, c);
+
+        std::uint8_t* p = &dst.Pixels[i * 4];
+        p[0] = (std::uint8_t)v.x;
+        p[1] = (std::uint8_t)v.y;
+        p[2] = (std::uint8_t)v.z;
+        p[3] = (std::uint8_t)v.w;
+    }
+}
+
+static float ComputeCoverage(const FloatImage& image, float alphaReference, float alphaScale)
+{
+    size_t count = 0;
+    for (const XMFLOAT4& t : image.Texels)
+    {
+        if (std::min<float>(t.w * alphaScale, 1.0f) >= alphaReference)
+            ++count;
+    }
+
+    return (float)count / image.Texels.size();
+}
+
+// 커버리지는 알파 배율에 대해 단조 증가하므로 이분 탐색으로 배율을 찾습니다.
+static float FindAlphaScale(const FloatImage& image, float alphaReference, float targetCoverage)
+{
+    float lo = 0.0f;
+    float hi = 4.0f;
+    for (int i = 0; i < 12; ++i)
+    {
+        const float mid = 0.5f * (lo + hi);
+        if (ComputeCoverage(image, alphaReference, mid) < targetCoverage)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return hi;
+}
+
+//---------------------------------------------------------------------------------------
+// MipGenerator
+//---------------------------------------------------------------------------------------
+
+MipGenerator::MipGenerator(const MipGenerationOptions& options)
+    : mOptions(options)
+{
+}
+
+const MipGenerationOptions& MipGenerator::Options() const
+{
+    return mOptions;
+}
+
+void MipGenerator::Generate(const RgbaImage& source, std::vector<RgbaImage>& mipChain, std::uint32_t mipLevels) const
+{
+    PROFILE_FUNCTION();
+
+    const std::uint32_t fullCount = GetMipCount(source.Width, source.Height);
+    if (mipLevels == 0 || mipLevels > fullCount)
+        mipLevels = fullCount;
+
+    mipChain.resize(mipLevels);
+    mipChain[0] = source;
+
+    if (source.Width == 0 || source.Height == 0)
+        return;
+
+    FloatImage level;
+    ToFloatImage(source, mOptions.Srgb, level);
+
+    const float targetCoverage = mOptions.PreserveAlphaCoverage ?
+        ComputeCoverage(level, mOptions.AlphaReference, 1.0f) : 0.0f;
+
+    FloatImage next;
+    for (std::uint32_t mip = 1; mip < mipLevels; ++mip)
+    {
+        Downsample(level, mOptions.Filter, next);
+
+        // 배율은 출력에만 적용하고 다음 밉은 배율을 적용하지 않은 값에서 만듭니다.
+        const float alphaScale = mOptions.PreserveAlphaCoverage ?
+            FindAlphaScale(next, mOptions.AlphaReference, targetCoverage) : 1.0f;
+
+        ToRgbaImage(next, mOptions.Srgb, alphaScale, mipChain[mip]);
+        std::swap(level, next);
+    }
+}
+
+void MipGenerator::GenerateArray(const std::vector<RgbaImage>& slices,
+    std::vector<std::vector<RgbaImage>>& mipChains, std::uint32_t mipLevels) const
+{
+    PROFILE_FUNCTION();
+
+    mipChains.resize(slices.size());
+
+    JobSystem::Default().ParallelFor(0, (int)slices.size(), [&](int i)
+    {
+        Generate(slices[i], mipChains[i], mipLevels);
+    });
+}
+
+std::uint32_t MipGenerator::GetMipCount(std::uint32_t width, std::uint32_t height)
+{
+    std::uint32_t count = 1;
+    while (width > 1 || height > 1)
+    {
+        width = std::max<std::uint32_t>(width / 2, 1);
+        height = std::max<std::uint32_t>(height / 2, 1);
+        ++count;
+    }
+
+    return count;
+}
+
+float MipGenerator::ComputeAlphaCoverage(const RgbaImage& image, float alphaReference)
+{
+    if (image.Pixels.empty())
+        return 0.0f;
+
+    size_t count = 0;
+    for (size_t i = 3; i < image.Pixels.size(); i += 4)
+    {
+        if (image.Pixels[i] / 255.0f >= alphaReference)
+            ++count;
+    }
+
+    return (float)count / ((size_t)image.Width * image.Height);
+}
@@ -0,0 +1,60 @@
+﻿//***************************************************************************************
+// MipGenerator.h
+//
+// CPU mip chain generation for textures that ship without mips (most of the DXT1 files
+// in the Textures directory).  Each level is filtered from the previous one in linear
+// float space: sRGB texels are converted before filtering and back afterwards, alpha is
+// always linear.  The box filter is the classic 2x2 average; the Kaiser-windowed sinc
+// keeps more detail in the small mips.  Rows of a level and slices of an array are
+// filtered in parallel; the levels themselves depend on each other.
+//
+// For alpha tested textures the alpha of each mip can be scaled so the fraction of
+// texels that pass the alpha test matches the top mip, so cutouts do not thin out or
+// disappear in the distance.
+//***************************************************************************************
+
+#pragma once
+
+#include "BlockCompressor.h"
+
+enum class MipFilter
+{
+    Box,   // 2x2 평균
+    Kaiser // 카이저 창을 씌운 sinc, 반지름 3 텍셀
+};
+
+struct MipGenerationOptions
+{
+    MipFilter Filter = MipFilter::Box;
+
+    // sRGB 텍셀은 선형 공간으로 바꿔서 필터링합니다. GenerateDDSMipChain은 포맷으로 정합니다.
+    bool Srgb = false;
+
+    // 알파 테스트(clip(alpha - AlphaReference))를 통과하는 텍셀의 비율을 모든 밉에서 유지합니다.
+    bool PreserveAlphaCoverage = false;
+    float AlphaReference = 0.5f;
+};
+
+class MipGenerator
+{
+public:
+    explicit MipGenerator(const MipGenerationOptions& options = MipGenerationOptions());
+
+    const MipGenerationOptions& Options() const;
+
+    // mipChain[0]은 source의 복사본입니다. mipLevels가 0이면 1x1까지 모든 밉을 만듭니다.
+    void Generate(const RgbaImage& source, std::vector<RgbaImage>& mipChain, std::uint32_t mipLevels = 0) const;
+
+    // 텍스쳐 배열의 슬라이스마다 밉 체인을 만듭니다. 슬라이스들은 병렬로 처리됩니다.
+    void GenerateArray(const std::vector<RgbaImage>& slices,
+        std::vector<std::vector<RgbaImage>>& mipChains, std::uint32_t mipLevels = 0) const;
+
+    // 1x1까지의 밉 개수입니다.
+    static std::uint32_t GetMipCount(std::uint32_t width, std::uint32_t height);
+
+    // 알파가 alphaReference 이상인 텍셀의 비율입니다.
+    static float ComputeAlphaCoverage(const RgbaImage& image, float alphaReference);
+
+private:
+    MipGenerationOptions mOptions;
+};
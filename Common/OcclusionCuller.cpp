@@ -0,0 +1,366 @@
+﻿//***************************************************************************************
+// OcclusionCuller.cpp
+//***************************************************************************************
+
+#include "OcclusionCuller.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+OcclusionCuller::OcclusionCuller(std::uint32_t width, std::uint32_t height)
+{
+    // 한 번에 네 픽셀씩 그리므로 행의 길이는 4의 배수여야 합니다.
+    mWidth = (std::max<std::uint32_t>(width, 4) + 3) & ~3u;
+    mHeight = std::max<std::uint32_t>(height, 1);
+
+    XMStoreFloat4x4(&mViewProj, XMMatrixIdentity());
+
+    std::uint32_t w = mWidth;
+    std::uint32_t h = mHeight;
+    for (;;)
+    {
+        mLevels.push_back(std::vector<float>((size_t)w * h, 1.0f));
+        mLevelWidths.push_back(w);
+        mLevelHeights.push_back(h);
+
+        if (w == 1 && h == 1)
+            break;
+
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+}
+
+std::uint32_t OcclusionCuller::Width() const
+{
+    return mWidth;
+}
+
+std::uint32_t OcclusionCuller::Height() const
+{
+    return mHeight;
+}
+
+void OcclusionCuller::BeginFrame(CXMMATRIX viewProj)
+{
+    PROFILE_FUNCTION();
+
+    XMStoreFloat4x4(&mViewProj, viewProj);
+
+    std::fill(mLevels[0].begin(), mLevels[0].end(), 1.0f);
+
+    mStats = CullStats();
+}
+
+void OcclusionCuller::RasterizeOccluder(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const std::uint32_t* indices, std::uint32_t indexCount, FXMMATRIX world)
+{
+    RasterizeIndexed(positions, stride, vertexCount, indices, indexCount, world);
+}
+
+void OcclusionCuller::RasterizeOccluder(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const std::uint16_t* indices, std::uint32_t indexCount, FXMMATRIX world)
+{
+    RasterizeIndexed(positions, stride, vertexCount, indices, indexCount, world);
+}
+
+template<typename Index>
+void OcclusionCuller::RasterizeIndexed(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const Index* indices, std::uint32_t indexCount, FXMMATRIX world)
+{
+    PROFILE_FUNCTION();
+
+    mStats.Occluders++;
+
+    // 정점마다 한 번만 클립 공간으로 변환합니다.
+    XMMATRIX worldViewProj = XMMatrixMultiply(world, XMLoadFloat4x4(&mViewProj));
+
+    mClipVertices.resize(vertexCount);
+
+    const std::uint8_t* src = static_cast<const std::uint8_t*>(positions);
+    for (std::uint32_t i = 0; i < vertexCount; ++i, src += stride)
+    {
+        XMVECTOR p = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(src));
+        XMStoreFloat4(&mClipVertices[i], XMVector3Transform(p, worldViewProj));
+    }
+
+    for (std::uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const XMFLOAT4& c0 = mClipVertices[indices[i + 0]];
+        const XMFLOAT4& c1 = mClipVertices[indices[i + 1]];
+        const XMFLOAT4& c2 = mClipVertices[indices[i + 2]];
+
+        // 세 정점이 모두 같은 클립 평면 밖에 있으면 그릴 필요가 없습니다.
+        if ((c0.x > c0.w && c1.x > c1.w && c2.x > c2.w) ||
+            (c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) ||
+            (c0.y > c0.w && c1.y > c1.w && c2.y > c2.w) ||
+            (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w) ||
+            (c0.z < 0.0f && c1.z < 0.0f && c2.z < 0.0f) ||
+            (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w))
+        {
+            mStats.TrianglesSkipped++;
+            continue;
+        }
+
+        ClipAndRasterize(c0, c1, c2);
+    }
+}
+
+XMFLOAT3 OcclusionCuller::ToScreen(const XMFLOAT4& clip) const
+{
+    const float invW = 1.0f / clip.w;
+
+    return XMFLOAT3(
+        (clip.x * invW * 0.5f + 0.5f) * mWidth,
+        (0.5f - clip.y * invW * 0.5f) * mHeight,
+        clip.z * invW);
+}
+
+void OcclusionCuller::ClipAndRasterize(const XMFLOAT4& c0, const XMFLOAT4& c1, const XMFLOAT4& c2)
+{
+    if (c0.z >= 0.0f && c1.z >= 0.0f && c2.z >= 0.0f)
+    {
+        RasterizeTriangle(ToScreen(c0), ToScreen(c1), ToScreen(c2));
+        return;
+    }
+
+    // 근평면(z = 0)으로 자르면 삼각형이나 사각형이 남습니다.
+    const XMFLOAT4* in[3] = { &c0, &c1, &c2 };
+    XMFLOAT4 out[4];
+    int outCount = 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const XMFLOAT4& a = *in[i];
+        const XMFLOAT4& b = *in[(i + 1) % 3];
+
+        if (a.z >= 0.0f)
+            out[outCount++] = a;
+
+        if ((a.z >= 0.0f) != (b.z >= 0.0f))
+        {
+            const float t = a.z / (a.z - b.z);
+            XMStoreFloat4(&out[outCount++], XMVectorLerp(XMLoadFloat4(&a), XMLoadFloat4(&b), t));
+        }
+    }
+
+    if (outCount < 3)
+    {
+        mStats.TrianglesSkipped++;
+        return;
+    }
+
+    const XMFLOAT3 s0 = ToScreen(out[0]);
+    for (int i = 1; i + 1 < outCount; ++i)
+        RasterizeTriangle(s0, ToScreen(out[i]), ToScreen(out[i + 1]));
+}
+
+void OcclusionCuller::RasterizeTriangle(XMFLOAT3 v0, XMFLOAT3 v1, XMFLOAT3 v2)
+{
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (std::fabs(area) < 1e-8f)
+    {
+        mStats.TrianglesSkipped++;
+        return;
+    }
+
+    // 뒷면도 그리므로 감기는 방향을 한쪽으로 맞춥니다.
+    if (area < 0.0f)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    // 픽셀 중심(x + 0.5)이 삼각형 안에 있는 픽셀만 덮습니다.
+    const int minX = std::max<int>((int)std::ceil(std::min<float>(v0.x, std::min<float>(v1.x, v2.x)) - 0.5f), 0);
+    const int maxX = std::min<int>((int)std::floor(std::max<float>(v0.x, std::max<float>(v1.x, v2.x)) - 0.5f), (int)mWidth - 1);
+    const int minY = std::max<int>((int)std::ceil(std::min<float>(v0.y, std::min<float>(v1.y, v2.y)) - 0.5f), 0);
+    const int maxY = std::min<int>((int)std::floor(std::max<float>(v0.y, std::max<float>(v1.y, v2.y)) - 0.5f), (int)mHeight - 1);
+
+    if (minX > maxX || minY > maxY)
+    {
+        mStats.TrianglesSkipped++;
+        return;
+    }
+
+    mStats.TrianglesRasterized++;
+
+    // 모서리 함수 E(p) = (b - a) x (p - a)는 세 모서리 모두에서 0 이상일 때 삼각형 안입니다.
+    // E12, E20, E01을 넓이로 나누면 v0, v1, v2의 무게중심 좌표입니다.
+    const float e0dx = -(v2.y - v1.y), e0dy = v2.x - v1.x;
+    const float e1dx = -(v0.y - v2.y), e1dy = v0.x - v2.x;
+    const float e2dx = -(v1.y - v0.y), e2dy = v1.x - v0.x;
+
+    const float invArea = 1.0f / area;
+    const float zdx = (e0dx * v0.z + e1dx * v1.z + e2dx * v2.z) * invArea;
+    const float zdy = (e0dy * v0.z + e1dy * v1.z + e2dy * v2.z) * invArea;
+
+    // 네 픽셀 묶음의 시작은 4의 배수로 맞춥니다. 너비가 4의 배수이므로 행을 넘지 않습니다.
+    const int startX = minX & ~3;
+    const float px = startX + 0.5f;
+
+    const XMVECTOR laneOffset = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+    const XMVECTOR e0Step = XMVectorReplicate(4.0f * e0dx);
+    const XMVECTOR e1Step = XMVectorReplicate(4.0f * e1dx);
+    const XMVECTOR e2Step = XMVectorReplicate(4.0f * e2dx);
+    const XMVECTOR zStep = XMVectorReplicate(4.0f * zdx);
+    const XMVECTOR zero = XMVectorZero();
+
+    std::vector<float>& depth = mLevels[0];
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        const float py = y + 0.5f;
+
+        const float e0Row = (v2.x - v1.x) * (py - v1.y) - (v2.y - v1.y) * (px - v1.x);
+        const float e1Row = (v0.x - v2.x) * (py - v2.y) - (v0.y - v2.y) * (px - v2.x);
+        const float e2Row = (v1.x - v0.x) * (py - v0.y) - (v1.y - v0.y) * (px - v0.x);
+        const float zRow = v0.z + zdx * (px - v0.x) + zdy * (py - v0.y);
+
+        XMVECTOR e0 = XMVectorMultiplyAdd(laneOffset, XMVectorReplicate(e0dx), XMVectorReplicate(e0Row));
+        XMVECTOR e1 = XMVectorMultiplyAdd(laneOffset, XMVectorReplicate(e1dx), XMVectorReplicate(e1Row));
+        XMVECTOR e2 = XMVectorMultiplyAdd(laneOffset, XMVectorReplicate(e2dx), XMVectorReplicate(e2Row));
+        XMVECTOR z = XMVectorMultiplyAdd(laneOffset, XMVectorReplicate(zdx), XMVectorReplicate(zRow));
+
+        float* row = &depth[(size_t)y * mWidth];
+
+        for (int x = startX; x <= maxX; x += 4)
+        {
+            XMVECTOR inside = XMVectorAndInt(XMVectorGreaterOrEqual(e0, zero),
+                XMVectorAndInt(XMVectorGreaterOrEqual(e1, zero), XMVectorGreaterOrEqual(e2, zero)));
+
+            XMVECTOR stored = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + x));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + x), XMVectorSelect(stored, XMVectorMin(stored, z), inside));
+
+            e0 = XMVectorAdd(e0, e0Step);
+            e1 = XMVectorAdd(e1, e1Step);
+            e2 = XMVectorAdd(e2, e2Step);
+            z = XMVectorAdd(z, zStep);
+        }
+    }
+}
+
+void OcclusionCuller::BuildHierarchy()
+{
+    PROFILE_FUNCTION();
+
+    // 상위 레벨 텍셀은 자신이 덮는 2x2 텍셀 중 가장 먼 깊이입니다.
+    for (size_t level = 1; level < mLevels.size(); ++level)
+    {
+        const std::vector<float>& src = mLevels[level - 1];
+        std::vector<float>& dst = mLevels[level];
+
+        const std::uint32_t srcW = mLevelWidths[level - 1];
+        const std::uint32_t srcH = mLevelHeights[level - 1];
+        const std::uint32_t dstW = mLevelWidths[level];
+        const std::uint32_t dstH = mLevelHeights[level];
+
+        for (std::uint32_t y = 0; y < dstH; ++y)
+        {
+            const std::uint32_t y0 = 2 * y;
+            const std::uint32_t y1 = std::min<std::uint32_t>(2 * y + 1, srcH - 1);
+
+            for (std::uint32_t x = 0; x < dstW; ++x)
+            {
+                const std::uint32_t x0 = 2 * x;
+                const std::uint32_t x1 = std::min<std::uint32_t>(2 * x + 1, srcW - 1);
+
+                dst[(size_t)y * dstW + x] = std::max<float>(
+                    std::max<float>(src[(size_t)y0 * srcW + x0], src[(size_t)y0 * srcW + x1]),
+                    std::max<float>(src[(size_t)y1 * srcW + x0], src[(size_t)y1 * srcW + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const BoundingBox& worldBounds)
+{
+    mStats.Tests++;
+
+    XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+    worldBounds.GetCorners(corners);
+
+    XMMATRIX viewProj = XMLoadFloat4x4(&mViewProj);
+
+    float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (size_t i = 0; i < BoundingBox::CORNER_COUNT; ++i)
+    {
+        XMFLOAT4 clip;
+        XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corners[i]), viewProj));
+
+        // 근평면에 걸친 박스는 화면 사각형을 구할 수 없으므로 보이는 것으로 취급합니다.
+        if (clip.z < 0.0f || clip.w <= 0.0f)
+            return true;
+
+        const XMFLOAT3 s = ToScreen(clip);
+        minX = std::min<float>(minX, s.x);
+        maxX = std::max<float>(maxX, s.x);
+        minY = std::min<float>(minY, s.y);
+        maxY = std::max<float>(maxY, s.y);
+        minZ = std::min<float>(minZ, s.z);
+    }
+
+    // 화면 밖의 박스는 프러스텀 컬링의 몫입니다.
+    if (maxX < 0.0f || maxY < 0.0f || minX >= (float)mWidth || minY >= (float)mHeight)
+        return false;
+
+    // 박스가 닿는 모든 픽셀을 포함하는 사각형입니다.
+    std::uint32_t x0 = (std::uint32_t)std::max<float>(minX, 0.0f);
+    std::uint32_t y0 = (std::uint32_t)std::max<float>(minY, 0.0f);
+    std::uint32_t x1 = (std::uint32_t)std::min<float>(maxX, (float)(mWidth - 1));
+    std::uint32_t y1 = (std::uint32_t)std::min<float>(maxY, (float)(mHeight - 1));
+
+    // 사각형이 많아야 2x2 텍셀에 걸치는 레벨을 고릅니다.
+    std::uint32_t level = 0;
+    while (level + 1 < (std::uint32_t)mLevels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        ++level;
+
+    x0 >>= level;
+    x1 >>= level;
+    y0 >>= level;
+    y1 >>= level;
+
+    const std::vector<float>& hiz = mLevels[level];
+    const std::uint32_t levelWidth = mLevelWidths[level];
+
+    for (std::uint32_t y = y0; y <= y1; ++y)
+    {
+        for (std::uint32_t x = x0; x <= x1; ++x)
+        {
+            if (minZ <= hiz[(size_t)y * levelWidth + x])
+                return true;
+        }
+    }
+
+    mStats.Occluded++;
+    return false;
+}
+
+std::uint32_t OcclusionCuller::LevelCount() const
+{
+    return (std::uint32_t)mLevels.size();
+}
+
+std::uint32_t OcclusionCuller::GetLevelWidth(std::uint32_t level) const
+{
+    return mLevelWidths[level];
+}
+
+std::uint32_t OcclusionCuller::GetLevelHeight(std::uint32_t level) const
+{
+    return mLevelHeights[level];
+}
+
+const std::vector<float>& OcclusionCuller::GetLevel(std::uint32_t level) const
+{
+    return mLevels[level];
+}
+
+const OcclusionCuller::CullStats& OcclusionCuller::LastStats() const
+{
+    return mStats;
+}
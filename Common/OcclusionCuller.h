@@ -0,0 +1,97 @@
+﻿//***************************************************************************************
+// OcclusionCuller.h
+//
+// Software occlusion culling on the CPU.  Selected occluder meshes are rasterized into
+// a small depth buffer (256x128 by default) four pixels at a time with DirectXMath
+// vectors, then a max-depth pyramid (HiZ) is built from it.  An instance's world AABB
+// is occluded when its nearest projected depth is behind the farthest occluder depth
+// of every HiZ texel its screen rectangle touches; the level is chosen so that at most
+// 2x2 texels are read.
+//
+// Depth follows the D3D convention (0 at the near plane, 1 at the far plane) and the
+// view-projection matrix is the one passed to BeginFrame.  Occluders are drawn without
+// back-face culling so open meshes such as rooms work from either side.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <vector>
+
+class OcclusionCuller
+{
+public:
+    // 마지막 BeginFrame 이후의 통계입니다.
+    struct CullStats
+    {
+        std::uint32_t Occluders = 0;
+        std::uint32_t TrianglesRasterized = 0;
+
+        // 화면 밖, 근평면 뒤, 또는 픽셀 중심을 하나도 덮지 않아서 그리지 않은 삼각형 수입니다.
+        std::uint32_t TrianglesSkipped = 0;
+
+        std::uint32_t Tests = 0;
+        std::uint32_t Occluded = 0;
+    };
+
+    // 너비는 4의 배수로 올립니다.
+    explicit OcclusionCuller(std::uint32_t width = 256, std::uint32_t height = 128);
+
+    std::uint32_t Width() const;
+    std::uint32_t Height() const;
+
+    // 깊이 버퍼를 가장 먼 깊이(1)로 지우고 이번 프레임의 view * proj 행렬을 기억합니다.
+    void BeginFrame(DirectX::CXMMATRIX viewProj);
+
+    // 오클루더 메시를 깊이 버퍼에 그립니다. positions는 stride 바이트 간격으로 놓인 로컬 위치
+    // (XMFLOAT3)들입니다. 정점 구조체의 첫 번째 멤버가 위치이면 정점 버퍼를 그대로 넘길 수 있습니다.
+    void RasterizeOccluder(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+        const std::uint32_t* indices, std::uint32_t indexCount, DirectX::FXMMATRIX world);
+    void RasterizeOccluder(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+        const std::uint16_t* indices, std::uint32_t indexCount, DirectX::FXMMATRIX world);
+
+    // 깊이 버퍼로 최대 깊이 피라미드를 만듭니다. 오클루더를 모두 그린 뒤, 테스트하기 전에 호출합니다.
+    void BuildHierarchy();
+
+    // world 바운딩 박스가 보일 수 있으면 true입니다. 박스가 근평면에 걸치면 항상 true입니다.
+    bool IsVisible(const DirectX::BoundingBox& worldBounds);
+
+    // 피라미드의 레벨 수와 각 레벨의 깊이입니다. 0번 레벨이 깊이 버퍼입니다.
+    std::uint32_t LevelCount() const;
+    std::uint32_t GetLevelWidth(std::uint32_t level) const;
+    std::uint32_t GetLevelHeight(std::uint32_t level) const;
+    const std::vector<float>& GetLevel(std::uint32_t level) const;
+
+    const CullStats& LastStats() const;
+
+private:
+    template<typename Index>
+    void RasterizeIndexed(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+        const Index* indices, std::uint32_t indexCount, DirectX::FXMMATRIX world);
+
+    // 클립 공간 삼각형을 근평면으로 자른 뒤 그립니다.
+    void ClipAndRasterize(const DirectX::XMFLOAT4& c0, const DirectX::XMFLOAT4& c1, const DirectX::XMFLOAT4& c2);
+
+    // 화면 공간(x, y는 픽셀, z는 깊이) 삼각형을 그립니다.
+    void RasterizeTriangle(DirectX::XMFLOAT3 v0, DirectX::XMFLOAT3 v1, DirectX::XMFLOAT3 v2);
+
+    DirectX::XMFLOAT3 ToScreen(const DirectX::XMFLOAT4& clip) const;
+
+private:
+    std::uint32_t mWidth = 0;
+    std::uint32_t mHeight = 0;
+
+    DirectX::XMFLOAT4X4 mViewProj;
+
+    // mLevels[0]이 깊이 버퍼이고 레벨마다 너비와 높이가 절반씩(올림) 줄어듭니다.
+    std::vector<std::vector<float>> mLevels;
+    std::vector<std::uint32_t> mLevelWidths;
+    std::vector<std::uint32_t> mLevelHeights;
+
+    // 클립 공간으로 변환한 오클루더 정점들입니다. 호출마다 재사용합니다.
+    std::vector<DirectX::XMFLOAT4> mClipVertices;
+
+    CullStats mStats;
+};
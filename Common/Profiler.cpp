@@ -0,0 +1,217 @@
+﻿//***************************************************************************************
+// Profiler.cpp
+//***************************************************************************************
+
+#include "Profiler.h"
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* Name;
+        std::int64_t Start;
+        std::int64_t End;
+    };
+
+    // 한 스레드만 쓰는 버퍼입니다. 이벤트를 쓴 뒤에 Count를 release로 올리므로
+    // Count를 acquire로 읽은 스레드는 그 아래의 이벤트들을 읽을 수 있습니다.
+    // Count와 Dropped는 주인 스레드만 바꿉니다. 새 캡쳐가 시작되면 주인 스레드가 다음
+    // Record에서 Generation을 보고 스스로 비웁니다.
+    struct ThreadBuffer
+    {
+        std::uint32_t ThreadId = 0;
+        const char* Name = nullptr; // gBuffersMutex로 보호됩니다.
+
+        std::unique_ptr<Event[]> Events;
+        std::atomic<std::uint32_t> Count{0};
+        std::atomic<std::uint32_t> Dropped{0};
+        std::atomic<std::uint32_t> Generation{0};
+    };
+
+    // 스레드가 끝나도 버퍼는 남겨 둡니다. 그 스레드의 이벤트를 나중에 내보낼 수 있고
+    // 등록할 때만 잠급니다.
+    std::mutex gBuffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> gBuffers;
+
+    // BeginCapture마다 1씩 늘어납니다. Generation이 이 값과 다른 버퍼는 이전 캡쳐의 것입니다.
+    std::atomic<std::uint32_t> gCaptureGeneration{0};
+    std::atomic<std::int64_t> gCaptureStart{0};
+
+    thread_local ThreadBuffer* tBuffer = nullptr;
+
+    ThreadBuffer* GetThreadBuffer()
+    {
+        if (tBuffer == nullptr)
+        {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->Events.reset(new Event[Profiler::MaxEventsPerThread]);
+
+            std::lock_guard<std::mutex> lock(gBuffersMutex);
+            buffer->ThreadId = (std::uint32_t)gBuffers.size() + 1;
+            tBuffer = buffer.get();
+            gBuffers.push_back(std::move(buffer));
+        }
+
+        return tBuffer;
+    }
+
+    void WriteJsonString(std::ostream& os, const char* s)
+    {
+        os << '"';
+        for (; *s != '\0'; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+                os << '\\' << *s;
+            else if ((unsigned char)*s < 0x20)
+                os << ' ';
+            else
+                os << *s;
+        }
+        os << '"';
+    }
+}
+
+std::atomic<bool> Profiler::mCapturing(false);
+
+void Profiler::BeginCapture()
+{
+    // 다른 스레드가 기록 중인 버퍼를 여기서 비우면 그 스레드의 Count 저장과 겹칩니다.
+    // 세대만 올리고 비우는 일은 각 버퍼의 주인 스레드에게 맡깁니다.
+    gCaptureStart.store(GameTimer::Now(), std::memory_order_relaxed);
+    gCaptureGeneration.fetch_add(1, std::memory_order_release);
+    mCapturing.store(true, std::memory_order_release);
+}
+
+void Profiler::EndCapture()
+{
+    mCapturing.store(false, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ThreadBuffer* buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+    buffer->Name = name;
+}
+
+void Profiler::Record(const char* name, std::int64_t start, std::int64_t end)
+{
+    ThreadBuffer* buffer = GetThreadBuffer();
+
+    // 새 캡쳐가 시작된 뒤의 첫 기록이면 이전 캡쳐의 이벤트를 버립니다. Generation을
+    // 마지막에 release로 저장하므로 그 값을 acquire로 읽은 스레드는 비워진 Count를 봅니다.
+    const std::uint32_t generation = gCaptureGeneration.load(std::memory_order_acquire);
+    if (buffer->Generation.load(std::memory_order_relaxed) != generation)
+    {
+        buffer->Count.store(0, std::memory_order_relaxed);
+        buffer->Dropped.store(0, std::memory_order_relaxed);
+        buffer->Generation.store(generation, std::memory_order_release);
+    }
+
+    // 이전 캡쳐 중에 시작된 구간은 이번 캡쳐에 넣지 않습니다.
+    if (start < gCaptureStart.load(std::memory_order_relaxed))
+        return;
+
+    std::uint32_t index = buffer->Count.load(std::memory_order_relaxed);
+    if (index >= MaxEventsPerThread)
+    {
+        buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->Events[index] = { name, start, end };
+    buffer->Count.store(index + 1, std::memory_order_release);
+}
+
+std::uint64_t Profiler::EventCount()
+{
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+
+    const std::uint32_t generation = gCaptureGeneration.load(std::memory_order_acquire);
+
+    std::uint64_t count = 0;
+    for (auto& buffer : gBuffers)
+    {
+        if (buffer->Generation.load(std::memory_order_acquire) == generation)
+            count += buffer->Count.load(std::memory_order_acquire);
+    }
+
+    return count;
+}
+
+std::uint64_t Profiler::DroppedEventCount()
+{
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+
+    const std::uint32_t generation = gCaptureGeneration.load(std::memory_order_acquire);
+
+    std::uint64_t count = 0;
+    for (auto& buffer : gBuffers)
+    {
+        if (buffer->Generation.load(std::memory_order_acquire) == generation)
+            count += buffer->Dropped.load(std::memory_order_relaxed);
+    }
+
+    return count;
+}
+
+void Profiler::WriteChromeTrace(std::ostream& os)
+{
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+
+    // 나노초를 잃지 않도록 마이크로초를 소수점 세 자리까지 씁니다.
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+
+    os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+    const std::uint32_t generation = gCaptureGeneration.load(std::memory_order_acquire);
+    const std::int64_t captureStart = gCaptureStart.load(std::memory_order_relaxed);
+
+    bool first = true;
+    auto separator = [&]()
+    {
+        os << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    for (auto& buffer : gBuffers)
+    {
+        // 이번 캡쳐에서 아무것도 기록하지 않은 버퍼는 이전 캡쳐의 이벤트를 갖고 있습니다.
+        const bool current = buffer->Generation.load(std::memory_order_acquire) == generation;
+        const std::uint32_t count = current ? buffer->Count.load(std::memory_order_acquire) : 0;
+
+        if (buffer->Name != nullptr)
+        {
+            separator();
+            os << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->ThreadId
+                << ", \"args\": {\"name\": ";
+            WriteJsonString(os, buffer->Name);
+            os << "}}";
+        }
+
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            const Event& e = buffer->Events[i];
+
+            separator();
+            os << "{\"name\": ";
+            WriteJsonString(os, e.Name);
+            os << ", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->ThreadId
+                << ", \"ts\": " << (e.Start - captureStart) / 1000.0
+                << ", \"dur\": " << (e.End - e.Start) / 1000.0 << "}";
+        }
+    }
+
+    os << "\n]}\n";
+
+    os.flags(flags);
+    os.precision(precision);
+}
@@ -0,0 +1,89 @@
+﻿//***************************************************************************************
+// Profiler.h
+//
+// Scoped CPU profiling zones.  PROFILE_SCOPE("name") or PROFILE_FUNCTION() at the top of
+// a block records the block's start and end time (GameTimer::Now, nanoseconds) while a
+// capture is running.  Each thread appends to its own fixed-size event buffer without
+// locking, so zones can be used inside ParallelFor bodies.  A finished capture is
+// written in the Chrome trace_event JSON format (chrome://tracing, Perfetto).
+//
+// Outside a capture a zone costs one relaxed atomic load.  Defining PROFILER_ENABLED
+// as 0 compiles the macros away entirely.
+//***************************************************************************************
+
+#pragma once
+
+#include "GameTimer.h"
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+class Profiler
+{
+public:
+    // 스레드마다 기록할 수 있는 최대 이벤트 수입니다. 넘치는 이벤트는 버리고 개수만 셉니다.
+    static const std::uint32_t MaxEventsPerThread = 1 << 16;
+
+    // 이전 캡쳐의 이벤트를 지우고 기록을 시작합니다. 프레임 사이에 호출합니다.
+    // 다른 스레드가 기록하는 중에 호출해도 됩니다. 각 스레드는 다음 기록에서 자기 버퍼를 비웁니다.
+    static void BeginCapture();
+    static void EndCapture();
+
+    static bool IsCapturing()
+    {
+        return mCapturing.load(std::memory_order_relaxed);
+    }
+
+    // 트레이스에 표시될 현재 스레드의 이름입니다. name은 프로그램이 끝날 때까지 유효해야 합니다.
+    static void SetThreadName(const char* name);
+
+    // name은 문자열 리터럴처럼 프로그램이 끝날 때까지 유효해야 합니다.
+    static void Record(const char* name, std::int64_t start, std::int64_t end);
+
+    // 마지막 캡쳐에서 기록된 이벤트 수와 버퍼가 넘쳐서 버려진 이벤트 수입니다.
+    static std::uint64_t EventCount();
+    static std::uint64_t DroppedEventCount();
+
+    // 마지막 캡쳐를 Chrome trace_event JSON으로 씁니다. 시간은 BeginCapture부터의 마이크로초입니다.
+    static void WriteChromeTrace(std::ostream& os);
+
+private:
+    static std::atomic<bool> mCapturing;
+};
+
+// 생성될 때 캡쳐 중이었으면 소멸될 때 구간을 기록합니다.
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+        : mName(name), mStart(Profiler::IsCapturing() ? GameTimer::Now() : -1)
+    {
+    }
+
+    ~ProfileZone()
+    {
+        if (mStart >= 0)
+            Profiler::Record(mName, mStart, GameTimer::Now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* mName;
+    std::int64_t mStart;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
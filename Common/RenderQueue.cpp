@@ -0,0 +1,149 @@
+﻿//***************************************************************************************
+// RenderQueue.cpp
+//***************************************************************************************
+
+#include "RenderQueue.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cassert>
+
+void RenderQueue::Clear()
+{
+    mEntries.clear();
+}
+
+std::uint64_t RenderQueue::MakeKey(std::uint32_t layer, std::uint32_t pipelineState, std::uint32_t geometry,
+    std::uint32_t material, float depth, bool backToFront)
+{
+    assert(layer < (1u << LayerBits));
+    assert(pipelineState < (1u << PipelineStateBits));
+    assert(geometry < (1u << GeometryBits));
+    assert(material < (1u << MaterialBits));
+
+    const std::uint64_t maxDepth = (1u << DepthBits) - 1;
+    depth = std::min<float>(std::max<float>(depth, 0.0f), 1.0f);
+    std::uint64_t quantizedDepth = (std::uint64_t)(depth * maxDepth);
+
+    const std::uint64_t state =
+        ((std::uint64_t)pipelineState << (GeometryBits + MaterialBits)) |
+        ((std::uint64_t)geometry << MaterialBits) |
+        (std::uint64_t)material;
+
+    // 하위 4비트는 쓰지 않습니다.
+    const std::uint32_t stateBits = PipelineStateBits + GeometryBits + MaterialBits;
+    const std::uint32_t lowShift = 64 - LayerBits - stateBits - DepthBits;
+
+    std::uint64_t key = (std::uint64_t)layer << (64 - LayerBits);
+    if (backToFront)
+    {
+        // 먼 것부터 그리도록 깊이를 뒤집어서 상태보다 앞에 둡니다.
+        quantizedDepth = maxDepth - quantizedDepth;
+        key |= quantizedDepth << (lowShift + stateBits);
+        key |= state << lowShift;
+    }
+    else
+    {
+        // 상태가 같은 항목들 안에서는 가까운 것부터 그려서 깊이 테스트로 픽셀을 일찍 버립니다.
+        key |= state << (lowShift + DepthBits);
+        key |= quantizedDepth << lowShift;
+    }
+
+    return key;
+}
+
+void RenderQueue::Add(std::uint32_t item, std::uint32_t layer, std::uint32_t pipelineState, std::uint32_t geometry,
+    std::uint32_t material, float depth, bool backToFront)
+{
+    Entry e;
+    e.Key = MakeKey(layer, pipelineState, geometry, material, depth, backToFront);
+    e.Item = item;
+    e.PipelineState = pipelineState;
+    e.Geometry = geometry;
+    e.Material = material;
+
+    mEntries.push_back(e);
+}
+
+std::uint32_t RenderQueue::ItemCount() const
+{
+    return (std::uint32_t)mEntries.size();
+}
+
+void RenderQueue::Sort()
+{
+    PROFILE_FUNCTION();
+
+    const size_t count = mEntries.size();
+    mScratch.resize(count);
+
+    // 하위 바이트부터 8번의 계수 정렬을 합니다. 계수 정렬은 안정적이므로 결과가 키의 순서가 됩니다.
+    for (std::uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        std::uint32_t offsets[256] = {};
+        for (const Entry& e : mEntries)
+            offsets[(e.Key >> shift) & 0xFF]++;
+
+        // 모든 키의 이 바이트가 같으면 순서가 바뀌지 않습니다.
+        if (offsets[(mEntries.empty() ? 0 : (mEntries[0].Key >> shift) & 0xFF)] == count)
+            continue;
+
+        std::uint32_t sum = 0;
+        for (std::uint32_t& offset : offsets)
+        {
+            const std::uint32_t bucketCount = offset;
+            offset = sum;
+            sum += bucketCount;
+        }
+
+        for (const Entry& e : mEntries)
+            mScratch[offsets[(e.Key >> shift) & 0xFF]++] = e;
+
+        mEntries.swap(mScratch);
+    }
+}
+
+void RenderQueue::BuildCommandStream(std::vector<RenderCommand>& commands)
+{
+    PROFILE_FUNCTION();
+
+    commands.clear();
+
+    mStats = QueueStats();
+    mStats.Items = (std::uint32_t)mEntries.size();
+
+    bool first = true;
+    Entry current;
+
+    for (const Entry& e : mEntries)
+    {
+        if (first || e.PipelineState != current.PipelineState)
+        {
+            commands.push_back({ RenderCommandType::SetPipelineState, e.PipelineState });
+            mStats.StateChanges++;
+        }
+
+        if (first || e.Geometry != current.Geometry)
+        {
+            commands.push_back({ RenderCommandType::SetGeometry, e.Geometry });
+            mStats.StateChanges++;
+        }
+
+        if (first || e.Material != current.Material)
+        {
+            commands.push_back({ RenderCommandType::SetMaterial, e.Material });
+            mStats.StateChanges++;
+        }
+
+        commands.push_back({ RenderCommandType::Draw, e.Item });
+
+        current = e;
+        first = false;
+    }
+
+    mStats.StateChangesAvoided = 3 * mStats.Items - mStats.StateChanges;
+}
+
+const RenderQueue::QueueStats& RenderQueue::LastStats() const
+{
+    return mStats;
+}
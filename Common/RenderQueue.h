@@ -0,0 +1,116 @@
+﻿//***************************************************************************************
+// RenderQueue.h
+//
+// Sorted draw submission.  Every visible item is added with its layer, pipeline state,
+// geometry, material and a normalized view depth, which are packed into a 64-bit key:
+//
+//   layer(4) | pipeline state(8) | geometry(12) | material(12) | depth(24) | unused(4)
+//
+// Layers that need back-to-front order (blended geometry) put the inverted depth right
+// after the layer instead, so depth wins over state there.  The keys are radix sorted
+// and turned into a command stream that only contains the state changes that are
+// really needed, followed by the draw of each item.  The stream is plain data, so the
+// sort and the deduplication can be checked without a device; the app replays it on
+// the real command list through SubmitCommandStream.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class RenderCommandType : std::uint32_t
+{
+    SetPipelineState,
+    SetGeometry,
+    SetMaterial,
+    Draw
+};
+
+// 기록된 명령 하나입니다. Value는 상태의 ID이거나, Draw이면 Add에 전달한 항목의 인덱스입니다.
+struct RenderCommand
+{
+    RenderCommandType Type = RenderCommandType::Draw;
+    std::uint32_t Value = 0;
+};
+
+class RenderQueue
+{
+public:
+    static const std::uint32_t LayerBits = 4;
+    static const std::uint32_t PipelineStateBits = 8;
+    static const std::uint32_t GeometryBits = 12;
+    static const std::uint32_t MaterialBits = 12;
+    static const std::uint32_t DepthBits = 24;
+
+    // 마지막 BuildCommandStream의 통계입니다.
+    struct QueueStats
+    {
+        std::uint32_t Items = 0;
+        std::uint32_t StateChanges = 0;
+
+        // 항목마다 세 가지 상태를 모두 바꾸는 경우보다 줄어든 상태 변경 수입니다.
+        std::uint32_t StateChangesAvoided = 0;
+    };
+
+    void Clear();
+
+    // depth는 0(근평면)~1(원평면)으로 정규화한 view 공간 깊이입니다. 범위를 벗어나면 잘라냅니다.
+    // 각 ID는 해당 필드의 비트 수 안에 들어가야 합니다.
+    void Add(std::uint32_t item, std::uint32_t layer, std::uint32_t pipelineState, std::uint32_t geometry,
+        std::uint32_t material, float depth, bool backToFront = false);
+
+    std::uint32_t ItemCount() const;
+
+    // 키의 바이트마다 한 번씩 안정적인 기수 정렬을 합니다. 모든 키에서 같은 바이트는 건너뜁니다.
+    void Sort();
+
+    // 정렬된 순서대로 바뀌는 상태만 기록한 명령 스트림을 만듭니다. Sort 다음에 호출합니다.
+    void BuildCommandStream(std::vector<RenderCommand>& commands);
+
+    const QueueStats& LastStats() const;
+
+    static std::uint64_t MakeKey(std::uint32_t layer, std::uint32_t pipelineState, std::uint32_t geometry,
+        std::uint32_t material, float depth, bool backToFront);
+
+private:
+    struct Entry
+    {
+        std::uint64_t Key = 0;
+        std::uint32_t Item = 0;
+        std::uint32_t PipelineState = 0;
+        std::uint32_t Geometry = 0;
+        std::uint32_t Material = 0;
+    };
+
+    std::vector<Entry> mEntries;
+    std::vector<Entry> mScratch;
+
+    QueueStats mStats;
+};
+
+// 명령 스트림을 순서대로 target에 전달합니다. target은 SetPipelineState, SetGeometry, SetMaterial과
+// Draw를 std::uint32_t 인자 하나로 받는 타입입니다. 앱은 커맨드 리스트에 기록하는 타입을 넘기고
+// 테스트는 호출을 기록하기만 하는 타입을 넘깁니다.
+template<typename Target>
+void SubmitCommandStream(const std::vector<RenderCommand>& commands, Target& target)
+{
+    for (const RenderCommand& cmd : commands)
+    {
+        switch (cmd.Type)
+        {
+        case RenderCommandType::SetPipelineState:
+            target.SetPipelineState(cmd.Value);
+            break;
+        case RenderCommandType::SetGeometry:
+            target.SetGeometry(cmd.Value);
+            break;
+        case RenderCommandType::SetMaterial:
+            target.SetMaterial(cmd.Value);
+            break;
+        case RenderCommandType::Draw:
+            target.Draw(cmd.Value);
+            break;
+        }
+    }
+}
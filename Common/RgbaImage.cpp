@@ -0,0 +1,110 @@
+﻿//***************************************************************************************
+// RgbaImage.cpp
+//***************************************************************************************
+
+#include "RgbaImage.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+void RgbaImage::Resize(std::uint32_t width, std::uint32_t height)
+{
+    Width = width;
+    Height = height;
+    Pixels.assign((size_t)width * height * 4, 0);
+}
+
+std::uint8_t* RgbaImage::GetPixel(std::uint32_t x, std::uint32_t y)
+{
+    return &Pixels[((size_t)y * Width + x) * 4];
+}
+
+const std::uint8_t* RgbaImage::GetPixel(std::uint32_t x, std::uint32_t y) const
+{
+    return &Pixels[((size_t)y * Width + x) * 4];
+}
+
+const std::uint8_t* RgbaImage::GetClampedPixel(std::int64_t x, std::int64_t y) const
+{
+    x = std::min<std::int64_t>(std::max<std::int64_t>(x, 0), (std::int64_t)Width - 1);
+    y = std::min<std::int64_t>(std::max<std::int64_t>(y, 0), (std::int64_t)Height - 1);
+
+    return GetPixel((std::uint32_t)x, (std::uint32_t)y);
+}
+
+static std::uint32_t ReadU32(const std::uint8_t* p)
+{
+    return (std::uint32_t)p[0] | ((std::uint32_t)p[1] << 8) | ((std::uint32_t)p[2] << 16) | ((std::uint32_t)p[3] << 24);
+}
+
+static std::uint16_t ReadU16(const std::uint8_t* p)
+{
+    return (std::uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool LoadBitmapFile(const std::wstring& filename, RgbaImage& image)
+{
+    // MSVC의 ifstream은 wchar_t 경로를 받습니다. 다른 컴파일러로는 ASCII 경로를 쓰는 테스트만 빌드합니다.
+#ifdef _MSC_VER
+    std::ifstream fin(filename, std::ios::binary);
+#else
+    std::ifstream fin(std::string(filename.begin(), filename.end()), std::ios::binary);
+#endif
+    if (!fin)
+        return false;
+
+    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    // BITMAPFILEHEADER(14바이트) 뒤에 BITMAPINFOHEADER(40바이트 이상)가 옵니다.
+    if (data.size() < 54 || data[0] != 'B' || data[1] != 'M')
+        return false;
+
+    const std::uint32_t pixelOffset = ReadU32(&data[10]);
+    const std::int32_t width = (std::int32_t)ReadU32(&data[18]);
+    const std::int32_t height = (std::int32_t)ReadU32(&data[22]);
+    const std::uint16_t bitCount = ReadU16(&data[28]);
+    const std::uint32_t compression = ReadU32(&data[30]);
+
+    // BI_RGB와 기본 마스크를 사용하는 BI_BITFIELDS만 지원합니다.
+    if (width <= 0 || height == 0 || (bitCount != 24 && bitCount != 32) || (compression != 0 && compression != 3))
+        return false;
+
+    // 높이가 음수이면 위에서 아래로 저장된 이미지입니다.
+    const bool topDown = height < 0;
+    const std::uint32_t w = (std::uint32_t)width;
+    const std::uint32_t h = (std::uint32_t)(topDown ? -height : height);
+
+    const size_t bytesPerPixel = bitCount / 8;
+    const size_t rowPitch = ((size_t)w * bytesPerPixel + 3) & ~(size_t)3;
+    if ((size_t)pixelOffset + rowPitch * h > data.size())
+        return false;
+
+    image.Resize(w, h);
+
+    bool anyAlpha = false;
+    for (std::uint32_t y = 0; y < h; ++y)
+    {
+        const std::uint8_t* src = &data[pixelOffset + rowPitch * (topDown ? y : h - 1 - y)];
+        std::uint8_t* dst = image.GetPixel(0, y);
+
+        for (std::uint32_t x = 0; x < w; ++x, src += bytesPerPixel, dst += 4)
+        {
+            // BMP는 BGR(A) 순서입니다.
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = bytesPerPixel == 4 ? src[3] : 255;
+
+            anyAlpha |= dst[3] != 0;
+        }
+    }
+
+    // 알파를 쓰지 않는 32비트 파일은 알파가 모두 0으로 저장되어 있습니다.
+    if (!anyAlpha)
+    {
+        for (size_t i = 3; i < image.Pixels.size(); i += 4)
+            image.Pixels[i] = 255;
+    }
+
+    return true;
+}
@@ -0,0 +1,33 @@
+﻿//***************************************************************************************
+// RgbaImage.h
+//
+// A tightly packed 8-bit RGBA image in system memory and a small reader for the
+// uncompressed 24/32-bit BMP files in the Textures directory.  This is the input of
+// the CPU texture tools (block compression, mip generation).
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct RgbaImage
+{
+    std::uint32_t Width = 0;
+    std::uint32_t Height = 0;
+
+    // 행 사이에 여백이 없는 RGBA 순서의 픽셀들입니다. 첫 번째 행이 이미지의 위쪽입니다.
+    std::vector<std::uint8_t> Pixels;
+
+    void Resize(std::uint32_t width, std::uint32_t height);
+
+    std::uint8_t* GetPixel(std::uint32_t x, std::uint32_t y);
+    const std::uint8_t* GetPixel(std::uint32_t x, std::uint32_t y) const;
+
+    // 이미지 밖의 좌표는 가장자리 픽셀로 고정합니다.
+    const std::uint8_t* GetClampedPixel(std::int64_t x, std::int64_t y) const;
+};
+
+// 압축되지 않은 24/32비트 BMP 파일을 읽습니다. 32비트 파일의 알파가 모두 0이면 불투명으로 취급합니다.
+bool LoadBitmapFile(const std::wstring& filename, RgbaImage& image);
@@ -0,0 +1,75 @@
+﻿//***************************************************************************************
+// ScratchArena.cpp
+//***************************************************************************************
+
+#include "ScratchArena.h"
+#include <algorithm>
+#include <cassert>
+
+ScratchArena::ScratchArena(std::size_t blockSize)
+    : mBlockSize(blockSize)
+{
+}
+
+void* ScratchArena::Allocate(std::size_t size, std::size_t alignment)
+{
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+    // 현재 블록부터 들어갈 수 있는 블록을 찾습니다. 되돌린 다음에는 뒤의 블록들을 다시 사용합니다.
+    for (; mCurrentBlock < mBlocks.size(); ++mCurrentBlock, mOffset = 0)
+    {
+        const Block& block = mBlocks[mCurrentBlock];
+
+        const std::uintptr_t base = (std::uintptr_t)block.Memory.get();
+        const std::uintptr_t aligned = (base + mOffset + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+        const std::size_t end = (std::size_t)(aligned - base) + size;
+
+        if (end <= block.Size)
+        {
+            mOffset = end;
+            return (void*)aligned;
+        }
+    }
+
+    Block block;
+    block.Size = std::max<std::size_t>(mBlockSize, size + alignment);
+    block.Memory.reset(new std::uint8_t[block.Size]);
+
+    mBlocks.push_back(std::move(block));
+    mCurrentBlock = mBlocks.size() - 1;
+    mOffset = 0;
+
+    return Allocate(size, alignment);
+}
+
+ScratchArena::Marker ScratchArena::GetMarker() const
+{
+    Marker marker;
+    marker.Block = mCurrentBlock;
+    marker.Offset = mOffset;
+
+    return marker;
+}
+
+void ScratchArena::Rewind(const Marker& marker)
+{
+    assert(marker.Block < mCurrentBlock || (marker.Block == mCurrentBlock && marker.Offset <= mOffset));
+
+    mCurrentBlock = marker.Block;
+    mOffset = marker.Offset;
+}
+
+void ScratchArena::Reset()
+{
+    mCurrentBlock = 0;
+    mOffset = 0;
+}
+
+std::size_t ScratchArena::CapacityBytes() const
+{
+    std::size_t bytes = 0;
+    for (const Block& block : mBlocks)
+        bytes += block.Size;
+
+    return bytes;
+}
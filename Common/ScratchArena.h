@@ -0,0 +1,96 @@
+﻿//***************************************************************************************
+// ScratchArena.h
+//
+// Bump allocator for short-lived, per-thread memory.  Allocate moves an offset inside
+// the current block and moves on to the next block when the current one is full.  A
+// Scope records the position and rewinds to it when it goes out of scope, so nested
+// scopes give their memory back in LIFO order.  Blocks are kept after a rewind, so once
+// warmed up a frame takes nothing from the heap.
+//
+// An arena belongs to one thread (JobSystem::Scratch hands out the current thread's
+// arena).  Destructors of the allocated objects are not run.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+class ScratchArena
+{
+public:
+    struct Marker
+    {
+        std::size_t Block = 0;
+        std::size_t Offset = 0;
+    };
+
+    // 생성될 때의 위치를 기억했다가 파괴될 때 되돌립니다.
+    class Scope
+    {
+    public:
+        explicit Scope(ScratchArena& arena)
+            : mArena(arena), mMarker(arena.GetMarker())
+        {
+        }
+
+        ~Scope()
+        {
+            mArena.Rewind(mMarker);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ScratchArena& mArena;
+        Marker mMarker;
+    };
+
+    explicit ScratchArena(std::size_t blockSize = 64 * 1024);
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // alignment는 2의 거듭제곱이어야 합니다. 블록보다 큰 요청은 그 크기의 블록을 새로 만듭니다.
+    void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    // 값으로 초기화된 배열입니다. 소멸자를 호출하지 않으므로 소멸자가 없는 타입만 허용합니다.
+    template<typename T>
+    T* AllocateArray(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "ScratchArena does not run destructors.");
+
+        T* array = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        for (std::size_t i = 0; i < count; ++i)
+            new (&array[i]) T();
+
+        return array;
+    }
+
+    Marker GetMarker() const;
+    void Rewind(const Marker& marker);
+
+    // 모든 할당을 되돌립니다. 블록은 해제하지 않습니다.
+    void Reset();
+
+    // 가지고 있는 블록들의 크기의 합입니다.
+    std::size_t CapacityBytes() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::uint8_t[]> Memory;
+        std::size_t Size = 0;
+    };
+
+    std::size_t mBlockSize = 0;
+
+    std::vector<Block> mBlocks;
+    std::size_t mCurrentBlock = 0;
+    std::size_t mOffset = 0;
+};
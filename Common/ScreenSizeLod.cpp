@@ -0,0 +1,220 @@
+﻿//***************************************************************************************
+// ScreenSizeLod.cpp
+//***************************************************************************************
+
+#include "ScreenSizeLod.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+using namespace DirectX;
+
+// BuildClusteredLodIndices의 격자 좌표는 축마다 21비트로 64비트 키 하나에 들어갑니다.
+static const std::uint32_t gMaxCellCoord = (1u << 21) - 1;
+
+ScreenSizeLod::ScreenSizeLod(const std::vector<float>& lodMinPixelSizes, float cullPixelSize)
+    : mLodMinPixelSizes(lodMinPixelSizes), mCullPixelSize(cullPixelSize)
+{
+    if (mLodMinPixelSizes.empty())
+        mLodMinPixelSizes.push_back(0.0f);
+}
+
+std::uint32_t ScreenSizeLod::LodCount() const
+{
+    return (std::uint32_t)mLodMinPixelSizes.size();
+}
+
+float ScreenSizeLod::GetCullPixelSize() const
+{
+    return mCullPixelSize;
+}
+
+void ScreenSizeLod::SetCullPixelSize(float cullPixelSize)
+{
+    mCullPixelSize = cullPixelSize;
+}
+
+void ScreenSizeLod::SetView(FXMVECTOR eyePos, CXMMATRIX proj, float viewportHeight)
+{
+    XMStoreFloat3(&mEyePos, eyePos);
+
+    XMFLOAT4X4 p;
+    XMStoreFloat4x4(&p, proj);
+
+    // 투영 행렬의 _22는 view 공간의 y를 NDC의 y(높이 2)로 옮기는 배율입니다.
+    // 원근 투영이면 여기에 다시 거리(w)로 나눠집니다.
+    mPixelScale = p._22 * 0.5f * viewportHeight;
+    mOrthographic = p._34 == 0.0f;
+}
+
+float ScreenSizeLod::GetProjectedSize(const BoundingSphere& sphere) const
+{
+    const float diameter = 2.0f * sphere.Radius;
+
+    if (mOrthographic)
+        return diameter * mPixelScale;
+
+    const float dx = sphere.Center.x - mEyePos.x;
+    const float dy = sphere.Center.y - mEyePos.y;
+    const float dz = sphere.Center.z - mEyePos.z;
+    const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    if (distance <= sphere.Radius)
+        return FLT_MAX;
+
+    return diameter * mPixelScale / distance;
+}
+
+std::uint32_t ScreenSizeLod::SelectLod(const BoundingSphere& sphere) const
+{
+    const float size = GetProjectedSize(sphere);
+    if (size < mCullPixelSize)
+        return Culled;
+
+    const std::uint32_t lodCount = LodCount();
+    for (std::uint32_t lod = 0; lod + 1 < lodCount; ++lod)
+    {
+        if (size >= mLodMinPixelSizes[lod])
+            return lod;
+    }
+
+    return lodCount - 1;
+}
+
+void ScreenSizeLod::Bucket(std::vector<std::uint32_t>& instances,
+    const std::function<BoundingSphere(std::uint32_t instance)>& getSphere,
+    std::vector<std::uint32_t>& lodStarts)
+{
+    PROFILE_FUNCTION();
+
+    const std::uint32_t count = (std::uint32_t)instances.size();
+    const std::uint32_t lodCount = LodCount();
+
+    mLods.resize(count);
+    JobSystem::Default().ParallelFor(0u, count, [&](std::uint32_t i)
+    {
+        mLods[i] = SelectLod(getSphere(instances[i]));
+    });
+
+    // LOD별 개수의 누적합으로 각 LOD의 시작 위치를 구한 뒤 순서를 유지하면서 흩어 씁니다.
+    lodStarts.assign(lodCount + 1, 0);
+    mCulledCount = 0;
+    for (std::uint32_t lod : mLods)
+    {
+        if (lod == Culled)
+            mCulledCount++;
+        else
+            lodStarts[lod + 1]++;
+    }
+
+    for (std::uint32_t lod = 0; lod < lodCount; ++lod)
+        lodStarts[lod + 1] += lodStarts[lod];
+
+    mBucketed.resize(lodStarts[lodCount]);
+
+    std::vector<std::uint32_t> next(lodStarts.begin(), lodStarts.end() - 1);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        if (mLods[i] != Culled)
+            mBucketed[next[mLods[i]]++] = instances[i];
+    }
+
+    instances.swap(mBucketed);
+}
+
+std::uint32_t ScreenSizeLod::LastCulledCount() const
+{
+    return mCulledCount;
+}
+
+void BuildClusteredLodIndices(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const std::uint32_t* indices, std::uint32_t indexCount, float cellSize, std::vector<std::uint32_t>& lodIndices)
+{
+    lodIndices.clear();
+    if (vertexCount == 0)
+        return;
+
+    auto getPosition = [&](std::uint32_t v)
+    {
+        return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(static_cast<const std::uint8_t*>(positions) + (size_t)v * stride));
+    };
+
+    XMVECTOR vMin = getPosition(0);
+    for (std::uint32_t v = 1; v < vertexCount; ++v)
+        vMin = XMVectorMin(vMin, getPosition(v));
+
+    // 정점이 속한 격자 칸을 구하고 칸마다 위치의 평균을 구합니다.
+    const XMVECTOR invCell = XMVectorReplicate(1.0f / cellSize);
+    const XMVECTOR maxCell = XMVectorReplicate((float)gMaxCellCoord);
+
+    struct Cell
+    {
+        XMFLOAT3 Sum = { 0.0f, 0.0f, 0.0f };
+        std::uint32_t Count = 0;
+        std::uint32_t Representative = 0;
+        float BestDistSq = FLT_MAX;
+    };
+
+    std::unordered_map<std::uint64_t, std::uint32_t> cellLookup;
+    std::vector<Cell> cells;
+    std::vector<std::uint32_t> vertexCells(vertexCount);
+
+    for (std::uint32_t v = 0; v < vertexCount; ++v)
+    {
+        XMVECTOR p = getPosition(v);
+
+        XMFLOAT3 cellCoord;
+        XMStoreFloat3(&cellCoord, XMVectorFloor(XMVectorMultiply(XMVectorSubtract(p, vMin), invCell)));
+
+        // 좌표가 21비트를 넘으면 다른 축의 비트와 겹쳐서 멀리 떨어진 칸이 합쳐지므로 잘라냅니다.
+        // 축마다 2백만 칸을 넘는 격자는 LOD로 의미가 없고, 넘친 정점들은 마지막 칸에 모입니다.
+        XMStoreFloat3(&cellCoord, XMVectorMin(XMLoadFloat3(&cellCoord), maxCell));
+
+        const std::uint64_t key = ((std::uint64_t)cellCoord.x << 42) | ((std::uint64_t)cellCoord.y << 21) | (std::uint64_t)cellCoord.z;
+
+        auto it = cellLookup.find(key);
+        if (it == cellLookup.end())
+        {
+            it = cellLookup.emplace(key, (std::uint32_t)cells.size()).first;
+            cells.emplace_back();
+        }
+
+        Cell& cell = cells[it->second];
+        XMStoreFloat3(&cell.Sum, XMVectorAdd(XMLoadFloat3(&cell.Sum), p));
+        cell.Count++;
+
+        vertexCells[v] = it->second;
+    }
+
+    // 칸마다 평균에 가장 가까운 정점을 대표로 남깁니다.
+    for (std::uint32_t v = 0; v < vertexCount; ++v)
+    {
+        Cell& cell = cells[vertexCells[v]];
+
+        XMVECTOR mean = XMVectorScale(XMLoadFloat3(&cell.Sum), 1.0f / cell.Count);
+        const float distSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(getPosition(v), mean)));
+        if (distSq < cell.BestDistSq)
+        {
+            cell.BestDistSq = distSq;
+            cell.Representative = v;
+        }
+    }
+
+    for (std::uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const std::uint32_t a = cells[vertexCells[indices[i + 0]]].Representative;
+        const std::uint32_t b = cells[vertexCells[indices[i + 1]]].Representative;
+        const std::uint32_t c = cells[vertexCells[indices[i + 2]]].Representative;
+
+        // 두 정점이 같은 칸으로 모인 삼각형은 넓이가 없습니다.
+        if (a == b || b == c || c == a)
+            continue;
+
+        lodIndices.push_back(a);
+        lodIndices.push_back(b);
+        lodIndices.push_back(c);
+    }
+}
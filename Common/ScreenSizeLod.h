@@ -0,0 +1,75 @@
+﻿//***************************************************************************************
+// ScreenSizeLod.h
+//
+// Level-of-detail selection from the projected size of bounding spheres.  The
+// diameter of a sphere in pixels is estimated from the camera position, the vertical
+// scale of the projection matrix and the viewport height; an instance smaller than
+// the cull size is dropped and the others get the first LOD whose minimum size they
+// reach.  Bucket reorders a list of instances into one contiguous range per LOD so
+// each LOD can be drawn with a single instanced draw call.
+//
+// BuildClusteredLodIndices makes the coarser meshes for those LODs by snapping the
+// vertices of a mesh to a grid, which only needs a new index buffer over the same
+// vertices.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class ScreenSizeLod
+{
+public:
+    // SelectLod가 컬링된 인스턴스에 대해서 반환하는 값입니다.
+    static const std::uint32_t Culled = 0xFFFFFFFF;
+
+    // lodMinPixelSizes[i]는 LOD i를 사용하기 위한 최소 화면 크기(지름, 픽셀)이고 내림차순입니다.
+    // 마지막 LOD는 cullPixelSize 이상이면 사용합니다.
+    ScreenSizeLod(const std::vector<float>& lodMinPixelSizes, float cullPixelSize);
+
+    std::uint32_t LodCount() const;
+
+    float GetCullPixelSize() const;
+    void SetCullPixelSize(float cullPixelSize);
+
+    // 프레임마다 카메라 위치, 투영 행렬, 뷰포트 높이(픽셀)를 설정합니다.
+    void SetView(DirectX::FXMVECTOR eyePos, DirectX::CXMMATRIX proj, float viewportHeight);
+
+    // 구의 화면에서의 지름(픽셀)입니다. 카메라가 구 안에 있으면 FLT_MAX입니다.
+    float GetProjectedSize(const DirectX::BoundingSphere& sphere) const;
+
+    std::uint32_t SelectLod(const DirectX::BoundingSphere& sphere) const;
+
+    // instances를 LOD 순서로(같은 LOD 안에서는 원래 순서대로) 다시 배열하고 컬링된 인스턴스를 제거합니다.
+    // lodStarts는 LodCount() + 1개이고 [lodStarts[i], lodStarts[i + 1])이 LOD i의 범위입니다.
+    void Bucket(std::vector<std::uint32_t>& instances,
+        const std::function<DirectX::BoundingSphere(std::uint32_t instance)>& getSphere,
+        std::vector<std::uint32_t>& lodStarts);
+
+    // 마지막 Bucket에서 화면 크기가 작아서 컬링된 인스턴스 수입니다.
+    std::uint32_t LastCulledCount() const;
+
+private:
+    std::vector<float> mLodMinPixelSizes;
+    float mCullPixelSize = 0.0f;
+
+    DirectX::XMFLOAT3 mEyePos = { 0.0f, 0.0f, 0.0f };
+
+    // 거리 1에서 길이 1이 차지하는 픽셀 수(직교 투영이면 거리와 상관 없는 값)입니다.
+    float mPixelScale = 1.0f;
+    bool mOrthographic = false;
+
+    std::vector<std::uint32_t> mLods;
+    std::vector<std::uint32_t> mBucketed;
+    std::uint32_t mCulledCount = 0;
+};
+
+// 정점을 cellSize 크기의 격자로 모아서 단순화한 인덱스를 만듭니다. 격자 칸마다 평균에 가장 가까운
+// 정점 하나를 남기고 퇴화한 삼각형은 버립니다. 결과 인덱스는 원래 정점 버퍼를 그대로 가리킵니다.
+// positions는 stride 바이트 간격으로 놓인 XMFLOAT3 위치들입니다.
+void BuildClusteredLodIndices(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const std::uint32_t* indices, std::uint32_t indexCount, float cellSize, std::vector<std::uint32_t>& lodIndices);
@@ -0,0 +1,455 @@
+﻿//***************************************************************************************
+// TexturePacker.cpp
+//***************************************************************************************
+
+#include "TexturePacker.h"
+#include "DDSSurfaceInfo.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace DirectX;
+
+// D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+static const std::uint32_t gMaxArraySize = 2048;
+
+static bool IsBlockCompressed(DXGI_FORMAT format)
+{
+    return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+        (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+}
+
+static XMFLOAT4X4 MakeUvTransform(float scaleU, float scaleV, float offsetU, float offsetV)
+{
+    return XMFLOAT4X4(
+        scaleU,  0.0f,    0.0f, 0.0f,
+        0.0f,    scaleV,  0.0f, 0.0f,
+        0.0f,    0.0f,    1.0f, 0.0f,
+        offsetU, offsetV, 0.0f, 1.0f);
+}
+
+TexturePacker::TexturePacker(const TexturePackOptions& options)
+    : mOptions(options)
+{
+}
+
+std::uint32_t TexturePacker::AddTexture(const TextureUploadDesc& desc, bool wrapsUV)
+{
+    Entry entry;
+    entry.Desc = desc;
+    entry.WrapsUV = wrapsUV;
+    entry.Placement.UvTransform = MakeUvTransform(1.0f, 1.0f, 0.0f, 0.0f);
+
+    mEntries.push_back(entry);
+
+    return (std::uint32_t)mEntries.size() - 1;
+}
+
+void TexturePacker::Pack()
+{
+    PROFILE_FUNCTION();
+
+    mGroups.clear();
+
+    std::vector<std::uint32_t> remaining(mEntries.size());
+    for (std::uint32_t i = 0; i < (std::uint32_t)mEntries.size(); ++i)
+        remaining[i] = i;
+
+    // 배열은 여백이 필요 없고 반복되는 텍스쳐 좌표도 지원하므로 먼저 묶습니다.
+    if (mOptions.BuildArrays)
+        PackArrays(remaining);
+
+    if (mOptions.BuildAtlases)
+        PackAtlases(remaining);
+
+    for (std::uint32_t texture : remaining)
+    {
+        TexturePackGroup group;
+        group.Kind = TexturePackKind::Standalone;
+        group.Desc = mEntries[texture].Desc;
+        group.Textures.push_back(texture);
+
+        Entry& entry = mEntries[texture];
+        entry.Placement = TexturePlacement();
+        entry.Placement.Group = (std::uint32_t)mGroups.size();
+        entry.Placement.UvTransform = MakeUvTransform(1.0f, 1.0f, 0.0f, 0.0f);
+
+        mGroups.push_back(group);
+    }
+}
+
+bool TexturePacker::CanBeGrouped(const TextureUploadDesc& desc) const
+{
+    return !desc.IsVolume && desc.DepthOrArraySize == 1;
+}
+
+void TexturePacker::PackArrays(std::vector<std::uint32_t>& remaining)
+{
+    // 포맷, 크기, 밉 개수가 모두 같은 텍스쳐들을 모읍니다.
+    std::vector<std::vector<std::uint32_t>> buckets;
+    std::vector<std::uint32_t> rest;
+
+    for (std::uint32_t texture : remaining)
+    {
+        const TextureUploadDesc& desc = mEntries[texture].Desc;
+        if (!CanBeGrouped(desc))
+        {
+            rest.push_back(texture);
+            continue;
+        }
+
+        auto bucket = std::find_if(buckets.begin(), buckets.end(), [&](const std::vector<std::uint32_t>& b)
+        {
+            const TextureUploadDesc& other = mEntries[b.front()].Desc;
+            return other.Format == desc.Format && other.Width == desc.Width &&
+                other.Height == desc.Height && other.MipLevels == desc.MipLevels;
+        });
+
+        if (bucket == buckets.end())
+            buckets.push_back({ texture });
+        else
+            bucket->push_back(texture);
+    }
+
+    for (const std::vector<std::uint32_t>& bucket : buckets)
+    {
+        if (bucket.size() < 2)
+        {
+            rest.push_back(bucket.front());
+            continue;
+        }
+
+        for (size_t first = 0; first < bucket.size(); first += gMaxArraySize)
+        {
+            const size_t count = std::min<size_t>(bucket.size() - first, gMaxArraySize);
+
+            TexturePackGroup group;
+            group.Kind = TexturePackKind::Array;
+            group.Desc = mEntries[bucket[first]].Desc;
+            group.Desc.DepthOrArraySize = (std::uint32_t)count;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const std::uint32_t texture = bucket[first + i];
+                group.Textures.push_back(texture);
+
+                TexturePlacement& placement = mEntries[texture].Placement;
+                placement = TexturePlacement();
+                placement.Group = (std::uint32_t)mGroups.size();
+                placement.Slice = (std::uint32_t)i;
+                placement.UvTransform = MakeUvTransform(1.0f, 1.0f, 0.0f, 0.0f);
+            }
+
+            mGroups.push_back(group);
+        }
+    }
+
+    std::sort(rest.begin(), rest.end());
+    remaining.swap(rest);
+}
+
+void TexturePacker::PackAtlases(std::vector<std::uint32_t>& remaining)
+{
+    // 포맷별로 아틀라스 후보를 모읍니다.
+    std::vector<std::vector<std::uint32_t>> buckets;
+    std::vector<std::uint32_t> rest;
+
+    for (std::uint32_t texture : remaining)
+    {
+        const Entry& entry = mEntries[texture];
+        const std::uint64_t size = std::max<std::uint64_t>(entry.Desc.Width, entry.Desc.Height);
+        if (!CanBeGrouped(entry.Desc) || entry.WrapsUV || size > mOptions.MaxAtlasItemSize)
+        {
+            rest.push_back(texture);
+            continue;
+        }
+
+        auto bucket = std::find_if(buckets.begin(), buckets.end(), [&](const std::vector<std::uint32_t>& b)
+        {
+            return mEntries[b.front()].Desc.Format == entry.Desc.Format;
+        });
+
+        if (bucket == buckets.end())
+            buckets.push_back({ texture });
+        else
+            bucket->push_back(texture);
+    }
+
+    for (std::vector<std::uint32_t>& bucket : buckets)
+    {
+        if (bucket.size() < 2)
+        {
+            rest.push_back(bucket.front());
+            continue;
+        }
+
+        // 아틀라스의 밉은 모든 텍스쳐가 가진 밉까지만 만듭니다. 위치를 블록 크기 << (밉 개수 - 1)에
+        // 맞추면 모든 밉에서 텍스쳐가 블록 경계에서 시작합니다.
+        std::uint32_t mipLevels = std::max<std::uint32_t>(mOptions.MaxAtlasMipLevels, 1);
+        for (std::uint32_t texture : bucket)
+            mipLevels = std::min<std::uint32_t>(mipLevels, mEntries[texture].Desc.MipLevels);
+
+        const std::uint32_t blockSize = IsBlockCompressed(mEntries[bucket.front()].Desc.Format) ? 4 : 1;
+        const std::uint32_t alignment = blockSize << (mipLevels - 1);
+
+        while (!bucket.empty())
+        {
+            const size_t before = bucket.size();
+            PackAtlasPage(bucket, mipLevels, alignment);
+
+            // 아틀라스보다 큰 텍스쳐는 단독으로 남깁니다.
+            if (bucket.size() == before)
+            {
+                rest.insert(rest.end(), bucket.begin(), bucket.end());
+                break;
+            }
+        }
+    }
+
+    // 텍스쳐가 하나뿐인 아틀라스는 단독 텍스쳐로 되돌립니다.
+    for (size_t i = 0; i < mGroups.size();)
+    {
+        if (mGroups[i].Kind == TexturePackKind::Atlas && mGroups[i].Textures.size() == 1)
+        {
+            rest.push_back(mGroups[i].Textures.front());
+            mGroups.erase(mGroups.begin() + i);
+
+            for (size_t j = i; j < mGroups.size(); ++j)
+            {
+                for (std::uint32_t texture : mGroups[j].Textures)
+                    mEntries[texture].Placement.Group = (std::uint32_t)j;
+            }
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    std::sort(rest.begin(), rest.end());
+    remaining.swap(rest);
+}
+
+void TexturePacker::PackAtlasPage(std::vector<std::uint32_t>& items, std::uint32_t mipLevels, std::uint32_t alignment)
+{
+    // 오른쪽과 아래쪽에 여백을 붙인 셀 크기입니다. 이웃한 텍스쳐 사이에는 항상 여백이 있습니다.
+    auto cellWidth = [&](std::uint32_t texture)
+    {
+        return (std::uint32_t)TextureUploadPlanner::AlignUp(mEntries[texture].Desc.Width + mOptions.Padding, alignment);
+    };
+    auto cellHeight = [&](std::uint32_t texture)
+    {
+        return (std::uint32_t)TextureUploadPlanner::AlignUp(mEntries[texture].Desc.Height + mOptions.Padding, alignment);
+    };
+
+    // 높이가 큰 순서로 선반(shelf)에 채웁니다.
+    std::sort(items.begin(), items.end(), [&](std::uint32_t a, std::uint32_t b)
+    {
+        if (cellHeight(a) != cellHeight(b))
+            return cellHeight(a) > cellHeight(b);
+        if (cellWidth(a) != cellWidth(b))
+            return cellWidth(a) > cellWidth(b);
+        return a < b;
+    });
+
+    struct Position
+    {
+        std::uint32_t X;
+        std::uint32_t Y;
+    };
+
+    // width 안에 순서대로 채우고 들어간 텍스쳐 수를 반환합니다.
+    auto shelfPack = [&](std::uint32_t width, std::vector<Position>& positions,
+                         std::uint32_t& usedWidth, std::uint32_t& usedHeight)
+    {
+        positions.clear();
+        usedWidth = 0;
+        usedHeight = 0;
+
+        std::uint32_t x = 0;
+        std::uint32_t y = 0;
+        std::uint32_t shelfHeight = 0;
+        for (std::uint32_t texture : items)
+        {
+            const std::uint32_t w = cellWidth(texture);
+            const std::uint32_t h = cellHeight(texture);
+            if (w > width)
+                break;
+
+            if (x + w > width)
+            {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+
+            if (y + h > mOptions.MaxAtlasSize)
+                break;
+
+            positions.push_back({ x, y });
+            x += w;
+            shelfHeight = std::max<std::uint32_t>(shelfHeight, h);
+            usedWidth = std::max<std::uint32_t>(usedWidth, x);
+            usedHeight = std::max<std::uint32_t>(usedHeight, y + shelfHeight);
+        }
+
+        return (std::uint32_t)positions.size();
+    };
+
+    // 정렬 단위의 모든 너비를 시도해서 모든 텍스쳐가 들어가는 가장 작은 면적을 고릅니다.
+    std::vector<Position> positions;
+    std::vector<Position> bestPositions;
+    std::uint32_t bestWidth = 0;
+    std::uint32_t bestHeight = 0;
+    std::uint64_t bestArea = 0;
+
+    for (std::uint32_t width = alignment; ; width += alignment)
+    {
+        width = std::min<std::uint32_t>(width, mOptions.MaxAtlasSize);
+
+        std::uint32_t usedWidth = 0;
+        std::uint32_t usedHeight = 0;
+        const std::uint32_t count = shelfPack(width, positions, usedWidth, usedHeight);
+
+        // 다 들어가지 않으면 가장 큰 너비에서 들어가는 만큼만 사용합니다.
+        const bool fitsAll = count == items.size();
+        const std::uint64_t area = (std::uint64_t)usedWidth * usedHeight;
+        if (count > 0 && (fitsAll || width == mOptions.MaxAtlasSize) &&
+            (bestPositions.size() < count || (bestPositions.size() == count && area < bestArea)))
+        {
+            bestPositions = positions;
+            bestWidth = usedWidth;
+            bestHeight = usedHeight;
+            bestArea = area;
+        }
+
+        if (width == mOptions.MaxAtlasSize)
+            break;
+    }
+
+    if (bestPositions.empty())
+        return;
+
+    TexturePackGroup group;
+    group.Kind = TexturePackKind::Atlas;
+    group.Desc = mEntries[items.front()].Desc;
+    group.Desc.Width = bestWidth;
+    group.Desc.Height = bestHeight;
+    group.Desc.DepthOrArraySize = 1;
+    group.Desc.MipLevels = mipLevels;
+
+    for (size_t i = 0; i < bestPositions.size(); ++i)
+    {
+        const std::uint32_t texture = items[i];
+        const TextureUploadDesc& desc = mEntries[texture].Desc;
+
+        TexturePlacement& placement = mEntries[texture].Placement;
+        placement = TexturePlacement();
+        placement.Group = (std::uint32_t)mGroups.size();
+        placement.X = bestPositions[i].X;
+        placement.Y = bestPositions[i].Y;
+
+        // [0, 1]을 첫 번째와 마지막 텍셀의 중심으로 옮겨서 밉 0에서 쌍선형 필터링이
+        // 여백을 읽지 않게 합니다.
+        placement.UvTransform = MakeUvTransform(
+            (float)(desc.Width - 1) / bestWidth,
+            (float)(desc.Height - 1) / bestHeight,
+            (placement.X + 0.5f) / bestWidth,
+            (placement.Y + 0.5f) / bestHeight);
+
+        group.Textures.push_back(texture);
+        group.UsedTexels += desc.Width * desc.Height;
+    }
+
+    mGroups.push_back(group);
+    items.erase(items.begin(), items.begin() + bestPositions.size());
+}
+
+std::uint32_t TexturePacker::TextureCount() const
+{
+    return (std::uint32_t)mEntries.size();
+}
+
+std::uint32_t TexturePacker::GroupCount() const
+{
+    return (std::uint32_t)mGroups.size();
+}
+
+const TexturePackGroup& TexturePacker::GetGroup(std::uint32_t group) const
+{
+    return mGroups[group];
+}
+
+const TexturePlacement& TexturePacker::GetPlacement(std::uint32_t texture) const
+{
+    return mEntries[texture].Placement;
+}
+
+void TexturePacker::GetCopies(std::uint32_t texture, std::vector<TexturePackCopy>& copies) const
+{
+    copies.clear();
+
+    const TextureUploadDesc& desc = mEntries[texture].Desc;
+    const TexturePlacement& placement = mEntries[texture].Placement;
+    const TexturePackGroup& group = mGroups[placement.Group];
+
+    const std::uint32_t arraySize = desc.IsVolume ? 1 : desc.DepthOrArraySize;
+    for (std::uint32_t slice = 0; slice < arraySize; ++slice)
+    {
+        for (std::uint32_t mip = 0; mip < group.Desc.MipLevels; ++mip)
+        {
+            TexturePackCopy copy;
+            copy.SrcSubresource = mip + slice * desc.MipLevels;
+            copy.DstSubresource = mip + (placement.Slice + slice) * group.Desc.MipLevels;
+            copy.DstX = placement.X >> mip;
+            copy.DstY = placement.Y >> mip;
+            copy.Width = std::max<std::uint32_t>((std::uint32_t)(desc.Width >> mip), 1);
+            copy.Height = std::max<std::uint32_t>(desc.Height >> mip, 1);
+
+            copies.push_back(copy);
+        }
+    }
+}
+
+float TexturePacker::GetAtlasEfficiency() const
+{
+    std::uint64_t usedTexels = 0;
+    std::uint64_t totalTexels = 0;
+    for (const TexturePackGroup& group : mGroups)
+    {
+        if (group.Kind != TexturePackKind::Atlas)
+            continue;
+
+        usedTexels += group.UsedTexels;
+        totalTexels += group.Desc.Width * group.Desc.Height;
+    }
+
+    return totalTexels > 0 ? (float)usedTexels / totalTexels : 1.0f;
+}
+
+void TexturePacker::ApplyUvTransform(std::uint32_t texture, XMFLOAT4X4& matTransform) const
+{
+    XMMATRIX uvTransform = XMLoadFloat4x4(&mEntries[texture].Placement.UvTransform);
+    XMStoreFloat4x4(&matTransform, XMMatrixMultiply(XMLoadFloat4x4(&matTransform), uvTransform));
+}
+
+void TexturePacker::CopySurface(DXGI_FORMAT format, const TexturePackCopy& copy,
+    const void* src, size_t srcRowPitch, void* dst, size_t dstRowPitch)
+{
+    const std::uint32_t blockSize = IsBlockCompressed(format) ? 4 : 1;
+
+    // 블록(또는 텍셀) 하나의 바이트 수입니다.
+    size_t blockBytes = 0;
+    GetDDSSurfaceInfo(blockSize, blockSize, format, nullptr, &blockBytes, nullptr);
+
+    size_t rowBytes = 0;
+    size_t numRows = 0;
+    GetDDSSurfaceInfo(copy.Width, copy.Height, format, nullptr, &rowBytes, &numRows);
+
+    const std::uint8_t* srcBytes = reinterpret_cast<const std::uint8_t*>(src);
+    std::uint8_t* dstBytes = reinterpret_cast<std::uint8_t*>(dst) +
+        (copy.DstY / blockSize) * dstRowPitch + (copy.DstX / blockSize) * blockBytes;
+
+    for (size_t row = 0; row < numRows; ++row)
+        std::memcpy(dstBytes + row * dstRowPitch, srcBytes + row * srcRowPitch, rowBytes);
+}
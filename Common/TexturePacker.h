@@ -0,0 +1,131 @@
+﻿//***************************************************************************************
+// TexturePacker.h
+//
+// Groups many small material textures into fewer resources so an app needs fewer SRVs
+// and descriptor table entries.  Textures with the same format, size and mip count
+// become the slices of one Texture2DArray.  Small textures whose texture coordinates
+// stay in [0, 1] are packed into an atlas (shelf packing with padding) and get a UV
+// transform that is appended to Material::MatTransform.  Everything else stays
+// standalone.  The packer only produces the layout and copies surfaces in system
+// memory.
+//***************************************************************************************
+
+#pragma once
+
+#include "TextureUploadPlanner.h"
+#include <DirectXMath.h>
+
+struct TexturePackOptions
+{
+    bool BuildArrays = true;
+    bool BuildAtlases = true;
+
+    // 아틀라스에 넣을 수 있는 텍스쳐의 최대 크기(한 변)와 아틀라스의 최대 크기입니다.
+    std::uint32_t MaxAtlasItemSize = 256;
+    std::uint32_t MaxAtlasSize = 2048;
+
+    // 아틀라스에서 텍스쳐 사이에 두는 최소 여백(밉 0의 텍셀)입니다.
+    std::uint32_t Padding = 4;
+
+    // 아틀라스의 최대 밉 개수입니다. 작은 밉에서는 여백이 사라져서 이웃 텍스쳐가 번집니다.
+    std::uint32_t MaxAtlasMipLevels = 4;
+};
+
+enum class TexturePackKind
+{
+    Standalone,
+    Array,
+    Atlas
+};
+
+// 텍스쳐들이 묶인 리소스 하나입니다.
+struct TexturePackGroup
+{
+    TexturePackKind Kind = TexturePackKind::Standalone;
+    TextureUploadDesc Desc;
+
+    std::vector<std::uint32_t> Textures;
+
+    // 아틀라스에서 텍스쳐들이 실제로 차지하는 밉 0 텍셀 수입니다.
+    std::uint64_t UsedTexels = 0;
+};
+
+struct TexturePlacement
+{
+    std::uint32_t Group = 0;
+    std::uint32_t Slice = 0;
+
+    // 아틀라스 안에서의 위치(밉 0 텍셀)입니다.
+    std::uint32_t X = 0;
+    std::uint32_t Y = 0;
+
+    // 텍스쳐 좌표를 묶인 리소스의 좌표로 바꾸는 변환입니다.
+    DirectX::XMFLOAT4X4 UvTransform;
+};
+
+// 원본 텍스쳐의 서브리소스 하나를 묶인 리소스로 옮기는 정보입니다.
+struct TexturePackCopy
+{
+    std::uint32_t SrcSubresource = 0;
+    std::uint32_t DstSubresource = 0;
+
+    // 대상 서브리소스 안에서의 위치(텍셀)와 복사할 크기입니다.
+    std::uint32_t DstX = 0;
+    std::uint32_t DstY = 0;
+    std::uint32_t Width = 0;
+    std::uint32_t Height = 0;
+};
+
+class TexturePacker
+{
+public:
+    explicit TexturePacker(const TexturePackOptions& options = TexturePackOptions());
+
+    // 텍스쳐를 등록하고 인덱스를 반환합니다. 텍스쳐 좌표가 [0, 1] 밖으로 반복될 수 있으면
+    // wrapsUV를 true로 전달합니다. 그런 텍스쳐는 아틀라스에 넣지 않습니다.
+    std::uint32_t AddTexture(const TextureUploadDesc& desc, bool wrapsUV);
+
+    // 등록된 텍스쳐들을 배열, 아틀라스, 단독 그룹으로 나눕니다.
+    void Pack();
+
+    std::uint32_t TextureCount() const;
+    std::uint32_t GroupCount() const;
+
+    const TexturePackGroup& GetGroup(std::uint32_t group) const;
+    const TexturePlacement& GetPlacement(std::uint32_t texture) const;
+
+    // 텍스쳐의 서브리소스들이 묶인 리소스의 어디로 복사되어야 하는지 구합니다.
+    // 아틀라스의 밉 개수보다 상세한 밉만 복사됩니다.
+    void GetCopies(std::uint32_t texture, std::vector<TexturePackCopy>& copies) const;
+
+    // 모든 아틀라스 면적 중 텍스쳐가 차지하는 비율입니다. 아틀라스가 없으면 1입니다.
+    float GetAtlasEfficiency() const;
+
+    // 메터리얼의 MatTransform 뒤에 텍스쳐의 UV 변환을 붙입니다.
+    void ApplyUvTransform(std::uint32_t texture, DirectX::XMFLOAT4X4& matTransform) const;
+
+    // 원본 서브리소스를 대상 서브리소스의 (DstX, DstY) 위치에 복사합니다.
+    // 블록 압축 포맷은 4x4 블록 단위로 복사되며 위치는 4의 배수여야 합니다.
+    static void CopySurface(DXGI_FORMAT format, const TexturePackCopy& copy,
+        const void* src, size_t srcRowPitch, void* dst, size_t dstRowPitch);
+
+private:
+    struct Entry
+    {
+        TextureUploadDesc Desc;
+        bool WrapsUV = false;
+        TexturePlacement Placement;
+    };
+
+    void PackArrays(std::vector<std::uint32_t>& remaining);
+    void PackAtlases(std::vector<std::uint32_t>& remaining);
+    void PackAtlasPage(std::vector<std::uint32_t>& items, std::uint32_t mipLevels, std::uint32_t alignment);
+
+    bool CanBeGrouped(const TextureUploadDesc& desc) const;
+
+private:
+    TexturePackOptions mOptions;
+
+    std::vector<Entry> mEntries;
+    std::vector<TexturePackGroup> mGroups;
+};
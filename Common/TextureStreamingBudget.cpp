@@ -0,0 +1,234 @@
+﻿//***************************************************************************************
+// TextureStreamingBudget.cpp
+//***************************************************************************************
+
+#include "TextureStreamingBudget.h"
+#include "DDSSurfaceInfo.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cassert>
+
+TextureStreamingBudget::TextureStreamingBudget(std::uint64_t budgetBytes, std::uint32_t minResidentSize)
+    : mBudgetBytes(budgetBytes), mMinResidentSize(std::max<std::uint32_t>(1, minResidentSize))
+{
+}
+
+std::uint32_t TextureStreamingBudget::AddTexture(const TextureUploadDesc& desc, float screenSize)
+{
+    Entry e;
+    e.Desc = desc;
+    e.Desc.MipLevels = std::max<std::uint32_t>(1, desc.MipLevels);
+    e.ScreenSize = screenSize;
+
+    mEntries.push_back(e);
+
+    return (std::uint32_t)mEntries.size() - 1;
+}
+
+void TextureStreamingBudget::SetScreenSize(std::uint32_t index, float screenSize)
+{
+    assert(index < mEntries.size());
+
+    Entry& e = mEntries[index];
+    e.ScreenSize = screenSize;
+    e.DesiredTopMip = GetScreenSizeTopMip(e.Desc, e.ScreenSize);
+    e.TailMip = std::max<std::uint32_t>(e.DesiredTopMip, GetTailMip(e.Desc));
+}
+
+void TextureStreamingBudget::Resolve()
+{
+    PROFILE_FUNCTION();
+
+    mResidentBytes = 0;
+    mOverBudget = false;
+
+    // 먼저 화면 크기에 맞는 밉부터 상주시킵니다. 그보다 큰 밉은 화면에서 보이지 않습니다.
+    for (auto& e : mEntries)
+    {
+        e.DesiredTopMip = GetScreenSizeTopMip(e.Desc, e.ScreenSize);
+        e.TailMip = std::max<std::uint32_t>(e.DesiredTopMip, GetTailMip(e.Desc));
+        e.ResidentTopMip = e.DesiredTopMip;
+        e.ResidentBytes = GetMipChainBytes(e.Desc, e.ResidentTopMip);
+
+        mResidentBytes += e.ResidentBytes;
+    }
+
+    // 예산을 넘으면 가장 많은 메모리를 줄일 수 있는 텍스쳐의 최상위 밉을 하나씩 버립니다.
+    while (mResidentBytes > mBudgetBytes)
+    {
+        Entry* best = nullptr;
+        std::uint64_t bestSavedBytes = 0;
+        std::uint64_t bestRemainingBytes = 0;
+
+        for (auto& e : mEntries)
+        {
+            if (e.ResidentTopMip >= e.TailMip)
+                continue;
+
+            std::uint64_t remainingBytes = GetMipChainBytes(e.Desc, e.ResidentTopMip + 1);
+            std::uint64_t savedBytes = e.ResidentBytes - remainingBytes;
+            if (savedBytes > bestSavedBytes)
+            {
+                best = &e;
+                bestSavedBytes = savedBytes;
+                bestRemainingBytes = remainingBytes;
+            }
+        }
+
+        if (best == nullptr)
+        {
+            // 모든 텍스쳐가 밉 테일까지 줄었지만 여전히 예산을 넘습니다.
+            mOverBudget = true;
+            break;
+        }
+
+        best->ResidentTopMip++;
+        best->ResidentBytes = bestRemainingBytes;
+        mResidentBytes -= bestSavedBytes;
+    }
+}
+
+std::uint32_t TextureStreamingBudget::TextureCount() const
+{
+    return (std::uint32_t)mEntries.size();
+}
+
+std::uint32_t TextureStreamingBudget::GetResidentTopMip(std::uint32_t index) const
+{
+    return mEntries[index].ResidentTopMip;
+}
+
+std::uint32_t TextureStreamingBudget::GetDesiredTopMip(std::uint32_t index) const
+{
+    return mEntries[index].DesiredTopMip;
+}
+
+std::uint64_t TextureStreamingBudget::GetMaxSize(std::uint32_t index) const
+{
+    return GetMaxSizeForMip(mEntries[index].Desc, mEntries[index].ResidentTopMip);
+}
+
+std::uint64_t TextureStreamingBudget::GetMaxSize(std::uint32_t index, std::uint32_t topMip) const
+{
+    return GetMaxSizeForMip(mEntries[index].Desc, topMip);
+}
+
+std::uint64_t TextureStreamingBudget::GetResidentBytes(std::uint32_t index) const
+{
+    return mEntries[index].ResidentBytes;
+}
+
+std::uint64_t TextureStreamingBudget::ResidentBytes() const
+{
+    return mResidentBytes;
+}
+
+std::uint64_t TextureStreamingBudget::BudgetBytes() const
+{
+    return mBudgetBytes;
+}
+
+bool TextureStreamingBudget::IsOverBudget() const
+{
+    return mOverBudget;
+}
+
+bool TextureStreamingBudget::NextStreamingRequest(std::uint32_t& index, std::uint32_t& topMip) const
+{
+    bool found = false;
+    std::uint32_t bestDeficit = 0;
+    std::uint64_t bestCost = 0;
+
+    for (std::uint32_t i = 0; i < (std::uint32_t)mEntries.size(); ++i)
+    {
+        const Entry& e = mEntries[i];
+        if (e.ResidentTopMip <= e.DesiredTopMip)
+            continue;
+
+        std::uint64_t cost = GetMipChainBytes(e.Desc, e.ResidentTopMip - 1) - e.ResidentBytes;
+        if (mResidentBytes + cost > mBudgetBytes)
+            continue;
+
+        // 원하는 해상도와 가장 많이 차이나는 텍스쳐를 먼저, 같다면 비용이 적은 텍스쳐를 먼저 올립니다.
+        std::uint32_t deficit = e.ResidentTopMip - e.DesiredTopMip;
+        if (!found || deficit > bestDeficit || (deficit == bestDeficit && cost < bestCost))
+        {
+            found = true;
+            bestDeficit = deficit;
+            bestCost = cost;
+            index = i;
+            topMip = e.ResidentTopMip - 1;
+        }
+    }
+
+    return found;
+}
+
+void TextureStreamingBudget::CommitResidentMip(std::uint32_t index, std::uint32_t topMip)
+{
+    assert(index < mEntries.size());
+
+    Entry& e = mEntries[index];
+    e.ResidentTopMip = std::min<std::uint32_t>(topMip, e.Desc.MipLevels - 1);
+
+    mResidentBytes -= e.ResidentBytes;
+    e.ResidentBytes = GetMipChainBytes(e.Desc, e.ResidentTopMip);
+    mResidentBytes += e.ResidentBytes;
+}
+
+std::uint64_t TextureStreamingBudget::GetMipChainBytes(const TextureUploadDesc& desc, std::uint32_t firstMip)
+{
+    const std::uint32_t arraySize = desc.IsVolume ? 1 : desc.DepthOrArraySize;
+
+    std::uint64_t bytes = 0;
+    for (std::uint32_t mip = firstMip; mip < desc.MipLevels; ++mip)
+    {
+        size_t width = (size_t)std::max<std::uint64_t>(1, desc.Width >> mip);
+        size_t height = std::max<std::uint32_t>(1, desc.Height >> mip);
+        size_t depth = desc.IsVolume ? std::max<std::uint32_t>(1, desc.DepthOrArraySize >> mip) : 1;
+
+        size_t numBytes = 0;
+        DirectX::GetDDSSurfaceInfo(width, height, desc.Format, &numBytes, nullptr, nullptr);
+
+        bytes += (std::uint64_t)numBytes * depth;
+    }
+
+    return bytes * arraySize;
+}
+
+std::uint32_t TextureStreamingBudget::GetScreenSizeTopMip(const TextureUploadDesc& desc, float screenSize)
+{
+    const std::uint32_t lastMip = std::max<std::uint32_t>(1, desc.MipLevels) - 1;
+    if (screenSize <= 0.0f)
+        return lastMip;
+
+    const std::uint64_t maxDim = std::max<std::uint64_t>(desc.Width, desc.Height);
+
+    // 화면 크기 이상의 해상도를 가진 가장 작은 밉을 찾습니다.
+    std::uint32_t mip = 0;
+    while (mip < lastMip && (float)(maxDim >> (mip + 1)) >= screenSize)
+        ++mip;
+
+    return mip;
+}
+
+std::uint64_t TextureStreamingBudget::GetMaxSizeForMip(const TextureUploadDesc& desc, std::uint32_t topMip)
+{
+    // 로더는 가로, 세로, 깊이가 모두 maxsize 이하인 밉부터 업로드합니다.
+    std::uint64_t maxDim = std::max<std::uint64_t>(desc.Width, desc.Height);
+    if (desc.IsVolume)
+        maxDim = std::max<std::uint64_t>(maxDim, desc.DepthOrArraySize);
+
+    return std::max<std::uint64_t>(1, maxDim >> topMip);
+}
+
+std::uint32_t TextureStreamingBudget::GetTailMip(const TextureUploadDesc& desc) const
+{
+    const std::uint64_t maxDim = std::max<std::uint64_t>(desc.Width, desc.Height);
+
+    std::uint32_t mip = 0;
+    while (mip + 1 < desc.MipLevels && (maxDim >> mip) > mMinResidentSize)
+        ++mip;
+
+    return mip;
+}
@@ -0,0 +1,88 @@
+﻿//***************************************************************************************
+// TextureStreamingBudget.h
+//
+// Chooses the most detailed mip that each texture keeps resident.  The choice starts
+// from the mip that matches the expected on-screen size and then drops the largest
+// mips of the most expensive textures until the whole set fits in a global memory
+// budget.  The small mip tail is never dropped.  The dropped mips are handed out
+// later, one at a time, as streaming requests.
+//
+// The byte accounting uses GetDDSSurfaceInfo so it matches what the DDS loader
+// actually uploads.
+//***************************************************************************************
+
+#pragma once
+
+#include "TextureUploadPlanner.h"
+
+class TextureStreamingBudget
+{
+public:
+    explicit TextureStreamingBudget(std::uint64_t budgetBytes, std::uint32_t minResidentSize = 64);
+
+    // 텍스쳐를 등록하고 인덱스를 반환합니다.
+    // screenSize는 텍스쳐가 화면에서 차지할 것으로 예상되는 최대 픽셀 수(한 변)입니다.
+    std::uint32_t AddTexture(const TextureUploadDesc& desc, float screenSize);
+
+    // 원하는 밉만 다시 계산합니다. 상주 밉은 스트리밍을 통해서 바뀝니다.
+    void SetScreenSize(std::uint32_t index, float screenSize);
+
+    // 화면 크기와 예산으로 모든 텍스쳐의 상주 밉을 결정합니다. 로드하기 전에 호출합니다.
+    void Resolve();
+
+    std::uint32_t TextureCount() const;
+
+    // 상주하는 가장 상세한 밉과 화면 크기로 결정된 원하는 밉입니다.
+    std::uint32_t GetResidentTopMip(std::uint32_t index) const;
+    std::uint32_t GetDesiredTopMip(std::uint32_t index) const;
+
+    // CreateDDSTextureFromFile12/LoadDDSTextureFromMemory12에 전달할 maxsize입니다.
+    std::uint64_t GetMaxSize(std::uint32_t index) const;
+    std::uint64_t GetMaxSize(std::uint32_t index, std::uint32_t topMip) const;
+
+    std::uint64_t GetResidentBytes(std::uint32_t index) const;
+    std::uint64_t ResidentBytes() const;
+    std::uint64_t BudgetBytes() const;
+
+    // 밉 테일까지 줄여도 예산을 넘는 경우 true입니다.
+    bool IsOverBudget() const;
+
+    // 다음에 스트리밍할 텍스쳐와 밉을 고릅니다. 예산 안에서 원하는 밉보다 낮은 해상도로
+    // 상주하는 텍스쳐 중 가장 많이 부족한 텍스쳐의 한 단계 위 밉을 반환합니다.
+    bool NextStreamingRequest(std::uint32_t& index, std::uint32_t& topMip) const;
+
+    // 스트리밍이 끝나서 topMip부터 상주하게 되었을 때 호출합니다.
+    void CommitResidentMip(std::uint32_t index, std::uint32_t topMip);
+
+    // firstMip부터 마지막 밉까지 모든 배열 슬라이스의 바이트 수입니다.
+    static std::uint64_t GetMipChainBytes(const TextureUploadDesc& desc, std::uint32_t firstMip);
+
+    // 화면 크기에 필요한 해상도를 가진 가장 작은 밉입니다.
+    static std::uint32_t GetScreenSizeTopMip(const TextureUploadDesc& desc, float screenSize);
+
+    // topMip을 최상위 밉으로 로드하기 위한 maxsize입니다.
+    static std::uint64_t GetMaxSizeForMip(const TextureUploadDesc& desc, std::uint32_t topMip);
+
+private:
+    struct Entry
+    {
+        TextureUploadDesc Desc;
+        float ScreenSize = 0.0f;
+
+        std::uint32_t DesiredTopMip = 0;
+        std::uint32_t TailMip = 0;
+        std::uint32_t ResidentTopMip = 0;
+        std::uint64_t ResidentBytes = 0;
+    };
+
+    std::uint32_t GetTailMip(const TextureUploadDesc& desc) const;
+
+private:
+    std::uint64_t mBudgetBytes = 0;
+    std::uint32_t mMinResidentSize = 64;
+
+    std::uint64_t mResidentBytes = 0;
+    bool mOverBudget = false;
+
+    std::vector<Entry> mEntries;
+};
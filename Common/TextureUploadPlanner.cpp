@@ -0,0 +1,127 @@
+﻿//***************************************************************************************
+// TextureUploadPlanner.cpp
+//***************************************************************************************
+
+#include "TextureUploadPlanner.h"
+#include "DDSSurfaceInfo.h"
+#include <algorithm>
+
+TextureUploadPlanner::TextureUploadPlanner(std::uint64_t ringByteSize)
+    : mRingByteSize(ringByteSize)
+{
+}
+
+bool TextureUploadPlanner::Plan(const std::vector<TextureUploadDesc>& textures)
+{
+    mCopies.clear();
+    mBatchCount = 0;
+    mPeakStagingBytes = 0;
+    mPerTextureStagingBytes = 0;
+
+    std::uint64_t head = 0;
+    std::uint32_t batch = 0;
+
+    for (std::uint32_t i = 0; i < (std::uint32_t)textures.size(); ++i)
+    {
+        const TextureUploadDesc& tex = textures[i];
+
+        const std::uint32_t arraySize = tex.IsVolume ? 1 : tex.DepthOrArraySize;
+        const std::uint32_t subresourceCount = tex.MipLevels * arraySize;
+
+        // 텍스쳐마다 업로드 힙을 만들었다면 GetRequiredIntermediateSize 만큼 필요했을 것입니다.
+        std::uint64_t textureBytes = 0;
+
+        for (std::uint32_t sub = 0; sub < subresourceCount; ++sub)
+        {
+            TextureCopyDesc copy = GetCopyFootprint(tex, sub);
+            copy.TextureIndex = i;
+
+            if (copy.TotalBytes > mRingByteSize)
+            {
+                mCopies.clear();
+                return false;
+            }
+
+            textureBytes = AlignUp(textureBytes, PlacementAlignment) + copy.TotalBytes;
+
+            // 링의 남은 공간이 부족하면 새 배치를 시작합니다.
+            // 새 배치는 이전 배치의 복사가 모두 끝난 뒤 링의 처음부터 다시 채웁니다.
+            std::uint64_t offset = AlignUp(head, PlacementAlignment);
+            if (offset + copy.TotalBytes > mRingByteSize)
+            {
+                ++batch;
+                offset = 0;
+            }
+
+            copy.RingOffset = offset;
+            copy.Batch = batch;
+            head = offset + copy.TotalBytes;
+
+            mPeakStagingBytes = std::max<std::uint64_t>(mPeakStagingBytes, head);
+            mCopies.push_back(copy);
+        }
+
+        mPerTextureStagingBytes += textureBytes;
+    }
+
+    mBatchCount = mCopies.empty() ? 0 : batch + 1;
+
+    return true;
+}
+
+const std::vector<TextureCopyDesc>& TextureUploadPlanner::Copies() const
+{
+    return mCopies;
+}
+
+std::uint64_t TextureUploadPlanner::RingByteSize() const
+{
+    return mRingByteSize;
+}
+
+std::uint32_t TextureUploadPlanner::BatchCount() const
+{
+    return mBatchCount;
+}
+
+std::uint64_t TextureUploadPlanner::PeakStagingBytes() const
+{
+    return mPeakStagingBytes;
+}
+
+std::uint64_t TextureUploadPlanner::PerTextureStagingBytes() const
+{
+    return mPerTextureStagingBytes;
+}
+
+TextureCopyDesc TextureUploadPlanner::GetCopyFootprint(const TextureUploadDesc& desc, std::uint32_t subresource)
+{
+    // 서브리소스 인덱스는 D3D12CalcSubresource와 같이 MipSlice + ArraySlice * MipLevels 입니다.
+    const std::uint32_t mip = subresource % desc.MipLevels;
+
+    TextureCopyDesc copy;
+    copy.Subresource = subresource;
+    copy.Format = desc.Format;
+    copy.Width = (std::uint32_t)std::max<std::uint64_t>(1, desc.Width >> mip);
+    copy.Height = std::max<std::uint32_t>(1, desc.Height >> mip);
+    copy.Depth = desc.IsVolume ? std::max<std::uint32_t>(1, desc.DepthOrArraySize >> mip) : 1;
+
+    size_t rowBytes = 0;
+    size_t numRows = 0;
+    DirectX::GetDDSSurfaceInfo(copy.Width, copy.Height, desc.Format, nullptr, &rowBytes, &numRows);
+
+    copy.RowSizeInBytes = rowBytes;
+    copy.NumRows = (std::uint32_t)numRows;
+    copy.RowPitch = (std::uint32_t)AlignUp(rowBytes, RowPitchAlignment);
+
+    // 마지막 행은 정렬된 행 간격 대신 실제 행 크기만큼만 차지합니다.
+    const std::uint64_t sliceBytes = (std::uint64_t)copy.RowPitch * copy.NumRows;
+    copy.TotalBytes = sliceBytes * (copy.Depth - 1) + (std::uint64_t)copy.RowPitch * (copy.NumRows - 1) + copy.RowSizeInBytes;
+
+    return copy;
+}
+
+std::uint64_t TextureUploadPlanner::AlignUp(std::uint64_t value, std::uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
@@ -0,0 +1,92 @@
+﻿//***************************************************************************************
+// TextureUploadPlanner.h
+//
+// Computes where every subresource of a list of textures goes inside one shared
+// staging ring buffer so that many DDS files can be uploaded without creating a
+// committed upload heap per texture.  The planner never touches the device and only
+// produces copy descriptors.
+//***************************************************************************************
+
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstdint>
+#include <vector>
+
+// 업로드할 텍스쳐의 정보입니다. D3D12_RESOURCE_DESC에서 필요한 값들만 가져옵니다.
+struct TextureUploadDesc
+{
+    std::uint64_t Width = 1;
+    std::uint32_t Height = 1;
+    std::uint32_t DepthOrArraySize = 1;
+    std::uint32_t MipLevels = 1;
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+
+    // 3D 텍스쳐인 경우 DepthOrArraySize는 깊이이고 밉마다 줄어듭니다.
+    bool IsVolume = false;
+};
+
+// 스테이징 링에서 텍스쳐의 서브리소스 하나로 복사하기 위한 정보입니다.
+// D3D12_PLACED_SUBRESOURCE_FOOTPRINT와 CopyTextureRegion에 그대로 대응됩니다.
+struct TextureCopyDesc
+{
+    std::uint32_t TextureIndex = 0;
+    std::uint32_t Subresource = 0;
+
+    // 이 복사가 속한 배치입니다. 배치가 바뀔 때 이전 배치의 복사가 끝날 때까지 기다린 후
+    // 링의 앞부분을 재사용합니다.
+    std::uint32_t Batch = 0;
+
+    // 링 버퍼 시작부터의 오프셋 (512 바이트 정렬).
+    std::uint64_t RingOffset = 0;
+
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+    std::uint32_t Width = 0;
+    std::uint32_t Height = 0;
+    std::uint32_t Depth = 0;
+
+    // 링 안에서의 행 간격 (256 바이트 정렬)과 소스 데이터의 실제 행 크기입니다.
+    std::uint32_t RowPitch = 0;
+    std::uint32_t NumRows = 0;
+    std::uint64_t RowSizeInBytes = 0;
+
+    // 링 안에서 이 서브리소스가 차지하는 바이트 수입니다.
+    std::uint64_t TotalBytes = 0;
+};
+
+class TextureUploadPlanner
+{
+public:
+    static const std::uint64_t PlacementAlignment = 512; // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+    static const std::uint32_t RowPitchAlignment = 256;  // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+
+    explicit TextureUploadPlanner(std::uint64_t ringByteSize);
+
+    // 텍스쳐들의 모든 서브리소스를 링에 배치합니다.
+    // 링보다 큰 서브리소스가 있으면 false를 반환합니다.
+    bool Plan(const std::vector<TextureUploadDesc>& textures);
+
+    const std::vector<TextureCopyDesc>& Copies() const;
+
+    std::uint64_t RingByteSize() const;
+    std::uint32_t BatchCount() const;
+
+    // 실제로 필요한 스테이징 메모리의 최대 크기입니다. 링은 이 크기로 만들면 충분합니다.
+    std::uint64_t PeakStagingBytes() const;
+
+    // 텍스쳐마다 업로드 힙을 만들었을 경우 필요했던 메모리의 합입니다.
+    std::uint64_t PerTextureStagingBytes() const;
+
+    // 서브리소스 하나의 복사 정보를 계산합니다. RingOffset과 Batch는 채우지 않습니다.
+    static TextureCopyDesc GetCopyFootprint(const TextureUploadDesc& desc, std::uint32_t subresource);
+
+    static std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment);
+
+private:
+    std::uint64_t mRingByteSize = 0;
+    std::uint32_t mBatchCount = 0;
+    std::uint64_t mPeakStagingBytes = 0;
+    std::uint64_t mPerTextureStagingBytes = 0;
+
+    std::vector<TextureCopyDesc> mCopies;
+};
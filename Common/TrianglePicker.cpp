@@ -0,0 +1,493 @@
+﻿//***************************************************************************************
+// TrianglePicker.cpp
+//***************************************************************************************
+
+#include "TrianglePicker.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+void TrianglePicker::Clear()
+{
+    mMeshes.clear();
+    mInstances.clear();
+
+    mInstanceBvh.Clear();
+    mInstanceBvhDirty = true;
+    mMovedInstances.clear();
+}
+
+std::uint32_t TrianglePicker::AddMesh(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const std::uint32_t* indices, std::uint32_t indexCount, std::int32_t baseVertex)
+{
+    return AddIndexedMesh(positions, stride, vertexCount, indices, indexCount, baseVertex);
+}
+
+std::uint32_t TrianglePicker::AddMesh(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const std::uint16_t* indices, std::uint32_t indexCount, std::int32_t baseVertex)
+{
+    return AddIndexedMesh(positions, stride, vertexCount, indices, indexCount, baseVertex);
+}
+
+template<typename Index>
+std::uint32_t TrianglePicker::AddIndexedMesh(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+    const Index* indices, std::uint32_t indexCount, std::int32_t baseVertex)
+{
+    const std::uint32_t triCount = indexCount / 3;
+
+    // 잘못된 인덱스를 가까운 버텍스로 바꾸면 렌더링되는 메쉬와 다른 삼각형이 선택되므로 메쉬를 거부합니다.
+    for (std::uint32_t i = 0; i < triCount * 3; ++i)
+    {
+        const std::int64_t vertex = (std::int64_t)baseVertex + (std::int64_t)indices[i];
+        if (vertex < 0 || vertex >= (std::int64_t)vertexCount)
+            return Invalid;
+    }
+
+    auto getPosition = [&](std::uint32_t i)
+    {
+        const std::uint32_t vertex = (std::uint32_t)(baseVertex + (std::int64_t)indices[i]);
+        return XMLoadFloat3((const XMFLOAT3*)((const std::uint8_t*)positions + (size_t)vertex * stride));
+    };
+
+    Mesh mesh;
+
+    mesh.Triangles.resize(triCount);
+
+    std::vector<BoundingBox> triangleBounds(triCount);
+
+    XMVECTOR meshMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR meshMax = XMVectorReplicate(-FLT_MAX);
+
+    for (std::uint32_t i = 0; i < triCount; ++i)
+    {
+        XMVECTOR v0 = getPosition(i * 3 + 0);
+        XMVECTOR v1 = getPosition(i * 3 + 1);
+        XMVECTOR v2 = getPosition(i * 3 + 2);
+
+        XMStoreFloat3(&mesh.Triangles[i].V0, v0);
+        XMStoreFloat3(&mesh.Triangles[i].E1, XMVectorSubtract(v1, v0));
+        XMStoreFloat3(&mesh.Triangles[i].E2, XMVectorSubtract(v2, v0));
+
+        XMVECTOR triMin = XMVectorMin(XMVectorMin(v0, v1), v2);
+        XMVECTOR triMax = XMVectorMax(XMVectorMax(v0, v1), v2);
+        BoundingBox::CreateFromPoints(triangleBounds[i], triMin, triMax);
+
+        meshMin = XMVectorMin(meshMin, triMin);
+        meshMax = XMVectorMax(meshMax, triMax);
+    }
+
+    if (triCount > 0)
+        BoundingBox::CreateFromPoints(mesh.Bounds, meshMin, meshMax);
+
+    mesh.Bvh.Build(triangleBounds);
+
+    mMeshes.push_back(std::move(mesh));
+    return (std::uint32_t)mMeshes.size() - 1;
+}
+
+std::uint32_t TrianglePicker::AddInstance(std::uint32_t mesh, FXMMATRIX world)
+{
+    if (mesh >= mMeshes.size())
+        return Invalid;
+
+    Instance instance;
+    instance.Mesh = mesh;
+    mInstances.push_back(instance);
+
+    const std::uint32_t index = (std::uint32_t)mInstances.size() - 1;
+    SetInstanceWorld(index, world);
+
+    mInstanceBvhDirty = true;
+    return index;
+}
+
+void TrianglePicker::SetInstanceWorld(std::uint32_t instance, FXMMATRIX world)
+{
+    Instance& inst = mInstances[instance];
+
+    XMVECTOR det = XMMatrixDeterminant(world);
+    XMStoreFloat4x4(&inst.InvWorld, XMMatrixInverse(&det, world));
+
+    // 행렬식이 0이면 XMMatrixInverse가 무한대나 NaN을 돌려주므로 역행렬의 원소도 함께 확인합니다.
+    const float d = XMVectorGetX(det);
+    inst.Invertible = std::isfinite(d) && std::fabs(d) > FLT_MIN;
+    for (int r = 0; r < 4 && inst.Invertible; ++r)
+        for (int c = 0; c < 4; ++c)
+            inst.Invertible = inst.Invertible && std::isfinite(inst.InvWorld(r, c));
+
+    mMeshes[inst.Mesh].Bounds.Transform(inst.WorldBounds, world);
+
+    if (!inst.Moved)
+    {
+        inst.Moved = true;
+        mMovedInstances.push_back(instance);
+    }
+}
+
+void TrianglePicker::SetInstanceEnabled(std::uint32_t instance, bool enabled)
+{
+    mInstances[instance].Enabled = enabled;
+}
+
+std::uint32_t TrianglePicker::MeshCount() const
+{
+    return (std::uint32_t)mMeshes.size();
+}
+
+std::uint32_t TrianglePicker::InstanceCount() const
+{
+    return (std::uint32_t)mInstances.size();
+}
+
+size_t TrianglePicker::MemoryUsage() const
+{
+    size_t bytes = mInstanceBvh.MemoryUsage();
+    for (const Mesh& mesh : mMeshes)
+        bytes += mesh.Triangles.capacity() * sizeof(Triangle) + mesh.Bvh.MemoryUsage();
+
+    return bytes;
+}
+
+bool TrianglePicker::IntersectTriangles(const Mesh& mesh, FXMVECTOR origin, FXMVECTOR direction,
+    const std::uint32_t* triangles, std::uint32_t count, float maxDist,
+    std::uint32_t& triangle, float& t, float& u, float& v)
+{
+    const XMVECTOR ox = XMVectorSplatX(origin);
+    const XMVECTOR oy = XMVectorSplatY(origin);
+    const XMVECTOR oz = XMVectorSplatZ(origin);
+    const XMVECTOR dx = XMVectorSplatX(direction);
+    const XMVECTOR dy = XMVectorSplatY(direction);
+    const XMVECTOR dz = XMVectorSplatZ(direction);
+
+    const XMVECTOR zero = XMVectorZero();
+    const XMVECTOR one = XMVectorSplatOne();
+    const XMVECTOR epsilon = XMVectorReplicate(1e-20f);
+    const XMVECTOR maxT = XMVectorReplicate(maxDist);
+
+    bool hit = false;
+
+    for (std::uint32_t base = 0; base < count; base += 4)
+    {
+        // 삼각형 4개를 성분별 벡터로 모읍니다. 모자라는 자리는 첫 번째 삼각형으로 채웁니다.
+        const Triangle* tri[4];
+        for (std::uint32_t lane = 0; lane < 4; ++lane)
+            tri[lane] = &mesh.Triangles[triangles[base + (base + lane < count ? lane : 0)]];
+
+        const XMVECTOR v0x = XMVectorSet(tri[0]->V0.x, tri[1]->V0.x, tri[2]->V0.x, tri[3]->V0.x);
+        const XMVECTOR v0y = XMVectorSet(tri[0]->V0.y, tri[1]->V0.y, tri[2]->V0.y, tri[3]->V0.y);
+        const XMVECTOR v0z = XMVectorSet(tri[0]->V0.z, tri[1]->V0.z, tri[2]->V0.z, tri[3]->V0.z);
+        const XMVECTOR e1x = XMVectorSet(tri[0]->E1.x, tri[1]->E1.x, tri[2]->E1.x, tri[3]->E1.x);
+        const XMVECTOR e1y = XMVectorSet(tri[0]->E1.y, tri[1]->E1.y, tri[2]->E1.y, tri[3]->E1.y);
+        const XMVECTOR e1z = XMVectorSet(tri[0]->E1.z, tri[1]->E1.z, tri[2]->E1.z, tri[3]->E1.z);
+        const XMVECTOR e2x = XMVectorSet(tri[0]->E2.x, tri[1]->E2.x, tri[2]->E2.x, tri[3]->E2.x);
+        const XMVECTOR e2y = XMVectorSet(tri[0]->E2.y, tri[1]->E2.y, tri[2]->E2.y, tri[3]->E2.y);
+        const XMVECTOR e2z = XMVectorSet(tri[0]->E2.z, tri[1]->E2.z, tri[2]->E2.z, tri[3]->E2.z);
+
+        // p = d x e2, det = e1 . p
+        const XMVECTOR px = XMVectorSubtract(XMVectorMultiply(dy, e2z), XMVectorMultiply(dz, e2y));
+        const XMVECTOR py = XMVectorSubtract(XMVectorMultiply(dz, e2x), XMVectorMultiply(dx, e2z));
+        const XMVECTOR pz = XMVectorSubtract(XMVectorMultiply(dx, e2y), XMVectorMultiply(dy, e2x));
+        const XMVECTOR det = XMVectorMultiplyAdd(e1x, px, XMVectorMultiplyAdd(e1y, py, XMVectorMultiply(e1z, pz)));
+        const XMVECTOR invDet = XMVectorReciprocal(det);
+
+        // s = o - v0, u = (s . p) / det
+        const XMVECTOR sx = XMVectorSubtract(ox, v0x);
+        const XMVECTOR sy = XMVectorSubtract(oy, v0y);
+        const XMVECTOR sz = XMVectorSubtract(oz, v0z);
+        const XMVECTOR bu = XMVectorMultiply(XMVectorMultiplyAdd(sx, px, XMVectorMultiplyAdd(sy, py, XMVectorMultiply(sz, pz))), invDet);
+
+        // q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+        const XMVECTOR qx = XMVectorSubtract(XMVectorMultiply(sy, e1z), XMVectorMultiply(sz, e1y));
+        const XMVECTOR qy = XMVectorSubtract(XMVectorMultiply(sz, e1x), XMVectorMultiply(sx, e1z));
+        const XMVECTOR qz = XMVectorSubtract(XMVectorMultiply(sx, e1y), XMVectorMultiply(sy, e1x));
+        const XMVECTOR bv = XMVectorMultiply(XMVectorMultiplyAdd(dx, qx, XMVectorMultiplyAdd(dy, qy, XMVectorMultiply(dz, qz))), invDet);
+        const XMVECTOR bt = XMVectorMultiply(XMVectorMultiplyAdd(e2x, qx, XMVectorMultiplyAdd(e2y, qy, XMVectorMultiply(e2z, qz))), invDet);
+
+        XMVECTOR valid = XMVectorGreater(XMVectorAbs(det), epsilon);
+        valid = XMVectorAndInt(valid, XMVectorGreaterOrEqual(bu, zero));
+        valid = XMVectorAndInt(valid, XMVectorGreaterOrEqual(bv, zero));
+        valid = XMVectorAndInt(valid, XMVectorGreaterOrEqual(one, XMVectorAdd(bu, bv)));
+        valid = XMVectorAndInt(valid, XMVectorGreaterOrEqual(bt, zero));
+        valid = XMVectorAndInt(valid, XMVectorGreater(maxT, bt));
+
+        XMFLOAT4 laneT;
+        XMFLOAT4 laneU;
+        XMFLOAT4 laneV;
+        XMStoreFloat4(&laneT, XMVectorSelect(XMVectorSplatInfinity(), bt, valid));
+        XMStoreFloat4(&laneU, bu);
+        XMStoreFloat4(&laneV, bv);
+
+        const float* lt = &laneT.x;
+        for (std::uint32_t lane = 0; lane < 4 && base + lane < count; ++lane)
+        {
+            if (lt[lane] < maxDist)
+            {
+                maxDist = lt[lane];
+                triangle = triangles[base + lane];
+                t = lt[lane];
+                u = (&laneU.x)[lane];
+                v = (&laneV.x)[lane];
+                hit = true;
+            }
+        }
+    }
+
+    return hit;
+}
+
+void TrianglePicker::UpdateHierarchy()
+{
+    PROFILE_FUNCTION();
+
+    mUpdateStats = UpdateStats();
+    mUpdateStats.MovedInstances = (std::uint32_t)mMovedInstances.size();
+
+    if (!mInstanceBvhDirty && !mMovedInstances.empty())
+    {
+        // 움직인 인스턴스의 리프에서 루트까지만 다시 계산합니다.
+        for (std::uint32_t instance : mMovedInstances)
+            mInstanceBvh.SetPrimitiveBounds(instance, mInstances[instance].WorldBounds);
+
+        mUpdateStats.RefitNodes = mInstanceBvh.RefitPrimitives(mMovedInstances);
+
+        // 인스턴스들이 흩어져서 노드들이 많이 겹치게 되면 다시 만듭니다.
+        if (mInstanceBvh.SahCost() > mRebuildRatio * mInstanceBvh.BuildSahCost())
+            mInstanceBvhDirty = true;
+    }
+
+    for (std::uint32_t instance : mMovedInstances)
+        mInstances[instance].Moved = false;
+    mMovedInstances.clear();
+
+    if (!mInstanceBvhDirty)
+        return;
+
+    std::vector<BoundingBox> instanceBounds(mInstances.size());
+    for (size_t i = 0; i < mInstances.size(); ++i)
+        instanceBounds[i] = mInstances[i].WorldBounds;
+
+    mInstanceBvh.Build(instanceBounds);
+    mInstanceBvhDirty = false;
+
+    mUpdateStats.Rebuilt = true;
+}
+
+void TrianglePicker::SetRebuildRatio(float ratio)
+{
+    mRebuildRatio = ratio;
+}
+
+const TrianglePicker::UpdateStats& TrianglePicker::LastUpdateStats() const
+{
+    return mUpdateStats;
+}
+
+bool TrianglePicker::TraceRay(const PickRay& ray, bool anyHit, PickHit& hit, BoundingVolumeHierarchy::RayStats* stats,
+    std::uint32_t* instanceTests) const
+{
+    BoundingVolumeHierarchy::RayStats totalStats;
+    std::uint32_t tests = 0;
+
+    const XMVECTOR origin = XMLoadFloat3(&ray.Origin);
+    const XMVECTOR direction = XMLoadFloat3(&ray.Direction);
+
+    std::uint32_t hitTriangle = 0;
+    float hitU = 0.0f;
+    float hitV = 0.0f;
+
+    // 상위 BVH의 리프에 있는 인스턴스마다 메쉬 BVH를 순회합니다.
+    auto intersectInstances = [&](const std::uint32_t* instances, std::uint32_t count, float maxDist,
+        std::uint32_t& instance, float& t)
+    {
+        bool found = false;
+
+        for (std::uint32_t k = 0; k < count; ++k)
+        {
+            const Instance& inst = mInstances[instances[k]];
+            if (!inst.Enabled || !inst.Invertible)
+                continue;
+
+            float boxDist = 0.0f;
+            if (!inst.WorldBounds.Intersects(origin, direction, boxDist) || boxDist >= maxDist)
+                continue;
+
+            tests++;
+
+            // 레이를 이 인스턴스의 로컬 공간으로 옮깁니다. 방향을 정규화하지 않으므로 로컬 공간에서의
+            // 거리가 월드 공간에서의 거리와 같습니다. 원래 레이는 그대로 두고 다음 인스턴스에 다시 사용합니다.
+            const XMMATRIX invWorld = XMLoadFloat4x4(&inst.InvWorld);
+            const XMVECTOR localOrigin = XMVector3TransformCoord(origin, invWorld);
+            const XMVECTOR localDirection = XMVector3TransformNormal(direction, invWorld);
+
+            const Mesh& mesh = mMeshes[inst.Mesh];
+
+            float u = 0.0f;
+            float v = 0.0f;
+            auto intersectLeaf = [&](const std::uint32_t* triangles, std::uint32_t triCount, float leafMaxDist,
+                std::uint32_t& triangle, float& leafDist)
+            {
+                return IntersectTriangles(mesh, localOrigin, localDirection, triangles, triCount, leafMaxDist,
+                    triangle, leafDist, u, v);
+            };
+
+            BoundingVolumeHierarchy::RayStats meshStats;
+            std::uint32_t triangle = 0;
+            float dist = 0.0f;
+
+            bool meshHit = false;
+            if (anyHit)
+                meshHit = mesh.Bvh.QueryRayAny(localOrigin, localDirection, maxDist, intersectLeaf, &meshStats);
+            else
+                meshHit = mesh.Bvh.QueryRayLeaves(localOrigin, localDirection, maxDist, intersectLeaf, triangle, dist, &meshStats);
+
+            totalStats.NodesVisited += meshStats.NodesVisited;
+            totalStats.PrimitiveTests += meshStats.PrimitiveTests;
+
+            if (meshHit)
+            {
+                maxDist = dist;
+                instance = instances[k];
+                t = dist;
+
+                hitTriangle = triangle;
+                hitU = u;
+                hitV = v;
+                found = true;
+
+                if (anyHit)
+                    break;
+            }
+        }
+
+        return found;
+    };
+
+    BoundingVolumeHierarchy::RayStats instanceStats;
+    std::uint32_t instance = 0;
+    float dist = 0.0f;
+
+    bool found = false;
+    if (anyHit)
+        found = mInstanceBvh.QueryRayAny(origin, direction, ray.MaxDistance, intersectInstances, &instanceStats);
+    else
+        found = mInstanceBvh.QueryRayLeaves(origin, direction, ray.MaxDistance, intersectInstances, instance, dist, &instanceStats);
+
+    if (found && !anyHit)
+    {
+        hit.Instance = instance;
+        hit.Triangle = hitTriangle;
+        hit.U = hitU;
+        hit.V = hitV;
+        hit.Distance = dist;
+    }
+
+    if (stats)
+    {
+        stats->NodesVisited = totalStats.NodesVisited + instanceStats.NodesVisited;
+        stats->PrimitiveTests = totalStats.PrimitiveTests;
+    }
+
+    if (instanceTests)
+        *instanceTests = tests;
+
+    return found;
+}
+
+PickHit TrianglePicker::PickOne(const PickRay& ray, BoundingVolumeHierarchy::RayStats* stats,
+    std::uint32_t* instanceTests) const
+{
+    PickHit hit;
+    TraceRay(ray, false, hit, stats, instanceTests);
+
+    return hit;
+}
+
+bool TrianglePicker::IsOccluded(const PickRay& ray, BoundingVolumeHierarchy::RayStats* stats,
+    std::uint32_t* instanceTests) const
+{
+    PickHit hit;
+    return TraceRay(ray, true, hit, stats, instanceTests);
+}
+
+void TrianglePicker::Pick(const PickRay* rays, std::uint32_t rayCount, PickHit* hits)
+{
+    PROFILE_FUNCTION();
+
+    UpdateHierarchy();
+
+    // 레이별 통계는 이 함수 안에서만 사용하므로 스크래치 메모리에 둡니다.
+    ScratchArena& scratch = JobSystem::Default().Scratch();
+    ScratchArena::Scope scratchScope(scratch);
+
+    auto rayStats = scratch.AllocateArray<BoundingVolumeHierarchy::RayStats>(rayCount);
+    auto instanceTests = scratch.AllocateArray<std::uint32_t>(rayCount);
+
+    JobSystem::Default().ParallelFor(0u, rayCount, [&](std::uint32_t i)
+    {
+        hits[i] = PickOne(rays[i], &rayStats[i], &instanceTests[i]);
+    });
+
+    mStats = PickStats();
+    mStats.Rays = rayCount;
+    for (std::uint32_t i = 0; i < rayCount; ++i)
+    {
+        mStats.Hits += hits[i].IsHit() ? 1 : 0;
+        mStats.InstanceTests += instanceTests[i];
+        mStats.NodesVisited += rayStats[i].NodesVisited;
+        mStats.TriangleTests += rayStats[i].PrimitiveTests;
+    }
+}
+
+void TrianglePicker::Occluded(const PickRay* rays, std::uint32_t rayCount, bool* occluded)
+{
+    PROFILE_FUNCTION();
+
+    UpdateHierarchy();
+
+    // 레이별 통계는 이 함수 안에서만 사용하므로 스크래치 메모리에 둡니다.
+    ScratchArena& scratch = JobSystem::Default().Scratch();
+    ScratchArena::Scope scratchScope(scratch);
+
+    auto rayStats = scratch.AllocateArray<BoundingVolumeHierarchy::RayStats>(rayCount);
+    auto instanceTests = scratch.AllocateArray<std::uint32_t>(rayCount);
+
+    JobSystem::Default().ParallelFor(0u, rayCount, [&](std::uint32_t i)
+    {
+        occluded[i] = IsOccluded(rays[i], &rayStats[i], &instanceTests[i]);
+    });
+
+    mStats = PickStats();
+    mStats.Rays = rayCount;
+    for (std::uint32_t i = 0; i < rayCount; ++i)
+    {
+        mStats.Hits += occluded[i] ? 1 : 0;
+        mStats.InstanceTests += instanceTests[i];
+        mStats.NodesVisited += rayStats[i].NodesVisited;
+        mStats.TriangleTests += rayStats[i].PrimitiveTests;
+    }
+}
+
+const TrianglePicker::PickStats& TrianglePicker::LastStats() const
+{
+    return mStats;
+}
+
+PickRay TrianglePicker::ComputeScreenRay(float sx, float sy, float clientWidth, float clientHeight,
+    CXMMATRIX invView, CXMMATRIX proj)
+{
+    XMFLOAT4X4 P;
+    XMStoreFloat4x4(&P, proj);
+
+    // 뷰 스페이스에서의 선택 레이를 계산합니다.
+    const float vx = (+2.0f * sx / clientWidth - 1.0f) / P(0, 0);
+    const float vy = (-2.0f * sy / clientHeight + 1.0f) / P(1, 1);
+
+    PickRay ray;
+    XMStoreFloat3(&ray.Origin, XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), invView));
+    XMStoreFloat3(&ray.Direction, XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(vx, vy, 1.0f, 0.0f), invView)));
+
+    return ray;
+}
@@ -0,0 +1,200 @@
+﻿//***************************************************************************************
+// TrianglePicker.h
+//
+// Ray picking against triangle meshes.  Each mesh gets a binned-SAH triangle BVH and
+// its triangles are kept as (v0, e1, e2) so a BVH leaf is tested four triangles at a
+// time with DirectXMath vectors (Moller-Trumbore).  Instances place meshes in the
+// world and are kept in a second, top-level BVH over their world bounds, so a ray
+// only descends into the meshes whose boxes it crosses.  Moving an instance refits
+// only its path to the root; the tree is rebuilt when refitting has made it too
+// much worse than a fresh build.  Every ray is moved into each
+// instance's local space on its own, without normalizing the direction, so hit
+// distances of all instances are in world units and the nearest one wins.
+//
+// Pick takes any number of rays (mouse picking, selection rectangles, camera
+// collision, ground snapping) and traces them in parallel.  Each hit reports the
+// instance, the triangle, its barycentrics and the distance along the ray.  Occluded
+// answers any-hit queries such as line of sight; it stops at the first triangle found.
+//***************************************************************************************
+
+#pragma once
+
+#include "BoundingVolumeHierarchy.h"
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+struct PickRay
+{
+    DirectX::XMFLOAT3 Origin = { 0.0f, 0.0f, 0.0f };
+
+    // 길이가 1이어야 합니다. 교차 거리는 이 방향의 길이를 단위로 합니다.
+    DirectX::XMFLOAT3 Direction = { 0.0f, 0.0f, 1.0f };
+
+    float MaxDistance = FLT_MAX;
+};
+
+struct PickHit
+{
+    static const std::uint32_t Invalid = 0xFFFFFFFF;
+
+    // 교차하지 않았으면 Instance가 Invalid입니다.
+    std::uint32_t Instance = Invalid;
+
+    // 메쉬의 인덱스 버퍼에서 3 * Triangle번째 인덱스부터가 교차한 삼각형입니다.
+    std::uint32_t Triangle = Invalid;
+
+    // 교차점 = (1 - U - V) * v0 + U * v1 + V * v2 입니다.
+    float U = 0.0f;
+    float V = 0.0f;
+
+    float Distance = 0.0f;
+
+    bool IsHit() const { return Instance != Invalid; }
+};
+
+class TrianglePicker
+{
+public:
+    // AddMesh와 AddInstance가 실패했을 때 반환하는 인덱스입니다.
+    static const std::uint32_t Invalid = 0xFFFFFFFF;
+
+    // 마지막 Pick의 통계입니다.
+    struct PickStats
+    {
+        std::uint32_t Rays = 0;
+        std::uint32_t Hits = 0;
+
+        // 레이가 바운딩 박스와 교차해서 메쉬 BVH를 순회한 인스턴스 수의 합입니다.
+        // NodesVisited는 인스턴스 BVH와 메쉬 BVH의 노드를 모두 셉니다.
+        std::uint32_t InstanceTests = 0;
+        std::uint32_t NodesVisited = 0;
+        std::uint32_t TriangleTests = 0;
+    };
+
+    // 마지막 UpdateHierarchy에서 인스턴스 BVH를 갱신한 방법입니다.
+    struct UpdateStats
+    {
+        std::uint32_t MovedInstances = 0;
+        std::uint32_t RefitNodes = 0;
+        bool Rebuilt = false;
+    };
+
+    void Clear();
+
+    // 메쉬를 등록하고 인덱스를 반환합니다. positions는 stride 바이트 간격으로 놓인 로컬 위치(XMFLOAT3)들이고
+    // 인덱스에는 baseVertex가 더해집니다. 데이터는 복사되므로 호출한 뒤에 해제해도 됩니다.
+    // baseVertex를 더한 인덱스가 [0, vertexCount) 밖에 있으면 메쉬를 등록하지 않고 Invalid를 반환합니다.
+    std::uint32_t AddMesh(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+        const std::uint32_t* indices, std::uint32_t indexCount, std::int32_t baseVertex = 0);
+    std::uint32_t AddMesh(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+        const std::uint16_t* indices, std::uint32_t indexCount, std::int32_t baseVertex = 0);
+
+    // 메쉬의 인스턴스를 추가하고 인덱스를 반환합니다. mesh가 유효하지 않으면 Invalid를 반환합니다.
+    std::uint32_t AddInstance(std::uint32_t mesh, DirectX::FXMMATRIX world);
+
+    // 움직인 인스턴스는 다음 UpdateHierarchy에서 인스턴스 BVH에 반영됩니다. 역행렬이 없는 행렬(크기가
+    // 0인 축이 있는 스케일 등)이면 레이를 로컬 공간으로 옮길 수 없으므로, 다시 역행렬이 있는 행렬이
+    // 설정될 때까지 인스턴스가 선택되지 않습니다.
+    void SetInstanceWorld(std::uint32_t instance, DirectX::FXMMATRIX world);
+
+    // 비활성화된 인스턴스는 선택되지 않습니다.
+    void SetInstanceEnabled(std::uint32_t instance, bool enabled);
+
+    std::uint32_t MeshCount() const;
+    std::uint32_t InstanceCount() const;
+
+    // 메쉬 BVH와 삼각형 데이터가 차지하는 바이트 수입니다.
+    size_t MemoryUsage() const;
+
+    // 인스턴스가 추가되었으면 인스턴스 BVH를 다시 만들고, 움직였으면 움직인 인스턴스의 경로만
+    // 다시 계산합니다. Pick과 Occluded가 호출하므로 PickOne이나 IsOccluded만 사용할 때 직접 호출합니다.
+    void UpdateHierarchy();
+
+    // 다시 계산한 인스턴스 BVH의 SAH 비용이 새로 만들었을 때의 ratio배를 넘으면 다시 만듭니다.
+    void SetRebuildRatio(float ratio);
+
+    const UpdateStats& LastUpdateStats() const;
+
+    // rays[i]와 가장 가까이 교차하는 삼각형을 hits[i]에 씁니다. 레이들은 병렬로 처리됩니다.
+    void Pick(const PickRay* rays, std::uint32_t rayCount, PickHit* hits);
+
+    // rays[i]가 MaxDistance 안에서 삼각형과 교차하면 occluded[i]가 true입니다. 레이들은 병렬로 처리됩니다.
+    void Occluded(const PickRay* rays, std::uint32_t rayCount, bool* occluded);
+
+    // 레이 하나를 처리합니다. 통계를 갱신하지 않으므로 여러 스레드에서 호출할 수 있습니다.
+    PickHit PickOne(const PickRay& ray, BoundingVolumeHierarchy::RayStats* stats = nullptr,
+        std::uint32_t* instanceTests = nullptr) const;
+    bool IsOccluded(const PickRay& ray, BoundingVolumeHierarchy::RayStats* stats = nullptr,
+        std::uint32_t* instanceTests = nullptr) const;
+
+    const PickStats& LastStats() const;
+
+    // 화면 좌표(sx, sy)를 지나는 월드 공간 레이입니다. invView는 카메라 뷰 행렬의 역행렬이고
+    // proj는 카메라의 투영 행렬입니다.
+    static PickRay ComputeScreenRay(float sx, float sy, float clientWidth, float clientHeight,
+        DirectX::CXMMATRIX invView, DirectX::CXMMATRIX proj);
+
+private:
+    // 삼각형의 v0와 두 변입니다.
+    struct Triangle
+    {
+        DirectX::XMFLOAT3 V0;
+        DirectX::XMFLOAT3 E1;
+        DirectX::XMFLOAT3 E2;
+    };
+
+    struct Mesh
+    {
+        std::vector<Triangle> Triangles;
+        BoundingVolumeHierarchy Bvh;
+        DirectX::BoundingBox Bounds;
+    };
+
+    struct Instance
+    {
+        std::uint32_t Mesh = 0;
+        bool Enabled = true;
+
+        // 월드 행렬의 역행렬이 없으면 false이고 InvWorld는 의미가 없습니다.
+        bool Invertible = true;
+
+        // 마지막 UpdateHierarchy 이후에 움직였으면 true입니다.
+        bool Moved = false;
+
+        DirectX::XMFLOAT4X4 InvWorld;
+        DirectX::BoundingBox WorldBounds;
+    };
+
+    template<typename Index>
+    std::uint32_t AddIndexedMesh(const void* positions, std::uint32_t stride, std::uint32_t vertexCount,
+        const Index* indices, std::uint32_t indexCount, std::int32_t baseVertex);
+
+    // 인스턴스 BVH를 순회해서 가장 가까운(anyHit이면 처음 찾은) 교차를 찾습니다.
+    bool TraceRay(const PickRay& ray, bool anyHit, PickHit& hit, BoundingVolumeHierarchy::RayStats* stats,
+        std::uint32_t* instanceTests) const;
+
+    // 리프의 삼각형들을 4개씩 레이와 테스트합니다.
+    static bool IntersectTriangles(const Mesh& mesh, DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction,
+        const std::uint32_t* triangles, std::uint32_t count, float maxDist,
+        std::uint32_t& triangle, float& t, float& u, float& v);
+
+private:
+    std::vector<Mesh> mMeshes;
+    std::vector<Instance> mInstances;
+
+    // 인스턴스의 월드 바운딩 박스에 대한 상위 BVH입니다.
+    BoundingVolumeHierarchy mInstanceBvh;
+
+    // 인스턴스가 추가되어서 다시 만들어야 하면 true입니다.
+    bool mInstanceBvhDirty = true;
+
+    std::vector<std::uint32_t> mMovedInstances;
+    float mRebuildRatio = 1.5f;
+
+    UpdateStats mUpdateStats;
+
+    PickStats mStats;
+};
@@ -3,8 +3,14 @@
 //***************************************************************************************
 
 #include "d3dApp.h"
+#include "Profiler.h"
 #include <windowsx.h>
 
+// 고해상도 대기 타이머는 Windows 10 1803부터 지원됩니다. 이전 SDK에는 정의가 없습니다.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 using Microsoft::WRL::ComPtr;
 using namespace std;
 using namespace DirectX;
@@ -26,12 +32,20 @@ D3DApp::D3DApp(HINSTANCE hInstance)
     // 반드시 한개의 D3DApp만 생성될 수 있습니다.
     assert(mApp == nullptr);
     mApp = this;
+
+    mFramePacer = FramePacer(&GameTimer::Now, [this](std::int64_t nanoseconds)
+        {
+            WaitFrameTimer(nanoseconds);
+        });
 }
 
 D3DApp::~D3DApp()
 {
     if (md3dDevice != nullptr)
         FlushCommandQueue();
+
+    if (mFrameWaitTimer != nullptr)
+        CloseHandle(mFrameWaitTimer);
 }
 
 D3DApp* D3DApp::GetApp()
@@ -66,6 +80,7 @@ void D3DApp::Set4xMsaaState(bool value)
         m4xMsaaState = value;
 
         // 멀티샘플을 위해서 스왑 체인과 버퍼를 다시 생성합니다.
+        WaitForRenderThread();
         CreateSwapChain();
         OnResize();
     }
@@ -76,32 +91,84 @@ int D3DApp::Run()
     MSG msg = {0};
 
     mTimer.Reset();
+    Profiler::SetThreadName("Main");
+
+    // 고해상도 타이머를 만들 수 없으면 일반 대기 타이머를 사용합니다. 일반 타이머는 시스템 타이머
+    // 해상도만큼 늦게 깨어날 수 있지만 FramePacer가 늦잠을 측정해서 그만큼 스핀으로 보충합니다.
+    mFrameWaitTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (mFrameWaitTimer == nullptr)
+        mFrameWaitTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+
+    mFramePacer.SetTargetFrameRate(mFrameLimitEnabled ? mTargetFrameRate : 0.0);
+    mFramePacer.Reset();
 
-    while (msg.message != WM_QUIT)
+    try
     {
-        // 처리해야할 윈도우 메세지들이 있는지 확인합니다.
-        if (PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
+        while (msg.message != WM_QUIT)
         {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
-        // 처리해야할 메세지가 없는 경우, 에니메이션과 게임을 처리합니다.
-        else
-        {
-            mTimer.Tick();
-
-            if (!mAppPaused)
+            // 처리해야할 윈도우 메세지들이 있는지 확인합니다.
+            if (PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
             {
-                CalculateFrameStats();
-                Update(mTimer);
-                Draw(mTimer);
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
             }
+            // 처리해야할 메세지가 없는 경우, 에니메이션과 게임을 처리합니다.
             else
             {
-                Sleep(100);
+                ProcessDeferredRequests();
+
+                // 파이프라인 모드에서는 Update가 채울 프레임 자원을 렌더 스레드가 돌려줄 때까지 기다립니다.
+                // 얻지 못했으면 메세지를 처리하러 돌아갑니다.
+                if (mFramePipeline != nullptr && !mAppPaused && !BeginUpdateFrame())
+                    continue;
+
+                mTimer.Tick();
+
+                if (!mAppPaused)
+                {
+                    PROFILE_SCOPE("Frame");
+
+                    CalculateFrameStats();
+                    {
+                        PROFILE_SCOPE("Update");
+                        Update(mTimer);
+                    }
+
+                    if (mFramePipeline != nullptr)
+                    {
+                        mFramePipeline->EndProduce();
+
+                        // 렌더 스레드를 사용하지 않으면 같은 스레드에서 바로 그립니다.
+                        if (!mFramePipeline->HasConsumerThread())
+                            DrawPipelinedFrame();
+                    }
+                    else
+                    {
+                        PROFILE_SCOPE("Draw");
+                        Draw(mTimer);
+                    }
+                    {
+                        PROFILE_SCOPE("Wait");
+                        mFramePacer.WaitForNextFrame();
+                    }
+                }
+                else
+                {
+                    // 정지된 동안에는 메세지가 올 때까지 잠들고, 다시 시작할 때 다음 프레임 마감 시각을 새로 잡습니다.
+                    WaitMessage();
+                    mFramePacer.Reset();
+                }
             }
         }
     }
+    catch (...)
+    {
+        // 앱 객체가 파괴되기 전에 렌더 스레드를 끝냅니다.
+        SetRenderThreadEnabled(false);
+        throw;
+    }
+
+    SetRenderThreadEnabled(false);
 
     return (int)msg.wParam;
 }
@@ -159,7 +226,7 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 mAppPaused = false;
                 mMinimized = false;
                 mMaximized = true;
-                OnResize();
+                RequestResize();
             }
             else if (wParam == SIZE_RESTORED)
             {
@@ -168,14 +235,14 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 {
                     mAppPaused = false;
                     mMinimized = false;
-                    OnResize();
+                    RequestResize();
                 }
                 // 최대화 상태로부터 다시 복원되는 겁니까?
                 else if (mMaximized)
                 {
                     mAppPaused = false;
                     mMaximized = false;
-                    OnResize();
+                    RequestResize();
                 }
                 else if (mResizing)
                 {
@@ -185,7 +252,7 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 }
                 else // SetWindowPos 또는 mSwapChain->SetFullscreenState에 의해서 API가 호출됬습니다.
                 {
-                    OnResize();
+                    RequestResize();
                 }
             }
         }
@@ -204,7 +271,7 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         mAppPaused = false;
         mResizing  = false;
         mTimer.Start();
-        OnResize();
+        RequestResize();
         return 0;
 
         // 윈도우가 파괴될 때 WM_DESTORY가 보내집니다.
@@ -247,7 +314,46 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         }
         else if ((int)wParam == VK_F2)
         {
-            Set4xMsaaState(!m4xMsaaState);
+            // 스왑 체인을 다시 만들려면 렌더 스레드를 기다려야 하므로 Run 루프에서 바꿉니다.
+            m4xMsaaTogglePending = !m4xMsaaTogglePending;
+        }
+        else if ((int)wParam == VK_F3)
+        {
+            // 최근 프레임 시간들과 통계를 작업 디렉토리에 저장합니다.
+            std::ofstream csv("FrameTimes.csv");
+            mTimer.WriteFrameTimesCsv(csv);
+
+            std::ofstream json("FrameStats.json");
+            mTimer.WriteFrameStatsJson(json);
+        }
+        else if ((int)wParam == VK_F4)
+        {
+            // 프로파일러 캡쳐를 시작하거나 끝냅니다. 끝낼 때 chrome://tracing에서 열 수 있는
+            // 트레이스를 작업 디렉토리에 저장합니다.
+            if (!Profiler::IsCapturing())
+            {
+                Profiler::BeginCapture();
+            }
+            else
+            {
+                Profiler::EndCapture();
+
+                std::ofstream trace("Trace.json");
+                Profiler::WriteChromeTrace(trace);
+            }
+        }
+        else if ((int)wParam == VK_F5)
+        {
+            // 프레임 제한을 끄면 벤치마크처럼 최대한 빨리 그립니다.
+            mFrameLimitEnabled = !mFrameLimitEnabled;
+            mFramePacer.SetTargetFrameRate(mFrameLimitEnabled ? mTargetFrameRate : 0.0);
+            mFramePacer.ResetStats();
+        }
+        else if ((int)wParam == VK_F6)
+        {
+            // 파이프라인 모드를 사용하는 앱에서 렌더 스레드를 켜거나 끕니다. 끌 때는 렌더 스레드가
+            // 끝나기를 기다려야 하므로 Run 루프에서 바꿉니다.
+            mRenderThreadTogglePending = !mRenderThreadTogglePending;
         }
         return 0;
     }
@@ -280,7 +386,8 @@ void D3DApp::OnResize()
     assert(mSwapChain);
     assert(mDirectCmdListAlloc);
 
-    // 어떤 리소스가 변경되기 전에 플러시합니다.
+    // 어떤 리소스가 변경되기 전에 렌더 스레드가 제출을 끝내도록 하고 플러시합니다.
+    WaitForRenderThread();
     FlushCommandQueue();
 
     ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
@@ -322,7 +429,9 @@ void D3DApp::OnResize()
     //  1. SRV 포멧: DXGI_FORMAT_R24_UNORM_X8_TYPELESS
     //  2. DSV 포멧: DXGI_FORMAT_D24_UNORM_S8_UINT
     // 그러므로 뎁스/스텐실을 생성할 때 타입 없는 포멧을 사용한다.
-    depthStencilDesc.Format = DXGI_FORMAT_R24G8_TYPELESS;
+    // 리버스 Z를 사용하는 앱은 32비트 부동소수점 뎁스를 사용한다.
+    depthStencilDesc.Format = mDepthStencilFormat == DXGI_FORMAT_D32_FLOAT_S8X24_UINT ?
+        DXGI_FORMAT_R32G8X24_TYPELESS : DXGI_FORMAT_R24G8_TYPELESS;
 
     depthStencilDesc.SampleDesc.Count = m4xMsaaState ? 4 : 1;
     depthStencilDesc.SampleDesc.Quality = m4xMsaaState ? (m4xMsaaQuality - 1) : 0;
@@ -331,7 +440,7 @@ void D3DApp::OnResize()
 
     D3D12_CLEAR_VALUE optClear;
     optClear.Format = mDepthStencilFormat;
-    optClear.DepthStencil.Depth = 1.0f;
+    optClear.DepthStencil.Depth = mDepthClearValue;
     optClear.DepthStencil.Stencil = 0;
     ThrowIfFailed(md3dDevice->CreateCommittedResource(
         &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
@@ -588,9 +697,27 @@ void D3DApp::CalculateFrameStats()
         wstring fpsStr = to_wstring(fps);
         wstring mpsfStr = to_wstring(mspf);
 
+        // 평균은 끊김을 감추므로 최근 프레임 시간의 백분위수도 보여줍니다.
+        GameTimer::FrameStats stats = mTimer.ComputeFrameStats();
+
         wstring windowText = mMainWndCaption +
             L"    fps: " + fpsStr +
-            L"   mfps: " + mpsfStr;
+            L"   mfps: " + mpsfStr +
+            L"   p95: " + to_wstring(stats.P95Ms) +
+            L"   p99: " + to_wstring(stats.P99Ms);
+
+        if (mFramePipeline != nullptr)
+            windowText += mFramePipeline->HasConsumerThread() ? L"   render thread: on" : L"   render thread: off";
+
+        // 프레임 제한을 사용하면 프레임이 마감 시각보다 늦게 시작한 시간(지터)도 보여줍니다.
+        if (mFramePacer.TargetFrameTime() > 0)
+        {
+            FramePacer::PacingStats pacing = mFramePacer.Stats();
+            windowText +=
+                L"   jitter: " + to_wstring(pacing.AvgJitterMs) +
+                L"   max jitter: " + to_wstring(pacing.MaxJitterMs);
+            mFramePacer.ResetStats();
+        }
 
         SetWindowText(mhMainWnd, windowText.c_str());
 
@@ -600,6 +727,137 @@ void D3DApp::CalculateFrameStats()
     }
 }
 
+void D3DApp::WaitFrameTimer(std::int64_t nanoseconds)
+{
+    // 음수는 상대 시간이고 단위는 100나노초입니다.
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -std::max<std::int64_t>(nanoseconds / 100, 1);
+
+    if (mFrameWaitTimer != nullptr && SetWaitableTimer(mFrameWaitTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+        WaitForSingleObject(mFrameWaitTimer, INFINITE);
+    else
+        Sleep((DWORD)(nanoseconds / 1000000));
+}
+
+void D3DApp::EnableFramePipeline(UINT frameResourceCount)
+{
+    assert(mFramePipeline == nullptr || !mFramePipeline->HasConsumerThread());
+
+    mFramePipeline = std::make_unique<FramePipeline>(frameResourceCount);
+}
+
+void D3DApp::SetRenderThreadEnabled(bool enabled)
+{
+    if (mFramePipeline == nullptr || enabled == mFramePipeline->HasConsumerThread())
+        return;
+
+    if (enabled)
+    {
+        mFramePipeline->StartConsumerThread("Render", [this](std::uint32_t slot)
+            {
+                DrawFrameResource(slot);
+            });
+    }
+    else
+    {
+        // 렌더 스레드는 남은 프레임을 모두 그린 다음에 끝납니다. 그 사이에 Present가 보낸 메세지를 처리합니다.
+        mFramePipeline->StopConsumerThread(&D3DApp::PumpSentMessages);
+    }
+}
+
+UINT D3DApp::UpdateFrameIndex() const
+{
+    return mUpdateFrameIndex;
+}
+
+UINT D3DApp::DrawFrameIndex() const
+{
+    return mDrawFrameIndex;
+}
+
+void D3DApp::WaitForRenderThread()
+{
+    if (mFramePipeline == nullptr)
+        return;
+
+    // 렌더 스레드의 Present가 이 스레드로 메세지를 보내고 기다리는 중일 수 있습니다.
+    while (!mFramePipeline->WaitIdle(std::chrono::milliseconds(5)))
+        PumpSentMessages();
+}
+
+void D3DApp::PumpSentMessages()
+{
+    // 다른 스레드가 SendMessage로 보낸 메세지만 처리하고 메세지 큐의 메세지는 꺼내지 않습니다.
+    MSG msg;
+    PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+}
+
+void D3DApp::RequestResize()
+{
+    if (mFramePipeline != nullptr && mFramePipeline->HasConsumerThread())
+        mResizePending = true;
+    else
+        OnResize();
+}
+
+void D3DApp::ProcessDeferredRequests()
+{
+    if (mRenderThreadTogglePending)
+    {
+        mRenderThreadTogglePending = false;
+        SetRenderThreadEnabled(mFramePipeline != nullptr && !mFramePipeline->HasConsumerThread());
+    }
+
+    if (m4xMsaaTogglePending)
+    {
+        // Set4xMsaaState가 리사이즈도 합니다.
+        m4xMsaaTogglePending = false;
+        mResizePending = false;
+        Set4xMsaaState(!m4xMsaaState);
+    }
+
+    if (mResizePending)
+    {
+        mResizePending = false;
+        OnResize();
+    }
+}
+
+bool D3DApp::BeginUpdateFrame()
+{
+    // 렌더 스레드의 Present가 이 스레드로 메세지를 보내고 기다릴 수 있으므로 오래 막혀 있지 않습니다.
+    std::uint32_t slot = 0;
+    if (!mFramePipeline->BeginProduce(slot, std::chrono::milliseconds(10)))
+    {
+        // 렌더 스레드에서 발생한 예외는 파이프라인을 닫습니다. 메인 스레드에서 다시 던집니다.
+        mFramePipeline->RethrowConsumerException();
+        return false;
+    }
+
+    mUpdateFrameIndex = slot;
+    return true;
+}
+
+bool D3DApp::DrawPipelinedFrame()
+{
+    std::uint32_t slot = 0;
+    if (!mFramePipeline->BeginConsume(slot))
+        return false;
+
+    DrawFrameResource(slot);
+
+    mFramePipeline->EndConsume();
+    return true;
+}
+
+void D3DApp::DrawFrameResource(std::uint32_t slot)
+{
+    PROFILE_SCOPE("Draw");
+
+    mDrawFrameIndex = slot;
+    Draw(mTimer);
+}
+
 void D3DApp::LogAdapters()
 {
     UINT i = 0;
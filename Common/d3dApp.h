@@ -10,7 +10,10 @@
 #endif
 
 #include "d3dUtil.h"
+#include "FramePacer.h"
+#include "FramePipeline.h"
 #include "GameTimer.h"
+#include "Profiler.h"
 
 // 필요한 d3d12 라이브러리 링크
 #pragma comment(lib, "d3dcompiler.lib")
@@ -64,11 +67,37 @@ protected:
     D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView() const;
 
     void CalculateFrameStats();
+    void WaitFrameTimer(std::int64_t nanoseconds);
+
+    // 파이프라인 모드를 사용하는 앱이 Initialize에서 호출합니다. frameResourceCount는 gNumFrameResources입니다.
+    // 이후 Update는 UpdateFrameIndex()의 프레임 자원만 채우고 Draw는 DrawFrameIndex()의 프레임 자원만
+    // 제출해야 합니다. 렌더 스레드를 켜면 Draw가 렌더 스레드에서 호출되므로 Draw는 gt를 읽지 않고,
+    // Update에서 바뀌는 앱의 상태 대신 프레임 자원에 기록된 값만 사용해야 합니다.
+    void EnableFramePipeline(UINT frameResourceCount);
+    void SetRenderThreadEnabled(bool enabled);
+
+    UINT UpdateFrameIndex() const;
+    UINT DrawFrameIndex() const;
+
+    // 렌더 스레드가 그리고 있는 프레임이 모두 끝날 때까지 기다립니다. 스왑 체인 같은 공유 자원을 바꾸기 전에 호출합니다.
+    // 기다리는 동안 렌더 스레드가 보낸 메세지를 처리합니다.
+    void WaitForRenderThread();
 
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
     void LogOutputDisplayModes(IDXGIOutput* output, DXGI_FORMAT format);
 
+private:
+    bool BeginUpdateFrame();
+    bool DrawPipelinedFrame();
+    void DrawFrameResource(std::uint32_t slot);
+
+    // 렌더 스레드가 켜져 있으면 리사이즈처럼 렌더 스레드를 기다려야 하는 요청을 메세지 처리 중에
+    // 바로 하지 않고 Run 루프에서 처리합니다.
+    void RequestResize();
+    void ProcessDeferredRequests();
+    static void PumpSentMessages();
+
 protected:
     static D3DApp* mApp;
 
@@ -88,6 +117,21 @@ protected:
     // 게임 시간과 델타 시간을 측정하기 위해 사용합니다 (§4.4).
     GameTimer mTimer;
 
+    // 프레임 시작 간격을 목표 프레임 시간에 맞춥니다. 기다리는 동안 코어를 점유하지 않습니다.
+    // 챕터들은 수직 동기화 없이 Present하므로 기본으로는 제한하지 않고 F5로 켭니다.
+    FramePacer mFramePacer;
+    HANDLE mFrameWaitTimer = nullptr;
+    bool mFrameLimitEnabled = false;
+
+    // 메인 스레드가 다음 프레임을 Update하는 동안 렌더 스레드가 이전 프레임을 Draw합니다.
+    std::unique_ptr<FramePipeline> mFramePipeline;
+    UINT mUpdateFrameIndex = 0;
+    UINT mDrawFrameIndex = 0;
+
+    bool mResizePending = false;
+    bool m4xMsaaTogglePending = false;
+    bool mRenderThreadTogglePending = false;
+
     Microsoft::WRL::ComPtr<IDXGIFactory4>  mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
     Microsoft::WRL::ComPtr<ID3D12Device>   md3dDevice;
@@ -119,6 +163,8 @@ protected:
     D3D_DRIVER_TYPE md3dDriverType = D3D_DRIVER_TYPE_HARDWARE;
     DXGI_FORMAT     mBackBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
     DXGI_FORMAT     mDepthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    float           mDepthClearValue = 1.0f;
+    double          mTargetFrameRate = 60.0;
     int             mClientWidth = 800;
     int             mClientHeight = 600;
 };
\ No newline at end of file
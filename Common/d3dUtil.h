@@ -212,6 +212,9 @@ struct Material
     // 디퓨즈 텍스쳐에 해당하는 SRV 힙의 인덱스입니다.
     int DiffuseSrvHeapIndex = -1;
 
+    // 디퓨즈 텍스쳐가 텍스쳐 배열에 묶여 있을 때 배열의 슬라이스 인덱스입니다.
+    int DiffuseSrvArraySlice = 0;
+
     // 노말 텍스쳐에 해당하는 SRV 힙의 인덱스입니다.
     int NormalSrvHeapIndex = -1;
 
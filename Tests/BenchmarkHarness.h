@@ -0,0 +1,64 @@
+﻿//***************************************************************************************
+// BenchmarkHarness.h
+//
+// Small helpers shared by the headless benchmarks.  A benchmark runs each case a few
+// times and reports the median wall time, which is less noisy than the mean on a busy
+// machine.  With --quick only the smallest problem size runs once or twice, so CTest
+// can check that the benchmark still builds and its results still agree.
+//***************************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    bool Quick = false;
+    int Repeats = 15;
+
+    BenchmarkOptions(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--quick") == 0)
+                Quick = true;
+        }
+
+        if (Quick)
+            Repeats = 2;
+    }
+};
+
+// fn을 repeats번 실행하고 실행 시간의 중앙값(밀리초)을 반환합니다.
+template<typename Function>
+double MeasureMedianMs(int repeats, Function&& fn)
+{
+    std::vector<double> times;
+    times.reserve(repeats);
+
+    for (int i = 0; i < repeats; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        fn(i);
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// 결과가 기대와 다르면 메시지를 출력하고 실패로 기록합니다. 벤치마크는 실패가 있으면 1을 반환합니다.
+inline bool BenchmarkCheck(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        std::printf("MISMATCH: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
@@ -0,0 +1,331 @@
+﻿//***************************************************************************************
+// BlockCompressorTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "BlockCompressor.h"
+#include <vector>
+
+namespace
+{
+    // 블록 하나(4x4)짜리 압축 이미지를 만듭니다.
+    CompressedImage MakeBlock(DXGI_FORMAT format, const std::vector<std::uint8_t>& block)
+    {
+        CompressedImage compressed;
+        compressed.Format = format;
+        compressed.Width = 4;
+        compressed.Height = 4;
+        compressed.RowPitch = (std::uint32_t)block.size();
+        compressed.Blocks = block;
+        return compressed;
+    }
+
+    bool PixelIs(const RgbaImage& image, std::uint32_t i, int r, int g, int b, int a)
+    {
+        const std::uint8_t* p = image.GetPixel(i & 3, i >> 2);
+        return p[0] == r && p[1] == g && p[2] == b && p[3] == a;
+    }
+
+    // 대각선 방향으로 변하는 색입니다. 블록 안의 색이 한 직선 위에 있으므로 끝점 두 개로 잘 맞습니다.
+    RgbaImage MakeRamp(std::uint32_t width, std::uint32_t height, bool alpha)
+    {
+        RgbaImage image;
+        image.Resize(width, height);
+        for (std::uint32_t y = 0; y < height; ++y)
+        {
+            for (std::uint32_t x = 0; x < width; ++x)
+            {
+                const std::uint8_t v = (std::uint8_t)((x + y) * 255 / (width + height - 2));
+                std::uint8_t* p = image.GetPixel(x, y);
+                p[0] = v;
+                p[1] = (std::uint8_t)(255 - v);
+                p[2] = (std::uint8_t)(v / 2 + 64);
+                p[3] = alpha ? (std::uint8_t)(255 - x * 255 / (width - 1)) : 255;
+            }
+        }
+        return image;
+    }
+
+    // 빨강은 가로로, 초록은 세로로 변합니다. 블록 안의 색이 평면을 이루므로 오차가 더 큽니다.
+    RgbaImage MakePlane(std::uint32_t width, std::uint32_t height, bool alpha)
+    {
+        RgbaImage image;
+        image.Resize(width, height);
+        for (std::uint32_t y = 0; y < height; ++y)
+        {
+            for (std::uint32_t x = 0; x < width; ++x)
+            {
+                std::uint8_t* p = image.GetPixel(x, y);
+                p[0] = (std::uint8_t)(x * 255 / (width - 1));
+                p[1] = (std::uint8_t)(y * 255 / (height - 1));
+                p[2] = (std::uint8_t)((x + y) * 255 / (width + height - 2));
+                p[3] = alpha ? (std::uint8_t)(255 - p[0]) : 255;
+            }
+        }
+        return image;
+    }
+
+    const CompressionQuality gQualities[3] =
+    {
+        CompressionQuality::Fast, CompressionQuality::Normal, CompressionQuality::High
+    };
+}
+
+TEST_CASE(DecodesSolidBC1Block)
+{
+    // c0 = 빨강(565 0xF800), c1 = 검정, 모든 인덱스 0입니다.
+    const CompressedImage compressed = MakeBlock(DXGI_FORMAT_BC1_UNORM,
+        { 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 });
+
+    RgbaImage image;
+    REQUIRE(BlockCompressor::Decompress(compressed, image));
+    REQUIRE(image.Width == 4 && image.Height == 4);
+    for (std::uint32_t i = 0; i < 16; ++i)
+        CHECK(PixelIs(image, i, 255, 0, 0, 255));
+}
+
+TEST_CASE(DecodesFourColorBC1Block)
+{
+    // c0 = 흰색 > c1 = 파랑이므로 4색 모드입니다. 행마다 인덱스 0, 1, 2, 3을 씁니다.
+    const CompressedImage compressed = MakeBlock(DXGI_FORMAT_BC1_UNORM,
+        { 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x55, 0xAA, 0xFF });
+
+    RgbaImage image;
+    REQUIRE(BlockCompressor::Decompress(compressed, image));
+    for (std::uint32_t i = 0; i < 4; ++i)
+    {
+        CHECK(PixelIs(image, i, 255, 255, 255, 255));
+        CHECK(PixelIs(image, 4 + i, 0, 0, 255, 255));
+        CHECK(PixelIs(image, 8 + i, 170, 170, 255, 255));
+        CHECK(PixelIs(image, 12 + i, 85, 85, 255, 255));
+    }
+}
+
+TEST_CASE(DecodesThreeColorBC1Block)
+{
+    // c0 = 파랑 <= c1 = 흰색이면 3색 모드이고 인덱스 3은 투명한 검정입니다.
+    const CompressedImage compressed = MakeBlock(DXGI_FORMAT_BC1_UNORM_SRGB,
+        { 0x1F, 0x00, 0xFF, 0xFF, 0x00, 0x55, 0xAA, 0xFF });
+
+    RgbaImage image;
+    REQUIRE(BlockCompressor::Decompress(compressed, image));
+    for (std::uint32_t i = 0; i < 4; ++i)
+    {
+        CHECK(PixelIs(image, i, 0, 0, 255, 255));
+        CHECK(PixelIs(image, 4 + i, 255, 255, 255, 255));
+        CHECK(PixelIs(image, 8 + i, 127, 127, 255, 255));
+        CHECK(PixelIs(image, 12 + i, 0, 0, 0, 0));
+    }
+}
+
+TEST_CASE(DecodesBC3AlphaBlock)
+{
+    // 알파 끝점 200 > 100이므로 8단계이고 모든 인덱스가 2(= (6 * 200 + 100) / 7)입니다.
+    // 색 블록은 초록 하나입니다.
+    const CompressedImage compressed = MakeBlock(DXGI_FORMAT_BC3_UNORM,
+        { 200, 100, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49,
+          0xE0, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 });
+
+    RgbaImage image;
+    REQUIRE(BlockCompressor::Decompress(compressed, image));
+    for (std::uint32_t i = 0; i < 16; ++i)
+        CHECK(PixelIs(image, i, 0, 255, 0, 186));
+}
+
+TEST_CASE(DecodesBC7Mode6Block)
+{
+    // 모드 6: 끝점 (0, 0, 0, 127) p = 0과 (127, 127, 127, 127) p = 1, 텍셀 i의 인덱스는 i입니다.
+    const CompressedImage compressed = MakeBlock(DXGI_FORMAT_BC7_UNORM,
+        { 0x40, 0xC0, 0x1F, 0xF0, 0x07, 0xFC, 0xFF, 0x7F,
+          0x11, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE });
+
+    // 0과 255 사이를 BC7의 4비트 가중치로 보간한 값입니다.
+    const int ramp[16] = { 0, 16, 36, 52, 68, 84, 104, 120, 135, 151, 171, 187, 203, 219, 239, 255 };
+
+    RgbaImage image;
+    REQUIRE(BlockCompressor::Decompress(compressed, image));
+    for (std::uint32_t i = 0; i < 16; ++i)
+    {
+        // 알파는 254와 255 사이를 보간합니다.
+        const int alpha = i < 8 ? 254 : 255;
+        CHECK(PixelIs(image, i, ramp[i], ramp[i], ramp[i], alpha));
+    }
+}
+
+TEST_CASE(DecodesBC7Mode5Block)
+{
+    // 모드 5: 색 끝점 빨강과 파랑을 열마다, 알파 끝점 0과 255를 행마다 2비트 인덱스로 보간합니다.
+    const CompressedImage compressed = MakeBlock(DXGI_FORMAT_BC7_UNORM,
+        { 0x20, 0x7F, 0x00, 0x00, 0x00, 0xF8, 0x03, 0xFC,
+          0xCB, 0xC9, 0xC9, 0xC9, 0x01, 0x55, 0xAA, 0xFF });
+
+    const int ramp[4] = { 0, 84, 171, 255 };
+
+    RgbaImage image;
+    REQUIRE(BlockCompressor::Decompress(compressed, image));
+    for (std::uint32_t i = 0; i < 16; ++i)
+        CHECK(PixelIs(image, i, ramp[3 - (i & 3)], 0, ramp[i & 3], ramp[i >> 2]));
+}
+
+TEST_CASE(UnknownBlocksAreRejected)
+{
+    // 인코더가 쓰지 않는 BC7 모드와 블록 압축이 아닌 포맷은 풀지 않습니다.
+    RgbaImage image;
+    CHECK(!BlockCompressor::Decompress(MakeBlock(DXGI_FORMAT_BC7_UNORM, std::vector<std::uint8_t>(16, 0x01)), image));
+    CHECK(!BlockCompressor::Decompress(MakeBlock(DXGI_FORMAT_R8G8B8A8_UNORM, std::vector<std::uint8_t>(64, 0)), image));
+}
+
+TEST_CASE(SolidColorsRoundTripExactly)
+{
+    // 565로도, p비트가 1인 BC7 끝점으로도 정확히 표현되는 색은 오차 없이 돌아와야 합니다.
+    RgbaImage image;
+    image.Resize(8, 8);
+    for (std::uint32_t i = 0; i < 64; ++i)
+    {
+        std::uint8_t* p = &image.Pixels[i * 4];
+        p[0] = 255;
+        p[1] = 65;
+        p[2] = 33;
+        p[3] = 255;
+    }
+
+    for (BlockFormat format : { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7 })
+    {
+        for (CompressionQuality quality : gQualities)
+        {
+            BlockCompressor compressor(format, quality);
+            CompressedImage compressed;
+            compressor.Compress(image, compressed);
+
+            RgbaImage decoded;
+            REQUIRE(BlockCompressor::Decompress(compressed, decoded));
+            CHECK(decoded.Pixels == image.Pixels);
+        }
+    }
+}
+
+TEST_CASE(CompressedLayoutMatchesTheFormat)
+{
+    struct Expected
+    {
+        BlockFormat Format;
+        bool Srgb;
+        DXGI_FORMAT DxgiFormat;
+        std::uint32_t BlockBytes;
+    };
+
+    const Expected expected[] =
+    {
+        { BlockFormat::BC1, false, DXGI_FORMAT_BC1_UNORM, 8 },
+        { BlockFormat::BC1, true, DXGI_FORMAT_BC1_UNORM_SRGB, 8 },
+        { BlockFormat::BC3, false, DXGI_FORMAT_BC3_UNORM, 16 },
+        { BlockFormat::BC5, false, DXGI_FORMAT_BC5_UNORM, 16 },
+        { BlockFormat::BC7, true, DXGI_FORMAT_BC7_UNORM_SRGB, 16 },
+    };
+
+    // 4의 배수가 아닌 크기는 블록 수를 올림합니다.
+    const RgbaImage image = MakePlane(30, 18, false);
+    for (const Expected& e : expected)
+    {
+        BlockCompressor compressor(e.Format, CompressionQuality::Fast, e.Srgb);
+        CHECK(compressor.GetDxgiFormat() == e.DxgiFormat);
+        CHECK(BlockCompressor::GetBlockBytes(e.DxgiFormat) == e.BlockBytes);
+
+        CompressedImage compressed;
+        compressor.Compress(image, compressed);
+        CHECK(compressed.Format == e.DxgiFormat);
+        CHECK(compressed.Width == 30 && compressed.Height == 18);
+        CHECK(compressed.RowPitch == 8 * e.BlockBytes);
+        CHECK(compressed.Blocks.size() == 5u * compressed.RowPitch);
+    }
+}
+
+TEST_CASE(GradientsRoundTripAboveMinimumPsnr)
+{
+    struct MinimumPsnr
+    {
+        BlockFormat Format;
+        double Ramp[3];  // Fast, Normal, High
+        double Plane;
+    };
+
+    // 블록 안의 색이 직선을 이루는 경사는 끝점 두 개로 잘 맞고, 평면을 이루는 경사는 더 나쁩니다.
+    const MinimumPsnr minimums[] =
+    {
+        { BlockFormat::BC1, { 43.0, 43.0, 43.0 }, 30.0 },
+        { BlockFormat::BC3, { 43.0, 43.0, 43.0 }, 30.0 },
+        { BlockFormat::BC5, { 48.0, 48.0, 49.0 }, 44.0 },
+        { BlockFormat::BC7, { 46.0, 47.0, 47.0 }, 30.0 },
+    };
+
+    for (const MinimumPsnr& minimum : minimums)
+    {
+        const bool alpha = minimum.Format == BlockFormat::BC3 || minimum.Format == BlockFormat::BC7;
+        const RgbaImage ramp = MakeRamp(64, 64, alpha);
+        const RgbaImage plane = MakePlane(30, 18, alpha);
+
+        for (int q = 0; q < 3; ++q)
+        {
+            BlockCompressor compressor(minimum.Format, gQualities[q]);
+
+            CompressedImage compressed;
+            compressor.Compress(ramp, compressed);
+            CHECK(compressor.ComputePsnr(ramp, compressed) >= minimum.Ramp[q]);
+
+            compressor.Compress(plane, compressed);
+            CHECK(compressor.ComputePsnr(plane, compressed) >= minimum.Plane);
+        }
+    }
+}
+
+TEST_CASE(BC1KeepsTheAlphaTestResult)
+{
+    // 알파 테스트를 통과하지 못하는 픽셀은 3색 모드의 투명한 검정이 되어야 합니다.
+    RgbaImage image = MakeRamp(16, 16, false);
+    for (std::uint32_t y = 0; y < 16; ++y)
+        for (std::uint32_t x = 0; x < 16; ++x)
+            image.GetPixel(x, y)[3] = ((x / 3 + y / 2) % 2) ? 255 : 0;
+
+    for (CompressionQuality quality : gQualities)
+    {
+        CompressedImage compressed;
+        BlockCompressor(BlockFormat::BC1, quality).Compress(image, compressed);
+
+        RgbaImage decoded;
+        REQUIRE(BlockCompressor::Decompress(compressed, decoded));
+
+        std::uint32_t wrong = 0;
+        for (size_t i = 3; i < image.Pixels.size(); i += 4)
+            wrong += decoded.Pixels[i] != image.Pixels[i] ? 1 : 0;
+        CHECK(wrong == 0);
+    }
+}
+
+TEST_CASE(BC7UsesMode5WhenAlphaDoesNotFollowTheColor)
+{
+    // 색은 가로로, 알파는 세로로 변하는 컷아웃 같은 블록입니다.
+    RgbaImage image;
+    image.Resize(4, 4);
+    for (std::uint32_t i = 0; i < 16; ++i)
+    {
+        std::uint8_t* p = image.GetPixel(i & 3, i >> 2);
+        p[0] = (std::uint8_t)(60 * (i & 3));
+        p[1] = (std::uint8_t)(200 - 60 * (i & 3));
+        p[2] = 40;
+        p[3] = (i >> 2) < 2 ? 0 : 255;
+    }
+
+    // 빠른 설정은 바운딩 박스를 안쪽으로 당긴 끝점을 다듬지 않으므로 양 끝 열의 오차가 남습니다.
+    const double minimumPsnr[3] = { 30.0, 45.0, 45.0 };
+
+    for (int q = 0; q < 3; ++q)
+    {
+        BlockCompressor compressor(BlockFormat::BC7, gQualities[q]);
+        CompressedImage compressed;
+        compressor.Compress(image, compressed);
+
+        REQUIRE(compressed.Blocks.size() == 16);
+        CHECK((compressed.Blocks[0] & 0x3F) == 0x20);
+        CHECK(compressor.ComputePsnr(image, compressed) >= minimumPsnr[q]);
+    }
+}
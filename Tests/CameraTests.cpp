@@ -0,0 +1,267 @@
+﻿//***************************************************************************************
+// CameraTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    const float gNear = 1.0f;
+    const float gFar = 200.0f;
+
+    // 뷰 스페이스 깊이 z의 점이 깊이 버퍼에 기록되는 값입니다.
+    float DepthAt(const Camera& camera, float z)
+    {
+        XMFLOAT4 clip;
+        XMStoreFloat4(&clip, XMVector4Transform(XMVectorSet(0.0f, 0.0f, z, 1.0f), camera.GetProj()));
+        return clip.z / clip.w;
+    }
+
+    void SetupCamera(Camera& camera, Camera::DepthMode mode)
+    {
+        camera.SetLens(0.25f * MathHelper::Pi, 16.0f / 9.0f, gNear, gFar, mode);
+        camera.LookAt(XMFLOAT3(3.0f, 2.0f, -5.0f), XMFLOAT3(0.0f, 0.0f, 20.0f), XMFLOAT3(0.0f, 1.0f, 0.0f));
+        camera.UpdateViewMatrix();
+    }
+
+    float PlaneDistance(const XMFLOAT4& p, const XMFLOAT3& v)
+    {
+        return p.x * v.x + p.y * v.y + p.z * v.z + p.w;
+    }
+
+    // 두 프러스텀의 꼭짓점들이 모두 가까운지 확인합니다.
+    bool FrustumsNear(const BoundingFrustum& a, const BoundingFrustum& b)
+    {
+        XMFLOAT3 cornersA[BoundingFrustum::CORNER_COUNT];
+        XMFLOAT3 cornersB[BoundingFrustum::CORNER_COUNT];
+        a.GetCorners(cornersA);
+        b.GetCorners(cornersB);
+        for (size_t i = 0; i < BoundingFrustum::CORNER_COUNT; ++i)
+        {
+            if (!XMVector3NearEqual(XMLoadFloat3(&cornersA[i]), XMLoadFloat3(&cornersB[i]), XMVectorReplicate(1e-2f)))
+                return false;
+        }
+        return true;
+    }
+
+    const Camera::DepthMode gModes[3] =
+    {
+        Camera::DepthMode::Standard, Camera::DepthMode::Reversed, Camera::DepthMode::ReversedInfinite
+    };
+}
+
+TEST_CASE(StandardDepthGoesFromZeroToOne)
+{
+    Camera camera;
+    camera.SetLens(0.25f * MathHelper::Pi, 1.0f, gNear, gFar);
+
+    CHECK_NEAR(DepthAt(camera, gNear), 0.0f, 1e-6f);
+    CHECK_NEAR(DepthAt(camera, gFar), 1.0f, 1e-5f);
+
+    float prev = -1.0f;
+    for (float z = gNear; z <= gFar; z *= 1.5f)
+    {
+        const float depth = DepthAt(camera, z);
+        CHECK(depth > prev);
+        prev = depth;
+    }
+
+    CHECK(camera.GetCullFarZ() == gFar);
+}
+
+TEST_CASE(ReversedDepthGoesFromOneToZero)
+{
+    Camera camera;
+    camera.SetLens(0.25f * MathHelper::Pi, 1.0f, gNear, gFar, Camera::DepthMode::Reversed);
+
+    CHECK_NEAR(DepthAt(camera, gNear), 1.0f, 1e-6f);
+    CHECK_NEAR(DepthAt(camera, gFar), 0.0f, 1e-5f);
+
+    // 표준 깊이를 뒤집은 것과 같습니다.
+    Camera standard;
+    standard.SetLens(0.25f * MathHelper::Pi, 1.0f, gNear, gFar);
+    for (float z = gNear; z <= gFar; z *= 1.5f)
+        CHECK_NEAR(DepthAt(camera, z), 1.0f - DepthAt(standard, z), 1e-5f);
+
+    CHECK(camera.GetCullFarZ() == gFar);
+}
+
+TEST_CASE(ReversedInfiniteDepthIsNearOverZ)
+{
+    Camera camera;
+    camera.SetLens(0.25f * MathHelper::Pi, 1.0f, gNear, gFar, Camera::DepthMode::ReversedInfinite);
+
+    for (float z = gNear; z < 1.0e7f; z *= 3.0f)
+        CHECK_NEAR(DepthAt(camera, z), gNear / z, 1e-6f);
+
+    // 아주 먼 곳도 0보다 큰 깊이를 가지므로 0으로 지운 버퍼에서 GREATER 테스트를 통과합니다.
+    CHECK(DepthAt(camera, 1.0e7f) > 0.0f);
+
+    // 투영에는 원평면이 없지만 컬링 거리는 유한합니다.
+    CHECK(camera.GetFarZ() == MathHelper::Infinity);
+    CHECK(camera.GetCullFarZ() == gFar);
+
+    camera.SetLens(0.25f * MathHelper::Pi, 1.0f, gNear, MathHelper::Infinity, Camera::DepthMode::ReversedInfinite);
+    CHECK(std::isfinite(camera.GetCullFarZ()));
+    CHECK(camera.GetCullFarZ() == gNear * 1.0e6f);
+}
+
+TEST_CASE(FrustumPlanesMatchClipSpace)
+{
+    TestRandom random(9);
+
+    for (Camera::DepthMode mode : gModes)
+    {
+        Camera camera;
+        SetupCamera(camera, mode);
+
+        const XMFLOAT4* planes = camera.GetFrustumPlanes();
+        const XMMATRIX view = camera.GetView();
+        const XMMATRIX viewProj = camera.GetViewProj();
+
+        int inside = 0;
+        for (int i = 0; i < 2000; ++i)
+        {
+            const XMFLOAT3 p(random.Range(-150.0f, 150.0f), random.Range(-150.0f, 150.0f), random.Range(-50.0f, 250.0f));
+            const XMVECTOR v = XMLoadFloat3(&p);
+
+            // 클립 공간의 x, y 범위와 뷰 스페이스 깊이 범위로 판정합니다.
+            XMFLOAT4 clip;
+            XMStoreFloat4(&clip, XMVector4Transform(XMVectorSetW(v, 1.0f), viewProj));
+            const float viewZ = XMVectorGetZ(XMVector3TransformCoord(v, view));
+
+            const float margin = 0.01f * std::fabs(clip.w) + 0.01f;
+            const float slack = std::min<float>(std::min<float>(clip.w - std::fabs(clip.x), clip.w - std::fabs(clip.y)),
+                std::min<float>(viewZ - gNear, gFar - viewZ));
+            if (std::fabs(slack) < margin)
+                continue;
+
+            bool planesInside = true;
+            for (int k = 0; k < 6; ++k)
+                planesInside = planesInside && PlaneDistance(planes[k], p) >= 0.0f;
+
+            CHECK(planesInside == (slack > 0.0f));
+            inside += slack > 0.0f ? 1 : 0;
+        }
+
+        CHECK(inside > 0);
+    }
+}
+
+TEST_CASE(FrustumCornersAreFiniteAndOnThePlanes)
+{
+    for (Camera::DepthMode mode : gModes)
+    {
+        Camera camera;
+        SetupCamera(camera, mode);
+
+        XMFLOAT3 corners[BoundingFrustum::CORNER_COUNT];
+        camera.GetFrustum().GetCorners(corners);
+
+        const XMFLOAT4* planes = camera.GetFrustumPlanes();
+        const XMVECTOR eye = camera.GetPosition();
+
+        for (const XMFLOAT3& c : corners)
+        {
+            CHECK(std::isfinite(c.x) && std::isfinite(c.y) && std::isfinite(c.z));
+
+            // 모든 꼭짓점은 평면들 안쪽에 있고 적어도 세 평면 위에 있습니다.
+            int onPlanes = 0;
+            for (int k = 0; k < 6; ++k)
+            {
+                const float d = PlaneDistance(planes[k], c);
+                CHECK(d > -1e-2f);
+                onPlanes += std::fabs(d) < 1e-2f ? 1 : 0;
+            }
+            CHECK(onPlanes >= 3);
+
+            // 뷰 방향으로의 거리는 근평면이나 컬링 원평면입니다.
+            const float z = XMVectorGetX(XMVector3Dot(XMVectorSubtract(XMLoadFloat3(&c), eye), camera.GetLook()));
+            CHECK(std::fabs(z - gNear) < 1e-3f || std::fabs(z - gFar) < 1e-2f);
+        }
+    }
+}
+
+TEST_CASE(PredictedFrustumFollowsTheMotion)
+{
+    Camera camera;
+    SetupCamera(camera, Camera::DepthMode::Standard);
+    const float dt = 1.0f / 60.0f;
+
+    // 움직이지 않으면 지금의 프러스텀과 같습니다.
+    camera.UpdateMotion(dt);
+    BoundingFrustum predicted;
+    camera.GetPredictedFrustum(0.5f, predicted);
+    CHECK(FrustumsNear(predicted, camera.GetFrustum()));
+
+    // 초당 6만큼 걷는 입력이 충분히 이어지면 0.5초 뒤에는 보는 방향으로 3만큼 가 있습니다.
+    for (int frame = 0; frame < 120; ++frame)
+    {
+        camera.Walk(0.1f);
+        camera.UpdateViewMatrix();
+        camera.UpdateMotion(dt);
+    }
+    Camera expected = camera;
+    expected.Walk(3.0f);
+    expected.UpdateViewMatrix();
+    camera.GetPredictedFrustum(0.5f, predicted);
+    CHECK(FrustumsNear(predicted, expected.GetFrustum()));
+
+    // 제자리에서 초당 0.6라디안으로 돌면 0.5초 뒤에는 월드 Y축에 대해 0.3라디안 더 돌아 있습니다.
+    for (int frame = 0; frame < 120; ++frame)
+    {
+        camera.RotateY(0.01f);
+        camera.UpdateViewMatrix();
+        camera.UpdateMotion(dt);
+    }
+    expected = camera;
+    expected.RotateY(0.3f);
+    expected.UpdateViewMatrix();
+    camera.GetPredictedFrustum(0.5f, predicted);
+    CHECK(FrustumsNear(predicted, expected.GetFrustum()));
+
+    // 순간 이동하면 속도가 0이 되므로 다시 지금의 프러스텀과 같습니다.
+    camera.LookAt(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT3(0.0f, 1.0f, 0.0f));
+    camera.UpdateViewMatrix();
+    camera.UpdateMotion(dt);
+    camera.GetPredictedFrustum(0.5f, predicted);
+    CHECK(FrustumsNear(predicted, camera.GetFrustum()));
+}
+
+TEST_CASE(SweptPlanesContainTheCurrentFrustum)
+{
+    for (Camera::DepthMode mode : gModes)
+    {
+        Camera camera;
+        SetupCamera(camera, mode);
+
+        // 걸으면서 도는 입력을 몇 프레임 줍니다.
+        const float dt = 1.0f / 60.0f;
+        camera.UpdateMotion(dt);
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            camera.Walk(0.2f);
+            camera.RotateY(0.02f);
+            camera.UpdateViewMatrix();
+            camera.UpdateMotion(dt);
+        }
+
+        XMFLOAT4 swept[6];
+        camera.GetSweptFrustumPlanes(0.25f, swept);
+
+        XMFLOAT3 corners[BoundingFrustum::CORNER_COUNT];
+        camera.GetFrustum().GetCorners(corners);
+
+        for (const XMFLOAT4& p : swept)
+        {
+            CHECK(std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z) && std::isfinite(p.w));
+            for (const XMFLOAT3& c : corners)
+                CHECK(PlaneDistance(p, c) > -1e-2f);
+        }
+    }
+}
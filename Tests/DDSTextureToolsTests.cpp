@@ -0,0 +1,100 @@
+﻿//***************************************************************************************
+// DDSTextureToolsTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "DDSTextureTools.h"
+#include "DDSTextureLoader.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    RgbaImage MakeCheckerboard(std::uint32_t width, std::uint32_t height)
+    {
+        RgbaImage image;
+        image.Resize(width, height);
+        for (std::uint32_t y = 0; y < height; ++y)
+        {
+            for (std::uint32_t x = 0; x < width; ++x)
+            {
+                std::uint8_t* p = image.GetPixel(x, y);
+                const std::uint8_t v = ((x / 4 + y / 4) % 2) ? 255 : 0;
+                p[0] = v;
+                p[1] = (std::uint8_t)(x * 8);
+                p[2] = (std::uint8_t)(y * 8);
+                p[3] = 255;
+            }
+        }
+        return image;
+    }
+
+    // 가장 가까운 텍셀을 골라 크기를 반으로 줄입니다. 저장과 로드만 확인하므로 필터는 상관없습니다.
+    RgbaImage HalveImage(const RgbaImage& image)
+    {
+        RgbaImage half;
+        half.Resize(std::max<std::uint32_t>(1, image.Width / 2), std::max<std::uint32_t>(1, image.Height / 2));
+        for (std::uint32_t y = 0; y < half.Height; ++y)
+            for (std::uint32_t x = 0; x < half.Width; ++x)
+                std::memcpy(half.GetPixel(x, y), image.GetClampedPixel(2 * x, 2 * y), 4);
+        return half;
+    }
+}
+
+TEST_CASE(CompressedMipChainReloadsThroughTheDDSLoader)
+{
+    for (BlockFormat format : { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC5, BlockFormat::BC7 })
+    {
+        BlockCompressor compressor(format, CompressionQuality::Fast, format == BlockFormat::BC7);
+
+        std::vector<CompressedImage> mipChain;
+        for (RgbaImage image = MakeCheckerboard(32, 16);; image = HalveImage(image))
+        {
+            mipChain.emplace_back();
+            compressor.Compress(image, mipChain.back());
+            if (image.Width == 1 && image.Height == 1)
+                break;
+        }
+        REQUIRE(mipChain.size() == 6);
+
+        std::vector<std::uint8_t> ddsData;
+        REQUIRE(SaveCompressedDDSToMemory(mipChain, ddsData));
+
+        D3D12_RESOURCE_DESC texDesc;
+        std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+        bool isCubeMap = true;
+        REQUIRE(SUCCEEDED(DirectX::GetDDSSubresourcesFromMemory12(ddsData.data(), ddsData.size(),
+            texDesc, subresources, &isCubeMap)));
+
+        CHECK(texDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D);
+        CHECK(texDesc.Width == 32 && texDesc.Height == 16);
+        CHECK(texDesc.DepthOrArraySize == 1);
+        CHECK(texDesc.MipLevels == 6);
+        CHECK(texDesc.Format == compressor.GetDxgiFormat());
+        CHECK(!isCubeMap);
+        REQUIRE(subresources.size() == mipChain.size());
+
+        // 로더가 돌려준 밉마다 저장한 블록과 같은 바이트를 가리켜야 합니다.
+        for (size_t mip = 0; mip < mipChain.size(); ++mip)
+        {
+            const CompressedImage& saved = mipChain[mip];
+            CHECK(subresources[mip].RowPitch == (LONG_PTR)saved.RowPitch);
+            REQUIRE(subresources[mip].SlicePitch == (LONG_PTR)saved.Blocks.size());
+            CHECK(std::memcmp(subresources[mip].pData, saved.Blocks.data(), saved.Blocks.size()) == 0);
+        }
+    }
+}
+
+TEST_CASE(MismatchedMipChainIsNotSaved)
+{
+    BlockCompressor compressor(BlockFormat::BC1);
+
+    std::vector<CompressedImage> mipChain(2);
+    compressor.Compress(MakeCheckerboard(16, 16), mipChain[0]);
+    compressor.Compress(MakeCheckerboard(4, 4), mipChain[1]);
+
+    // 두 번째 밉이 8x8이 아니므로 저장하지 않습니다.
+    std::vector<std::uint8_t> ddsData;
+    CHECK(!SaveCompressedDDSToMemory(mipChain, ddsData));
+    CHECK(!SaveCompressedDDSToMemory(std::vector<CompressedImage>(), ddsData));
+}
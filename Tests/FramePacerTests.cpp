@@ -0,0 +1,211 @@
+﻿//***************************************************************************************
+// FramePacerTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "FramePacer.h"
+#include <vector>
+
+namespace
+{
+    const std::int64_t gMs = 1000000;
+    const std::int64_t gFrameTime = 16 * gMs;
+
+    // 시계를 읽을 때마다 조금씩 흐르는 가짜 시계입니다. 잠은 요청한 시간에 Oversleep만큼
+    // 늦게 깨어납니다.
+    struct FakeClock
+    {
+        std::int64_t Time = 0;
+        std::int64_t ReadCost = 1000;
+        std::int64_t Oversleep = 0;
+
+        std::uint32_t Reads = 0;
+        std::vector<std::int64_t> Sleeps;
+
+        FramePacer MakePacer()
+        {
+            return FramePacer([this]()
+                {
+                    Reads++;
+                    Time += ReadCost;
+                    return Time;
+                },
+                [this](std::int64_t nanoseconds)
+                {
+                    Sleeps.push_back(nanoseconds);
+                    Time += nanoseconds + Oversleep;
+                });
+        }
+    };
+}
+
+TEST_CASE(NoTargetDoesNotWait)
+{
+    FakeClock clock;
+    FramePacer pacer = clock.MakePacer();
+
+    for (int i = 0; i < 10; ++i)
+        pacer.WaitForNextFrame();
+
+    CHECK(clock.Reads == 0);
+    CHECK(clock.Sleeps.empty());
+    CHECK(pacer.Stats().FrameCount == 0);
+
+    pacer.SetTargetFrameRate(0.0);
+    CHECK(pacer.TargetFrameTime() == 0);
+    pacer.SetTargetFrameRate(50.0);
+    CHECK(pacer.TargetFrameTime() == 20 * gMs);
+}
+
+TEST_CASE(SleepsThenSpinsUpToTheDeadline)
+{
+    FakeClock clock;
+    FramePacer pacer = clock.MakePacer();
+    pacer.SetTargetFrameTime(gFrameTime);
+    pacer.SetSpinThreshold(gMs);
+    pacer.Reset();
+    const std::int64_t deadline = clock.Time + gFrameTime;
+
+    // 5ms 동안 일한 프레임입니다.
+    clock.Time += 5 * gMs;
+    const std::int64_t before = clock.Time;
+    pacer.WaitForNextFrame();
+
+    // 스핀할 1ms를 남기고 한 번만 잡니다.
+    REQUIRE(clock.Sleeps.size() == 1);
+    CHECK(clock.Sleeps[0] == deadline - (before + clock.ReadCost) - gMs);
+
+    // 마감 시각을 지나자마자 돌아옵니다.
+    CHECK(clock.Time >= deadline);
+    CHECK(clock.Time <= deadline + clock.ReadCost);
+
+    const FramePacer::PacingStats stats = pacer.Stats();
+    CHECK(stats.FrameCount == 1);
+    CHECK(stats.MissedFrames == 0);
+    CHECK_NEAR(stats.AvgSpinMs, 1.0, 0.01);
+    CHECK_NEAR(stats.AvgSleepMs + stats.AvgSpinMs, 11.0, 0.01);
+    CHECK(stats.MaxJitterMs <= clock.ReadCost * 1e-6f);
+}
+
+TEST_CASE(ShortRemainderIsSpunWithoutSleeping)
+{
+    FakeClock clock;
+    FramePacer pacer = clock.MakePacer();
+    pacer.SetTargetFrameTime(gFrameTime);
+    pacer.SetSpinThreshold(2 * gMs);
+    pacer.Reset();
+
+    clock.Time += gFrameTime - gMs;
+    pacer.WaitForNextFrame();
+
+    CHECK(clock.Sleeps.empty());
+    CHECK(pacer.Stats().MissedFrames == 0);
+    CHECK_NEAR(pacer.Stats().AvgSpinMs, 1.0, 0.01);
+}
+
+TEST_CASE(OversleepIsCompensated)
+{
+    FakeClock clock;
+    clock.Oversleep = 3 * gMs;
+
+    FramePacer pacer = clock.MakePacer();
+    pacer.SetTargetFrameTime(gFrameTime);
+    pacer.SetSpinThreshold(gMs);
+    pacer.Reset();
+
+    // 첫 프레임은 늦잠을 모르므로 마감 시각을 넘깁니다.
+    clock.Time += 4 * gMs;
+    pacer.WaitForNextFrame();
+    CHECK_NEAR(pacer.Stats().MaxJitterMs, 2.0, 0.01);
+    CHECK_NEAR(pacer.Stats().OversleepEstimateMs, 3.0, 0.01);
+
+    // 그 뒤로는 그만큼 일찍 깨어나도록 짧게 자서 제때 시작합니다.
+    pacer.ResetStats();
+    for (int frame = 0; frame < 20; ++frame)
+    {
+        const std::int64_t frameStart = clock.Time;
+        clock.Time += 4 * gMs;
+        pacer.WaitForNextFrame();
+
+        CHECK(clock.Sleeps.back() < gFrameTime - 4 * gMs - gMs - 2 * gMs);
+        CHECK(clock.Time - frameStart <= gFrameTime + 2 * clock.ReadCost);
+    }
+
+    const FramePacer::PacingStats stats = pacer.Stats();
+    CHECK(stats.MissedFrames == 0);
+    CHECK(stats.MaxJitterMs <= clock.ReadCost * 1e-6f);
+}
+
+TEST_CASE(OversleepEstimateDecaysSlowly)
+{
+    FakeClock clock;
+    clock.Oversleep = 4 * gMs;
+
+    FramePacer pacer = clock.MakePacer();
+    pacer.SetTargetFrameTime(gFrameTime);
+    pacer.Reset();
+    pacer.WaitForNextFrame();
+    CHECK_NEAR(pacer.Stats().OversleepEstimateMs, 4.0, 0.01);
+
+    // 한 번 정확히 깨어났다고 바로 잊지 않고 조금씩 줄입니다.
+    clock.Oversleep = 0;
+    float previous = pacer.Stats().OversleepEstimateMs;
+    for (int frame = 0; frame < 16; ++frame)
+    {
+        pacer.WaitForNextFrame();
+        const float estimate = pacer.Stats().OversleepEstimateMs;
+        CHECK(estimate < previous);
+        CHECK(estimate > previous * 0.9f);
+        previous = estimate;
+    }
+
+    // 다시 늦잠이 늘면 바로 따라갑니다.
+    clock.Oversleep = 5 * gMs;
+    pacer.WaitForNextFrame();
+    CHECK_NEAR(pacer.Stats().OversleepEstimateMs, 5.0, 0.01);
+}
+
+TEST_CASE(LongFrameIsNotFollowedByABurst)
+{
+    FakeClock clock;
+    FramePacer pacer = clock.MakePacer();
+    pacer.SetTargetFrameTime(gFrameTime);
+    pacer.Reset();
+
+    // 세 프레임만큼 걸린 프레임은 기다리지 않습니다.
+    clock.Time += 3 * gFrameTime;
+    pacer.WaitForNextFrame();
+    CHECK(clock.Sleeps.empty());
+    CHECK(pacer.Stats().MissedFrames == 1);
+
+    // 밀린 마감 시각들을 따라잡으려고 연달아 실행하지 않고 한 프레임을 온전히 기다립니다.
+    const std::int64_t frameStart = clock.Time;
+    clock.Time += gMs;
+    pacer.WaitForNextFrame();
+    CHECK(pacer.Stats().MissedFrames == 1);
+    CHECK(clock.Time - frameStart >= gFrameTime);
+}
+
+TEST_CASE(DeadlinesDoNotDrift)
+{
+    FakeClock clock;
+    clock.Oversleep = gMs / 2;
+
+    FramePacer pacer = clock.MakePacer();
+    pacer.SetTargetFrameTime(gFrameTime);
+    pacer.Reset();
+    const std::int64_t start = clock.Time;
+
+    // 일하는 시간이 달라도 프레임은 시작 시각의 정수배에 맞춰 시작합니다.
+    TestRandom random(3);
+    const int frames = 100;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        clock.Time += (std::int64_t)random.Range(0.0f, 12.0f) * gMs;
+        pacer.WaitForNextFrame();
+    }
+
+    CHECK(clock.Time >= start + frames * gFrameTime);
+    CHECK(clock.Time <= start + frames * gFrameTime + 2 * clock.ReadCost);
+    CHECK(pacer.Stats().MissedFrames == 0);
+}
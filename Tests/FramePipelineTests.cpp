@@ -0,0 +1,248 @@
+﻿//***************************************************************************************
+// FramePipelineTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "FramePipeline.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const std::chrono::milliseconds gShortWait(2);
+    const std::chrono::milliseconds gLongWait(5000);
+
+    // 생산자가 슬롯에 패킷 번호를 쓰고 소비자가 그 번호를 확인합니다.
+    struct Packets
+    {
+        std::vector<std::uint64_t> Slots;
+        std::vector<std::uint32_t> ConsumedSlots;
+        std::uint64_t NextExpected = 0;
+        std::atomic<std::uint32_t> OutOfOrder{0};
+
+        explicit Packets(std::uint32_t slotCount) : Slots(slotCount, ~0ull) {}
+
+        void Consume(std::uint32_t slot)
+        {
+            ConsumedSlots.push_back(slot);
+            if (Slots[slot] != NextExpected)
+                OutOfOrder++;
+            NextExpected++;
+        }
+    };
+
+    bool Produce(FramePipeline& pipeline, Packets& packets, std::uint64_t packet)
+    {
+        std::uint32_t slot = 0;
+        if (!pipeline.BeginProduce(slot, gLongWait))
+            return false;
+
+        packets.Slots[slot] = packet;
+        pipeline.EndProduce();
+        return true;
+    }
+}
+
+TEST_CASE(SlotsAreUsedInRingOrder)
+{
+    FramePipeline pipeline(3);
+    CHECK(pipeline.SlotCount() == 3);
+
+    // 소비자가 돌려주기 전에는 슬롯 수만큼만 채울 수 있습니다.
+    std::uint32_t slot = 0;
+    for (std::uint32_t i = 0; i < 3; ++i)
+    {
+        REQUIRE(pipeline.BeginProduce(slot, gShortWait));
+        CHECK(slot == i);
+        pipeline.EndProduce();
+    }
+    CHECK(!pipeline.BeginProduce(slot, gShortWait));
+    CHECK(!pipeline.WaitIdle(gShortWait));
+
+    REQUIRE(pipeline.BeginConsume(slot));
+    CHECK(slot == 0);
+    pipeline.EndConsume();
+
+    REQUIRE(pipeline.BeginProduce(slot, gShortWait));
+    CHECK(slot == 0);
+    pipeline.EndProduce();
+
+    for (std::uint32_t expected : { 1u, 2u, 0u })
+    {
+        REQUIRE(pipeline.BeginConsume(slot));
+        CHECK(slot == expected);
+        pipeline.EndConsume();
+    }
+
+    CHECK(pipeline.WaitIdle(gShortWait));
+    CHECK(pipeline.ProducedCount() == 4);
+    CHECK(pipeline.ConsumedCount() == 4);
+}
+
+TEST_CASE(ConsumerThreadSeesEveryPacketInOrder)
+{
+    FramePipeline pipeline(3);
+    Packets packets(3);
+
+    pipeline.StartConsumerThread("Consumer", [&](std::uint32_t slot) { packets.Consume(slot); });
+    CHECK(pipeline.HasConsumerThread());
+
+    const std::uint64_t count = 2000;
+    for (std::uint64_t i = 0; i < count; ++i)
+        REQUIRE(Produce(pipeline, packets, i));
+
+    CHECK(pipeline.WaitIdle(gLongWait));
+    CHECK(pipeline.ConsumedCount() == count);
+
+    pipeline.StopConsumerThread(nullptr);
+    CHECK(!pipeline.HasConsumerThread());
+    CHECK(!pipeline.IsClosed());
+
+    REQUIRE(packets.ConsumedSlots.size() == count);
+    CHECK(packets.OutOfOrder == 0);
+    for (std::uint64_t i = 0; i < count; ++i)
+        CHECK(packets.ConsumedSlots[i] == i % 3);
+}
+
+TEST_CASE(WaitIdleTimesOutWhileAFrameIsInFlight)
+{
+    FramePipeline pipeline(2);
+    Packets packets(2);
+
+    std::atomic<bool> release(false);
+    pipeline.StartConsumerThread("Consumer", [&](std::uint32_t slot)
+        {
+            while (!release.load())
+                std::this_thread::yield();
+            packets.Consume(slot);
+        });
+
+    REQUIRE(Produce(pipeline, packets, 0));
+    CHECK(!pipeline.WaitIdle(gShortWait));
+
+    release.store(true);
+    CHECK(pipeline.WaitIdle(gLongWait));
+    CHECK(pipeline.ConsumedCount() == 1);
+
+    pipeline.StopConsumerThread(nullptr);
+}
+
+TEST_CASE(StopPumpsUntilTheInFlightFramesAreDone)
+{
+    FramePipeline pipeline(3);
+    Packets packets(3);
+
+    // 소비자는 생산자 스레드가 pump에서 처리해 주는 요청을 기다립니다. Present가 메인 스레드로
+    // 보내는 메세지와 같은 상황입니다.
+    std::atomic<std::uint32_t> requests(0);
+    std::atomic<std::uint32_t> handled(0);
+    pipeline.StartConsumerThread("Consumer", [&](std::uint32_t slot)
+        {
+            const std::uint32_t request = ++requests;
+            while (handled.load() < request)
+                std::this_thread::yield();
+            packets.Consume(slot);
+        });
+
+    for (std::uint64_t i = 0; i < 3; ++i)
+        REQUIRE(Produce(pipeline, packets, i));
+
+    std::uint32_t pumps = 0;
+    pipeline.StopConsumerThread([&]()
+        {
+            pumps++;
+            handled.store(requests.load());
+        });
+
+    // 닫기 전에 넘긴 프레임은 모두 그려지고, 파이프라인은 슬롯 순서를 이어서 다시 열립니다.
+    CHECK(pumps > 0);
+    CHECK(!pipeline.HasConsumerThread());
+    CHECK(!pipeline.IsClosed());
+    CHECK(pipeline.ConsumedCount() == 3);
+    CHECK(packets.OutOfOrder == 0);
+
+    std::uint32_t slot = 0;
+    REQUIRE(pipeline.BeginProduce(slot, gShortWait));
+    CHECK(slot == 0);
+    pipeline.EndProduce();
+    REQUIRE(pipeline.BeginConsume(slot));
+    CHECK(slot == 0);
+    pipeline.EndConsume();
+}
+
+TEST_CASE(ConsumerExceptionIsRethrownOnTheProducer)
+{
+    FramePipeline pipeline(2);
+    Packets packets(2);
+
+    pipeline.StartConsumerThread("Consumer", [&](std::uint32_t slot)
+        {
+            if (packets.Slots[slot] == 3)
+                throw std::runtime_error("device removed");
+            packets.Consume(slot);
+        });
+
+    // 예외가 파이프라인을 닫으면 BeginProduce가 실패합니다.
+    std::uint64_t produced = 0;
+    while (Produce(pipeline, packets, produced))
+        produced++;
+
+    CHECK(produced >= 4);
+    CHECK(pipeline.IsClosed());
+    CHECK(pipeline.WaitIdle(gShortWait));
+
+    bool rethrown = false;
+    try
+    {
+        pipeline.RethrowConsumerException();
+    }
+    catch (const std::runtime_error& e)
+    {
+        rethrown = std::string(e.what()) == "device removed";
+    }
+    CHECK(rethrown);
+
+    // 스레드는 정리되었고 실패한 프레임만 버려졌으므로 그 뒤의 프레임은 같은 스레드에서 이어서 그립니다.
+    CHECK(!pipeline.HasConsumerThread());
+    CHECK(!pipeline.IsClosed());
+    CHECK(packets.ConsumedSlots.size() == 3);
+    CHECK(pipeline.ConsumedCount() == 4);
+    pipeline.RethrowConsumerException();
+
+    std::uint32_t slot = 0;
+    while (pipeline.ConsumedCount() < pipeline.ProducedCount())
+    {
+        REQUIRE(pipeline.BeginConsume(slot));
+        CHECK(packets.Slots[slot] == 4);
+        pipeline.EndConsume();
+    }
+
+    REQUIRE(pipeline.BeginProduce(slot, gShortWait));
+    pipeline.EndProduce();
+    CHECK(pipeline.BeginConsume(slot));
+    pipeline.EndConsume();
+}
+
+TEST_CASE(DestructorStopsTheConsumerThread)
+{
+    std::atomic<std::uint32_t> consumed(0);
+    std::uint32_t produced = 0;
+    {
+        FramePipeline pipeline(3);
+        pipeline.StartConsumerThread("Consumer", [&](std::uint32_t)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                consumed++;
+            });
+
+        std::uint32_t slot = 0;
+        for (; produced < 3 && pipeline.BeginProduce(slot, gLongWait); ++produced)
+            pipeline.EndProduce();
+    }
+
+    CHECK(produced == 3);
+    CHECK(consumed == 3);
+}
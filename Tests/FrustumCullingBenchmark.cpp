@@ -0,0 +1,165 @@
+﻿//***************************************************************************************
+// FrustumCullingBenchmark.cpp
+//
+// Compares three ways of frustum culling the same set of instance AABBs: a scalar
+// per-instance loop (the baseline), the linear SoA InstanceCuller (Cull and
+// CullParallel) and the BoundingVolumeHierarchy query.  The camera turns a little
+// every repeat, so the "unchanged" fast paths never trigger and the coherence caches
+// only help as much as they would while the camera moves.  All methods must return
+// the same set of instances.
+//***************************************************************************************
+
+#include "BenchmarkHarness.h"
+#include "BoundingVolumeHierarchy.h"
+#include "InstanceCuller.h"
+#include "MathHelper.h"
+#include "TestHarness.h"
+#include <atomic>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    struct Scene
+    {
+        std::vector<BoundingBox> WorldBounds;
+        InstanceCuller Culler;
+        BoundingVolumeHierarchy Bvh;
+        float HalfSize = 0.0f;
+    };
+
+    // 인스턴스 밀도가 일정하도록 인스턴스 수에 맞춰 정육면체의 크기를 정합니다.
+    void BuildScene(Scene& scene, std::uint32_t count)
+    {
+        TestRandom random(count);
+        scene.HalfSize = 2.0f * std::cbrt((float)count);
+        scene.Culler.Clear();
+        scene.WorldBounds.clear();
+
+        const float s = scene.HalfSize;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            BoundingBox local(XMFLOAT3(0.0f, 0.0f, 0.0f),
+                XMFLOAT3(random.Range(0.2f, 1.0f), random.Range(0.2f, 1.0f), random.Range(0.2f, 1.0f)));
+
+            XMMATRIX world = XMMatrixRotationY(random.Range(0.0f, XM_2PI)) *
+                XMMatrixTranslation(random.Range(-s, s), random.Range(-s, s), random.Range(-s, s));
+
+            scene.Culler.AddInstance(local, world);
+            scene.WorldBounds.push_back(scene.Culler.GetWorldBounds(i));
+        }
+    }
+
+    void ComputeCameraPlanes(const Scene& scene, float yaw, XMFLOAT4 planes[6])
+    {
+        XMVECTOR eye = XMVectorZero();
+        XMVECTOR target = XMVectorSet(std::sin(yaw), 0.0f, std::cos(yaw), 0.0f);
+        XMMATRIX view = XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, scene.HalfSize);
+        MathHelper::ComputeFrustumPlanes(view * proj, planes);
+    }
+
+    // 기준이 되는 스칼라 구현입니다. 인스턴스마다 여섯 평면을 순서대로 테스트합니다.
+    void CullScalar(const std::vector<BoundingBox>& bounds, const XMFLOAT4 planes[6], std::vector<std::uint32_t>& visible)
+    {
+        visible.clear();
+        for (std::uint32_t i = 0; i < (std::uint32_t)bounds.size(); ++i)
+        {
+            const XMFLOAT3& c = bounds[i].Center;
+            const XMFLOAT3& e = bounds[i].Extents;
+
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p)
+            {
+                const XMFLOAT4& pl = planes[p];
+                const float dist = c.x * pl.x + c.y * pl.y + c.z * pl.z + pl.w;
+                const float radius = e.x * std::fabs(pl.x) + e.y * std::fabs(pl.y) + e.z * std::fabs(pl.z);
+                inside = dist + radius >= 0.0f;
+            }
+
+            if (inside)
+                visible.push_back(i);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options(argc, argv);
+
+    std::vector<std::uint32_t> sizes = { 10000, 100000, 1000000 };
+    if (options.Quick)
+        sizes.resize(1);
+
+    bool failed = false;
+
+    std::printf("%10s %9s %12s %12s %12s %12s %12s\n",
+        "instances", "visible", "scalar ms", "soa ms", "parallel ms", "bvh ms", "bvh build");
+
+    for (std::uint32_t count : sizes)
+    {
+        Scene scene;
+        BuildScene(scene, count);
+
+        const double buildMs = MeasureMedianMs(1, [&](int)
+        {
+            scene.Bvh.Build(scene.WorldBounds);
+        });
+
+        // 반복마다 카메라를 조금씩 돌립니다.
+        auto planesFor = [&](int repeat, XMFLOAT4 planes[6])
+        {
+            ComputeCameraPlanes(scene, 0.01f * repeat, planes);
+        };
+
+        std::vector<std::uint32_t> scalarVisible;
+        std::vector<std::uint32_t> soaVisible;
+        std::vector<std::uint32_t> bvhVisible;
+        std::vector<std::uint32_t> parallelVisible(count);
+        std::uint32_t parallelCount = 0;
+
+        const double scalarMs = MeasureMedianMs(options.Repeats, [&](int repeat)
+        {
+            XMFLOAT4 planes[6];
+            planesFor(repeat, planes);
+            CullScalar(scene.WorldBounds, planes, scalarVisible);
+        });
+
+        const double soaMs = MeasureMedianMs(options.Repeats, [&](int repeat)
+        {
+            XMFLOAT4 planes[6];
+            planesFor(repeat, planes);
+            scene.Culler.Cull(planes, soaVisible);
+        });
+
+        const double parallelMs = MeasureMedianMs(options.Repeats, [&](int repeat)
+        {
+            XMFLOAT4 planes[6];
+            planesFor(repeat, planes);
+            parallelCount = scene.Culler.CullParallel(planes, [&](std::uint32_t instance, std::uint32_t outputIndex)
+            {
+                parallelVisible[outputIndex] = instance;
+            });
+        });
+
+        const double bvhMs = MeasureMedianMs(options.Repeats, [&](int repeat)
+        {
+            XMFLOAT4 planes[6];
+            planesFor(repeat, planes);
+            scene.Bvh.QueryFrustum(planes, bvhVisible);
+        });
+
+        // 마지막 반복의 결과는 모두 같은 카메라에서 나온 것입니다.
+        parallelVisible.resize(parallelCount);
+        std::sort(bvhVisible.begin(), bvhVisible.end());
+        BenchmarkCheck(soaVisible == scalarVisible, "SoA culler differs from the scalar baseline", failed);
+        BenchmarkCheck(parallelVisible == scalarVisible, "parallel culler differs from the scalar baseline", failed);
+        BenchmarkCheck(bvhVisible == scalarVisible, "BVH query differs from the scalar baseline", failed);
+
+        std::printf("%10u %9u %12.3f %12.3f %12.3f %12.3f %12.3f\n",
+            count, (std::uint32_t)scalarVisible.size(), scalarMs, soaMs, parallelMs, bvhMs, buildMs);
+    }
+
+    return failed ? 1 : 0;
+}
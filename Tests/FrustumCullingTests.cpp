@@ -0,0 +1,288 @@
+﻿//***************************************************************************************
+// FrustumCullingTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "BoundingVolumeHierarchy.h"
+#include "InstanceCuller.h"
+#include "MathHelper.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    const float gHalfSize = 40.0f;
+
+    // 정육면체 안에 흩어진 인스턴스들입니다. 개수가 4의 배수가 아니어서 마지막 그룹에 채우기용 레인이 생깁니다.
+    void BuildScene(InstanceCuller& culler, std::vector<BoundingBox>& worldBounds, std::uint32_t count = 2001)
+    {
+        TestRandom random(7);
+        culler.Clear();
+        worldBounds.clear();
+
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            BoundingBox local(XMFLOAT3(0.0f, 0.0f, 0.0f),
+                XMFLOAT3(random.Range(0.2f, 1.0f), random.Range(0.2f, 1.0f), random.Range(0.2f, 1.0f)));
+
+            XMMATRIX world = XMMatrixRotationY(random.Range(0.0f, XM_2PI)) *
+                XMMatrixTranslation(random.Range(-gHalfSize, gHalfSize), random.Range(-gHalfSize, gHalfSize),
+                    random.Range(-gHalfSize, gHalfSize));
+
+            culler.AddInstance(local, world);
+            worldBounds.push_back(culler.GetWorldBounds(i));
+        }
+    }
+
+    // 원점에서 yaw 방향을 바라보는 카메라의 world 평면들입니다.
+    void ComputeCameraPlanes(float yaw, XMFLOAT4 planes[6])
+    {
+        XMVECTOR eye = XMVectorZero();
+        XMVECTOR target = XMVectorSet(std::sin(yaw), 0.0f, std::cos(yaw), 0.0f);
+        XMMATRIX view = XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, gHalfSize);
+        MathHelper::ComputeFrustumPlanes(view * proj, planes);
+    }
+
+    // 인스턴스마다 여섯 평면을 모두 테스트하는 기준 구현입니다.
+    std::vector<std::uint32_t> CullBruteForce(const std::vector<BoundingBox>& bounds, const XMFLOAT4 planes[6])
+    {
+        std::vector<std::uint32_t> visible;
+        for (std::uint32_t i = 0; i < (std::uint32_t)bounds.size(); ++i)
+        {
+            const XMFLOAT3& c = bounds[i].Center;
+            const XMFLOAT3& e = bounds[i].Extents;
+
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p)
+            {
+                const XMFLOAT4& pl = planes[p];
+                const float dist = c.x * pl.x + c.y * pl.y + c.z * pl.z + pl.w;
+                const float radius = e.x * std::fabs(pl.x) + e.y * std::fabs(pl.y) + e.z * std::fabs(pl.z);
+                inside = dist + radius >= 0.0f;
+            }
+
+            if (inside)
+                visible.push_back(i);
+        }
+        return visible;
+    }
+
+    std::vector<std::uint32_t> CullParallel(InstanceCuller& culler, const XMFLOAT4 planes[6])
+    {
+        std::vector<std::uint32_t> visible(culler.InstanceCount());
+        const std::uint32_t count = culler.CullParallel(planes, [&](std::uint32_t instance, std::uint32_t outputIndex)
+        {
+            visible[outputIndex] = instance;
+        }, 256);
+        visible.resize(count);
+        return visible;
+    }
+
+    // BVH는 트리를 순회한 순서로 돌려주므로 정렬해서 비교합니다.
+    std::vector<std::uint32_t> QuerySorted(BoundingVolumeHierarchy& bvh, const XMFLOAT4 planes[6])
+    {
+        std::vector<std::uint32_t> visible;
+        bvh.QueryFrustum(planes, visible);
+        std::sort(visible.begin(), visible.end());
+        return visible;
+    }
+
+    // 카메라 뒤쪽, 프러스텀 밖으로 옮긴 박스입니다.
+    BoundingBox BehindCamera()
+    {
+        return BoundingBox(XMFLOAT3(0.0f, 0.0f, -20.0f), XMFLOAT3(0.5f, 0.5f, 0.5f));
+    }
+}
+
+TEST_CASE(CullMatchesBruteForce)
+{
+    InstanceCuller culler;
+    std::vector<BoundingBox> bounds;
+    BuildScene(culler, bounds);
+
+    BoundingVolumeHierarchy bvh;
+    bvh.Build(bounds);
+
+    for (float yaw : { 0.0f, 1.3f, 2.9f, 4.4f })
+    {
+        XMFLOAT4 planes[6];
+        ComputeCameraPlanes(yaw, planes);
+        const std::vector<std::uint32_t> expected = CullBruteForce(bounds, planes);
+        REQUIRE(!expected.empty());
+
+        std::vector<std::uint32_t> visible;
+        culler.Cull(planes, visible);
+        CHECK(visible == expected);
+        CHECK(!culler.LastStats().Unchanged);
+        CHECK(culler.LastStats().Instances == culler.InstanceCount());
+
+        CHECK(CullParallel(culler, planes) == expected);
+        CHECK(QuerySorted(bvh, planes) == expected);
+        CHECK(!bvh.LastStats().Unchanged);
+    }
+}
+
+TEST_CASE(RepeatedPlanesReuseTheLastResult)
+{
+    InstanceCuller culler;
+    std::vector<BoundingBox> bounds;
+    BuildScene(culler, bounds);
+
+    BoundingVolumeHierarchy bvh;
+    bvh.Build(bounds);
+
+    XMFLOAT4 planes[6];
+    ComputeCameraPlanes(0.7f, planes);
+
+    std::vector<std::uint32_t> first;
+    std::vector<std::uint32_t> second;
+    culler.Cull(planes, first);
+    culler.Cull(planes, second);
+    CHECK(culler.LastStats().Unchanged);
+    CHECK(culler.LastStats().PlaneTests == 0);
+    CHECK(culler.LastStats().PlaneTestsSaved == (std::int32_t)(6 * culler.InstanceCount()));
+    CHECK(second == first);
+
+    // CullParallel은 청크별 결과를 따로 기억하므로 Cull의 결과를 재사용하지 않습니다.
+    const std::vector<std::uint32_t> parallelFirst = CullParallel(culler, planes);
+    CHECK(!culler.LastStats().Unchanged);
+    const std::vector<std::uint32_t> parallelSecond = CullParallel(culler, planes);
+    CHECK(culler.LastStats().Unchanged);
+    CHECK(parallelFirst == first);
+    CHECK(parallelSecond == first);
+
+    bvh.QueryFrustum(planes, first);
+    bvh.QueryFrustum(planes, second);
+    CHECK(bvh.LastStats().Unchanged);
+    CHECK(bvh.LastStats().PlaneTests == 0);
+    CHECK(bvh.LastStats().NodesVisited == 0);
+    CHECK(second == first);
+}
+
+TEST_CASE(NudgedPlanesUseTheCachedRejectPlane)
+{
+    InstanceCuller culler;
+    std::vector<BoundingBox> bounds;
+    BuildScene(culler, bounds);
+
+    BoundingVolumeHierarchy bvh;
+    bvh.Build(bounds);
+
+    // 카메라가 조금씩 돌면 대부분의 인스턴스는 지난번에 거부한 평면 하나로 다시 거부됩니다.
+    std::vector<std::uint32_t> visible;
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        XMFLOAT4 planes[6];
+        ComputeCameraPlanes(0.5f + 0.01f * frame, planes);
+        const std::vector<std::uint32_t> expected = CullBruteForce(bounds, planes);
+
+        culler.Cull(planes, visible);
+        CHECK(visible == expected);
+        CHECK(CullParallel(culler, planes) == expected);
+        CHECK(QuerySorted(bvh, planes) == expected);
+
+        if (frame > 0)
+        {
+            CHECK(!culler.LastStats().Unchanged);
+            CHECK(culler.LastStats().CachedPlaneRejects > 0);
+            CHECK(culler.LastStats().PlaneTestsSaved > 0);
+            CHECK(!bvh.LastStats().Unchanged);
+            CHECK(bvh.LastStats().CachedPlaneRejects > 0);
+        }
+    }
+}
+
+TEST_CASE(MovedInstancesInvalidateTheCache)
+{
+    InstanceCuller culler;
+    std::vector<BoundingBox> bounds;
+    BuildScene(culler, bounds);
+
+    XMFLOAT4 planes[6];
+    ComputeCameraPlanes(2.0f, planes);
+
+    std::vector<std::uint32_t> visible;
+    culler.Cull(planes, visible);
+    REQUIRE(!visible.empty());
+
+    // 보이던 인스턴스를 카메라 뒤로 옮기면 같은 평면이라도 다시 컬링해야 합니다.
+    const std::uint32_t moved = visible[visible.size() / 2];
+    const BoundingBox local(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.5f, 0.5f, 0.5f));
+    culler.SetInstance(moved, local, XMMatrixTranslation(0.0f, 0.0f, -20.0f));
+    bounds[moved] = culler.GetWorldBounds(moved);
+
+    culler.Cull(planes, visible);
+    CHECK(!culler.LastStats().Unchanged);
+    CHECK(visible == CullBruteForce(bounds, planes));
+    CHECK(std::find(visible.begin(), visible.end(), moved) == visible.end());
+
+    // CullCandidates도 지난 결과를 덮어쓰므로 다음 Cull은 재사용하지 않습니다.
+    std::vector<std::uint32_t> candidates;
+    culler.CullCandidates(planes, { 0, 1, 2, 3 }, candidates);
+    culler.Cull(planes, visible);
+    CHECK(!culler.LastStats().Unchanged);
+    CHECK(visible == CullBruteForce(bounds, planes));
+
+    // 새로 추가한 인스턴스도 마찬가지입니다.
+    culler.AddInstance(local, XMMatrixTranslation(0.0f, 0.0f, 0.0f));
+    bounds.push_back(culler.GetWorldBounds(culler.InstanceCount() - 1));
+    culler.Cull(planes, visible);
+    CHECK(!culler.LastStats().Unchanged);
+    CHECK(visible == CullBruteForce(bounds, planes));
+}
+
+TEST_CASE(MovedPrimitivesInvalidateTheBvhCache)
+{
+    InstanceCuller culler;
+    std::vector<BoundingBox> bounds;
+    BuildScene(culler, bounds);
+
+    BoundingVolumeHierarchy bvh;
+    bvh.Build(bounds);
+
+    XMFLOAT4 planes[6];
+    ComputeCameraPlanes(2.0f, planes);
+
+    std::vector<std::uint32_t> visible = QuerySorted(bvh, planes);
+    REQUIRE(!visible.empty());
+
+    // 보이던 프리미티브 하나는 카메라 뒤로, 보이지 않던 프리미티브 하나는 카메라 앞으로 옮깁니다.
+    std::uint32_t hidden = 0;
+    while (std::binary_search(visible.begin(), visible.end(), hidden))
+        ++hidden;
+
+    const std::uint32_t moved = visible[visible.size() / 2];
+    bounds[moved] = BehindCamera();
+    bvh.SetPrimitiveBounds(moved, bounds[moved]);
+
+    const XMFLOAT3 forward(std::sin(2.0f) * 10.0f, 0.0f, std::cos(2.0f) * 10.0f);
+    bounds[hidden] = BoundingBox(forward, XMFLOAT3(0.5f, 0.5f, 0.5f));
+    bvh.SetPrimitiveBounds(hidden, bounds[hidden]);
+
+    // 노드의 박스는 Refit 전까지 그대로지만 같은 평면이라도 지난 결과를 재사용하지는 않습니다.
+    bvh.QueryFrustum(planes, visible);
+    CHECK(!bvh.LastStats().Unchanged);
+    CHECK(bvh.LastStats().NodesVisited > 0);
+
+    bvh.RefitPrimitives({ moved, hidden });
+
+    visible = QuerySorted(bvh, planes);
+    CHECK(!bvh.LastStats().Unchanged);
+    CHECK(visible == CullBruteForce(bounds, planes));
+    CHECK(std::binary_search(visible.begin(), visible.end(), hidden));
+    CHECK(!std::binary_search(visible.begin(), visible.end(), moved));
+
+    // Refit과 Build도 캐시를 비웁니다.
+    bvh.QueryFrustum(planes, visible);
+    CHECK(bvh.LastStats().Unchanged);
+    bvh.Refit();
+    bvh.QueryFrustum(planes, visible);
+    CHECK(!bvh.LastStats().Unchanged);
+    bvh.Build(bounds);
+    visible = QuerySorted(bvh, planes);
+    CHECK(!bvh.LastStats().Unchanged);
+    CHECK(visible == CullBruteForce(bounds, planes));
+}
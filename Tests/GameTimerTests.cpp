@@ -0,0 +1,172 @@
+﻿//***************************************************************************************
+// GameTimerTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "GameTimer.h"
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const std::int64_t gMs = 1000000;
+
+    // 직접 시각을 옮기는 가짜 시계입니다.
+    struct FakeClock
+    {
+        std::int64_t Time = 0;
+
+        GameTimer::NowFunction Now()
+        {
+            return [this]() { return Time; };
+        }
+    };
+
+    // 프레임마다 주어진 밀리초만큼 시계를 옮기고 Tick합니다.
+    void TickFrames(GameTimer& timer, FakeClock& clock, const std::vector<std::int64_t>& frameMs)
+    {
+        for (std::int64_t ms : frameMs)
+        {
+            clock.Time += ms * gMs;
+            timer.Tick();
+        }
+    }
+}
+
+TEST_CASE(StatsUseNearestRank)
+{
+    FakeClock clock;
+    GameTimer timer(clock.Now());
+    timer.Reset();
+
+    // 1~100ms를 섞어서 기록합니다. 정렬한 n번째 값이 n퍼센트 순위입니다.
+    std::vector<std::int64_t> frameMs;
+    for (std::int64_t i = 0; i < 100; ++i)
+        frameMs.push_back((i * 37) % 100 + 1);
+    TickFrames(timer, clock, frameMs);
+
+    GameTimer::FrameStats stats = timer.ComputeFrameStats();
+    CHECK(stats.FrameCount == 100);
+    CHECK_NEAR(stats.MinMs, 1.0f, 1e-3f);
+    CHECK_NEAR(stats.MaxMs, 100.0f, 1e-3f);
+    CHECK_NEAR(stats.AvgMs, 50.5f, 1e-3f);
+    CHECK_NEAR(stats.P50Ms, 50.0f, 1e-3f);
+    CHECK_NEAR(stats.P95Ms, 95.0f, 1e-3f);
+    CHECK_NEAR(stats.P99Ms, 99.0f, 1e-3f);
+
+    // 모집단 표준편차입니다. 1~n이면 sqrt((n^2 - 1) / 12)입니다.
+    CHECK_NEAR(stats.StdDevMs, std::sqrt(9999.0f / 12.0f), 1e-3f);
+
+    // 표본이 적으면 순위를 올림하므로 p95와 p99는 최댓값입니다.
+    timer.Reset();
+    TickFrames(timer, clock, { 30, 10, 20 });
+    stats = timer.ComputeFrameStats();
+    CHECK(stats.FrameCount == 3);
+    CHECK_NEAR(stats.P50Ms, 20.0f, 1e-3f);
+    CHECK_NEAR(stats.P95Ms, 30.0f, 1e-3f);
+    CHECK_NEAR(stats.P99Ms, 30.0f, 1e-3f);
+    CHECK_NEAR(stats.StdDevMs, std::sqrt(200.0f / 3.0f), 1e-3f);
+
+    // 기록이 없으면 모두 0입니다.
+    timer.Reset();
+    stats = timer.ComputeFrameStats();
+    CHECK(stats.FrameCount == 0);
+    CHECK(stats.MinMs == 0.0f && stats.MaxMs == 0.0f && stats.P99Ms == 0.0f && stats.StdDevMs == 0.0f);
+}
+
+TEST_CASE(RingKeepsTheMostRecentFrames)
+{
+    FakeClock clock;
+    GameTimer timer(clock.Now());
+    timer.Reset();
+
+    // 링 크기보다 10 프레임 더 기록하면 처음 10 프레임은 밀려납니다.
+    const std::uint32_t frameCount = GameTimer::FrameHistorySize + 10;
+    std::vector<std::int64_t> frameMs;
+    for (std::uint32_t i = 0; i < frameCount; ++i)
+        frameMs.push_back(i < 10 ? 500 : i % 50 + 1);
+    TickFrames(timer, clock, frameMs);
+
+    CHECK(timer.FrameCount() == frameCount);
+
+    GameTimer::FrameStats stats = timer.ComputeFrameStats();
+    CHECK(stats.FrameCount == GameTimer::FrameHistorySize);
+    CHECK_NEAR(stats.MinMs, 1.0f, 1e-3f);
+    CHECK_NEAR(stats.MaxMs, 50.0f, 1e-3f);
+
+    // CSV는 오래된 것부터이고 행 번호는 Reset 이후의 프레임 번호입니다.
+    std::stringstream csv;
+    timer.WriteFrameTimesCsv(csv);
+
+    std::string line;
+    REQUIRE(std::getline(csv, line));
+    CHECK(line == "frame,ms");
+
+    std::uint32_t rows = 0;
+    while (std::getline(csv, line))
+    {
+        const size_t comma = line.find(',');
+        REQUIRE(comma != std::string::npos);
+
+        const std::uint32_t frame = (std::uint32_t)std::stoul(line.substr(0, comma));
+        CHECK(frame == 10 + rows);
+        CHECK_NEAR(std::stof(line.substr(comma + 1)), (float)frameMs[frame], 1e-3f);
+        rows++;
+    }
+    CHECK(rows == GameTimer::FrameHistorySize);
+
+    // Reset하면 기록을 처음부터 다시 셉니다.
+    timer.Reset();
+    TickFrames(timer, clock, { 5, 6 });
+    std::stringstream csvAfterReset;
+    timer.WriteFrameTimesCsv(csvAfterReset);
+    CHECK(csvAfterReset.str() == "frame,ms\n0,5\n1,6\n");
+}
+
+TEST_CASE(PausedTimeIsNotRecorded)
+{
+    FakeClock clock;
+    GameTimer timer(clock.Now());
+    timer.Reset();
+    TickFrames(timer, clock, { 10, 10 });
+
+    // 멈춘 동안의 Tick은 기록되지 않고, 다시 시작한 뒤의 첫 프레임에도 멈춘 시간이 들어가지 않습니다.
+    timer.Stop();
+    clock.Time += 1000 * gMs;
+    timer.Tick();
+    CHECK(timer.DeltaTime() == 0.0f);
+    CHECK(timer.FrameCount() == 2);
+
+    timer.Start();
+    TickFrames(timer, clock, { 20 });
+    CHECK_NEAR(timer.DeltaTime(), 0.02f, 1e-6f);
+    CHECK_NEAR(timer.TotalTime(), 0.04f, 1e-6f);
+
+    GameTimer::FrameStats stats = timer.ComputeFrameStats();
+    CHECK(stats.FrameCount == 3);
+    CHECK_NEAR(stats.MaxMs, 20.0f, 1e-3f);
+}
+
+TEST_CASE(JsonHoldsTheStats)
+{
+    FakeClock clock;
+    GameTimer timer(clock.Now());
+    timer.Reset();
+    TickFrames(timer, clock, { 30, 10, 20 });
+
+    std::stringstream json;
+    timer.WriteFrameStatsJson(json);
+    const std::string text = json.str();
+
+    CHECK(text.front() == '{');
+    CHECK(text.find("\"frames\": 3,") != std::string::npos);
+    CHECK(text.find("\"min_ms\": 10,") != std::string::npos);
+    CHECK(text.find("\"avg_ms\": 20,") != std::string::npos);
+    CHECK(text.find("\"p50_ms\": 20,") != std::string::npos);
+    CHECK(text.find("\"p95_ms\": 30,") != std::string::npos);
+    CHECK(text.find("\"p99_ms\": 30,") != std::string::npos);
+    CHECK(text.find("\"max_ms\": 30,") != std::string::npos);
+    CHECK(text.find("\"stddev_ms\": 8.16497}") != std::string::npos);
+}
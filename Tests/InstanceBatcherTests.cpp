@@ -0,0 +1,163 @@
+﻿//***************************************************************************************
+// InstanceBatcherTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "InstanceBatcher.h"
+
+namespace
+{
+    // 지오메트리는 주소로만 구분하므로 아무 객체나 가리키면 됩니다.
+    int gBoxGeo = 0;
+    int gShapeGeo = 0;
+
+    InstanceBatchKey MakeKey(const void* geometry, std::uint32_t indexCount, std::uint32_t startIndex = 0,
+        std::int32_t baseVertex = 0, std::uint32_t topology = 4)
+    {
+        InstanceBatchKey key;
+        key.Geometry = geometry;
+        key.IndexCount = indexCount;
+        key.StartIndexLocation = startIndex;
+        key.BaseVertexLocation = baseVertex;
+        key.PrimitiveTopology = topology;
+        return key;
+    }
+}
+
+TEST_CASE(KeysCompareEveryField)
+{
+    const InstanceBatchKey key = MakeKey(&gShapeGeo, 36, 12, 8, 4);
+
+    CHECK(key == MakeKey(&gShapeGeo, 36, 12, 8, 4));
+    CHECK(!(key == MakeKey(&gBoxGeo, 36, 12, 8, 4)));
+    CHECK(!(key == MakeKey(&gShapeGeo, 30, 12, 8, 4)));
+    CHECK(!(key == MakeKey(&gShapeGeo, 36, 0, 8, 4)));
+    CHECK(!(key == MakeKey(&gShapeGeo, 36, 12, 0, 4)));
+    CHECK(!(key == MakeKey(&gShapeGeo, 36, 12, 8, 5)));
+}
+
+TEST_CASE(ItemsWithEqualKeysShareABatch)
+{
+    // 같은 지오메트리의 다른 서브메쉬(원기둥, 구)와 다른 지오메트리의 상자입니다.
+    const InstanceBatchKey cylinder = MakeKey(&gShapeGeo, 120, 0, 0);
+    const InstanceBatchKey sphere = MakeKey(&gShapeGeo, 240, 120, 40);
+    const InstanceBatchKey box = MakeKey(&gBoxGeo, 36);
+
+    InstanceBatcher batcher;
+    batcher.Add(10, cylinder);
+    batcher.Add(11, sphere);
+    batcher.Add(12, cylinder);
+    batcher.Add(3, box);
+    batcher.Add(13, sphere);
+    batcher.Add(14, cylinder);
+    batcher.Build();
+
+    // 배치는 키가 처음 나온 순서이고 인스턴스 범위는 빈틈 없이 이어집니다.
+    const std::vector<InstanceBatch>& batches = batcher.Batches();
+    REQUIRE(batches.size() == 3);
+
+    CHECK(batches[0].Key == cylinder);
+    CHECK(batches[0].FirstInstance == 0);
+    CHECK(batches[0].InstanceCount == 3);
+
+    CHECK(batches[1].Key == sphere);
+    CHECK(batches[1].FirstInstance == 3);
+    CHECK(batches[1].InstanceCount == 2);
+
+    CHECK(batches[2].Key == box);
+    CHECK(batches[2].FirstInstance == 5);
+    CHECK(batches[2].InstanceCount == 1);
+
+    // 배치 안에서는 추가한 순서를 유지합니다.
+    CHECK(batcher.Items() == std::vector<std::uint32_t>({ 10, 12, 14, 11, 13, 3 }));
+}
+
+TEST_CASE(InstanceIndexPointsBackToTheItem)
+{
+    InstanceBatcher batcher;
+    batcher.Add(7, MakeKey(&gShapeGeo, 120));
+    batcher.Add(2, MakeKey(&gBoxGeo, 36));
+    batcher.Add(5, MakeKey(&gShapeGeo, 120));
+    batcher.Add(0, MakeKey(&gBoxGeo, 36));
+    batcher.Build();
+
+    CHECK(batcher.GetInstanceIndex(7) == 0);
+    CHECK(batcher.GetInstanceIndex(5) == 1);
+    CHECK(batcher.GetInstanceIndex(2) == 2);
+    CHECK(batcher.GetInstanceIndex(0) == 3);
+
+    for (std::uint32_t instance = 0; instance < batcher.Items().size(); ++instance)
+        CHECK(batcher.GetInstanceIndex(batcher.Items()[instance]) == instance);
+
+    // 추가하지 않은 항목은 범위 안이든 밖이든 InvalidInstance입니다.
+    CHECK(batcher.GetInstanceIndex(1) == InstanceBatcher::InvalidInstance);
+    CHECK(batcher.GetInstanceIndex(6) == InstanceBatcher::InvalidInstance);
+    CHECK(batcher.GetInstanceIndex(100) == InstanceBatcher::InvalidInstance);
+}
+
+TEST_CASE(EveryItemLandsInsideItsBatch)
+{
+    // 여러 키가 섞인 많은 항목도 배치 범위 안에 정확히 한 번씩 들어갑니다.
+    int geometries[3] = {};
+    std::vector<InstanceBatchKey> keys;
+    for (const int& geo : geometries)
+    {
+        for (std::uint32_t submesh = 0; submesh < 4; ++submesh)
+            keys.push_back(MakeKey(&geo, 36 + submesh, submesh * 100));
+    }
+
+    TestRandom random(5);
+    std::vector<size_t> itemKeys;
+    InstanceBatcher batcher;
+    for (std::uint32_t item = 0; item < 1000; ++item)
+    {
+        itemKeys.push_back(random.Next() % keys.size());
+        batcher.Add(item, keys[itemKeys.back()]);
+    }
+    batcher.Build();
+
+    const std::vector<InstanceBatch>& batches = batcher.Batches();
+    CHECK(batches.size() == keys.size());
+    CHECK(batcher.Items().size() == 1000);
+
+    std::uint32_t next = 0;
+    for (const InstanceBatch& batch : batches)
+    {
+        CHECK(batch.FirstInstance == next);
+        next += batch.InstanceCount;
+
+        std::uint32_t previous = 0;
+        for (std::uint32_t instance = batch.FirstInstance; instance < batch.FirstInstance + batch.InstanceCount; ++instance)
+        {
+            const std::uint32_t item = batcher.Items()[instance];
+            CHECK(keys[itemKeys[item]] == batch.Key);
+            CHECK(batcher.GetInstanceIndex(item) == instance);
+            CHECK(instance == batch.FirstInstance || item > previous);
+            previous = item;
+        }
+    }
+    CHECK(next == 1000);
+}
+
+TEST_CASE(ClearAndRebuildStartsOver)
+{
+    InstanceBatcher batcher;
+    batcher.Add(4, MakeKey(&gBoxGeo, 36));
+    batcher.Build();
+    CHECK(batcher.GetInstanceIndex(4) == 0);
+
+    batcher.Clear();
+    CHECK(batcher.Batches().empty());
+    CHECK(batcher.Items().empty());
+    CHECK(batcher.GetInstanceIndex(4) == InstanceBatcher::InvalidInstance);
+
+    batcher.Build();
+    CHECK(batcher.Batches().empty());
+
+    // 다시 만들면 이전 결과는 남지 않습니다.
+    batcher.Add(1, MakeKey(&gShapeGeo, 120));
+    batcher.Build();
+    REQUIRE(batcher.Batches().size() == 1);
+    CHECK(batcher.GetInstanceIndex(1) == 0);
+    CHECK(batcher.GetInstanceIndex(4) == InstanceBatcher::InvalidInstance);
+}
@@ -0,0 +1,173 @@
+﻿//***************************************************************************************
+// JobSystemBenchmark.cpp
+//
+// Measures the JobSystem itself rather than a workload that uses it.  The empty-job
+// case reports the fixed cost of Run plus Wait per job, once for jobs submitted by the
+// main thread through the shared queue and once for jobs a worker pushes onto its own
+// deque.  The ParallelFor case runs the same compute-bound loop with a growing number
+// of workers and reports the speedup over running it on the calling thread alone.
+// The imbalance case has one worker spawn tasks of which a few are much longer than
+// the rest, so the others only help by stealing.  Results must match a serial run.
+//***************************************************************************************
+
+#include "BenchmarkHarness.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    // 결과가 실행 순서와 무관하게 같은 작은 계산입니다.
+    float Work(std::uint32_t i, std::uint32_t iterations)
+    {
+        float x = (float)(i % 1024);
+        for (std::uint32_t k = 0; k < iterations; ++k)
+            x = x * 0.999f + std::sqrt(x + (float)k);
+        return x;
+    }
+
+    // main이 Wait로 가져가지 않도록 워커가 부모 작업을 실행할 때까지 기다립니다.
+    void RunOnWorker(JobSystem& jobs, JobSystem::JobFunction job)
+    {
+        JobSystem::Counter counter;
+        jobs.Run(std::move(job), &counter);
+        while (!counter.IsDone())
+            std::this_thread::yield();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options(argc, argv);
+
+    const std::uint32_t hardwareThreads = std::max<std::uint32_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<std::uint32_t> workerCounts = { 0, 1, 3 };
+    for (std::uint32_t w = 7; w < hardwareThreads; w = 2 * w + 1)
+        workerCounts.push_back(w);
+    if (hardwareThreads - 1 > workerCounts.back())
+        workerCounts.push_back(hardwareThreads - 1);
+
+    const std::uint32_t emptyJobs = options.Quick ? 10000 : 200000;
+    const std::uint32_t forCount = options.Quick ? 1 << 14 : 1 << 20;
+    const std::uint32_t forIterations = 32;
+    const std::uint32_t imbalancedTasks = 256;
+    const std::uint32_t lightIterations = options.Quick ? 200 : 2000;
+
+    bool failed = false;
+    std::printf("%u hardware threads\n", hardwareThreads);
+
+    // 빈 작업 하나를 실행하고 기다리는 비용입니다.
+    std::printf("\nempty jobs (%u per batch)\n", emptyJobs);
+    std::printf("%8s %16s %16s %10s\n", "workers", "shared ns/job", "deque ns/job", "stolen");
+
+    for (std::uint32_t workers : workerCounts)
+    {
+        JobSystem jobs(workers);
+        std::atomic<std::uint32_t> executed(0);
+
+        const double sharedMs = MeasureMedianMs(options.Repeats, [&](int)
+        {
+            JobSystem::Counter counter;
+            for (std::uint32_t i = 0; i < emptyJobs; ++i)
+                jobs.Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            jobs.Wait(counter);
+        });
+
+        const std::uint64_t stolenBefore = jobs.GetStats().JobsStolen;
+        const double dequeMs = MeasureMedianMs(options.Repeats, [&](int)
+        {
+            RunOnWorker(jobs, [&]()
+                {
+                    JobSystem::Counter counter;
+                    for (std::uint32_t i = 0; i < emptyJobs; ++i)
+                        jobs.Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+                    jobs.Wait(counter);
+                });
+        });
+        const std::uint64_t stolen = jobs.GetStats().JobsStolen - stolenBefore;
+
+        BenchmarkCheck(executed == 2ull * options.Repeats * emptyJobs, "empty jobs lost", failed);
+
+        std::printf("%8u %16.1f %16.1f %10.1f\n", workers, sharedMs * 1e6 / emptyJobs, dequeMs * 1e6 / emptyJobs,
+            (double)stolen / options.Repeats);
+    }
+
+    // 계산량이 고른 루프를 워커 수를 늘려 가며 나눕니다.
+    std::vector<float> reference(forCount);
+    for (std::uint32_t i = 0; i < forCount; ++i)
+        reference[i] = Work(i, forIterations);
+
+    std::printf("\nParallelFor (%u items, %u iterations each)\n", forCount, forIterations);
+    std::printf("%8s %12s %10s %10s\n", "workers", "ms", "speedup", "splits");
+
+    double baseMs = 0.0;
+    for (std::uint32_t workers : workerCounts)
+    {
+        JobSystem jobs(workers);
+        std::vector<float> output(forCount);
+
+        const double ms = MeasureMedianMs(options.Repeats, [&](int)
+        {
+            jobs.ParallelFor(0u, forCount, [&](std::uint32_t i) { output[i] = Work(i, forIterations); });
+        });
+
+        if (workers == 0)
+            baseMs = ms;
+
+        BenchmarkCheck(output == reference, "ParallelFor result differs from the serial loop", failed);
+
+        std::printf("%8u %12.3f %10.2f %10.1f\n", workers, ms, baseMs / ms,
+            (double)jobs.GetStats().RangeSplits / options.Repeats);
+    }
+
+    // 16개 중 하나가 64배 긴 작업들을 한 워커가 모두 만듭니다. 다른 워커들은 훔쳐야만 도울 수 있습니다.
+    auto taskIterations = [&](std::uint32_t task)
+    {
+        return task % 16 == 0 ? 64 * lightIterations : lightIterations;
+    };
+
+    float imbalancedReference = 0.0f;
+    std::vector<float> taskResults(imbalancedTasks);
+    for (std::uint32_t t = 0; t < imbalancedTasks; ++t)
+        imbalancedReference += Work(t, taskIterations(t));
+
+    std::printf("\nimbalanced tasks (%u tasks, every 16th is 64x longer)\n", imbalancedTasks);
+    std::printf("%8s %12s %10s %10s %12s\n", "workers", "ms", "speedup", "stolen", "efficiency");
+
+    double serialMs = 0.0;
+    for (std::uint32_t workers : workerCounts)
+    {
+        if (workers == 0)
+            continue;
+
+        JobSystem jobs(workers);
+
+        const double ms = MeasureMedianMs(options.Repeats, [&](int)
+        {
+            RunOnWorker(jobs, [&]()
+                {
+                    JobSystem::Counter counter;
+                    for (std::uint32_t t = 0; t < imbalancedTasks; ++t)
+                        jobs.Run([&, t]() { taskResults[t] = Work(t, taskIterations(t)); }, &counter);
+                    jobs.Wait(counter);
+                });
+        });
+
+        if (workers == 1)
+            serialMs = ms;
+
+        float total = 0.0f;
+        for (float r : taskResults)
+            total += r;
+        BenchmarkCheck(total == imbalancedReference, "imbalanced tasks result differs from the serial loop", failed);
+
+        // 효율은 한 워커일 때의 시간을 워커 수와 사용할 수 있는 코어 수 중 작은 것으로 나눈 값과 비교합니다.
+        const double speedup = serialMs / ms;
+        const double efficiency = speedup / std::min<std::uint32_t>(workers, hardwareThreads);
+        std::printf("%8u %12.3f %10.2f %10.1f %11.0f%%\n", workers, ms, speedup,
+            (double)jobs.GetStats().JobsStolen / options.Repeats, efficiency * 100.0);
+    }
+
+    return failed ? 1 : 0;
+}
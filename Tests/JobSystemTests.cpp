@@ -0,0 +1,250 @@
+﻿//***************************************************************************************
+// JobSystemTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // 워커가 없는 경우, 하나인 경우, 코어 수보다 많은 경우를 모두 확인합니다.
+    const std::uint32_t gWorkerCounts[3] = { 0, 1, 3 };
+}
+
+TEST_CASE(WaitReturnsAfterEveryJob)
+{
+    for (std::uint32_t workers : gWorkerCounts)
+    {
+        JobSystem jobs(workers);
+        CHECK(jobs.WorkerCount() == workers);
+
+        std::atomic<std::uint32_t> executed(0);
+        JobSystem::Counter counter;
+        CHECK(counter.IsDone());
+
+        for (int i = 0; i < 1000; ++i)
+            jobs.Run([&executed]() { executed++; }, &counter);
+
+        jobs.Wait(counter);
+        CHECK(counter.IsDone());
+        CHECK(executed == 1000);
+
+        // 카운터는 Wait가 반환된 뒤에 다시 쓸 수 있습니다.
+        for (int i = 0; i < 10; ++i)
+            jobs.Run([&executed]() { executed++; }, &counter);
+
+        jobs.Wait(counter);
+        CHECK(executed == 1010);
+    }
+}
+
+TEST_CASE(WaitInsideAJobRunsOtherJobs)
+{
+    // 모든 워커가 자식 작업을 기다리는 부모 작업을 실행하고 있어도 진행되어야 합니다.
+    for (std::uint32_t workers : gWorkerCounts)
+    {
+        JobSystem jobs(workers);
+
+        std::atomic<std::uint32_t> children(0);
+        JobSystem::Counter parents;
+        for (int p = 0; p < 8; ++p)
+        {
+            jobs.Run([&jobs, &children]()
+                {
+                    JobSystem::Counter counter;
+                    for (int c = 0; c < 50; ++c)
+                        jobs.Run([&children]() { children++; }, &counter);
+
+                    jobs.Wait(counter);
+                }, &parents);
+        }
+
+        jobs.Wait(parents);
+        CHECK(children == 400);
+    }
+}
+
+TEST_CASE(RunAfterWaitsForTheDependency)
+{
+    for (std::uint32_t workers : { 1u, 3u })
+    {
+        JobSystem jobs(workers);
+
+        // 앞 단계의 작업들은 main이 열어 줄 때까지 끝나지 않습니다.
+        std::atomic<bool> open(false);
+        std::atomic<std::uint32_t> firstDone(0);
+        JobSystem::Counter first;
+        for (int i = 0; i < 4; ++i)
+        {
+            jobs.Run([&]()
+                {
+                    while (!open.load())
+                        std::this_thread::yield();
+                    firstDone++;
+                }, &first);
+        }
+
+        std::atomic<std::uint32_t> seenByContinuation(~0u);
+        JobSystem::Counter second;
+        jobs.RunAfter(first, [&]() { seenByContinuation = firstDone.load(); }, &second);
+
+        // 이어지는 작업에 대한 카운터는 등록하자마자 끝나지 않은 상태입니다.
+        CHECK(!second.IsDone());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        CHECK(seenByContinuation == ~0u);
+
+        open.store(true);
+        jobs.Wait(second);
+        CHECK(seenByContinuation == 4);
+        CHECK(first.IsDone());
+    }
+}
+
+TEST_CASE(RunAfterChainsRunInOrder)
+{
+    for (std::uint32_t workers : gWorkerCounts)
+    {
+        JobSystem jobs(workers);
+
+        std::mutex mutex;
+        std::vector<int> order;
+        auto record = [&](int step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(step);
+        };
+
+        JobSystem::Counter stages[4];
+        jobs.Run([&]() { record(0); }, &stages[0]);
+        for (int s = 1; s < 4; ++s)
+            jobs.RunAfter(stages[s - 1], [&record, s]() { record(s); }, &stages[s]);
+
+        jobs.Wait(stages[3]);
+        CHECK(order == std::vector<int>({ 0, 1, 2, 3 }));
+
+        // 이미 끝난 카운터 뒤에 등록한 작업은 바로 시작합니다.
+        jobs.RunAfter(stages[0], [&]() { record(4); }, &stages[1]);
+        jobs.Wait(stages[1]);
+        CHECK(order.size() == 5 && order.back() == 4);
+    }
+}
+
+TEST_CASE(ParallelForVisitsEveryIndexOnce)
+{
+    const std::uint32_t counts[] = { 1, 7, 1000, 100000 };
+    const std::uint32_t grains[] = { 0, 1, 64 };
+
+    for (std::uint32_t workers : gWorkerCounts)
+    {
+        JobSystem jobs(workers);
+
+        for (std::uint32_t count : counts)
+        {
+            for (std::uint32_t grain : grains)
+            {
+                std::unique_ptr<std::atomic<std::uint8_t>[]> visits(new std::atomic<std::uint8_t>[count]);
+                for (std::uint32_t i = 0; i < count; ++i)
+                    visits[i] = 0;
+
+                jobs.ParallelFor(0u, count, [&](std::uint32_t i) { visits[i]++; }, grain);
+
+                std::uint32_t wrong = 0;
+                for (std::uint32_t i = 0; i < count; ++i)
+                    wrong += visits[i] != 1 ? 1 : 0;
+                CHECK(wrong == 0);
+            }
+        }
+
+        // 0에서 시작하지 않는 부호 있는 범위와 빈 범위입니다.
+        std::atomic<int> sum(0);
+        jobs.ParallelFor(-50, 50, [&](int i) { sum += i; }, 4);
+        CHECK(sum == -50);
+
+        bool called = false;
+        jobs.ParallelFor(10, 10, [&](int) { called = true; });
+        CHECK(!called);
+    }
+}
+
+TEST_CASE(IdleWorkersStealFromABusyWorker)
+{
+    JobSystem jobs(3);
+
+    // 한 워커가 자기 덱에 자식 작업들을 쌓으면 잠들어 있던 워커들이 깨어나서 위쪽에서 훔칩니다.
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    JobSystem::Counter parent;
+    jobs.Run([&]()
+        {
+            JobSystem::Counter children;
+            for (int i = 0; i < 64; ++i)
+            {
+                jobs.Run([&]()
+                    {
+                        std::this_thread::sleep_for(std::chrono::microseconds(500));
+                        std::lock_guard<std::mutex> lock(mutex);
+                        threads.insert(std::this_thread::get_id());
+                    }, &children);
+            }
+            jobs.Wait(children);
+        }, &parent);
+
+    // main이 Wait로 부모 작업을 가져가면 자식들이 공유 큐로 가므로 워커가 가져갈 때까지 기다리기만 합니다.
+    while (!parent.IsDone())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    CHECK(jobs.GetStats().JobsStolen > 0);
+    CHECK(threads.size() > 1);
+    CHECK(jobs.GetStats().JobsExecuted >= 64);
+}
+
+TEST_CASE(FullDequeRunsJobsInline)
+{
+    JobSystem jobs(1);
+
+    // 워커 덱의 용량보다 많이 쌓아도 작업을 잃지 않습니다.
+    std::atomic<std::uint32_t> executed(0);
+    JobSystem::Counter parent;
+    jobs.Run([&]()
+        {
+            JobSystem::Counter children;
+            for (int i = 0; i < 6000; ++i)
+                jobs.Run([&executed]() { executed++; }, &children);
+            jobs.Wait(children);
+        }, &parent);
+
+    // 부모 작업이 워커의 덱에 자식들을 쌓도록 워커가 실행하게 합니다.
+    while (!parent.IsDone())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    CHECK(executed == 6000);
+}
+
+TEST_CASE(ScratchIsPerThread)
+{
+    JobSystem jobs(3);
+
+    // 작업 안에서 할당한 스크래치 메모리는 다른 스레드의 작업과 겹치지 않습니다.
+    std::atomic<std::uint32_t> corrupted(0);
+    jobs.ParallelFor(0, 256, [&](int i)
+        {
+            ScratchArena::Scope scope(jobs.Scratch());
+            std::uint32_t* data = jobs.Scratch().AllocateArray<std::uint32_t>(1024);
+            for (std::uint32_t k = 0; k < 1024; ++k)
+                data[k] = (std::uint32_t)i;
+
+            std::this_thread::yield();
+            for (std::uint32_t k = 0; k < 1024; ++k)
+                corrupted += data[k] != (std::uint32_t)i ? 1 : 0;
+        }, 1);
+
+    CHECK(corrupted == 0);
+}
@@ -0,0 +1,206 @@
+﻿//***************************************************************************************
+// MipGeneratorTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "MipGenerator.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // 텍셀마다 검정과 흰색이 번갈아 나오는 체커입니다. 알파도 같은 모양입니다.
+    RgbaImage MakeChecker(std::uint32_t width, std::uint32_t height)
+    {
+        RgbaImage image;
+        image.Resize(width, height);
+        for (std::uint32_t y = 0; y < height; ++y)
+        {
+            for (std::uint32_t x = 0; x < width; ++x)
+            {
+                std::uint8_t* p = image.GetPixel(x, y);
+                const std::uint8_t v = ((x + y) % 2) ? 255 : 0;
+                p[0] = p[1] = p[2] = p[3] = v;
+            }
+        }
+        return image;
+    }
+
+    // 알파가 물결 모양으로 오르내리는 컷아웃입니다. 봉우리 주변만 기준을 넘습니다.
+    RgbaImage MakeCutout(std::uint32_t size)
+    {
+        RgbaImage image;
+        image.Resize(size, size);
+        for (std::uint32_t y = 0; y < size; ++y)
+        {
+            for (std::uint32_t x = 0; x < size; ++x)
+            {
+                std::uint8_t* p = image.GetPixel(x, y);
+                p[0] = 160;
+                p[1] = 160;
+                p[2] = 170;
+                const float alpha = 0.5f + 0.5f * std::sin(0.4f * x) * std::sin(0.55f * y);
+                p[3] = (std::uint8_t)(alpha * 255.0f + 0.5f);
+            }
+        }
+        return image;
+    }
+
+    // 가장자리를 뺀 안쪽 텍셀들이 모두 value에서 tolerance 이내인지 확인합니다.
+    bool InteriorIsNear(const RgbaImage& image, int channel, int value, int tolerance, std::uint32_t border)
+    {
+        for (std::uint32_t y = border; y + border < image.Height; ++y)
+        {
+            for (std::uint32_t x = border; x + border < image.Width; ++x)
+            {
+                const int v = image.GetPixel(x, y)[channel];
+                if (v < value - tolerance || v > value + tolerance)
+                    return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE(MipCountGoesDownToOneTexel)
+{
+    CHECK(MipGenerator::GetMipCount(1, 1) == 1);
+    CHECK(MipGenerator::GetMipCount(2, 1) == 2);
+    CHECK(MipGenerator::GetMipCount(256, 256) == 9);
+    CHECK(MipGenerator::GetMipCount(512, 4) == 10);
+    CHECK(MipGenerator::GetMipCount(37, 10) == 6);
+}
+
+TEST_CASE(MipDimensionsHalveAndRoundDown)
+{
+    const RgbaImage source = MakeChecker(37, 10);
+
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        MipGenerationOptions options;
+        options.Filter = filter;
+
+        std::vector<RgbaImage> mipChain;
+        MipGenerator(options).Generate(source, mipChain);
+
+        // 37x10, 18x5, 9x2, 4x1, 2x1, 1x1
+        REQUIRE(mipChain.size() == 6);
+        CHECK(mipChain[0].Pixels == source.Pixels);
+        for (std::uint32_t mip = 0; mip < mipChain.size(); ++mip)
+        {
+            CHECK(mipChain[mip].Width == std::max<std::uint32_t>(1, 37 >> mip));
+            CHECK(mipChain[mip].Height == std::max<std::uint32_t>(1, 10 >> mip));
+            CHECK(mipChain[mip].Pixels.size() == (size_t)mipChain[mip].Width * mipChain[mip].Height * 4);
+        }
+    }
+
+    // 요청한 수만큼만 만들고, 전체보다 많이 요청하면 1x1에서 멈춥니다.
+    std::vector<RgbaImage> mipChain;
+    MipGenerator().Generate(source, mipChain, 3);
+    CHECK(mipChain.size() == 3);
+    MipGenerator().Generate(source, mipChain, 20);
+    CHECK(mipChain.size() == 6);
+    MipGenerator().Generate(MakeChecker(1, 1), mipChain);
+    CHECK(mipChain.size() == 1);
+}
+
+TEST_CASE(SrgbTexelsAreFilteredInLinearSpace)
+{
+    const RgbaImage source = MakeChecker(16, 16);
+
+    // 선형 공간에서 0과 1의 평균 0.5를 sRGB로 바꾸면 188입니다. 감마 공간에서 평균하면 128이 됩니다.
+    MipGenerationOptions options;
+    options.Srgb = true;
+
+    std::vector<RgbaImage> mipChain;
+    MipGenerator(options).Generate(source, mipChain, 2);
+    CHECK(InteriorIsNear(mipChain[1], 0, 188, 0, 0));
+    CHECK(InteriorIsNear(mipChain[1], 2, 188, 0, 0));
+
+    // 알파는 항상 선형입니다.
+    CHECK(InteriorIsNear(mipChain[1], 3, 128, 0, 0));
+
+    options.Srgb = false;
+    MipGenerator(options).Generate(source, mipChain, 2);
+    CHECK(InteriorIsNear(mipChain[1], 0, 128, 0, 0));
+    CHECK(InteriorIsNear(mipChain[1], 3, 128, 0, 0));
+
+    // 카이저 필터도 평균은 같습니다. 가장자리는 넓은 필터가 반복된 텍셀을 읽으므로 뺍니다.
+    options.Srgb = true;
+    options.Filter = MipFilter::Kaiser;
+    MipGenerator(options).Generate(source, mipChain, 2);
+    CHECK(InteriorIsNear(mipChain[1], 0, 188, 2, 2));
+}
+
+TEST_CASE(AlphaCoverageIsMeasuredAgainstTheReference)
+{
+    RgbaImage image;
+    image.Resize(2, 2);
+    const std::uint8_t alphas[4] = { 0, 100, 128, 255 };
+    for (int i = 0; i < 4; ++i)
+        image.Pixels[i * 4 + 3] = alphas[i];
+
+    CHECK_NEAR(MipGenerator::ComputeAlphaCoverage(image, 0.0f), 1.0f, 1e-6f);
+    CHECK_NEAR(MipGenerator::ComputeAlphaCoverage(image, 0.1f), 0.75f, 1e-6f);
+    CHECK_NEAR(MipGenerator::ComputeAlphaCoverage(image, 0.5f), 0.5f, 1e-6f);
+    CHECK_NEAR(MipGenerator::ComputeAlphaCoverage(image, 1.0f), 0.25f, 1e-6f);
+    CHECK(MipGenerator::ComputeAlphaCoverage(RgbaImage(), 0.5f) == 0.0f);
+}
+
+TEST_CASE(AlphaCoverageIsPreservedAcrossMips)
+{
+    const RgbaImage cutout = MakeCutout(64);
+    const float alphaReference = 0.8f;
+    const float topCoverage = MipGenerator::ComputeAlphaCoverage(cutout, alphaReference);
+    REQUIRE(topCoverage > 0.1f && topCoverage < 0.2f);
+
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        MipGenerationOptions options;
+        options.Filter = filter;
+        options.AlphaReference = alphaReference;
+
+        // 그냥 평균하면 봉우리가 깎여서 커버리지가 줄다가 8x8에서 사라집니다.
+        std::vector<RgbaImage> plain;
+        MipGenerator(options).Generate(cutout, plain);
+        CHECK(MipGenerator::ComputeAlphaCoverage(plain[2], alphaReference) < 0.75f * topCoverage);
+        CHECK(MipGenerator::ComputeAlphaCoverage(plain[3], alphaReference) == 0.0f);
+
+        options.PreserveAlphaCoverage = true;
+        std::vector<RgbaImage> preserved;
+        MipGenerator(options).Generate(cutout, preserved);
+        REQUIRE(preserved.size() == plain.size());
+
+        // 텍셀이 충분한 밉은 최상위 밉의 커버리지를 따라가고, 색은 바뀌지 않습니다.
+        for (std::uint32_t mip = 1; preserved[mip].Width >= 16; ++mip)
+        {
+            const float coverage = MipGenerator::ComputeAlphaCoverage(preserved[mip], alphaReference);
+            CHECK_NEAR(coverage, topCoverage, 0.01f);
+            CHECK(InteriorIsNear(preserved[mip], 0, 160, 0, 0));
+        }
+
+        // 텍셀이 몇 개 없는 밉은 커버리지를 정확히 맞출 수 없지만 사라지지는 않습니다.
+        for (const RgbaImage& mip : preserved)
+            CHECK(MipGenerator::ComputeAlphaCoverage(mip, alphaReference) > 0.0f);
+    }
+}
+
+TEST_CASE(ArraySlicesGetTheirOwnChains)
+{
+    std::vector<RgbaImage> slices = { MakeChecker(8, 8), MakeCutout(8), MakeChecker(8, 8) };
+
+    std::vector<std::vector<RgbaImage>> mipChains;
+    MipGenerator().GenerateArray(slices, mipChains);
+
+    REQUIRE(mipChains.size() == 3);
+    for (size_t i = 0; i < slices.size(); ++i)
+    {
+        REQUIRE(mipChains[i].size() == 4);
+        CHECK(mipChains[i][0].Pixels == slices[i].Pixels);
+        CHECK(mipChains[i][3].Width == 1 && mipChains[i][3].Height == 1);
+    }
+
+    // 같은 입력은 같은 결과를 냅니다.
+    for (size_t mip = 0; mip < 4; ++mip)
+        CHECK(mipChains[0][mip].Pixels == mipChains[2][mip].Pixels);
+}
@@ -0,0 +1,122 @@
+﻿//***************************************************************************************
+// OcclusionCullerBenchmark.cpp
+//
+// Measures the three phases of software occlusion culling on a city-like scene: a grid
+// of box buildings is rasterized as occluders, the HiZ pyramid is built, and then a
+// large number of small instance boxes scattered between the buildings are tested.
+// The camera stands at street level so the nearer buildings hide most of the scene.
+//***************************************************************************************
+
+#include "BenchmarkHarness.h"
+#include "OcclusionCuller.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+namespace
+{
+    struct BoxMesh
+    {
+        XMFLOAT3 Positions[8];
+        std::uint16_t Indices[36];
+    };
+
+    BoxMesh MakeBoxMesh()
+    {
+        BoxMesh mesh;
+
+        BoundingBox unit(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+        unit.GetCorners(mesh.Positions);
+
+        // BoundingBox의 모서리 순서는 앞면(z = -1) 네 개, 뒷면(z = +1) 네 개입니다.
+        const std::uint16_t indices[36] =
+        {
+            0, 1, 2, 0, 2, 3,   4, 6, 5, 4, 7, 6,
+            0, 4, 5, 0, 5, 1,   3, 2, 6, 3, 6, 7,
+            1, 5, 6, 1, 6, 2,   0, 3, 7, 0, 7, 4
+        };
+        std::copy(indices, indices + 36, mesh.Indices);
+
+        return mesh;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options(argc, argv);
+
+    std::vector<std::uint32_t> testCounts = { 10000, 100000, 1000000 };
+    if (options.Quick)
+        testCounts.resize(1);
+
+    const BoxMesh box = MakeBoxMesh();
+
+    // 20x20 블록의 건물들입니다.
+    std::vector<XMFLOAT4X4> buildings;
+    TestRandom random(5);
+    for (int gz = 0; gz < 20; ++gz)
+    {
+        for (int gx = -10; gx < 10; ++gx)
+        {
+            const float height = random.Range(5.0f, 30.0f);
+            XMFLOAT4X4 world;
+            XMStoreFloat4x4(&world, XMMatrixScaling(4.0f, height, 4.0f) *
+                XMMatrixTranslation(gx * 12.0f + 6.0f, height, 10.0f + gz * 12.0f));
+            buildings.push_back(world);
+        }
+    }
+
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 2.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 2.0f, 1.0f, 1.0f),
+        XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 2.0f, 1.0f, 500.0f);
+    XMMATRIX viewProj = view * proj;
+
+    OcclusionCuller culler;
+
+    const double rasterMs = MeasureMedianMs(options.Repeats, [&](int)
+    {
+        culler.BeginFrame(viewProj);
+        for (const XMFLOAT4X4& world : buildings)
+            culler.RasterizeOccluder(box.Positions, sizeof(XMFLOAT3), 8, box.Indices, 36, XMLoadFloat4x4(&world));
+    });
+
+    const std::uint32_t triangles = culler.LastStats().TrianglesRasterized;
+
+    const double hizMs = MeasureMedianMs(options.Repeats, [&](int)
+    {
+        culler.BuildHierarchy();
+    });
+
+    bool failed = false;
+
+    std::printf("occluders %u, triangles rasterized %u, raster %.3f ms, HiZ %.3f ms\n",
+        (std::uint32_t)buildings.size(), triangles, rasterMs, hizMs);
+    std::printf("%10s %12s %12s %12s\n", "boxes", "culled", "test ms", "ns / box");
+
+    for (std::uint32_t count : testCounts)
+    {
+        // 건물 사이의 거리에 작은 물체들을 흩어 놓습니다.
+        std::vector<BoundingBox> boxes(count);
+        for (BoundingBox& b : boxes)
+        {
+            b.Center = XMFLOAT3(random.Range(-120.0f, 120.0f), random.Range(0.5f, 3.0f), random.Range(5.0f, 250.0f));
+            b.Extents = XMFLOAT3(0.5f, 0.5f, 0.5f);
+        }
+
+        // 화면 밖의 박스도 false이므로 가려진 박스와 함께 셉니다.
+        std::uint32_t occluded = 0;
+        const double testMs = MeasureMedianMs(options.Repeats, [&](int)
+        {
+            occluded = 0;
+            for (const BoundingBox& b : boxes)
+                occluded += culler.IsVisible(b) ? 0 : 1;
+        });
+
+        // 카메라 바로 앞의 거리에는 가리는 건물이 없으므로 모든 물체가 가려질 수는 없습니다.
+        BenchmarkCheck(occluded > 0 && occluded < count, "unexpected occlusion ratio", failed);
+
+        std::printf("%10u %12u %12.3f %12.1f\n", count, occluded, testMs, testMs * 1e6 / count);
+    }
+
+    return failed ? 1 : 0;
+}
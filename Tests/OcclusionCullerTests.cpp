@@ -0,0 +1,250 @@
+﻿//***************************************************************************************
+// OcclusionCullerTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    const float gNear = 1.0f;
+    const float gFar = 100.0f;
+
+    // 원점에서 +z를 바라보는 카메라입니다. 256x128 버퍼에 맞춰 종횡비는 2입니다.
+    XMMATRIX CameraViewProj()
+    {
+        return XMMatrixPerspectiveFovLH(0.5f * XM_PI, 2.0f, gNear, gFar);
+    }
+
+    // 뷰 공간 깊이 z의 D3D 깊이 값입니다.
+    float DepthAt(float z)
+    {
+        return gFar / (gFar - gNear) * (1.0f - gNear / z);
+    }
+
+    // z 평면 위의 [x0, x1] x [y0, y1] 사각형입니다.
+    void DrawQuad(OcclusionCuller& culler, float x0, float y0, float x1, float y1, float z, bool flip = false)
+    {
+        const XMFLOAT3 positions[4] =
+        {
+            XMFLOAT3(x0, y0, z), XMFLOAT3(x0, y1, z), XMFLOAT3(x1, y1, z), XMFLOAT3(x1, y0, z)
+        };
+        const std::uint32_t front[6] = { 0, 1, 2, 0, 2, 3 };
+        const std::uint32_t back[6] = { 0, 2, 1, 0, 3, 2 };
+
+        culler.RasterizeOccluder(positions, sizeof(XMFLOAT3), 4, flip ? back : front, 6, XMMatrixIdentity());
+    }
+
+    BoundingBox MakeBox(float x, float y, float z, float extent)
+    {
+        return BoundingBox(XMFLOAT3(x, y, z), XMFLOAT3(extent, extent, extent));
+    }
+}
+
+TEST_CASE(EmptyBufferKeepsEverythingVisible)
+{
+    OcclusionCuller culler(250, 128);
+
+    // 너비는 4의 배수로 올라갑니다.
+    CHECK(culler.Width() == 252);
+    CHECK(culler.Height() == 128);
+
+    culler.BeginFrame(CameraViewProj());
+    culler.BuildHierarchy();
+
+    CHECK(culler.IsVisible(MakeBox(0.0f, 0.0f, 50.0f, 1.0f)));
+    CHECK(culler.IsVisible(MakeBox(5.0f, -3.0f, 90.0f, 0.1f)));
+    CHECK(culler.LastStats().Occluded == 0);
+}
+
+TEST_CASE(PyramidLevelsHalveAndKeepTheFarthestDepth)
+{
+    OcclusionCuller culler(256, 128);
+    culler.BeginFrame(CameraViewProj());
+
+    // 여러 깊이의 삼각형들로 깊이 버퍼를 채웁니다.
+    TestRandom random(3);
+    for (int i = 0; i < 20; ++i)
+    {
+        const float z = random.Range(5.0f, 60.0f);
+        XMFLOAT3 positions[3];
+        for (XMFLOAT3& p : positions)
+            p = XMFLOAT3(random.Range(-2.0f * z, 2.0f * z), random.Range(-z, z), z);
+
+        const std::uint16_t indices[3] = { 0, 1, 2 };
+        culler.RasterizeOccluder(positions, sizeof(XMFLOAT3), 3, indices, 3, XMMatrixIdentity());
+    }
+    culler.BuildHierarchy();
+
+    REQUIRE(culler.LevelCount() >= 8);
+    CHECK(culler.GetLevelWidth(culler.LevelCount() - 1) == 1);
+    CHECK(culler.GetLevelHeight(culler.LevelCount() - 1) == 1);
+
+    for (std::uint32_t level = 1; level < culler.LevelCount(); ++level)
+    {
+        const std::uint32_t srcW = culler.GetLevelWidth(level - 1);
+        const std::uint32_t srcH = culler.GetLevelHeight(level - 1);
+        const std::uint32_t w = culler.GetLevelWidth(level);
+        const std::uint32_t h = culler.GetLevelHeight(level);
+        CHECK(w == (srcW + 1) / 2);
+        CHECK(h == (srcH + 1) / 2);
+
+        const std::vector<float>& src = culler.GetLevel(level - 1);
+        const std::vector<float>& dst = culler.GetLevel(level);
+        for (std::uint32_t y = 0; y < h; ++y)
+        {
+            for (std::uint32_t x = 0; x < w; ++x)
+            {
+                float expected = 0.0f;
+                for (std::uint32_t sy = 2 * y; sy <= std::min<std::uint32_t>(2 * y + 1, srcH - 1); ++sy)
+                    for (std::uint32_t sx = 2 * x; sx <= std::min<std::uint32_t>(2 * x + 1, srcW - 1); ++sx)
+                        expected = std::max<float>(expected, src[(size_t)sy * srcW + sx]);
+
+                CHECK(dst[(size_t)y * w + x] == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE(RasterizedDepthMatchesProjection)
+{
+    OcclusionCuller culler(256, 128);
+    culler.BeginFrame(CameraViewProj());
+
+    // 화면 가운데의 절반을 덮는 사각형입니다. fovY가 90도이므로 z에서 화면 높이의 절반은 z입니다.
+    const float z = 20.0f;
+    DrawQuad(culler, -z, -0.5f * z, z, 0.5f * z, z);
+
+    const std::vector<float>& depth = culler.GetLevel(0);
+    CHECK_NEAR(depth[64 * 256 + 128], DepthAt(z), 1e-4f);
+    CHECK_NEAR(depth[40 * 256 + 70], DepthAt(z), 1e-4f);
+
+    // 사각형 밖은 지운 깊이 그대로입니다.
+    CHECK(depth[10 * 256 + 128] == 1.0f);
+    CHECK(depth[120 * 256 + 5] == 1.0f);
+    CHECK(culler.LastStats().TrianglesRasterized == 2);
+}
+
+TEST_CASE(FullScreenOccluderHidesBoxesBehindIt)
+{
+    OcclusionCuller culler;
+    culler.BeginFrame(CameraViewProj());
+
+    // 화면 전체를 덮는 벽입니다.
+    DrawQuad(culler, -100.0f, -100.0f, 100.0f, 100.0f, 10.0f);
+    culler.BuildHierarchy();
+
+    CHECK(!culler.IsVisible(MakeBox(0.0f, 0.0f, 20.0f, 1.0f)));
+    CHECK(!culler.IsVisible(MakeBox(-15.0f, 6.0f, 40.0f, 3.0f)));
+
+    // 벽 앞에 있거나 벽을 뚫고 나온 박스는 보입니다.
+    CHECK(culler.IsVisible(MakeBox(0.0f, 0.0f, 5.0f, 1.0f)));
+    CHECK(culler.IsVisible(MakeBox(0.0f, 0.0f, 10.5f, 1.0f)));
+
+    // 근평면에 걸친 박스는 항상 보이는 것으로 취급합니다.
+    CHECK(culler.IsVisible(MakeBox(0.0f, 0.0f, 1.0f, 2.0f)));
+
+    CHECK(culler.LastStats().Tests == 5);
+    CHECK(culler.LastStats().Occluded == 2);
+}
+
+TEST_CASE(PartialOccluderOnlyHidesCoveredBoxes)
+{
+    OcclusionCuller culler;
+    culler.BeginFrame(CameraViewProj());
+
+    // 화면의 왼쪽 절반만 덮습니다. 뒷면으로 그려도 똑같이 가려야 합니다.
+    DrawQuad(culler, -100.0f, -100.0f, 0.0f, 100.0f, 10.0f, true);
+    culler.BuildHierarchy();
+
+    CHECK(!culler.IsVisible(MakeBox(-20.0f, 0.0f, 30.0f, 2.0f)));
+    CHECK(culler.IsVisible(MakeBox(20.0f, 0.0f, 30.0f, 2.0f)));
+
+    // 경계에 걸친 박스는 보입니다.
+    CHECK(culler.IsVisible(MakeBox(0.0f, 0.0f, 30.0f, 2.0f)));
+}
+
+TEST_CASE(OccludedResultsAreConservative)
+{
+    OcclusionCuller culler;
+    TestRandom random(11);
+
+    for (int trial = 0; trial < 10; ++trial)
+    {
+        culler.BeginFrame(CameraViewProj());
+
+        // 무작위 오클루더들을 그립니다.
+        for (int i = 0; i < 8; ++i)
+        {
+            const float z = random.Range(5.0f, 40.0f);
+            const float x = random.Range(-2.0f * z, 2.0f * z);
+            const float y = random.Range(-z, z);
+            const float size = random.Range(0.2f, 1.0f) * z;
+            DrawQuad(culler, x - size, y - size, x + size, y + size, z);
+        }
+        culler.BuildHierarchy();
+
+        XMMATRIX viewProj = CameraViewProj();
+        const std::vector<float>& depth = culler.GetLevel(0);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const float z = random.Range(10.0f, 90.0f);
+            BoundingBox box = MakeBox(random.Range(-2.0f * z, 2.0f * z), random.Range(-z, z), z, random.Range(0.2f, 4.0f));
+            if (culler.IsVisible(box))
+                continue;
+
+            // 가려졌다고 판단한 박스는 자신이 덮는 모든 픽셀에서 깊이 버퍼보다 뒤에 있어야 합니다.
+            XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+            box.GetCorners(corners);
+
+            float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+            for (const XMFLOAT3& corner : corners)
+            {
+                XMFLOAT4 clip;
+                XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), viewProj));
+                const float sx = (clip.x / clip.w * 0.5f + 0.5f) * culler.Width();
+                const float sy = (0.5f - clip.y / clip.w * 0.5f) * culler.Height();
+                minX = std::min<float>(minX, sx);
+                maxX = std::max<float>(maxX, sx);
+                minY = std::min<float>(minY, sy);
+                maxY = std::max<float>(maxY, sy);
+                minZ = std::min<float>(minZ, clip.z / clip.w);
+            }
+
+            // 화면 밖의 박스는 프러스텀 컬링의 몫이므로 건너뜁니다.
+            if (maxX < 0.0f || maxY < 0.0f || minX >= culler.Width() || minY >= culler.Height())
+                continue;
+
+            const int x0 = std::max<int>((int)minX, 0);
+            const int y0 = std::max<int>((int)minY, 0);
+            const int x1 = std::min<int>((int)maxX, (int)culler.Width() - 1);
+            const int y1 = std::min<int>((int)maxY, (int)culler.Height() - 1);
+
+            bool behind = true;
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    behind = behind && minZ > depth[(size_t)y * culler.Width() + x];
+
+            CHECK(behind);
+        }
+    }
+}
+
+TEST_CASE(OccludersBehindTheCameraAreSkipped)
+{
+    OcclusionCuller culler;
+    culler.BeginFrame(CameraViewProj());
+
+    DrawQuad(culler, -100.0f, -100.0f, 100.0f, 100.0f, -10.0f);
+    culler.BuildHierarchy();
+
+    CHECK(culler.LastStats().TrianglesRasterized == 0);
+    CHECK(culler.LastStats().TrianglesSkipped == 2);
+    CHECK(culler.IsVisible(MakeBox(0.0f, 0.0f, 20.0f, 1.0f)));
+}
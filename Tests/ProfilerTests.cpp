@@ -0,0 +1,179 @@
+﻿//***************************************************************************************
+// ProfilerTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::string CaptureTrace()
+    {
+        std::ostringstream os;
+        Profiler::WriteChromeTrace(os);
+        return os.str();
+    }
+
+    // 트레이스에서 "ts" 값들을 꺼냅니다.
+    std::vector<double> EventTimes(const std::string& trace)
+    {
+        std::vector<double> times;
+        const std::string key = "\"ts\": ";
+        for (size_t pos = trace.find(key); pos != std::string::npos; pos = trace.find(key, pos + 1))
+            times.push_back(std::strtod(trace.c_str() + pos + key.size(), nullptr));
+        return times;
+    }
+
+    void RecordZones(int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            PROFILE_SCOPE("Zone");
+        }
+    }
+}
+
+TEST_CASE(ZonesAreRecordedOnlyDuringACapture)
+{
+    Profiler::EndCapture();
+    RecordZones(3);
+
+    Profiler::BeginCapture();
+    CHECK(Profiler::IsCapturing());
+    RecordZones(5);
+    Profiler::EndCapture();
+
+    RecordZones(4);
+
+    CHECK(Profiler::EventCount() == 5);
+    CHECK(Profiler::DroppedEventCount() == 0);
+
+    // 시간은 캡쳐 시작부터 잽니다.
+    const std::vector<double> times = EventTimes(CaptureTrace());
+    CHECK(times.size() == 5);
+    for (double t : times)
+        CHECK(t >= 0.0);
+}
+
+TEST_CASE(BeginCaptureForgetsThePreviousCapture)
+{
+    Profiler::BeginCapture();
+    RecordZones(7);
+
+    // 끝난 스레드의 버퍼도 남아 있다가 다음 캡쳐에서 빠져야 합니다.
+    std::thread worker([]() { RecordZones(11); });
+    worker.join();
+    CHECK(Profiler::EventCount() == 18);
+
+    Profiler::BeginCapture();
+    CHECK(Profiler::EventCount() == 0);
+
+    RecordZones(2);
+    Profiler::EndCapture();
+
+    CHECK(Profiler::EventCount() == 2);
+    CHECK(EventTimes(CaptureTrace()).size() == 2);
+}
+
+TEST_CASE(ZonesFromThePreviousCaptureAreLeftOut)
+{
+    // 이전 캡쳐 중에 시작해서 새 캡쳐 중에 끝난 구간은 시작 시간이 캡쳐보다 앞섭니다.
+    Profiler::BeginCapture();
+    {
+        PROFILE_SCOPE("Spanning");
+        Profiler::BeginCapture();
+    }
+    RecordZones(1);
+    Profiler::EndCapture();
+
+    CHECK(Profiler::EventCount() == 1);
+    for (double t : EventTimes(CaptureTrace()))
+        CHECK(t >= 0.0);
+}
+
+TEST_CASE(OverflowingEventsAreCountedAsDropped)
+{
+    Profiler::BeginCapture();
+
+    std::thread worker([]()
+    {
+        const std::int64_t now = GameTimer::Now();
+        for (std::uint32_t i = 0; i < Profiler::MaxEventsPerThread + 10; ++i)
+            Profiler::Record("Overflow", now, now + 1);
+    });
+    worker.join();
+
+    Profiler::EndCapture();
+    CHECK(Profiler::EventCount() == Profiler::MaxEventsPerThread);
+    CHECK(Profiler::DroppedEventCount() == 10);
+
+    // 다음 캡쳐에서는 넘친 개수도 지워집니다.
+    Profiler::BeginCapture();
+    Profiler::EndCapture();
+    CHECK(Profiler::EventCount() == 0);
+    CHECK(Profiler::DroppedEventCount() == 0);
+}
+
+TEST_CASE(ThreadNamesAppearInTheTrace)
+{
+    Profiler::BeginCapture();
+
+    std::thread worker([]()
+    {
+        Profiler::SetThreadName("Profiler \"Test\" Worker");
+        RecordZones(1);
+    });
+    worker.join();
+
+    Profiler::EndCapture();
+
+    const std::string trace = CaptureTrace();
+    CHECK(trace.find("\"thread_name\"") != std::string::npos);
+    CHECK(trace.find("\"Profiler \\\"Test\\\" Worker\"") != std::string::npos);
+}
+
+TEST_CASE(CapturesRestartWhileOtherThreadsRecord)
+{
+    // 작업 스레드들이 쉬지 않고 기록하는 동안 캡쳐를 여러 번 다시 시작합니다.
+    // 이전 캡쳐의 이벤트가 다음 캡쳐에 섞이면 시작 시간보다 앞선 이벤트가 나옵니다.
+    const int workerCount = 3;
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> workers;
+    for (int w = 0; w < workerCount; ++w)
+    {
+        workers.emplace_back([&stop]()
+        {
+            Profiler::SetThreadName("Recorder");
+            while (!stop.load(std::memory_order_relaxed))
+                RecordZones(16);
+        });
+    }
+
+    for (int capture = 0; capture < 8; ++capture)
+    {
+        Profiler::BeginCapture();
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        Profiler::EndCapture();
+
+        CHECK(Profiler::EventCount() <= (std::uint64_t)(workerCount + 1) * Profiler::MaxEventsPerThread);
+        for (double t : EventTimes(CaptureTrace()))
+            CHECK(t >= 0.0);
+    }
+
+    stop.store(true);
+    for (std::thread& worker : workers)
+        worker.join();
+
+    // 모든 스레드가 멈춘 뒤의 캡쳐는 비어 있습니다.
+    Profiler::BeginCapture();
+    Profiler::EndCapture();
+    CHECK(Profiler::EventCount() == 0);
+    CHECK(Profiler::DroppedEventCount() == 0);
+}
@@ -0,0 +1,200 @@
+﻿//***************************************************************************************
+// RayQueryBenchmark.cpp
+//
+// Measures the two-level ray query service in TrianglePicker against the car and skull
+// meshes that the Picking chapter loads.  A grid of rotated, non-uniformly scaled
+// instances is traced with three kinds of batches of the same size: closest-hit rays
+// (camera collision, hit testing), any-hit segments (line of sight) and downward rays
+// (ground snapping).  The frame budget is 100k rays, so each batch is reported as
+// milliseconds per 100k rays.  Line-of-sight answers must agree with closest hits.
+//***************************************************************************************
+
+#include "BenchmarkHarness.h"
+#include "JobSystem.h"
+#include "TestHarness.h"
+#include "TrianglePicker.h"
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace DirectX;
+
+namespace
+{
+    struct ModelMesh
+    {
+        std::vector<XMFLOAT3> Positions;
+        std::vector<std::uint32_t> Indices;
+    };
+
+    // 챕터들이 읽는 것과 같은 텍스트 형식입니다. 위치만 사용하고 노멀은 건너뜁니다.
+    bool LoadModel(const std::string& filename, ModelMesh& mesh)
+    {
+        std::ifstream fin(filename);
+        if (!fin)
+            return false;
+
+        std::uint32_t vcount = 0;
+        std::uint32_t tcount = 0;
+        std::string ignore;
+
+        fin >> ignore >> vcount;
+        fin >> ignore >> tcount;
+        fin >> ignore >> ignore >> ignore >> ignore;
+
+        mesh.Positions.resize(vcount);
+        for (XMFLOAT3& p : mesh.Positions)
+        {
+            float nx, ny, nz;
+            fin >> p.x >> p.y >> p.z >> nx >> ny >> nz;
+        }
+
+        fin >> ignore >> ignore >> ignore;
+
+        mesh.Indices.resize(3 * (size_t)tcount);
+        for (std::uint32_t& index : mesh.Indices)
+            fin >> index;
+
+        return (bool)fin;
+    }
+
+    const std::uint32_t gFrameRays = 100000;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options(argc, argv);
+
+    const std::uint32_t gridSize = options.Quick ? 8 : 32;
+    const std::uint32_t rayCount = options.Quick ? 10000 : gFrameRays;
+
+    const std::string modelsDir = PICKING_MODELS_DIR;
+    ModelMesh models[2];
+    if (!LoadModel(modelsDir + "/car.txt", models[0]) || !LoadModel(modelsDir + "/skull.txt", models[1]))
+    {
+        std::printf("cannot load car.txt and skull.txt from %s\n", modelsDir.c_str());
+        return 1;
+    }
+
+    bool failed = false;
+    TrianglePicker picker;
+
+    // 메쉬 BVH(하위 레벨)를 만듭니다.
+    std::uint32_t meshes[2] = {};
+    const double meshBuildMs = MeasureMedianMs(1, [&](int)
+    {
+        for (int m = 0; m < 2; ++m)
+        {
+            meshes[m] = picker.AddMesh(models[m].Positions.data(), sizeof(XMFLOAT3), (std::uint32_t)models[m].Positions.size(),
+                models[m].Indices.data(), (std::uint32_t)models[m].Indices.size());
+        }
+    });
+    BenchmarkCheck(meshes[0] != TrianglePicker::Invalid && meshes[1] != TrianglePicker::Invalid, "model rejected", failed);
+    if (failed)
+        return 1;
+
+    // 바닥 위에 자동차와 해골을 번갈아 세운 격자입니다. 간격은 10입니다.
+    TestRandom random(7);
+    const float halfExtent = 5.0f * gridSize;
+    for (std::uint32_t z = 0; z < gridSize; ++z)
+    {
+        for (std::uint32_t x = 0; x < gridSize; ++x)
+        {
+            const float scale = random.Range(0.3f, 0.6f);
+            XMMATRIX world = XMMatrixScaling(scale, scale * random.Range(0.8f, 1.2f), scale) *
+                XMMatrixRotationY(random.Range(0.0f, XM_2PI)) *
+                XMMatrixTranslation(10.0f * x - halfExtent + 5.0f, 2.0f, 10.0f * z - halfExtent + 5.0f);
+            picker.AddInstance(meshes[(x + z) % 2], world);
+        }
+    }
+
+    const double instanceBuildMs = MeasureMedianMs(1, [&](int)
+    {
+        picker.UpdateHierarchy();
+    });
+
+    std::printf("%u instances, %u + %u triangles, mesh BVH build %.3f ms, instance BVH build %.3f ms, %.1f MB, %u workers\n",
+        picker.InstanceCount(), (std::uint32_t)models[0].Indices.size() / 3, (std::uint32_t)models[1].Indices.size() / 3,
+        meshBuildMs, instanceBuildMs, picker.MemoryUsage() / (1024.0 * 1024.0), JobSystem::Default().WorkerCount());
+
+    auto randomPoint = [&](float y0, float y1)
+    {
+        return XMVectorSet(random.Range(-halfExtent, halfExtent), random.Range(y0, y1), random.Range(-halfExtent, halfExtent), 1.0f);
+    };
+
+    // 장면 위의 점에서 장면 안의 점을 향하는 레이입니다.
+    std::vector<PickRay> closestRays(rayCount);
+    for (PickRay& ray : closestRays)
+    {
+        XMVECTOR origin = randomPoint(5.0f, 20.0f);
+        XMStoreFloat3(&ray.Origin, origin);
+        XMStoreFloat3(&ray.Direction, XMVector3Normalize(XMVectorSubtract(randomPoint(0.0f, 4.0f), origin)));
+    }
+
+    // 눈높이의 두 점을 잇는 선분입니다.
+    std::vector<PickRay> sightRays(rayCount);
+    for (PickRay& ray : sightRays)
+    {
+        XMVECTOR from = randomPoint(1.5f, 3.0f);
+        XMVECTOR to = randomPoint(1.5f, 3.0f);
+        XMVECTOR delta = XMVectorSubtract(to, from);
+        XMStoreFloat3(&ray.Origin, from);
+        XMStoreFloat3(&ray.Direction, XMVector3Normalize(delta));
+        ray.MaxDistance = XMVectorGetX(XMVector3Length(delta));
+    }
+
+    // 위에서 바로 아래로 쏘는 레이입니다.
+    std::vector<PickRay> groundRays(rayCount);
+    for (PickRay& ray : groundRays)
+    {
+        XMStoreFloat3(&ray.Origin, randomPoint(30.0f, 30.0f));
+        ray.Direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+    }
+
+    std::vector<PickHit> hits(rayCount);
+    std::unique_ptr<bool[]> occluded(new bool[rayCount]);
+
+    std::printf("%14s %9s %9s %12s %11s %11s %11s %11s\n",
+        "batch", "rays", "hits", "ms / 100k", "Mrays / s", "inst / ray", "nodes / ray", "tris / ray");
+
+    auto report = [&](const char* name, double ms)
+    {
+        const TrianglePicker::PickStats& stats = picker.LastStats();
+        const double msPer100k = ms * gFrameRays / rayCount;
+        std::printf("%14s %9u %9u %12.3f %11.2f %11.1f %11.1f %11.1f\n", name, rayCount, stats.Hits, msPer100k,
+            rayCount / (ms * 1000.0), (double)stats.InstanceTests / rayCount, (double)stats.NodesVisited / rayCount,
+            (double)stats.TriangleTests / rayCount);
+    };
+
+    const double closestMs = MeasureMedianMs(options.Repeats, [&](int)
+    {
+        picker.Pick(closestRays.data(), rayCount, hits.data());
+    });
+    report("closest hit", closestMs);
+    BenchmarkCheck(picker.LastStats().Hits > 0, "no closest-hit ray hit the scene", failed);
+
+    const double sightMs = MeasureMedianMs(options.Repeats, [&](int)
+    {
+        picker.Occluded(sightRays.data(), rayCount, occluded.get());
+    });
+    report("line of sight", sightMs);
+
+    const double groundMs = MeasureMedianMs(options.Repeats, [&](int)
+    {
+        picker.Pick(groundRays.data(), rayCount, hits.data());
+    });
+    report("ground snap", groundMs);
+
+    // 가려진 선분은 같은 선분의 가장 가까운 교차가 있는 선분과 같아야 합니다.
+    picker.Pick(sightRays.data(), rayCount, hits.data());
+    std::uint32_t mismatches = 0;
+    for (std::uint32_t i = 0; i < rayCount; ++i)
+        mismatches += occluded[i] != hits[i].IsHit() ? 1 : 0;
+    BenchmarkCheck(mismatches == 0, "any-hit and closest-hit disagree on line of sight", failed);
+
+    // 한 프레임에 세 종류를 10만 개씩 처리한다고 보고 60Hz 프레임에서 차지하는 비율을 출력합니다.
+    const double frameMs = (closestMs + sightMs + groundMs) * gFrameRays / rayCount;
+    std::printf("3 x 100k rays: %.3f ms (%.0f%% of a 60 Hz frame)\n", frameMs, frameMs / (1000.0 / 60.0) * 100.0);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+﻿//***************************************************************************************
+// RenderQueueTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "RenderQueue.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    struct QueueItem
+    {
+        std::uint32_t Layer;
+        std::uint32_t PipelineState;
+        std::uint32_t Geometry;
+        std::uint32_t Material;
+        float Depth;
+        bool BackToFront;
+    };
+
+    // 커맨드 리스트 대신 SubmitCommandStream에 넘기는 스텁입니다. 현재 상태를 흉내 내고
+    // Draw마다 그 시점의 상태를 기록합니다.
+    struct RecordingCommandList
+    {
+        struct DrawCall
+        {
+            std::uint32_t Item;
+            std::uint32_t PipelineState;
+            std::uint32_t Geometry;
+            std::uint32_t Material;
+        };
+
+        static const std::uint32_t Unset = ~0u;
+
+        std::uint32_t PipelineState = Unset;
+        std::uint32_t Geometry = Unset;
+        std::uint32_t Material = Unset;
+
+        std::uint32_t StateCalls = 0;
+        std::uint32_t RedundantStateCalls = 0;
+        std::vector<DrawCall> Draws;
+
+        void SetPipelineState(std::uint32_t pso) { Set(PipelineState, pso); }
+        void SetGeometry(std::uint32_t geometry) { Set(Geometry, geometry); }
+        void SetMaterial(std::uint32_t material) { Set(Material, material); }
+
+        void Draw(std::uint32_t item)
+        {
+            Draws.push_back({ item, PipelineState, Geometry, Material });
+        }
+
+        void Set(std::uint32_t& state, std::uint32_t value)
+        {
+            StateCalls++;
+            if (state == value)
+                RedundantStateCalls++;
+            state = value;
+        }
+    };
+
+    void FillQueue(RenderQueue& queue, const std::vector<QueueItem>& items)
+    {
+        queue.Clear();
+        for (std::uint32_t i = 0; i < (std::uint32_t)items.size(); ++i)
+        {
+            const QueueItem& it = items[i];
+            queue.Add(i, it.Layer, it.PipelineState, it.Geometry, it.Material, it.Depth, it.BackToFront);
+        }
+    }
+
+    std::vector<QueueItem> RandomItems(TestRandom& random, std::uint32_t count)
+    {
+        std::vector<QueueItem> items(count);
+        for (QueueItem& it : items)
+        {
+            it.Layer = random.Next() % 3;
+            it.PipelineState = it.Layer;
+            it.Geometry = random.Next() % 5;
+            it.Material = random.Next() % 7;
+            it.Depth = random.Range(-0.2f, 1.2f);
+            it.BackToFront = it.Layer == 2;
+        }
+        return items;
+    }
+}
+
+TEST_CASE(KeysOrderLayersStateAndDepth)
+{
+    // 레이어가 가장 먼저 비교됩니다.
+    CHECK(RenderQueue::MakeKey(0, 200, 4000, 4000, 1.0f, false) < RenderQueue::MakeKey(1, 0, 0, 0, 0.0f, false));
+
+    // 불투명 레이어에서는 상태가 깊이보다 우선하고, 상태가 같으면 가까운 것이 먼저입니다.
+    CHECK(RenderQueue::MakeKey(0, 1, 2, 3, 0.9f, false) < RenderQueue::MakeKey(0, 1, 2, 4, 0.1f, false));
+    CHECK(RenderQueue::MakeKey(0, 1, 2, 3, 0.1f, false) < RenderQueue::MakeKey(0, 1, 2, 3, 0.9f, false));
+
+    // 블렌딩 레이어에서는 깊이가 상태보다 우선하고 먼 것이 먼저입니다.
+    CHECK(RenderQueue::MakeKey(2, 1, 2, 4, 0.9f, true) < RenderQueue::MakeKey(2, 1, 2, 3, 0.1f, true));
+
+    // 범위를 벗어난 깊이는 잘립니다.
+    CHECK(RenderQueue::MakeKey(0, 1, 2, 3, -5.0f, false) == RenderQueue::MakeKey(0, 1, 2, 3, 0.0f, false));
+    CHECK(RenderQueue::MakeKey(2, 1, 2, 3, 7.0f, true) == RenderQueue::MakeKey(2, 1, 2, 3, 1.0f, true));
+}
+
+TEST_CASE(RadixSortMatchesStableSortByKey)
+{
+    TestRandom random(21);
+    const std::vector<QueueItem> items = RandomItems(random, 2000);
+
+    RenderQueue queue;
+    FillQueue(queue, items);
+    queue.Sort();
+
+    std::vector<RenderCommand> commands;
+    queue.BuildCommandStream(commands);
+
+    std::vector<std::uint32_t> sorted;
+    for (const RenderCommand& cmd : commands)
+    {
+        if (cmd.Type == RenderCommandType::Draw)
+            sorted.push_back(cmd.Value);
+    }
+
+    std::vector<std::uint32_t> expected(items.size());
+    for (std::uint32_t i = 0; i < (std::uint32_t)expected.size(); ++i)
+        expected[i] = i;
+
+    auto key = [&](std::uint32_t i)
+    {
+        const QueueItem& it = items[i];
+        return RenderQueue::MakeKey(it.Layer, it.PipelineState, it.Geometry, it.Material, it.Depth, it.BackToFront);
+    };
+    std::stable_sort(expected.begin(), expected.end(), [&](std::uint32_t a, std::uint32_t b) { return key(a) < key(b); });
+
+    CHECK(sorted == expected);
+}
+
+TEST_CASE(ReplayedStreamDrawsEveryItemWithItsOwnState)
+{
+    TestRandom random(5);
+    const std::vector<QueueItem> items = RandomItems(random, 500);
+
+    RenderQueue queue;
+    FillQueue(queue, items);
+    queue.Sort();
+
+    std::vector<RenderCommand> commands;
+    queue.BuildCommandStream(commands);
+
+    RecordingCommandList cmdList;
+    SubmitCommandStream(commands, cmdList);
+
+    // 모든 항목이 한 번씩, 자신의 상태로 그려집니다.
+    REQUIRE(cmdList.Draws.size() == items.size());
+    std::vector<bool> drawn(items.size(), false);
+    for (const RecordingCommandList::DrawCall& draw : cmdList.Draws)
+    {
+        REQUIRE(draw.Item < items.size());
+        CHECK(!drawn[draw.Item]);
+        drawn[draw.Item] = true;
+
+        const QueueItem& it = items[draw.Item];
+        CHECK(draw.PipelineState == it.PipelineState);
+        CHECK(draw.Geometry == it.Geometry);
+        CHECK(draw.Material == it.Material);
+    }
+
+    // 이미 설정된 상태를 다시 설정하는 명령은 없습니다.
+    CHECK(cmdList.RedundantStateCalls == 0);
+    CHECK(cmdList.StateCalls == queue.LastStats().StateChanges);
+    CHECK(queue.LastStats().StateChangesAvoided == 3 * items.size() - cmdList.StateCalls);
+
+    // 레이어 순서를 지키고, 블렌딩 레이어는 먼 것부터 그립니다.
+    for (size_t i = 1; i < cmdList.Draws.size(); ++i)
+    {
+        const QueueItem& prev = items[cmdList.Draws[i - 1].Item];
+        const QueueItem& curr = items[cmdList.Draws[i].Item];
+        CHECK(prev.Layer <= curr.Layer);
+
+        if (prev.Layer == 2 && curr.Layer == 2)
+        {
+            const float prevDepth = std::min<float>(std::max<float>(prev.Depth, 0.0f), 1.0f);
+            const float currDepth = std::min<float>(std::max<float>(curr.Depth, 0.0f), 1.0f);
+            CHECK(prevDepth >= currDepth - 1e-6f);
+        }
+    }
+}
+
+TEST_CASE(SharedStateIsSetOnce)
+{
+    // 같은 상태를 가진 항목들은 상태 변경 세 번과 Draw들로 끝납니다.
+    RenderQueue queue;
+    for (std::uint32_t i = 0; i < 10; ++i)
+        queue.Add(i, 0, 3, 4, 5, 0.1f * i);
+    queue.Sort();
+
+    std::vector<RenderCommand> commands;
+    queue.BuildCommandStream(commands);
+
+    RecordingCommandList cmdList;
+    SubmitCommandStream(commands, cmdList);
+
+    CHECK(commands.size() == 13);
+    CHECK(cmdList.StateCalls == 3);
+    CHECK(queue.LastStats().StateChangesAvoided == 27);
+
+    // 불투명 항목은 가까운 것부터 그립니다.
+    for (std::uint32_t i = 0; i < 10; ++i)
+        CHECK(cmdList.Draws[i].Item == i);
+
+    // 빈 큐는 명령을 만들지 않습니다.
+    queue.Clear();
+    queue.Sort();
+    queue.BuildCommandStream(commands);
+    CHECK(commands.empty());
+    CHECK(queue.LastStats().Items == 0);
+}
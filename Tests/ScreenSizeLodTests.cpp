@@ -0,0 +1,187 @@
+﻿//***************************************************************************************
+// ScreenSizeLodTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "ScreenSizeLod.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace
+{
+    // _22가 1이고 뷰포트 높이가 2이므로 화면 크기가 world 단위의 지름과 같습니다.
+    void SetUnitOrthographicView(ScreenSizeLod& lod)
+    {
+        lod.SetView(XMVectorZero(), XMMatrixOrthographicLH(2.0f, 2.0f, 1.0f, 100.0f), 2.0f);
+    }
+
+    BoundingSphere SphereOfSize(float pixelSize)
+    {
+        return BoundingSphere(XMFLOAT3(0.0f, 0.0f, 50.0f), 0.5f * pixelSize);
+    }
+}
+
+TEST_CASE(PerspectiveSizeFallsOffWithDistance)
+{
+    ScreenSizeLod lod({ 0.0f }, 0.0f);
+
+    // 수직 시야각 90도이면 _22가 1이므로 거리 1에서 길이 1이 뷰포트 높이의 절반인 300픽셀입니다.
+    lod.SetView(XMVectorSet(1.0f, 2.0f, 3.0f, 1.0f), XMMatrixPerspectiveFovLH(0.5f * XM_PI, 1.5f, 0.1f, 1000.0f), 600.0f);
+
+    CHECK_NEAR(lod.GetProjectedSize(BoundingSphere(XMFLOAT3(1.0f, 2.0f, 13.0f), 1.0f)), 60.0f, 1e-3f);
+    CHECK_NEAR(lod.GetProjectedSize(BoundingSphere(XMFLOAT3(1.0f, 2.0f, 23.0f), 1.0f)), 30.0f, 1e-3f);
+
+    // 방향과 상관 없이 거리만 봅니다.
+    CHECK_NEAR(lod.GetProjectedSize(BoundingSphere(XMFLOAT3(-5.0f, -6.0f, 3.0f), 2.0f)), 120.0f, 1e-3f);
+
+    // 카메라가 구 안에 있으면 가장 큰 값입니다.
+    CHECK(lod.GetProjectedSize(BoundingSphere(XMFLOAT3(1.5f, 2.0f, 3.0f), 1.0f)) == FLT_MAX);
+}
+
+TEST_CASE(OrthographicSizeIgnoresDistance)
+{
+    ScreenSizeLod lod({ 0.0f }, 0.0f);
+
+    // 높이 20인 볼륨을 600픽셀에 그리므로 길이 1이 30픽셀입니다.
+    lod.SetView(XMVectorSet(0.0f, 0.0f, -50.0f, 1.0f), XMMatrixOrthographicLH(30.0f, 20.0f, 1.0f, 200.0f), 600.0f);
+
+    CHECK_NEAR(lod.GetProjectedSize(BoundingSphere(XMFLOAT3(0.0f, 0.0f, 0.0f), 1.0f)), 60.0f, 1e-3f);
+    CHECK_NEAR(lod.GetProjectedSize(BoundingSphere(XMFLOAT3(4.0f, 1.0f, 120.0f), 1.0f)), 60.0f, 1e-3f);
+    CHECK_NEAR(lod.GetProjectedSize(BoundingSphere(XMFLOAT3(0.0f, 0.0f, -50.0f), 0.25f)), 15.0f, 1e-3f);
+}
+
+TEST_CASE(SelectLodUsesInclusiveThresholds)
+{
+    ScreenSizeLod lod({ 100.0f, 40.0f, 10.0f }, 5.0f);
+    SetUnitOrthographicView(lod);
+    CHECK(lod.LodCount() == 3);
+
+    CHECK(lod.SelectLod(SphereOfSize(150.0f)) == 0);
+    CHECK(lod.SelectLod(SphereOfSize(100.0f)) == 0);
+    CHECK(lod.SelectLod(SphereOfSize(99.0f)) == 1);
+    CHECK(lod.SelectLod(SphereOfSize(40.0f)) == 1);
+    CHECK(lod.SelectLod(SphereOfSize(39.0f)) == 2);
+
+    // 마지막 LOD는 자신의 최소 크기가 아니라 컬링 크기까지 사용합니다.
+    CHECK(lod.SelectLod(SphereOfSize(9.0f)) == 2);
+    CHECK(lod.SelectLod(SphereOfSize(5.0f)) == 2);
+    CHECK(lod.SelectLod(SphereOfSize(4.9f)) == ScreenSizeLod::Culled);
+
+    lod.SetCullPixelSize(0.0f);
+    CHECK(lod.GetCullPixelSize() == 0.0f);
+    CHECK(lod.SelectLod(SphereOfSize(0.1f)) == 2);
+
+    // LOD 목록이 비어 있으면 LOD 하나로 취급합니다.
+    ScreenSizeLod single({}, 5.0f);
+    SetUnitOrthographicView(single);
+    CHECK(single.LodCount() == 1);
+    CHECK(single.SelectLod(SphereOfSize(1000.0f)) == 0);
+    CHECK(single.SelectLod(SphereOfSize(1.0f)) == ScreenSizeLod::Culled);
+}
+
+TEST_CASE(BucketKeepsOrderWithinEachLod)
+{
+    ScreenSizeLod lod({ 100.0f, 40.0f, 10.0f }, 5.0f);
+    SetUnitOrthographicView(lod);
+
+    const float sizes[10] = { 20.0f, 150.0f, 1.0f, 50.0f, 12.0f, 200.0f, 45.0f, 3.0f, 100.0f, 10.0f };
+    auto getSphere = [&](std::uint32_t instance) { return SphereOfSize(sizes[instance]); };
+
+    std::vector<std::uint32_t> instances = { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+    std::vector<std::uint32_t> lodStarts;
+    lod.Bucket(instances, getSphere, lodStarts);
+
+    const std::vector<std::uint32_t> expectedInstances = { 8, 5, 1, 6, 3, 9, 4, 0 };
+    const std::vector<std::uint32_t> expectedStarts = { 0, 3, 5, 8 };
+    CHECK(instances == expectedInstances);
+    CHECK(lodStarts == expectedStarts);
+    CHECK(lod.LastCulledCount() == 2);
+
+    // 비어 있는 LOD도 범위는 있습니다.
+    instances = { 1, 5, 2 };
+    lod.Bucket(instances, getSphere, lodStarts);
+    CHECK(instances == std::vector<std::uint32_t>({ 1, 5 }));
+    CHECK(lodStarts == std::vector<std::uint32_t>({ 0, 2, 2, 2 }));
+    CHECK(lod.LastCulledCount() == 1);
+
+    instances.clear();
+    lod.Bucket(instances, getSphere, lodStarts);
+    CHECK(instances.empty());
+    CHECK(lodStarts == std::vector<std::uint32_t>({ 0, 0, 0, 0 }));
+    CHECK(lod.LastCulledCount() == 0);
+}
+
+TEST_CASE(BucketMatchesSelectLodForManyInstances)
+{
+    ScreenSizeLod lod({ 100.0f, 40.0f, 10.0f }, 5.0f);
+    SetUnitOrthographicView(lod);
+
+    // 병렬로 LOD를 고르는 경우에도 결과는 순서대로 고른 것과 같아야 합니다.
+    TestRandom random(11);
+    std::vector<BoundingSphere> spheres;
+    std::vector<std::uint32_t> instances;
+    for (std::uint32_t i = 0; i < 20000; ++i)
+    {
+        spheres.push_back(SphereOfSize(random.Range(0.0f, 200.0f)));
+        instances.push_back(i);
+    }
+
+    std::vector<std::vector<std::uint32_t>> expected(lod.LodCount());
+    std::uint32_t culled = 0;
+    for (std::uint32_t i : instances)
+    {
+        const std::uint32_t selected = lod.SelectLod(spheres[i]);
+        if (selected == ScreenSizeLod::Culled)
+            culled++;
+        else
+            expected[selected].push_back(i);
+    }
+
+    std::vector<std::uint32_t> lodStarts;
+    lod.Bucket(instances, [&](std::uint32_t instance) { return spheres[instance]; }, lodStarts);
+
+    REQUIRE(lodStarts.size() == lod.LodCount() + 1);
+    CHECK(lod.LastCulledCount() == culled);
+    CHECK(instances.size() == spheres.size() - culled);
+    for (std::uint32_t i = 0; i < lod.LodCount(); ++i)
+    {
+        const std::vector<std::uint32_t> range(instances.begin() + lodStarts[i], instances.begin() + lodStarts[i + 1]);
+        CHECK(range == expected[i]);
+    }
+}
+
+TEST_CASE(ClusteredLodMergesVerticesInACell)
+{
+    // 정점 1, 2, 5는 같은 칸에 있고 정점 1이 세 정점의 평균입니다.
+    const XMFLOAT3 positions[6] =
+    {
+        XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.5f, 0.5f, 0.0f), XMFLOAT3(1.2f, 0.2f, 0.0f),
+        XMFLOAT3(0.0f, 1.5f, 0.0f), XMFLOAT3(1.5f, 1.5f, 0.0f), XMFLOAT3(1.8f, 0.8f, 0.0f)
+    };
+    const std::uint32_t indices[12] = { 0, 3, 1, 1, 3, 4, 1, 2, 4, 0, 2, 3 };
+
+    std::vector<std::uint32_t> lodIndices;
+    BuildClusteredLodIndices(positions, sizeof(XMFLOAT3), 6, indices, 12, 1.0f, lodIndices);
+
+    // 정점 2는 정점 1로 바뀌므로 세 번째 삼각형은 넓이가 없어져서 사라집니다.
+    CHECK(lodIndices == std::vector<std::uint32_t>({ 0, 3, 1, 1, 3, 4, 0, 1, 3 }));
+
+    // 칸이 충분히 크면 모든 삼각형이 사라집니다.
+    BuildClusteredLodIndices(positions, sizeof(XMFLOAT3), 6, indices, 12, 10.0f, lodIndices);
+    CHECK(lodIndices.empty());
+}
+
+TEST_CASE(ClusteredLodKeepsDistantCellsApart)
+{
+    // y축 격자 좌표가 2^21이면 21비트를 넘쳐서 x축 좌표 1과 같은 키가 되던 경우입니다.
+    const XMFLOAT3 positions[3] =
+    {
+        XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.5f, 0.0f, 0.0f), XMFLOAT3(0.0f, 2097152.0f, 0.0f)
+    };
+    const std::uint32_t indices[3] = { 0, 1, 2 };
+
+    std::vector<std::uint32_t> lodIndices;
+    BuildClusteredLodIndices(positions, sizeof(XMFLOAT3), 3, indices, 3, 1.0f, lodIndices);
+    CHECK(lodIndices == std::vector<std::uint32_t>({ 0, 1, 2 }));
+}
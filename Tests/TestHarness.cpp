@@ -0,0 +1,69 @@
+﻿//***************************************************************************************
+// TestHarness.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    struct RegisteredTest
+    {
+        const char* Name;
+        TestFunction Function;
+    };
+
+    std::vector<RegisteredTest>& Registry()
+    {
+        static std::vector<RegisteredTest> tests;
+        return tests;
+    }
+
+    int gFailureCount = 0;
+}
+
+bool RegisterTest(const char* name, TestFunction function)
+{
+    Registry().push_back({ name, function });
+    return true;
+}
+
+void ReportFailure(const char* file, int line, const char* expression)
+{
+    ++gFailureCount;
+    std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+}
+
+// 인자가 있으면 이름에 그 문자열이 들어간 테스트만 실행합니다.
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    int run = 0;
+    int failedTests = 0;
+    for (const RegisteredTest& test : Registry())
+    {
+        if (filter != nullptr && std::strstr(test.Name, filter) == nullptr)
+            continue;
+
+        const int failuresBefore = gFailureCount;
+        try
+        {
+            test.Function();
+        }
+        catch (...)
+        {
+            ReportFailure(__FILE__, __LINE__, "unexpected exception");
+        }
+
+        ++run;
+        const bool passed = gFailureCount == failuresBefore;
+        failedTests += passed ? 0 : 1;
+        std::printf("[%s] %s\n", passed ? "  OK  " : "FAILED", test.Name);
+    }
+
+    std::printf("%d tests, %d failed\n", run, failedTests);
+    return failedTests == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+﻿//***************************************************************************************
+// TestHarness.h
+//
+// Minimal headless test runner for the CPU-only parts of Common.  Each test
+// executable links TestHarness.cpp, registers cases with TEST_CASE and checks
+// results with CHECK / REQUIRE.  The process exits non-zero if any check fails,
+// which is all CTest needs.
+//***************************************************************************************
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+typedef void (*TestFunction)();
+
+bool RegisterTest(const char* name, TestFunction function);
+void ReportFailure(const char* file, int line, const char* expression);
+
+// 테스트 함수를 정의하고 실행 목록에 등록합니다.
+#define TEST_CASE(name) \
+    static void name(); \
+    static const bool name##Registered = RegisterTest(#name, &name); \
+    static void name()
+
+// 실패해도 테스트를 계속 진행합니다.
+#define CHECK(expression) \
+    ((expression) ? (void)0 : ReportFailure(__FILE__, __LINE__, #expression))
+
+// 실패하면 현재 테스트를 끝냅니다. 이후의 검사가 의미 없을 때 사용합니다.
+#define REQUIRE(expression) \
+    do { if (!(expression)) { ReportFailure(__FILE__, __LINE__, #expression); return; } } while (false)
+
+#define CHECK_NEAR(a, b, epsilon) \
+    CHECK(std::fabs((double)(a) - (double)(b)) <= (double)(epsilon))
+
+// 표현식이 예외를 던지는지 검사합니다.
+#define CHECK_THROWS(expression) \
+    do { bool thrown = false; try { expression; } catch (...) { thrown = true; } \
+         if (!thrown) ReportFailure(__FILE__, __LINE__, "throws: " #expression); } while (false)
+
+// 테스트 입력을 재현 가능하게 만들기 위한 작은 난수 생성기입니다 (xorshift32).
+struct TestRandom
+{
+    std::uint32_t State = 0x9E3779B9u;
+
+    explicit TestRandom(std::uint32_t seed = 1) : State(seed ? seed : 1) {}
+
+    std::uint32_t Next()
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        return State;
+    }
+
+    // [lo, hi) 구간의 실수입니다.
+    float Range(float lo, float hi)
+    {
+        return lo + (hi - lo) * (float)(Next() >> 8) * (1.0f / 16777216.0f);
+    }
+};
@@ -0,0 +1,304 @@
+﻿//***************************************************************************************
+// TexturePackerTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "TexturePacker.h"
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    TextureUploadDesc MakeTexture(std::uint64_t width, std::uint32_t height, std::uint32_t mipLevels,
+                                  DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM)
+    {
+        TextureUploadDesc desc;
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = mipLevels;
+        desc.Format = format;
+        return desc;
+    }
+
+    // 행 벡터 (u, v, 0, 1)에 UV 변환을 적용합니다.
+    XMFLOAT2 TransformUv(const XMFLOAT4X4& m, float u, float v)
+    {
+        return XMFLOAT2(u * m._11 + v * m._21 + m._41, u * m._12 + v * m._22 + m._42);
+    }
+
+    // 아틀라스 안의 텍스쳐들이 아틀라스 안에 있고, 여백을 포함해서 서로 겹치지 않는지 검사합니다.
+    bool AtlasIsValid(const TexturePacker& packer, std::uint32_t groupIndex, std::uint32_t padding)
+    {
+        const TexturePackGroup& group = packer.GetGroup(groupIndex);
+        std::uint64_t usedTexels = 0;
+
+        for (size_t i = 0; i < group.Textures.size(); ++i)
+        {
+            const TexturePlacement& a = packer.GetPlacement(group.Textures[i]);
+
+            std::vector<TexturePackCopy> copies;
+            packer.GetCopies(group.Textures[i], copies);
+            const std::uint32_t aw = copies.front().Width;
+            const std::uint32_t ah = copies.front().Height;
+            usedTexels += (std::uint64_t)aw * ah;
+
+            if (a.Group != groupIndex || a.X + aw > group.Desc.Width || a.Y + ah > group.Desc.Height)
+                return false;
+
+            for (size_t j = i + 1; j < group.Textures.size(); ++j)
+            {
+                const TexturePlacement& b = packer.GetPlacement(group.Textures[j]);
+                packer.GetCopies(group.Textures[j], copies);
+                const std::uint32_t bw = copies.front().Width;
+                const std::uint32_t bh = copies.front().Height;
+
+                const bool separated =
+                    a.X + aw + padding <= b.X || b.X + bw + padding <= a.X ||
+                    a.Y + ah + padding <= b.Y || b.Y + bh + padding <= a.Y;
+                if (!separated)
+                    return false;
+            }
+        }
+
+        return usedTexels == group.UsedTexels;
+    }
+}
+
+TEST_CASE(MatchingTexturesBecomeArraySlices)
+{
+    TexturePacker packer;
+    packer.AddTexture(MakeTexture(512, 512, 10, DXGI_FORMAT_BC1_UNORM), true);
+    packer.AddTexture(MakeTexture(256, 256, 9, DXGI_FORMAT_BC1_UNORM), true);
+    packer.AddTexture(MakeTexture(512, 512, 10, DXGI_FORMAT_BC1_UNORM), true);
+    packer.Pack();
+
+    // 크기가 다른 텍스쳐는 반복되는 UV 때문에 아틀라스에도 들어가지 못합니다.
+    REQUIRE(packer.GroupCount() == 2);
+
+    const TexturePlacement& first = packer.GetPlacement(0);
+    const TexturePlacement& third = packer.GetPlacement(2);
+    const TexturePackGroup& array = packer.GetGroup(first.Group);
+    CHECK(array.Kind == TexturePackKind::Array);
+    CHECK(array.Desc.DepthOrArraySize == 2);
+    CHECK(third.Group == first.Group);
+    CHECK(first.Slice == 0);
+    CHECK(third.Slice == 1);
+
+    // 배열의 슬라이스는 UV를 바꾸지 않고, 모든 밉이 슬라이스의 서브리소스로 복사됩니다.
+    XMFLOAT2 uv = TransformUv(third.UvTransform, 3.25f, -1.5f);
+    CHECK_NEAR(uv.x, 3.25f, 1e-6f);
+    CHECK_NEAR(uv.y, -1.5f, 1e-6f);
+
+    std::vector<TexturePackCopy> copies;
+    packer.GetCopies(2, copies);
+    REQUIRE(copies.size() == 10);
+    CHECK(copies[3].SrcSubresource == 3);
+    CHECK(copies[3].DstSubresource == 3 + 10);
+
+    CHECK(packer.GetGroup(packer.GetPlacement(1).Group).Kind == TexturePackKind::Standalone);
+}
+
+TEST_CASE(OnlyNonWrappingSmallTexturesGoToAtlases)
+{
+    TexturePackOptions options;
+    options.BuildArrays = false;
+    options.MaxAtlasItemSize = 128;
+
+    TexturePacker packer(options);
+    const std::uint32_t wrapping = packer.AddTexture(MakeTexture(64, 64, 1), true);
+    const std::uint32_t large = packer.AddTexture(MakeTexture(256, 64, 1), false);
+    const std::uint32_t a = packer.AddTexture(MakeTexture(64, 32, 1), false);
+    const std::uint32_t b = packer.AddTexture(MakeTexture(32, 64, 1), false);
+    const std::uint32_t otherFormat = packer.AddTexture(MakeTexture(32, 32, 1, DXGI_FORMAT_R16G16B16A16_FLOAT), false);
+    packer.Pack();
+
+    CHECK(packer.GetGroup(packer.GetPlacement(wrapping).Group).Kind == TexturePackKind::Standalone);
+    CHECK(packer.GetGroup(packer.GetPlacement(large).Group).Kind == TexturePackKind::Standalone);
+
+    // 포맷이 같은 후보가 하나뿐이면 아틀라스를 만들지 않습니다.
+    CHECK(packer.GetGroup(packer.GetPlacement(otherFormat).Group).Kind == TexturePackKind::Standalone);
+
+    const std::uint32_t atlas = packer.GetPlacement(a).Group;
+    CHECK(packer.GetGroup(atlas).Kind == TexturePackKind::Atlas);
+    CHECK(packer.GetPlacement(b).Group == atlas);
+    CHECK(AtlasIsValid(packer, atlas, options.Padding));
+
+    // 그룹 인덱스는 그룹 목록과 일치해야 합니다.
+    for (std::uint32_t t = 0; t < packer.TextureCount(); ++t)
+    {
+        const TexturePackGroup& group = packer.GetGroup(packer.GetPlacement(t).Group);
+        bool found = false;
+        for (std::uint32_t member : group.Textures)
+            found = found || member == t;
+        CHECK(found);
+    }
+}
+
+TEST_CASE(AtlasUvTransformMapsToTexelCenters)
+{
+    TexturePackOptions options;
+    options.BuildArrays = false;
+
+    TexturePacker packer(options);
+    packer.AddTexture(MakeTexture(64, 64, 1), false);
+    packer.AddTexture(MakeTexture(16, 8, 1), false);
+    packer.AddTexture(MakeTexture(1, 1, 1), false);
+    packer.Pack();
+
+    REQUIRE(packer.GroupCount() == 1);
+    const TexturePackGroup& group = packer.GetGroup(0);
+    const float atlasWidth = (float)group.Desc.Width;
+    const float atlasHeight = (float)group.Desc.Height;
+
+    for (std::uint32_t t = 0; t < packer.TextureCount(); ++t)
+    {
+        const TexturePlacement& placement = packer.GetPlacement(t);
+        std::vector<TexturePackCopy> copies;
+        packer.GetCopies(t, copies);
+        const std::uint32_t w = copies.front().Width;
+        const std::uint32_t h = copies.front().Height;
+
+        // (0, 0)과 (1, 1)은 첫 번째와 마지막 텍셀의 중심으로 옮겨집니다.
+        XMFLOAT2 lo = TransformUv(placement.UvTransform, 0.0f, 0.0f);
+        XMFLOAT2 hi = TransformUv(placement.UvTransform, 1.0f, 1.0f);
+        CHECK_NEAR(lo.x * atlasWidth, placement.X + 0.5f, 1e-3f);
+        CHECK_NEAR(lo.y * atlasHeight, placement.Y + 0.5f, 1e-3f);
+        CHECK_NEAR(hi.x * atlasWidth, placement.X + w - 0.5f, 1e-3f);
+        CHECK_NEAR(hi.y * atlasHeight, placement.Y + h - 0.5f, 1e-3f);
+    }
+
+    // 1x1 텍스쳐는 어떤 UV든 같은 텍셀을 가리키므로 반복되는 UV도 이웃을 읽지 않습니다.
+    const TexturePlacement& texel = packer.GetPlacement(2);
+    XMFLOAT2 repeated = TransformUv(texel.UvTransform, 7.5f, -3.0f);
+    CHECK_NEAR(repeated.x * atlasWidth, texel.X + 0.5f, 1e-3f);
+    CHECK_NEAR(repeated.y * atlasHeight, texel.Y + 0.5f, 1e-3f);
+}
+
+TEST_CASE(ApplyUvTransformAppendsToMaterialTransform)
+{
+    TexturePackOptions options;
+    options.BuildArrays = false;
+
+    TexturePacker packer(options);
+    packer.AddTexture(MakeTexture(32, 32, 1), false);
+    packer.AddTexture(MakeTexture(32, 32, 1), false);
+    packer.Pack();
+
+    // 메터리얼 변환이 먼저 적용되고 그 결과가 아틀라스 좌표로 옮겨집니다.
+    XMFLOAT4X4 matTransform(
+        0.5f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.5f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.25f, 0.5f, 0.0f, 1.0f);
+    packer.ApplyUvTransform(1, matTransform);
+
+    const XMFLOAT4X4& uvTransform = packer.GetPlacement(1).UvTransform;
+    XMFLOAT2 expected = TransformUv(uvTransform, 0.5f * 0.6f + 0.25f, 0.5f * 0.2f + 0.5f);
+    XMFLOAT2 actual = TransformUv(matTransform, 0.6f, 0.2f);
+    CHECK_NEAR(actual.x, expected.x, 1e-6f);
+    CHECK_NEAR(actual.y, expected.y, 1e-6f);
+}
+
+TEST_CASE(CompressedAtlasKeepsBlocksAlignedInEveryMip)
+{
+    TexturePackOptions options;
+    options.BuildArrays = false;
+    options.MaxAtlasMipLevels = 3;
+
+    TexturePacker packer(options);
+    packer.AddTexture(MakeTexture(64, 64, 7, DXGI_FORMAT_BC3_UNORM), false);
+    packer.AddTexture(MakeTexture(32, 16, 6, DXGI_FORMAT_BC3_UNORM), false);
+    packer.AddTexture(MakeTexture(40, 24, 2, DXGI_FORMAT_BC3_UNORM), false);
+    packer.Pack();
+
+    REQUIRE(packer.GroupCount() == 1);
+    const TexturePackGroup& group = packer.GetGroup(0);
+
+    // 가장 적은 밉 개수로 제한됩니다.
+    CHECK(group.Desc.MipLevels == 2);
+    CHECK(AtlasIsValid(packer, 0, options.Padding));
+
+    for (std::uint32_t t = 0; t < packer.TextureCount(); ++t)
+    {
+        std::vector<TexturePackCopy> copies;
+        packer.GetCopies(t, copies);
+        REQUIRE(copies.size() == group.Desc.MipLevels);
+
+        for (const TexturePackCopy& copy : copies)
+        {
+            CHECK(copy.DstX % 4 == 0);
+            CHECK(copy.DstY % 4 == 0);
+            CHECK(copy.SrcSubresource == copy.DstSubresource);
+        }
+    }
+}
+
+TEST_CASE(RandomAtlasesAreValidAndDense)
+{
+    TestRandom random(7);
+
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        TexturePackOptions options;
+        options.BuildArrays = false;
+        options.MaxAtlasSize = 512;
+
+        TexturePacker packer(options);
+        const int count = 8 + (int)(random.Next() % 40);
+        for (int i = 0; i < count; ++i)
+        {
+            const std::uint32_t w = 8 + random.Next() % 121;
+            const std::uint32_t h = 8 + random.Next() % 121;
+            packer.AddTexture(MakeTexture(w, h, 1), false);
+        }
+        packer.Pack();
+
+        std::uint32_t atlasTextures = 0;
+        for (std::uint32_t g = 0; g < packer.GroupCount(); ++g)
+        {
+            const TexturePackGroup& group = packer.GetGroup(g);
+            if (group.Kind != TexturePackKind::Atlas)
+                continue;
+
+            CHECK(group.Desc.Width <= options.MaxAtlasSize);
+            CHECK(group.Desc.Height <= options.MaxAtlasSize);
+            CHECK(AtlasIsValid(packer, g, options.Padding));
+            atlasTextures += (std::uint32_t)group.Textures.size();
+        }
+
+        // 모든 텍스쳐가 아틀라스 크기보다 작으므로 단독으로 남는 것은 마지막 페이지의 하나뿐입니다.
+        CHECK(atlasTextures + 1 >= (std::uint32_t)count);
+
+        // 셸프 패킹과 최소 면적 너비 탐색으로 여백을 포함해도 면적의 대부분을 사용합니다.
+        CHECK(packer.GetAtlasEfficiency() > 0.6f);
+    }
+}
+
+TEST_CASE(CopySurfacePlacesRowsAtDestination)
+{
+    // 4x2 RGBA8 텍스쳐를 8x4 아틀라스의 (3, 1)에 복사합니다.
+    std::vector<std::uint32_t> src(4 * 2);
+    for (std::uint32_t i = 0; i < src.size(); ++i)
+        src[i] = 100 + i;
+
+    std::vector<std::uint32_t> dst(8 * 4, 0);
+
+    TexturePackCopy copy;
+    copy.DstX = 3;
+    copy.DstY = 1;
+    copy.Width = 4;
+    copy.Height = 2;
+    TexturePacker::CopySurface(DXGI_FORMAT_R8G8B8A8_UNORM, copy, src.data(), 4 * sizeof(std::uint32_t),
+                               dst.data(), 8 * sizeof(std::uint32_t));
+
+    for (std::uint32_t y = 0; y < 4; ++y)
+    {
+        for (std::uint32_t x = 0; x < 8; ++x)
+        {
+            const bool inside = x >= 3 && x < 7 && y >= 1 && y < 3;
+            const std::uint32_t expected = inside ? src[(y - 1) * 4 + (x - 3)] : 0;
+            CHECK(dst[y * 8 + x] == expected);
+        }
+    }
+}
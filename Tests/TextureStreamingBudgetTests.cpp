@@ -0,0 +1,247 @@
+﻿//***************************************************************************************
+// TextureStreamingBudgetTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "TextureStreamingBudget.h"
+#include <vector>
+
+namespace
+{
+    const std::uint64_t gMB = 1024 * 1024;
+
+    // 화면보다 큰 크기를 주면 모든 텍스쳐가 최상위 밉을 원합니다.
+    const float gFullScreen = 4096.0f;
+
+    TextureUploadDesc MakeTexture(std::uint64_t width, std::uint32_t height, std::uint32_t mipLevels,
+                                  DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM, std::uint32_t depthOrArraySize = 1,
+                                  bool isVolume = false)
+    {
+        TextureUploadDesc desc;
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = mipLevels;
+        desc.DepthOrArraySize = depthOrArraySize;
+        desc.Format = format;
+        desc.IsVolume = isVolume;
+        return desc;
+    }
+
+    std::uint64_t SumResidentBytes(const TextureStreamingBudget& budget)
+    {
+        std::uint64_t bytes = 0;
+        for (std::uint32_t i = 0; i < budget.TextureCount(); ++i)
+            bytes += budget.GetResidentBytes(i);
+        return bytes;
+    }
+}
+
+TEST_CASE(MipChainBytesForUncompressedFormats)
+{
+    // 256 + 128 + ... + 1 의 제곱의 합에 텍셀당 4바이트입니다.
+    const TextureUploadDesc rgba = MakeTexture(256, 256, 9);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(rgba, 0) == 4u * 87381u);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(rgba, 8) == 4u);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(rgba, 9) == 0u);
+
+    // 정사각형이 아니면 짧은 변이 먼저 1에서 멈춥니다.
+    const TextureUploadDesc wide = MakeTexture(8, 2, 4);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(wide, 0) == 4u * (16u + 4u + 2u + 1u));
+}
+
+TEST_CASE(MipChainBytesForBlockCompressedFormats)
+{
+    // BC1은 4x4 블록당 8바이트이고 4보다 작은 밉도 블록 하나를 차지합니다.
+    const TextureUploadDesc bc1 = MakeTexture(16, 16, 5, DXGI_FORMAT_BC1_UNORM);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(bc1, 0) == 128u + 32u + 8u + 8u + 8u);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(bc1, 2) == 24u);
+
+    // BC3, BC5, BC7은 블록당 16바이트입니다.
+    for (DXGI_FORMAT format : { DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC7_UNORM_SRGB })
+    {
+        const TextureUploadDesc desc = MakeTexture(8, 8, 4, format);
+        CHECK(TextureStreamingBudget::GetMipChainBytes(desc, 0) == 64u + 16u + 16u + 16u);
+    }
+
+    // 블록 수는 올림합니다.
+    const TextureUploadDesc odd = MakeTexture(10, 6, 1, DXGI_FORMAT_BC1_UNORM);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(odd, 0) == 3u * 2u * 8u);
+}
+
+TEST_CASE(MipChainBytesForArraysAndVolumes)
+{
+    // 배열의 슬라이스마다 밉 체인 전체가 있습니다. 큐브 맵은 슬라이스 6개입니다.
+    const TextureUploadDesc cube = MakeTexture(4, 4, 3, DXGI_FORMAT_R8G8B8A8_UNORM, 6);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(cube, 0) == 6u * (64u + 16u + 4u));
+    CHECK(TextureStreamingBudget::GetMipChainBytes(cube, 1) == 6u * (16u + 4u));
+
+    // 볼륨은 깊이도 밉마다 줄어듭니다.
+    const TextureUploadDesc volume = MakeTexture(8, 8, 4, DXGI_FORMAT_R8G8B8A8_UNORM, 4, true);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(volume, 0) == 64u * 4u * 4u + 16u * 4u * 2u + 4u * 4u + 4u);
+    CHECK(TextureStreamingBudget::GetMipChainBytes(volume, 2) == 4u * 4u + 4u);
+}
+
+TEST_CASE(ScreenSizeTopMipIsTheSmallestSufficientMip)
+{
+    const TextureUploadDesc desc = MakeTexture(1024, 512, 11);
+
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(desc, 4096.0f) == 0);
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(desc, 1024.0f) == 0);
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(desc, 1000.0f) == 0);
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(desc, 512.0f) == 1);
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(desc, 300.0f) == 1);
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(desc, 1.0f) == 10);
+
+    // 보이지 않는 텍스쳐는 마지막 밉만 있으면 됩니다.
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(desc, 0.0f) == 10);
+
+    // 밉이 하나뿐이면 항상 0입니다.
+    CHECK(TextureStreamingBudget::GetScreenSizeTopMip(MakeTexture(1024, 1024, 1), 1.0f) == 0);
+
+    // 로더의 maxsize는 선택한 밉의 가장 긴 변입니다.
+    CHECK(TextureStreamingBudget::GetMaxSizeForMip(desc, 0) == 1024);
+    CHECK(TextureStreamingBudget::GetMaxSizeForMip(desc, 3) == 128);
+}
+
+TEST_CASE(ResolveKeepsTheScreenSizeMipWhenEverythingFits)
+{
+    TextureStreamingBudget budget(64 * gMB);
+    const std::uint32_t a = budget.AddTexture(MakeTexture(1024, 1024, 11), gFullScreen);
+    const std::uint32_t b = budget.AddTexture(MakeTexture(1024, 1024, 11), 100.0f);
+    budget.Resolve();
+
+    CHECK(!budget.IsOverBudget());
+    CHECK(budget.GetResidentTopMip(a) == 0);
+    CHECK(budget.GetDesiredTopMip(b) == 3);
+    CHECK(budget.GetResidentTopMip(b) == 3);
+    CHECK(budget.ResidentBytes() == SumResidentBytes(budget));
+
+    // 원하는 밉이 상주하므로 스트리밍할 것이 없습니다.
+    std::uint32_t index = 0;
+    std::uint32_t topMip = 0;
+    CHECK(!budget.NextStreamingRequest(index, topMip));
+}
+
+TEST_CASE(ResolveDropsTheMostSavingTopMipFirst)
+{
+    // 1024 밉 0은 4MB, 512 밉 0은 1MB를 줄입니다. 큰 텍스쳐의 밉 하나만 버리면 3MB 안에 들어갑니다.
+    TextureStreamingBudget budget(3 * gMB);
+    const std::uint32_t large = budget.AddTexture(MakeTexture(1024, 1024, 11), gFullScreen);
+    const std::uint32_t small = budget.AddTexture(MakeTexture(512, 512, 10), gFullScreen);
+    budget.Resolve();
+
+    CHECK(!budget.IsOverBudget());
+    CHECK(budget.GetResidentTopMip(large) == 1);
+    CHECK(budget.GetResidentTopMip(small) == 0);
+    CHECK(budget.ResidentBytes() <= budget.BudgetBytes());
+    CHECK(budget.ResidentBytes() == SumResidentBytes(budget));
+    CHECK(budget.GetMaxSize(large) == 512);
+    CHECK(budget.GetMaxSize(small) == 512);
+}
+
+TEST_CASE(ResolveStopsAtTheMipTail)
+{
+    // 예산이 없어도 가장 긴 변이 minResidentSize 이하인 밉부터는 버리지 않습니다.
+    TextureStreamingBudget budget(0, 64);
+    const std::uint32_t large = budget.AddTexture(MakeTexture(1024, 1024, 11), gFullScreen);
+    const std::uint32_t small = budget.AddTexture(MakeTexture(512, 512, 10, DXGI_FORMAT_BC1_UNORM), gFullScreen);
+    const std::uint32_t tiny = budget.AddTexture(MakeTexture(32, 32, 6), gFullScreen);
+    budget.Resolve();
+
+    CHECK(budget.IsOverBudget());
+    CHECK(budget.GetResidentTopMip(large) == 4);
+    CHECK(budget.GetResidentTopMip(small) == 3);
+    CHECK(budget.GetResidentTopMip(tiny) == 0);
+    CHECK(budget.ResidentBytes() == SumResidentBytes(budget));
+    CHECK(budget.GetResidentBytes(large) == TextureStreamingBudget::GetMipChainBytes(MakeTexture(1024, 1024, 11), 4));
+
+    // 밉 테일까지 줄인 상태에서는 올릴 수 있는 밉이 없습니다.
+    std::uint32_t index = 0;
+    std::uint32_t topMip = 0;
+    CHECK(!budget.NextStreamingRequest(index, topMip));
+}
+
+TEST_CASE(StreamingRequestsFollowDeficitThenCost)
+{
+    // 모두 밉 0을 원하지만 6MB에는 1024 텍스쳐의 밉 0까지는 들어가지 않습니다.
+    TextureStreamingBudget budget(6 * gMB);
+    const std::uint32_t a = budget.AddTexture(MakeTexture(1024, 1024, 11), gFullScreen);
+    const std::uint32_t b = budget.AddTexture(MakeTexture(512, 512, 10), gFullScreen);
+    const std::uint32_t c = budget.AddTexture(MakeTexture(256, 256, 9), gFullScreen);
+    budget.Resolve();
+
+    // 낮은 해상도로 로드한 상태에서 시작합니다.
+    budget.CommitResidentMip(a, 3);
+    budget.CommitResidentMip(b, 2);
+    budget.CommitResidentMip(c, 2);
+    CHECK(budget.ResidentBytes() == SumResidentBytes(budget));
+
+    // 부족한 밉 수가 많은 텍스쳐가 먼저이고, 같으면 한 단계 올리는 비용이 적은 텍스쳐가 먼저입니다.
+    const std::uint32_t expected[][2] =
+    {
+        { a, 2 }, { c, 1 }, { b, 1 }, { a, 1 }, { c, 0 }, { b, 0 }
+    };
+
+    for (const auto& step : expected)
+    {
+        std::uint32_t index = ~0u;
+        std::uint32_t topMip = ~0u;
+        REQUIRE(budget.NextStreamingRequest(index, topMip));
+        CHECK(index == step[0]);
+        CHECK(topMip == step[1]);
+
+        budget.CommitResidentMip(index, topMip);
+        CHECK(budget.ResidentBytes() <= budget.BudgetBytes());
+        CHECK(budget.ResidentBytes() == SumResidentBytes(budget));
+    }
+
+    // 남은 요청은 예산을 넘으므로 나오지 않습니다.
+    std::uint32_t index = 0;
+    std::uint32_t topMip = 0;
+    CHECK(!budget.NextStreamingRequest(index, topMip));
+    CHECK(budget.GetResidentTopMip(a) == 1);
+    CHECK(budget.ResidentBytes() + 4 * gMB > budget.BudgetBytes());
+}
+
+TEST_CASE(RequestThatDoesNotFitIsSkippedForOneThatDoes)
+{
+    // 부족한 밉이 더 많은 텍스쳐라도 예산을 넘으면 건너뛰고 들어가는 요청을 냅니다.
+    TextureStreamingBudget budget(2 * gMB);
+    const std::uint32_t large = budget.AddTexture(MakeTexture(1024, 1024, 11), gFullScreen);
+    const std::uint32_t small = budget.AddTexture(MakeTexture(256, 256, 9), gFullScreen);
+    budget.Resolve();
+
+    budget.CommitResidentMip(large, 1);
+    budget.CommitResidentMip(small, 1);
+    REQUIRE(budget.ResidentBytes() < budget.BudgetBytes());
+
+    std::uint32_t index = 0;
+    std::uint32_t topMip = 0;
+    REQUIRE(budget.NextStreamingRequest(index, topMip));
+    CHECK(index == small);
+    CHECK(topMip == 0);
+}
+
+TEST_CASE(SetScreenSizeChangesTheDesiredMipOnly)
+{
+    TextureStreamingBudget budget(64 * gMB);
+    const std::uint32_t index = budget.AddTexture(MakeTexture(1024, 1024, 11), 100.0f);
+    budget.Resolve();
+    REQUIRE(budget.GetResidentTopMip(index) == 3);
+
+    // 카메라가 다가가면 원하는 밉이 바뀌고 상주 밉은 스트리밍으로 따라갑니다.
+    budget.SetScreenSize(index, gFullScreen);
+    CHECK(budget.GetDesiredTopMip(index) == 0);
+    CHECK(budget.GetResidentTopMip(index) == 3);
+
+    std::vector<std::uint32_t> mips;
+    std::uint32_t request = 0;
+    std::uint32_t topMip = 0;
+    while (budget.NextStreamingRequest(request, topMip))
+    {
+        CHECK(request == index);
+        mips.push_back(topMip);
+        budget.CommitResidentMip(request, topMip);
+    }
+    CHECK(mips == std::vector<std::uint32_t>({ 2, 1, 0 }));
+}
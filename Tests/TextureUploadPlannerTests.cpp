@@ -0,0 +1,205 @@
+﻿//***************************************************************************************
+// TextureUploadPlannerTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "TextureUploadPlanner.h"
+#include <algorithm>
+
+namespace
+{
+    TextureUploadDesc MakeTexture(std::uint64_t width, std::uint32_t height, std::uint32_t mipLevels,
+                                  DXGI_FORMAT format, std::uint32_t arraySize = 1)
+    {
+        TextureUploadDesc desc;
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = mipLevels;
+        desc.DepthOrArraySize = arraySize;
+        desc.Format = format;
+        return desc;
+    }
+
+    // 한 배치 안의 복사들은 링 안에 있어야 하고 서로 겹치면 안 됩니다.
+    bool BatchesAreDisjoint(const TextureUploadPlanner& planner)
+    {
+        const std::vector<TextureCopyDesc>& copies = planner.Copies();
+        for (size_t i = 0; i < copies.size(); ++i)
+        {
+            const TextureCopyDesc& a = copies[i];
+            if (a.RingOffset + a.TotalBytes > planner.RingByteSize())
+                return false;
+
+            for (size_t j = i + 1; j < copies.size(); ++j)
+            {
+                const TextureCopyDesc& b = copies[j];
+                if (a.Batch != b.Batch)
+                    continue;
+                if (a.RingOffset < b.RingOffset + b.TotalBytes && b.RingOffset < a.RingOffset + a.TotalBytes)
+                    return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE(FootprintAlignsRowPitchForUncompressedFormats)
+{
+    TextureCopyDesc copy = TextureUploadPlanner::GetCopyFootprint(
+        MakeTexture(100, 37, 1, DXGI_FORMAT_R8G8B8A8_UNORM), 0);
+
+    CHECK(copy.Width == 100);
+    CHECK(copy.Height == 37);
+    CHECK(copy.RowSizeInBytes == 400);
+    CHECK(copy.RowPitch == 512);
+    CHECK(copy.NumRows == 37);
+
+    // 마지막 행은 정렬되지 않은 크기만 차지합니다.
+    CHECK(copy.TotalBytes == 512u * 36u + 400u);
+}
+
+TEST_CASE(FootprintCountsBlockRowsForCompressedFormats)
+{
+    const TextureUploadDesc bc1 = MakeTexture(130, 66, 8, DXGI_FORMAT_BC1_UNORM);
+
+    TextureCopyDesc top = TextureUploadPlanner::GetCopyFootprint(bc1, 0);
+    CHECK(top.RowSizeInBytes == 33u * 8u);
+    CHECK(top.NumRows == 17);
+    CHECK(top.RowPitch == 512);
+
+    // 4x4 보다 작은 밉도 블록 하나를 차지합니다.
+    TextureCopyDesc tail = TextureUploadPlanner::GetCopyFootprint(bc1, 7);
+    CHECK(tail.Width == 1);
+    CHECK(tail.Height == 1);
+    CHECK(tail.RowSizeInBytes == 8);
+    CHECK(tail.NumRows == 1);
+    CHECK(tail.RowPitch == TextureUploadPlanner::RowPitchAlignment);
+    CHECK(tail.TotalBytes == 8);
+}
+
+TEST_CASE(FootprintFollowsSubresourceOrderOfArraysAndVolumes)
+{
+    // D3D12CalcSubresource 순서: MipSlice + ArraySlice * MipLevels.
+    const TextureUploadDesc array = MakeTexture(64, 64, 3, DXGI_FORMAT_R8G8B8A8_UNORM, 4);
+    CHECK(TextureUploadPlanner::GetCopyFootprint(array, 4).Width == 32);
+    CHECK(TextureUploadPlanner::GetCopyFootprint(array, 6).Width == 64);
+    CHECK(TextureUploadPlanner::GetCopyFootprint(array, 4).Depth == 1);
+
+    TextureUploadDesc volume = MakeTexture(32, 32, 2, DXGI_FORMAT_R8G8B8A8_UNORM, 8);
+    volume.IsVolume = true;
+    TextureCopyDesc mip1 = TextureUploadPlanner::GetCopyFootprint(volume, 1);
+    CHECK(mip1.Depth == 4);
+    CHECK(mip1.TotalBytes == 256u * 16u * 3u + 256u * 15u + 64u);
+}
+
+TEST_CASE(PlanAlignsEveryPlacement)
+{
+    std::vector<TextureUploadDesc> textures;
+    textures.push_back(MakeTexture(100, 37, 7, DXGI_FORMAT_R8G8B8A8_UNORM));
+    textures.push_back(MakeTexture(130, 66, 8, DXGI_FORMAT_BC3_UNORM));
+    textures.push_back(MakeTexture(3, 5, 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 6));
+
+    TextureUploadPlanner planner(1 << 20);
+    REQUIRE(planner.Plan(textures));
+    CHECK(planner.Copies().size() == 7u + 8u + 6u);
+    CHECK(planner.BatchCount() == 1);
+
+    for (const TextureCopyDesc& copy : planner.Copies())
+    {
+        CHECK(copy.RingOffset % TextureUploadPlanner::PlacementAlignment == 0);
+        CHECK(copy.RowPitch % TextureUploadPlanner::RowPitchAlignment == 0);
+        CHECK(copy.RowPitch >= copy.RowSizeInBytes);
+    }
+    CHECK(BatchesAreDisjoint(planner));
+}
+
+TEST_CASE(PlanStartsNewBatchWhenSubresourceDoesNotFit)
+{
+    // 512x512 RGBA8 밉 하나는 정확히 1 MiB 입니다. 1.5 MiB 링에는 하나씩만 들어갑니다.
+    std::vector<TextureUploadDesc> textures(3, MakeTexture(512, 512, 1, DXGI_FORMAT_R8G8B8A8_UNORM));
+
+    TextureUploadPlanner planner(3 << 19);
+    REQUIRE(planner.Plan(textures));
+    REQUIRE(planner.Copies().size() == 3);
+    CHECK(planner.BatchCount() == 3);
+
+    for (std::uint32_t i = 0; i < 3; ++i)
+    {
+        CHECK(planner.Copies()[i].Batch == i);
+        CHECK(planner.Copies()[i].RingOffset == 0);
+        CHECK(planner.Copies()[i].TextureIndex == i);
+    }
+    CHECK(BatchesAreDisjoint(planner));
+}
+
+TEST_CASE(PlanSplitsMipChainAcrossBatches)
+{
+    // 256x256 RGBA8: 밉 0은 256 KiB, 밉 1은 64 KiB. 300 KiB 링에서는 밉 1부터 다음 배치로 갑니다.
+    std::vector<TextureUploadDesc> textures(1, MakeTexture(256, 256, 9, DXGI_FORMAT_R8G8B8A8_UNORM));
+
+    TextureUploadPlanner planner(300 * 1024);
+    REQUIRE(planner.Plan(textures));
+
+    const std::vector<TextureCopyDesc>& copies = planner.Copies();
+    REQUIRE(copies.size() == 9);
+    CHECK(copies[0].Batch == 0);
+    CHECK(copies[1].Batch == 1);
+    CHECK(copies[1].RingOffset == 0);
+    CHECK(planner.BatchCount() == 2);
+
+    // 배치 안에서는 오프셋이 증가하고 배치는 줄어들지 않습니다.
+    for (size_t i = 1; i < copies.size(); ++i)
+    {
+        CHECK(copies[i].Batch >= copies[i - 1].Batch);
+        if (copies[i].Batch == copies[i - 1].Batch)
+            CHECK(copies[i].RingOffset >= copies[i - 1].RingOffset + copies[i - 1].TotalBytes);
+    }
+    CHECK(BatchesAreDisjoint(planner));
+}
+
+TEST_CASE(PeakStagingBytesIsHighestRingHead)
+{
+    std::vector<TextureUploadDesc> textures;
+    textures.push_back(MakeTexture(256, 256, 9, DXGI_FORMAT_R8G8B8A8_UNORM));
+    textures.push_back(MakeTexture(128, 128, 8, DXGI_FORMAT_BC1_UNORM));
+
+    TextureUploadPlanner planner(8 << 20);
+    REQUIRE(planner.Plan(textures));
+    REQUIRE(planner.BatchCount() == 1);
+
+    std::uint64_t head = 0;
+    for (const TextureCopyDesc& copy : planner.Copies())
+        head = std::max<std::uint64_t>(head, copy.RingOffset + copy.TotalBytes);
+
+    CHECK(planner.PeakStagingBytes() == head);
+    CHECK(planner.PeakStagingBytes() < planner.RingByteSize());
+
+    // 한 배치에 모두 들어가면 텍스쳐별 크기의 합과 배치 사이의 정렬만큼만 차이납니다.
+    CHECK(planner.PeakStagingBytes() >= planner.PerTextureStagingBytes());
+    CHECK(planner.PeakStagingBytes() < planner.PerTextureStagingBytes() + TextureUploadPlanner::PlacementAlignment);
+
+    // 작은 링으로 나누면 최대 사용량은 링 크기를 넘지 않고 텍스쳐별 합보다 작아집니다.
+    TextureUploadPlanner small(300 * 1024);
+    REQUIRE(small.Plan(textures));
+    CHECK(small.BatchCount() > 1);
+    CHECK(small.PeakStagingBytes() <= small.RingByteSize());
+    CHECK(small.PeakStagingBytes() < small.PerTextureStagingBytes());
+    CHECK(small.PerTextureStagingBytes() == planner.PerTextureStagingBytes());
+}
+
+TEST_CASE(PlanFailsWhenSubresourceIsLargerThanRing)
+{
+    std::vector<TextureUploadDesc> textures;
+    textures.push_back(MakeTexture(64, 64, 1, DXGI_FORMAT_R8G8B8A8_UNORM));
+    textures.push_back(MakeTexture(1024, 1024, 1, DXGI_FORMAT_R8G8B8A8_UNORM));
+
+    TextureUploadPlanner planner(1 << 20);
+    CHECK(!planner.Plan(textures));
+    CHECK(planner.Copies().empty());
+
+    // 실패한 뒤에도 다시 계획할 수 있어야 합니다.
+    textures.pop_back();
+    REQUIRE(planner.Plan(textures));
+    CHECK(planner.Copies().size() == 1);
+    CHECK(planner.BatchCount() == 1);
+}
@@ -0,0 +1,410 @@
+﻿//***************************************************************************************
+// TrianglePickerTests.cpp
+//***************************************************************************************
+
+#include "TestHarness.h"
+#include "TrianglePicker.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    struct TestMesh
+    {
+        std::vector<XMFLOAT3> Positions;
+        std::vector<std::uint32_t> Indices;
+    };
+
+    struct TestScene
+    {
+        std::vector<TestMesh> Meshes;
+        std::vector<std::uint32_t> InstanceMesh;
+        std::vector<XMFLOAT4X4> InstanceWorld;
+        std::vector<bool> InstanceEnabled;
+
+        TrianglePicker Picker;
+    };
+
+    TestMesh MakeBox()
+    {
+        TestMesh mesh;
+
+        XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+        BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)).GetCorners(corners);
+        mesh.Positions.assign(corners, corners + BoundingBox::CORNER_COUNT);
+
+        // BoundingBox의 모서리 순서는 앞면(z = -1) 네 개, 뒷면(z = +1) 네 개입니다.
+        mesh.Indices =
+        {
+            0, 1, 2, 0, 2, 3,   4, 6, 5, 4, 7, 6,
+            0, 4, 5, 0, 5, 1,   3, 2, 6, 3, 6, 7,
+            1, 5, 6, 1, 6, 2,   0, 3, 7, 0, 7, 4
+        };
+        return mesh;
+    }
+
+    // 단위 정육면체 안에 흩어진 삼각형들입니다.
+    TestMesh MakeTriangleSoup(TestRandom& random, std::uint32_t triCount)
+    {
+        TestMesh mesh;
+        for (std::uint32_t i = 0; i < triCount; ++i)
+        {
+            const XMFLOAT3 center(random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f));
+            for (int k = 0; k < 3; ++k)
+            {
+                mesh.Indices.push_back((std::uint32_t)mesh.Positions.size());
+                mesh.Positions.push_back(XMFLOAT3(center.x + random.Range(-0.3f, 0.3f),
+                    center.y + random.Range(-0.3f, 0.3f), center.z + random.Range(-0.3f, 0.3f)));
+            }
+        }
+        return mesh;
+    }
+
+    // 회전하고 축마다 다르게 늘린 뒤 옮기는 월드 행렬입니다.
+    XMMATRIX RandomWorld(TestRandom& random, float extent)
+    {
+        XMVECTOR axis = XMVector3Normalize(XMVectorSet(random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f),
+            random.Range(0.1f, 1.0f), 0.0f));
+
+        return XMMatrixScaling(random.Range(0.3f, 3.0f), random.Range(0.3f, 3.0f), random.Range(0.3f, 3.0f)) *
+            XMMatrixRotationAxis(axis, random.Range(0.0f, XM_2PI)) *
+            XMMatrixTranslation(random.Range(-extent, extent), random.Range(-extent, extent), random.Range(-extent, extent));
+    }
+
+    void AddInstance(TestScene& scene, std::uint32_t mesh, FXMMATRIX world)
+    {
+        XMFLOAT4X4 w;
+        XMStoreFloat4x4(&w, world);
+        scene.InstanceMesh.push_back(mesh);
+        scene.InstanceWorld.push_back(w);
+        scene.InstanceEnabled.push_back(true);
+
+        CHECK(scene.Picker.AddInstance(mesh, world) == scene.InstanceMesh.size() - 1);
+    }
+
+    // 상자 메쉬(16비트 인덱스와 baseVertex)와 삼각형 더미 메쉬(32비트 인덱스)의 인스턴스들입니다.
+    void BuildScene(TestScene& scene, TestRandom& random, std::uint32_t instanceCount)
+    {
+        scene.Meshes.push_back(MakeBox());
+        scene.Meshes.push_back(MakeTriangleSoup(random, 200));
+
+        // 상자는 앞에 버텍스 두 개를 더 둔 버퍼에서 baseVertex로 등록합니다.
+        const TestMesh& box = scene.Meshes[0];
+        std::vector<XMFLOAT3> shifted(2, XMFLOAT3(100.0f, 100.0f, 100.0f));
+        shifted.insert(shifted.end(), box.Positions.begin(), box.Positions.end());
+        std::vector<std::uint16_t> boxIndices(box.Indices.begin(), box.Indices.end());
+
+        CHECK(scene.Picker.AddMesh(shifted.data(), sizeof(XMFLOAT3), (std::uint32_t)shifted.size(),
+            boxIndices.data(), (std::uint32_t)boxIndices.size(), 2) == 0);
+
+        const TestMesh& soup = scene.Meshes[1];
+        CHECK(scene.Picker.AddMesh(soup.Positions.data(), sizeof(XMFLOAT3), (std::uint32_t)soup.Positions.size(),
+            soup.Indices.data(), (std::uint32_t)soup.Indices.size()) == 1);
+
+        for (std::uint32_t i = 0; i < instanceCount; ++i)
+            AddInstance(scene, i % 2, RandomWorld(random, 20.0f));
+    }
+
+    // 월드 공간의 삼각형과 레이의 교차 거리입니다. 피커와 독립적으로 double로 계산합니다.
+    bool IntersectWorldTriangle(const PickRay& ray, const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c, double& t)
+    {
+        const double e1[3] = { (double)b.x - a.x, (double)b.y - a.y, (double)b.z - a.z };
+        const double e2[3] = { (double)c.x - a.x, (double)c.y - a.y, (double)c.z - a.z };
+        const double d[3] = { ray.Direction.x, ray.Direction.y, ray.Direction.z };
+        const double s[3] = { (double)ray.Origin.x - a.x, (double)ray.Origin.y - a.y, (double)ray.Origin.z - a.z };
+
+        const double p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+        const double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if (std::fabs(det) < 1e-12)
+            return false;
+
+        const double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+        const double q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        const double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+        t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+
+        return u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= 0.0 && t < ray.MaxDistance;
+    }
+
+    // 모든 인스턴스의 모든 삼각형을 월드 공간에서 테스트합니다.
+    PickHit PickBruteForce(const TestScene& scene, const PickRay& ray)
+    {
+        PickHit hit;
+        double best = DBL_MAX;
+
+        for (std::uint32_t i = 0; i < (std::uint32_t)scene.InstanceMesh.size(); ++i)
+        {
+            if (!scene.InstanceEnabled[i])
+                continue;
+
+            const TestMesh& mesh = scene.Meshes[scene.InstanceMesh[i]];
+            const XMMATRIX world = XMLoadFloat4x4(&scene.InstanceWorld[i]);
+
+            for (std::uint32_t tri = 0; tri < (std::uint32_t)mesh.Indices.size() / 3; ++tri)
+            {
+                XMFLOAT3 v[3];
+                for (int k = 0; k < 3; ++k)
+                    XMStoreFloat3(&v[k], XMVector3TransformCoord(XMLoadFloat3(&mesh.Positions[mesh.Indices[tri * 3 + k]]), world));
+
+                double t = 0.0;
+                if (IntersectWorldTriangle(ray, v[0], v[1], v[2], t) && t < best)
+                {
+                    best = t;
+                    hit.Instance = i;
+                    hit.Triangle = tri;
+                    hit.Distance = (float)t;
+                }
+            }
+        }
+
+        return hit;
+    }
+
+    // 장면 밖의 점에서 장면 안의 점을 향하는 레이들입니다.
+    std::vector<PickRay> RandomRays(TestRandom& random, std::uint32_t count)
+    {
+        std::vector<PickRay> rays(count);
+        for (PickRay& ray : rays)
+        {
+            XMVECTOR origin = XMVectorSet(random.Range(-40.0f, 40.0f), random.Range(-40.0f, 40.0f), random.Range(-40.0f, 40.0f), 1.0f);
+            XMVECTOR target = XMVectorSet(random.Range(-20.0f, 20.0f), random.Range(-20.0f, 20.0f), random.Range(-20.0f, 20.0f), 1.0f);
+            XMStoreFloat3(&ray.Origin, origin);
+            XMStoreFloat3(&ray.Direction, XMVector3Normalize(XMVectorSubtract(target, origin)));
+        }
+        return rays;
+    }
+
+    // 피커의 결과를 기준 구현과 비교합니다. 거의 같은 거리에 삼각형이 두 개 있으면 어느 쪽이든
+    // 맞으므로 거리만 비교하고, 보고된 삼각형과 무게중심 좌표가 그 거리의 점을 가리키는지 확인합니다.
+    void CheckAgainstBruteForce(const TestScene& scene, const std::vector<PickRay>& rays, const std::vector<PickHit>& hits)
+    {
+        for (size_t r = 0; r < rays.size(); ++r)
+        {
+            const PickHit expected = PickBruteForce(scene, rays[r]);
+            const PickHit& hit = hits[r];
+
+            CHECK(hit.IsHit() == expected.IsHit());
+            if (!hit.IsHit() || !expected.IsHit())
+                continue;
+
+            CHECK_NEAR(hit.Distance, expected.Distance, 1e-3f * std::max<float>(1.0f, expected.Distance));
+
+            REQUIRE(hit.Instance < scene.InstanceMesh.size());
+            const TestMesh& mesh = scene.Meshes[scene.InstanceMesh[hit.Instance]];
+            REQUIRE(hit.Triangle < mesh.Indices.size() / 3);
+
+            const XMMATRIX world = XMLoadFloat4x4(&scene.InstanceWorld[hit.Instance]);
+            XMVECTOR v[3];
+            for (int k = 0; k < 3; ++k)
+                v[k] = XMVector3TransformCoord(XMLoadFloat3(&mesh.Positions[mesh.Indices[hit.Triangle * 3 + k]]), world);
+
+            XMVECTOR onTriangle = XMVectorAdd(XMVectorScale(v[0], 1.0f - hit.U - hit.V),
+                XMVectorAdd(XMVectorScale(v[1], hit.U), XMVectorScale(v[2], hit.V)));
+            XMVECTOR onRay = XMVectorAdd(XMLoadFloat3(&rays[r].Origin), XMVectorScale(XMLoadFloat3(&rays[r].Direction), hit.Distance));
+
+            CHECK(XMVectorGetX(XMVector3Length(XMVectorSubtract(onTriangle, onRay))) < 1e-2f);
+        }
+    }
+}
+
+TEST_CASE(PickMatchesBruteForceOnTransformedInstances)
+{
+    TestRandom random(17);
+    TestScene scene;
+    BuildScene(scene, random, 40);
+
+    const std::vector<PickRay> rays = RandomRays(random, 500);
+    std::vector<PickHit> hits(rays.size());
+    scene.Picker.Pick(rays.data(), (std::uint32_t)rays.size(), hits.data());
+
+    CheckAgainstBruteForce(scene, rays, hits);
+    CHECK(scene.Picker.LastStats().Rays == rays.size());
+    CHECK(scene.Picker.LastStats().Hits > 0);
+    CHECK(scene.Picker.LastStats().Hits < rays.size());
+
+    // 한 레이씩 처리해도 같은 결과입니다.
+    for (size_t r = 0; r < rays.size(); r += 25)
+    {
+        const PickHit one = scene.Picker.PickOne(rays[r]);
+        CHECK(one.Instance == hits[r].Instance);
+        CHECK(one.Triangle == hits[r].Triangle);
+        CHECK(one.Distance == hits[r].Distance);
+    }
+}
+
+TEST_CASE(MovedInstancesAreFoundAfterRefitAndRebuild)
+{
+    TestRandom random(29);
+    TestScene scene;
+    BuildScene(scene, random, 60);
+
+    const std::vector<PickRay> rays = RandomRays(random, 300);
+    std::vector<PickHit> hits(rays.size());
+    scene.Picker.Pick(rays.data(), (std::uint32_t)rays.size(), hits.data());
+    CHECK(scene.Picker.LastUpdateStats().Rebuilt);
+
+    // 몇 개만 조금 옮기면 경로만 다시 계산합니다.
+    for (std::uint32_t i = 0; i < 5; ++i)
+    {
+        XMMATRIX world = XMLoadFloat4x4(&scene.InstanceWorld[i]) * XMMatrixTranslation(0.5f, -0.5f, 0.25f);
+        XMStoreFloat4x4(&scene.InstanceWorld[i], world);
+        scene.Picker.SetInstanceWorld(i, world);
+    }
+
+    scene.Picker.Pick(rays.data(), (std::uint32_t)rays.size(), hits.data());
+    CHECK(scene.Picker.LastUpdateStats().MovedInstances == 5);
+    CHECK(scene.Picker.LastUpdateStats().RefitNodes > 0);
+    CheckAgainstBruteForce(scene, rays, hits);
+
+    // 모두 멀리 흩어 놓으면 트리가 나빠지므로 다시 만듭니다.
+    for (std::uint32_t i = 0; i < (std::uint32_t)scene.InstanceWorld.size(); ++i)
+    {
+        XMMATRIX world = RandomWorld(random, 35.0f);
+        XMStoreFloat4x4(&scene.InstanceWorld[i], world);
+        scene.Picker.SetInstanceWorld(i, world);
+    }
+
+    scene.Picker.SetRebuildRatio(1.0f);
+    scene.Picker.Pick(rays.data(), (std::uint32_t)rays.size(), hits.data());
+    CHECK(scene.Picker.LastUpdateStats().Rebuilt);
+    CheckAgainstBruteForce(scene, rays, hits);
+}
+
+TEST_CASE(OccludedAgreesWithClosestHit)
+{
+    TestRandom random(41);
+    TestScene scene;
+    BuildScene(scene, random, 40);
+
+    std::vector<PickRay> rays = RandomRays(random, 400);
+    std::vector<PickHit> hits(rays.size());
+    scene.Picker.Pick(rays.data(), (std::uint32_t)rays.size(), hits.data());
+
+    std::unique_ptr<bool[]> occluded(new bool[rays.size()]);
+    scene.Picker.Occluded(rays.data(), (std::uint32_t)rays.size(), occluded.get());
+
+    for (size_t r = 0; r < rays.size(); ++r)
+        CHECK(occluded[r] == hits[r].IsHit());
+
+    // 가장 가까운 교차보다 조금 짧은 레이는 가려지지 않고, 조금 긴 레이는 가려집니다.
+    for (size_t r = 0; r < rays.size(); ++r)
+    {
+        if (!hits[r].IsHit() || hits[r].Distance < 0.1f)
+            continue;
+
+        PickRay shorter = rays[r];
+        shorter.MaxDistance = hits[r].Distance * 0.99f;
+        CHECK(!scene.Picker.IsOccluded(shorter));
+        CHECK(!scene.Picker.PickOne(shorter).IsHit());
+
+        PickRay longer = rays[r];
+        longer.MaxDistance = hits[r].Distance * 1.01f;
+        CHECK(scene.Picker.IsOccluded(longer));
+    }
+}
+
+TEST_CASE(MissesReportNoHit)
+{
+    TestRandom random(53);
+    TestScene scene;
+    BuildScene(scene, random, 20);
+    scene.Picker.UpdateHierarchy();
+
+    // 장면에서 멀어지는 레이입니다.
+    PickRay away;
+    away.Origin = XMFLOAT3(0.0f, 0.0f, 100.0f);
+    away.Direction = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+    const PickHit miss = scene.Picker.PickOne(away);
+    CHECK(!miss.IsHit());
+    CHECK(miss.Triangle == PickHit::Invalid);
+    CHECK(!scene.Picker.IsOccluded(away));
+
+    // 인스턴스를 모두 끄면 어떤 레이도 맞지 않습니다.
+    const std::vector<PickRay> rays = RandomRays(random, 200);
+    for (std::uint32_t i = 0; i < scene.Picker.InstanceCount(); ++i)
+        scene.Picker.SetInstanceEnabled(i, false);
+
+    std::vector<PickHit> hits(rays.size());
+    scene.Picker.Pick(rays.data(), (std::uint32_t)rays.size(), hits.data());
+    CHECK(scene.Picker.LastStats().Hits == 0);
+    CHECK(scene.Picker.LastStats().TriangleTests == 0);
+
+    // 절반만 다시 켜면 기준 구현도 그 절반만 봅니다.
+    for (std::uint32_t i = 0; i < scene.Picker.InstanceCount(); i += 2)
+    {
+        scene.Picker.SetInstanceEnabled(i, true);
+        scene.InstanceEnabled[i] = true;
+    }
+    for (std::uint32_t i = 1; i < scene.Picker.InstanceCount(); i += 2)
+        scene.InstanceEnabled[i] = false;
+
+    scene.Picker.Pick(rays.data(), (std::uint32_t)rays.size(), hits.data());
+    CheckAgainstBruteForce(scene, rays, hits);
+}
+
+TEST_CASE(OutOfRangeIndicesRejectTheMesh)
+{
+    TrianglePicker picker;
+    const TestMesh box = MakeBox();
+    const std::uint32_t vertexCount = (std::uint32_t)box.Positions.size();
+
+    // 버텍스 수와 같은 인덱스는 범위 밖입니다.
+    std::vector<std::uint32_t> indices = box.Indices;
+    indices[7] = vertexCount;
+    CHECK(picker.AddMesh(box.Positions.data(), sizeof(XMFLOAT3), vertexCount, indices.data(),
+        (std::uint32_t)indices.size()) == TrianglePicker::Invalid);
+
+    // baseVertex가 더해진 인덱스도 검사합니다.
+    CHECK(picker.AddMesh(box.Positions.data(), sizeof(XMFLOAT3), vertexCount, box.Indices.data(),
+        (std::uint32_t)box.Indices.size(), 1) == TrianglePicker::Invalid);
+    CHECK(picker.AddMesh(box.Positions.data(), sizeof(XMFLOAT3), vertexCount, box.Indices.data(),
+        (std::uint32_t)box.Indices.size(), -1) == TrianglePicker::Invalid);
+
+    std::vector<std::uint16_t> indices16(box.Indices.begin(), box.Indices.end());
+    indices16[0] = 0xFFFF;
+    CHECK(picker.AddMesh(box.Positions.data(), sizeof(XMFLOAT3), vertexCount, indices16.data(),
+        (std::uint32_t)indices16.size()) == TrianglePicker::Invalid);
+
+    CHECK(picker.MeshCount() == 0);
+    CHECK(picker.AddInstance(TrianglePicker::Invalid, XMMatrixIdentity()) == TrianglePicker::Invalid);
+    CHECK(picker.InstanceCount() == 0);
+
+    // 올바른 메쉬는 그대로 등록됩니다.
+    const std::uint32_t mesh = picker.AddMesh(box.Positions.data(), sizeof(XMFLOAT3), vertexCount,
+        box.Indices.data(), (std::uint32_t)box.Indices.size());
+    CHECK(mesh == 0);
+    CHECK(picker.AddInstance(mesh, XMMatrixIdentity()) == 0);
+}
+
+TEST_CASE(SingularWorldMatrixIsNeverHit)
+{
+    TrianglePicker picker;
+    const TestMesh box = MakeBox();
+    const std::uint32_t mesh = picker.AddMesh(box.Positions.data(), sizeof(XMFLOAT3), (std::uint32_t)box.Positions.size(),
+        box.Indices.data(), (std::uint32_t)box.Indices.size());
+
+    // y 축으로 납작하게 눌린 인스턴스입니다.
+    const std::uint32_t instance = picker.AddInstance(mesh, XMMatrixScaling(2.0f, 0.0f, 2.0f));
+    picker.UpdateHierarchy();
+
+    PickRay down;
+    down.Origin = XMFLOAT3(0.1f, 10.0f, 0.2f);
+    down.Direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+    CHECK(!picker.PickOne(down).IsHit());
+    CHECK(!picker.IsOccluded(down));
+
+    // 역행렬이 있는 행렬로 돌아오면 다시 선택됩니다.
+    picker.SetInstanceWorld(instance, XMMatrixScaling(2.0f, 0.5f, 2.0f));
+    picker.UpdateHierarchy();
+
+    const PickHit hit = picker.PickOne(down);
+    CHECK(hit.IsHit());
+    CHECK_NEAR(hit.Distance, 9.5f, 1e-4f);
+}